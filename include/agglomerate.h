@@ -0,0 +1,158 @@
+#ifndef _AGGLOMERATE_H
+#define _AGGLOMERATE_H
+
+#include <quda_internal.h>
+#include <invert_quda.h>
+#include <dirac_quda.h>
+#include <color_spinor_field.h>
+#include <comm_quda.h>
+
+#include <vector>
+
+namespace quda {
+
+  /**
+     Agglomeration of a coarse-grid solve onto fewer processes.  When
+     the local volume of a coarse lattice becomes so small that the
+     solve is dominated by halo exchanges and global reductions, the
+     processes are grouped into blocks of agg[0] x ... x agg[3]
+     neighbours and the coarse operator is gathered onto one process
+     of each block (the master).  The masters form a process group
+     with its own communicator and process grid, on which the coarse
+     system is solved on the host; the other processes wait for the
+     solution to be scattered back.
+   */
+  class Agglomerate {
+
+  private:
+    /** The distributed coarse operator */
+    const DiracCoarse &dirac;
+
+    TimeProfile &profile;
+
+    /** Parameters of the distributed coarse solver, which accumulate the solver statistics */
+    SolverParam &param;
+
+    /** Whether the solve is on the even-odd preconditioned system */
+    const bool matpc;
+
+    /** Number of dimensions of the lattice */
+    int nDim;
+
+    /** Local dimensions of the distributed coarse lattice */
+    int X[QUDA_MAX_DIM];
+
+    /** Agglomeration factor in each dimension */
+    int agg[QUDA_MAX_DIM];
+
+    /** Whether any dimension is agglomerated */
+    bool active;
+
+    /** Process grid of the masters */
+    int group_dims[QUDA_MAX_DIM];
+
+    /** Whether this process holds the agglomerated problem */
+    bool master;
+
+    /** Rank of the master of this process */
+    int master_rank;
+
+    /** Ranks of the processes of the block of this master, with their offsets on the agglomerated lattice */
+    std::vector<int> member_rank;
+    std::vector<std::vector<int> > member_offset;
+
+    /** The group of masters (null on the other processes) */
+    CommGroup *group;
+
+    /** Agglomerated link fields (masters only) */
+    cpuGaugeField *Y_h, *X_h, *Xinv_h, *Yhat_h;
+
+    /** Agglomerated coarse operators (masters only) */
+    DiracCoarse *dirac_agg;
+    Dirac *dirac_solve;
+    DiracMatrix *mat;
+
+    /** Solver of the agglomerated system (masters only) */
+    SolverParam *solver_param;
+    Solver *solver;
+
+    /** Agglomerated solution and source (masters only) */
+    ColorSpinorField *x_agg, *b_agg;
+
+    /** Host copies of the local solution and source */
+    ColorSpinorField *x_h, *b_h;
+
+    /** Prefix of the agglomerated solver output */
+    char prefix[128];
+
+    /**
+       @brief Copy arrays with site_bytes per site between the local
+       lattice and the agglomerated lattice of a master
+       @param[in,out] agg_ptr Array on the agglomerated lattice
+       @param[in,out] local_ptr Array on the local lattice
+       @param[in] offset Coordinates of the local lattice origin on the agglomerated lattice
+       @param[in] site_bytes Bytes per site
+       @param[in] to_agg Whether to copy from the local to the agglomerated array
+    */
+    void copyBlock(char *agg_ptr, char *local_ptr, const int *offset, size_t site_bytes, bool to_agg) const;
+
+    /**
+       @brief Gather n arrays from all processes of each block onto
+       its master, or scatter them back
+       @param[in,out] local Arrays on the local lattice
+       @param[in,out] agglomerated Arrays on the agglomerated lattice (masters only)
+       @param[in] n Number of arrays
+       @param[in] site_bytes Bytes per site
+       @param[in] gather Whether to gather (true) or scatter (false)
+    */
+    void exchange(void * const *local, void * const *agglomerated, int n, size_t site_bytes, bool gather) const;
+
+    /**
+       @brief Gather the link fields of the coarse operator onto the
+       masters and exchange their halos on the agglomerated lattice
+    */
+    void gatherLinks();
+
+  public:
+    /**
+       @brief Set up the agglomeration of the solve with a coarse
+       operator.  This is collective over all processes.  No process
+       groups are formed if the local volume is already above
+       min_volume or the process grid cannot be coarsened.
+       @param[in] dirac The distributed coarse operator
+       @param[in] meta Field defining the coarse lattice
+       @param[in] min_volume Agglomerate until the local volume is at least this
+       @param[in] param Parameters of the distributed coarse solver
+       @param[in] matpc Whether to solve the even-odd preconditioned system
+       @param[in] prefix Output prefix of the agglomerated solver
+       @param[in] profile Profile for the solver
+    */
+    Agglomerate(const DiracCoarse &dirac, const ColorSpinorField &meta, int min_volume,
+                SolverParam &param, bool matpc, const char *prefix, TimeProfile &profile);
+    virtual ~Agglomerate();
+
+    /**
+       @return Whether the solve is agglomerated
+    */
+    bool Active() const { return active; }
+
+    /**
+       @brief Solve the coarse system on the masters.  This is
+       collective over all processes.
+       @param[out] x Solution vector
+       @param[in] b Right hand side
+    */
+    void operator()(ColorSpinorField &x, ColorSpinorField &b);
+
+    /**
+       @brief Refresh the agglomerated operator after the sign of the
+       twisted mass of the distributed operator has been flipped.
+       The process groups and solvers are kept.  This is collective
+       over all processes.
+    */
+    void flipMu();
+  };
+
+} // namespace quda
+
+#endif // _AGGLOMERATE_H
@@ -103,6 +103,21 @@ namespace quda {
     double doubleCG3InitNorm(double a, ColorSpinorField &x, ColorSpinorField &y, ColorSpinorField &z);
     double doubleCG3UpdateNorm(double a, double b, ColorSpinorField &x, ColorSpinorField &y, ColorSpinorField &z);
 
+    /**
+       @brief Fused update of the auxiliary recurrences of pipelined CG:
+       y = x + b*y, w = z + b*w, z = z - a*y (with the new y)
+    */
+    void pipeCGUpdate(double a, double b, ColorSpinorField &x, ColorSpinorField &y,
+		      ColorSpinorField &z, ColorSpinorField &w);
+
+    /**
+       @brief Fused solution, residual and direction update of
+       pipelined CG: y = x + b*y, w = w + a*y, x = x - a*z, returning
+       (x,x) and Re(v,x) for the new x
+    */
+    double2 pipeCGUpdateNorm(double a, double b, ColorSpinorField &x, ColorSpinorField &y,
+			     ColorSpinorField &z, ColorSpinorField &w, ColorSpinorField &v);
+
     /**
        @brief Compute the block "caxpy" with over the set of
        ColorSpinorFields.  E.g., it computes
@@ -110,7 +125,8 @@ namespace quda {
        y = x * a + y
 
        The dimensions of a can be rectangular, e.g., the width of x
-       and y need not be same.
+       and y need not be same.  Host fields are updated with one
+       caxpy per coefficient.
 
        @param a[in] Matrix of coefficients
        @param x[in] vector of input ColorSpinorFields
@@ -313,7 +329,9 @@ namespace quda {
     void reDotProduct(double* result, std::vector<ColorSpinorField*>& a, std::vector<ColorSpinorField*>& b);
 
     /**
-       @brief Computes the matrix of inner products between the vector set a and the vector set b
+       @brief Computes the matrix of inner products between the vector
+       set a and the vector set b.  Host fields are reduced with one
+       dot product per pair.
 
        @param result[out] Matrix of inner product result[i][j] = (a[j],b[i])
        @param a[in] set of input ColorSpinorFields
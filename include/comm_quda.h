@@ -7,6 +7,8 @@ extern "C" {
 
   typedef struct MsgHandle_s MsgHandle;
   typedef struct Topology_s Topology;
+  typedef struct ReduceHandle_s ReduceHandle;
+  typedef struct CommGroup_s CommGroup;
 
   /* defined in quda.h; redefining here to avoid circular references */ 
   typedef int (*QudaCommsMap)(const int *coords, void *fdata);
@@ -256,6 +258,26 @@ extern "C" {
   MsgHandle *comm_declare_strided_receive_displaced(void *buffer, const int displacement[],
 						    size_t blksize, int nblocks, size_t stride);
 
+  /**
+     Create a persistent message handler for a send to an arbitrary
+     process, e.g., to gather a field onto fewer processes
+     @param buffer Buffer from which message will be sent
+     @param rank Rank of the receiving process
+     @param tag Tag distinguishing messages between the same processes
+     @param nbytes Size of message in bytes
+  */
+  MsgHandle *comm_declare_send_rank(void *buffer, int rank, int tag, size_t nbytes);
+
+  /**
+     Create a persistent message handler for a receive from an
+     arbitrary process
+     @param buffer Buffer into which message will be received
+     @param rank Rank of the sending process
+     @param tag Tag distinguishing messages between the same processes
+     @param nbytes Size of message in bytes
+  */
+  MsgHandle *comm_declare_receive_rank(void *buffer, int rank, int tag, size_t nbytes);
+
   void comm_free(MsgHandle *mh);
   void comm_start(MsgHandle *mh);
   void comm_wait(MsgHandle *mh);
@@ -264,15 +286,89 @@ extern "C" {
   void comm_allreduce_max(double* data);
   void comm_allreduce_min(double* data);
   void comm_allreduce_array(double* data, size_t size);
+
+  /**
+     @brief Start a non-blocking global sum of an array of doubles.
+     The array must not be accessed until the reduction has been
+     completed with comm_allreduce_wait.  Where non-blocking
+     collectives are not available the sum is done on the spot.
+     @param[in,out] data Array to sum, in place
+     @param[in] size Length of the array
+     @return Handle for the reduction (may be null)
+  */
+  MsgHandle *comm_allreduce_array_async(double* data, size_t size);
+
+  /**
+     @brief Complete a reduction started with
+     comm_allreduce_array_async and free its handle
+     @param[in] mh Handle for the reduction
+  */
+  void comm_allreduce_wait(MsgHandle *mh);
   void comm_allreduce_int(int* data);
   void comm_allreduce_xor(uint64_t *data);
   void comm_broadcast(void *data, size_t nbytes);
   void comm_barrier(void);
   void comm_abort(int status);
 
+  /**
+     @brief Create a group of processes with its own communicator and
+     process grid, e.g., to solve a small problem on a subset of the
+     processes.  This is collective over the active processes, and
+     only the processes that join the group get a handle.
+     @param[in] join Whether this process joins the group
+     @param[in] key Rank of this process within the group
+     @param[in] ndim Number of dimensions of the group process grid
+     @param[in] dims Dimensions of the group process grid
+     @param[in] rank_from_coords Map from grid coordinates to group rank
+     @param[in] map_data Data passed to rank_from_coords
+     @return Handle for the group, or null if this process did not join
+  */
+  CommGroup *comm_group_create(int join, int key, int ndim, const int *dims,
+                               QudaCommsMap rank_from_coords, void *map_data);
+
+  /**
+     @brief Destroy a group created with comm_group_create
+     @param[in] group Group to destroy (may be null)
+  */
+  void comm_group_destroy(CommGroup *group);
+
+  /**
+     @brief Make a group the active set of processes: until
+     comm_group_pop is called, comm_rank, comm_size, the default
+     topology, and all messages and reductions refer to the group.
+     Groups cannot be nested.
+     @param[in] group Group to activate
+  */
+  void comm_group_push(CommGroup *group);
+
+  /**
+     @brief Restore the set of processes that was active before
+     comm_group_push was called
+  */
+  void comm_group_pop(void);
+
   void reduceMaxDouble(double &);
   void reduceDouble(double &);
   void reduceDoubleArray(double *, const int len);
+
+  /**
+     @brief Start a non-blocking reduceDoubleArray, so that the global
+     reduction can be overlapped with other work, e.g., an operator
+     application.  Setting the environment variable
+     QUDA_REDUCTION_LATENCY to a time in microseconds adds that latency
+     to every global reduction (blocking or not), so a run on a few
+     local processes can stand in for the reduction cost at scale.
+     @param[in,out] sum Array to sum, in place
+     @param[in] len Length of the array
+     @return Handle for the reduction
+  */
+  ReduceHandle *reduceDoubleArrayStart(double *sum, const int len);
+
+  /**
+     @brief Complete a reduction started with reduceDoubleArrayStart
+     @param[in] handle Handle for the reduction, freed on return
+  */
+  void reduceDoubleArrayWait(ReduceHandle *handle);
   int commDim(int);
   int commCoords(int);
   int commDimPartitioned(int dir);
@@ -3,6 +3,7 @@
 #include <invert_quda.h>
 #include <vector>
 #include <complex_quda.h>
+#include <native_io.h>
 
 namespace quda {
 
@@ -48,8 +49,12 @@ namespace quda {
     /** Filename for where to load/store the deflation space */
     char filename[100];
 
+    /** Key identifying the operator the deflation space belongs to,
+	used to validate a persistent deflation space store */
+    uint64_t store_key;
+
     DeflationParam(QudaEigParam &param, ColorSpinorField *RV,  DiracMatrix &matDeflation, int cur_dim = 0) : eig_global(param), RV(RV), matDeflation(matDeflation), 
-             cur_dim(cur_dim), use_inv_ritz(false), location(param.location) {
+             cur_dim(cur_dim), use_inv_ritz(false), location(param.location), store_key(0) {
 
         if(param.nk == 0 || param.np == 0 || (param.np % param.nk != 0)) errorQuda("\nIncorrect deflation space parameters...\n");
         //redesign: param.nk => param.nev, param.np => param.deflation_grid*param.nev;
@@ -96,6 +101,25 @@ namespace quda {
     /** Deflation matrix operation result */
     ColorSpinorField *Av_sloppy;
 
+    /** Store the deflation space was restored from (mapped) */
+    NativeVectorStore *store_in;
+
+    /** Store that is kept up to date with the deflation space */
+    NativeVectorStore *store_out;
+
+    /** Number of leading Ritz vectors resident in RV (the remaining
+	ones are still only in store_in) */
+    int loaded_dim;
+
+    /** Number of leading Ritz vectors already saved in store_out */
+    int stored_dim;
+
+    /**
+       @brief Copy the Ritz vectors that are still only in the mapped
+       deflation space store into RV
+     */
+    void pageIn();
+
 
   public:
     /** 
@@ -141,13 +165,33 @@ namespace quda {
     void operator()(ColorSpinorField &out, ColorSpinorField &in);
 
     /**
-       @brief Load the eigen space vectors from file
+       @brief Deflate a family of shifted systems (A + sigma_j) x_j = b
+       at once: x_j = V (H + sigma_j)^{-1} V^dag b, with H the
+       projection matrix, and r = b - V V^dag b.  The residuals of the
+       shifted systems then stay collinear, as required by the
+       multi-shift solvers, up to the Ritz residuals of the deflation
+       space.
+       @param x The deflated guesses, one per shift
+       @param r The projected common residual
+       @param b The right hand side
+       @param offset The shifts sigma_j
+     */
+    void operator()(std::vector<ColorSpinorField*> &x, ColorSpinorField &r, ColorSpinorField &b, const double *offset);
+
+    /**
+       @brief Load the eigen space vectors from file.  A deflation
+       space store is only mapped, and its vectors are paged in on
+       first use; other files are read through QIO.
        @param RV Loaded eigen-space vectors (pre-allocated)
      */
     void loadVectors(ColorSpinorField *RV);
 
     /**
-       @brief Save the eigen space vectors in file
+       @brief Save the eigen space vectors in file.  With vec_store
+       set, this appends the vectors added since the last save to the
+       deflation space store, together with the inverse Ritz values and
+       projection matrix; otherwise the whole space is written as a
+       SciDAC file through QIO
        @param RV Save eigen-space vectors from here
      */
     void saveVectors(ColorSpinorField *RV);
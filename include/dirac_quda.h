@@ -14,6 +14,7 @@ namespace quda {
 
   class Transfer;
   class Dirac;
+  class CoarseMatrixPowers;
 
   // Params for Dirac operator
   class DiracParam {
@@ -44,6 +45,8 @@ namespace quda {
 
     QudaPrecision halo_precision; // only does something for DiracCoarse at present
 
+    QudaPrecision link_precision; // storage precision of the coarse link fields, only used by DiracCoarse
+
     // for multigrid only
     Transfer *transfer; 
     Dirac *dirac;
@@ -51,7 +54,7 @@ namespace quda {
   DiracParam() 
     : type(QUDA_INVALID_DIRAC), kappa(0.0), m5(0.0), matpcType(QUDA_MATPC_INVALID),
       dagger(QUDA_DAG_INVALID), gauge(0), clover(0), mu(0.0), mu_factor(0.0), epsilon(0.0),
-      tmp1(0), tmp2(0), halo_precision(QUDA_INVALID_PRECISION)
+      tmp1(0), tmp2(0), halo_precision(QUDA_INVALID_PRECISION), link_precision(QUDA_INVALID_PRECISION)
     {
       for (int i=0; i<QUDA_MAX_DIM; i++) commDim[i] = 1;
     }
@@ -68,6 +71,7 @@ namespace quda {
       printfQuda("mu = %g\n", mu);
       printfQuda("epsilon = %g\n", epsilon);
       printfQuda("halo_precision = %d\n", halo_precision);
+      printfQuda("link_precision = %d\n", link_precision);
       for (int i=0; i<QUDA_MAX_DIM; i++) printfQuda("commDim[%d] = %d\n", i, commDim[i]);
       for (int i=0; i<Ls; i++) printfQuda("b_5[%d] = %e\t c_5[%d] = %e\n", i,b_5[i],i,c_5[i]);
     }
@@ -143,6 +147,47 @@ namespace quda {
     void Mdag(ColorSpinorField &out, const ColorSpinorField &in) const;
     void MMdag(ColorSpinorField &out, const ColorSpinorField &in) const;
 
+    /**
+       @brief Apply M to a batch of fields.  The default applies the
+       operator to each field in turn; operators with a multi-RHS
+       stencil override this so that the gauge field is read once for
+       the whole batch.
+       @param[out] out Batch of output fields
+       @param[in] in Batch of input fields
+    */
+    virtual void M(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in) const;
+
+    /**
+       @brief Apply MdagM to a batch of fields (see M)
+       @param[out] out Batch of output fields
+       @param[in] in Batch of input fields
+    */
+    virtual void MdagM(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in) const;
+
+    /**
+       @brief Apply successive powers of M, out[k] = M^{k+1} in.  The
+       default applies M in turn; operators with a matrix-powers
+       kernel override this to compute several powers from a single
+       halo exchange.
+       @param[out] out Powers of M applied to in
+       @param[in] in Input field
+    */
+    virtual void MPowers(std::vector<ColorSpinorField*> &out, const ColorSpinorField &in) const;
+
+    /**
+       @brief Approximate solve of M x = b restricted to the local
+       domain extended by an overlap, as used by the restricted
+       additive Schwarz smoother.  Only operators with an extended
+       halo kernel support this; the default is an error.
+       @param[out] x Solution on the local sites
+       @param[in] b Source
+       @param[in] overlap Depth of the domain overlap
+       @param[in] niter Number of minimal-residual iterations on the domain
+       @param[in] omega Relaxation parameter of the iterations
+    */
+    virtual void SolveDomain(ColorSpinorField &x, const ColorSpinorField &b, int overlap, int niter,
+			     double omega) const;
+
     // required methods to use e-o preconditioning for solving full system
     virtual void prepare(ColorSpinorField* &src, ColorSpinorField* &sol,
 			 ColorSpinorField &x, ColorSpinorField &b,
@@ -157,6 +202,12 @@ namespace quda {
     virtual double Mu() const { return 0.; }
     virtual double MuFactor() const { return 0.; }
 
+    /**
+       @brief Flip the sign of the twisted-mass parameter, giving the
+       operator of the opposite flavor (twisted operators only)
+    */
+    virtual void flipMu() { errorQuda("Not supported for Dirac type %d", type); }
+
     unsigned long long Flops() const { unsigned long long rtn = flops; flops = 0; return rtn; }
 
 
@@ -509,6 +560,8 @@ namespace quda {
 
     double Mu() const { return mu; }
 
+    void flipMu() { mu = -mu; }
+
    /**
      * @brief Create the coarse twisted-mass operator
      *
@@ -593,6 +646,8 @@ namespace quda {
 
     double Mu() const { return mu; }
 
+    void flipMu() { mu = -mu; }
+
    /**
      * @brief Create the coarse twisted-clover operator
      *
@@ -804,19 +859,44 @@ namespace quda {
     mutable bool init_gpu; /** Whether this instance did the GPU allocation or not */
     mutable bool init_cpu; /** Whether this instance did the CPU allocation or not */
     const bool mapped; /** Whether we allocate Y and X GPU fields in mapped memory or not */
+    const QudaPrecision link_precision; /** Requested storage precision of the link fields */
+
+    /**
+       @brief Precision the link fields are stored in
+       @param[in] gpu Whether for the gpu (true) or cpu (false) fields
+       @return The null-space precision, or the requested link
+       precision if that is lower
+     */
+    QudaPrecision LinkPrecision(bool gpu) const;
 
     /**
        @brief Allocate the Y and X fields
        @param[in] gpu Whether to allocate on gpu (true) or cpu (false)
        @param[in] mapped whether to put gpu allocations into mapped memory
+       @param[in] precision Precision to allocate the fields in
+       (default is the storage precision given by LinkPrecision)
      */
-    void createY(bool gpu = true, bool mapped = false) const;
+    void createY(bool gpu = true, bool mapped = false, QudaPrecision precision = QUDA_INVALID_PRECISION) const;
+
+    mutable CoarseMatrixPowers *matrix_powers; /** Matrix-powers kernel for host fields */
+
+    mutable CoarseMatrixPowers *schwarz_domain; /** Extended-halo kernel for the overlapping Schwarz domain solves */
 
     /**
        @brief Allocate the Yhat and Xinv fields
        @param[in] gpu Whether to allocate on gpu (true) or cpu (false)
+       @param[in] precision Precision to allocate the fields in
+       (default is the storage precision given by LinkPrecision)
+     */
+    void createYhat(bool gpu = true, QudaPrecision precision = QUDA_INVALID_PRECISION) const;
+
+    /**
+       @brief Replace the link fields at the setup location, computed
+       in the null-space precision, by copies in the storage precision.
+       Fixed-point fields carry one scale factor per matrix row, taken
+       from the absolute maximum of that row.
      */
-    void createYhat(bool gpu = true) const;
+    void compressLinks() const;
 
   public:
     double Mu() const { return mu; }
@@ -826,8 +906,11 @@ namespace quda {
        @param[in] param Parameters defining this operator
        @param[in] gpu_setup Whether to do the setup on GPU or CPU
        @param[in] mapped Set to true to put Y and X fields in mapped memory
+       @param[in] compute Whether to compute the coarse operator now;
+       when false only the host link fields are allocated, to be
+       filled through HostFields() and completed with restoreCoarseOp()
      */
-    DiracCoarse(const DiracParam &param, bool gpu_setup=true, bool mapped=false);
+    DiracCoarse(const DiracParam &param, bool gpu_setup=true, bool mapped=false, bool compute=true);
 
     /**
        @param[in] param Parameters defining this operator
@@ -851,6 +934,35 @@ namespace quda {
     DiracCoarse(const DiracCoarse &dirac, const DiracParam &param);
     virtual ~DiracCoarse();
 
+    /**
+       @brief Return the host copies of the coarse link fields,
+       copying them from the device if needed.  These are used to
+       checkpoint and restore the coarse operator.
+       @param[out] Y Host coarse link field
+       @param[out] X Host coarse clover field
+       @param[out] Xinv Host coarse inverse clover field
+       @param[out] Yhat Host coarse preconditioned link field
+     */
+    void HostFields(cpuGaugeField *&Y, cpuGaugeField *&X, cpuGaugeField *&Xinv, cpuGaugeField *&Yhat) const;
+
+    /**
+       @brief Complete the restore of the coarse operator after its
+       host link fields have been filled: exchange the link ghost
+       zones and update any device copies.
+     */
+    void restoreCoarseOp();
+
+    /**
+       @brief Flip the sign of the twisted-mass parameter.  Since the
+       transfer operator preserves chirality, the coarse operator for
+       -mu is X(-mu) = Gamma5 X(mu)^dag Gamma5 with the links Y
+       unchanged, so only the coarse clover term and the
+       preconditioned links are recomputed.  Operators cloned from
+       another instance only refresh the fields they own, so the
+       instance they were cloned from must be flipped first.
+    */
+    void flipMu();
+
     /**
        @brief Apply the coarse clover operator
        @param[out] out Output field
@@ -894,6 +1006,50 @@ namespace quda {
 
     virtual void MdagM(ColorSpinorField &out, const ColorSpinorField &in) const;
 
+    /**
+       @brief Apply M to a batch of fields.  The batch is applied as
+       a single field with the sources along the fifth dimension, so
+       each link matrix is read once for the whole batch.  Half and
+       quarter precision device fields are applied in turn.
+       @param[out] out Batch of output fields
+       @param[in] in Batch of input fields
+    */
+    virtual void M(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in) const;
+
+    /**
+       @brief Apply MdagM to a batch of fields (see M)
+       @param[out] out Batch of output fields
+       @param[in] in Batch of input fields
+    */
+    virtual void MdagM(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in) const;
+
+    /**
+       @brief Apply successive powers of the operator.  For host
+       fields the powers are computed by the matrix-powers kernel
+       from a single depth-s halo exchange, with s the number of
+       powers; device fields apply the operator in turn.
+       @param[out] out Powers of M applied to in
+       @param[in] in Input field
+    */
+    virtual void MPowers(std::vector<ColorSpinorField*> &out, const ColorSpinorField &in) const;
+
+    /**
+       @brief Overlapping domain solve of the restricted additive
+       Schwarz smoother.  The solve is done on the host with the
+       extended-halo kernel, which imports the overlap with a single
+       exchange.  Host fields in another order or in half precision
+       are staged; device fields are rejected, since copying them to
+       the host and back on every smoother application would cost more
+       than the halo exchanges saved.
+       @param[out] x Solution on the local sites
+       @param[in] b Source
+       @param[in] overlap Depth of the domain overlap
+       @param[in] niter Number of minimal-residual iterations on the domain
+       @param[in] omega Relaxation parameter of the iterations
+    */
+    virtual void SolveDomain(ColorSpinorField &x, const ColorSpinorField &b, int overlap, int niter,
+			     double omega) const;
+
     virtual void prepare(ColorSpinorField* &src, ColorSpinorField* &sol, ColorSpinorField &x, ColorSpinorField &b,
 			 const QudaSolutionType) const;
 
@@ -951,6 +1107,12 @@ namespace quda {
 		    const ColorSpinorField &x, const double &k) const;
     void M(ColorSpinorField &out, const ColorSpinorField &in) const;
     void MdagM(ColorSpinorField &out, const ColorSpinorField &in) const;
+    void M(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in) const { Dirac::M(out, in); }
+    void MdagM(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in) const
+    { Dirac::MdagM(out, in); }
+    void MPowers(std::vector<ColorSpinorField*> &out, const ColorSpinorField &in) const { Dirac::MPowers(out, in); }
+    void SolveDomain(ColorSpinorField &x, const ColorSpinorField &b, int overlap, int niter, double omega) const
+    { Dirac::SolveDomain(x, b, overlap, niter, omega); }
     void prepare(ColorSpinorField* &src, ColorSpinorField* &sol, ColorSpinorField &x, ColorSpinorField &b,
 		 const QudaSolutionType) const;
     void reconstruct(ColorSpinorField &x, const ColorSpinorField &b, const QudaSolutionType) const;
@@ -1075,6 +1237,35 @@ namespace quda {
     virtual void operator()(ColorSpinorField &out, const ColorSpinorField &in,
 			    ColorSpinorField &Tmp1, ColorSpinorField &Tmp2) const = 0;
 
+    /**
+       @brief Apply the operator to a batch of fields.  By default
+       each field is done in turn; DiracM and DiracMdagM forward the
+       batch to the Dirac operator so that multi-RHS stencils are used
+       where available.
+       @param[out] out Batch of output fields
+       @param[in] in Batch of input fields
+       @param[in] Tmp1 Temporary field
+       @param[in] Tmp2 Temporary field
+    */
+    virtual void operator()(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in,
+			    ColorSpinorField &Tmp1, ColorSpinorField &Tmp2) const
+    {
+      for (unsigned int i=0; i<in.size(); i++) (*this)(*out[i], *in[i], Tmp1, Tmp2);
+    }
+
+    /**
+       @brief Apply successive powers of the operator, out[k] =
+       M^{k+1} in.  By default the operator is applied in turn; DiracM
+       forwards to the Dirac operator so that a matrix-powers kernel
+       is used where available.
+       @param[out] out Powers of the operator applied to in
+       @param[in] in Input field
+       @param[in] tmp Temporary field
+    */
+    virtual void powers(std::vector<ColorSpinorField*> &out, const ColorSpinorField &in, ColorSpinorField &tmp) const
+    {
+      for (unsigned int k=0; k<out.size(); k++) (*this)(*out[k], k==0 ? in : *out[k-1], tmp);
+    }
 
     unsigned long long flops() const { return dirac->Flops(); }
 
@@ -1092,7 +1283,7 @@ namespace quda {
 	      Type() == typeid(DiracImprovedStaggered).name()) ? true : false;
     }
     
-    const Dirac* Expose() { return dirac; }
+    const Dirac* Expose() const { return dirac; }
 
     //! Shift term added onto operator (M/M^dag M/M M^dag + shift)
     double shift;
@@ -1132,6 +1323,31 @@ namespace quda {
       if (reset1) { dirac->tmp1 = NULL; reset1 = false; }
     }
 
+    void operator()(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in,
+		    ColorSpinorField &Tmp1, ColorSpinorField &Tmp2) const
+    {
+      bool reset1 = false;
+      bool reset2 = false;
+      if (!dirac->tmp1) { dirac->tmp1 = &Tmp1; reset1 = true; }
+      if (!dirac->tmp2) { dirac->tmp2 = &Tmp2; reset2 = true; }
+      dirac->M(out, in);
+      if (shift != 0.0) for (unsigned int i=0; i<in.size(); i++) blas::axpy(shift, *in[i], *out[i]);
+      if (reset2) { dirac->tmp2 = NULL; reset2 = false; }
+      if (reset1) { dirac->tmp1 = NULL; reset1 = false; }
+    }
+
+    void powers(std::vector<ColorSpinorField*> &out, const ColorSpinorField &in, ColorSpinorField &tmp) const
+    {
+      if (shift != 0.0) {
+	DiracMatrix::powers(out, in, tmp);
+	return;
+      }
+      bool reset1 = false;
+      if (!dirac->tmp1) { dirac->tmp1 = &tmp; reset1 = true; }
+      dirac->MPowers(out, in);
+      if (reset1) { dirac->tmp1 = NULL; reset1 = false; }
+    }
+
     int getStencilSteps() const
     {
       return dirac->getStencilSteps(); 
@@ -1170,6 +1386,17 @@ namespace quda {
       dirac->tmp2 = NULL;
       dirac->tmp1 = NULL;
     }
+
+    void operator()(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in,
+		    ColorSpinorField &Tmp1, ColorSpinorField &Tmp2) const
+    {
+      dirac->tmp1 = &Tmp1;
+      dirac->tmp2 = &Tmp2;
+      dirac->MdagM(out, in);
+      if (shift != 0.0) for (unsigned int i=0; i<in.size(); i++) blas::axpy(shift, *in[i], *out[i]);
+      dirac->tmp2 = NULL;
+      dirac->tmp1 = NULL;
+    }
  
     int getStencilSteps() const
     {
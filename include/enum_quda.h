@@ -123,6 +123,11 @@ extern "C" {
     QUDA_CG3NR_INVERTER,
     QUDA_CA_CG_INVERTER,
     QUDA_CA_GCR_INVERTER,
+    QUDA_MSRC_CG_INVERTER,
+    QUDA_PIPELINED_CG_INVERTER,
+    QUDA_GCRODR_INVERTER,
+    QUDA_GMRES_POLYNOMIAL_INVERTER,
+    QUDA_CHEBYSHEV_INVERTER,
     QUDA_INVALID_INVERTER = QUDA_INVALID_ENUM
   } QudaInverterType;
 
@@ -168,6 +173,19 @@ extern "C" {
     QUDA_INVALID_SCHWARZ = QUDA_INVALID_ENUM
   } QudaSchwarzType;
 
+  typedef enum QudaCABasis_s {
+    QUDA_POWER_BASIS,
+    QUDA_CHEBYSHEV_BASIS,
+    QUDA_INVALID_BASIS = QUDA_INVALID_ENUM
+  } QudaCABasis;
+
+  typedef enum QudaChronoExtrapolationType_s {
+    QUDA_CHRONO_MINRES_EXTRAPOLATION,     // minimum residual over the history
+    QUDA_CHRONO_POLYNOMIAL_EXTRAPOLATION, // polynomial extrapolation through the history
+    QUDA_CHRONO_TIME_REVERSIBLE_EXTRAPOLATION, // time-reversible propagation of an auxiliary guess sequence
+    QUDA_CHRONO_INVALID_EXTRAPOLATION = QUDA_INVALID_ENUM
+  } QudaChronoExtrapolationType;
+
   typedef enum QudaResidualType_s {
     QUDA_L2_RELATIVE_RESIDUAL = 1, // L2 relative residual (default)
     QUDA_L2_ABSOLUTE_RESIDUAL = 2, // L2 absolute residual
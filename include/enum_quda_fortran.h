@@ -121,6 +121,11 @@
 #define QUDA_CG3NR_INVERTER 21
 #define QUDA_CA_CG_INVERTER 22
 #define QUDA_CA_GCR_INVERTER 23
+#define QUDA_MSRC_CG_INVERTER 24
+#define QUDA_PIPELINED_CG_INVERTER 25
+#define QUDA_GCRODR_INVERTER 26
+#define QUDA_GMRES_POLYNOMIAL_INVERTER 27
+#define QUDA_CHEBYSHEV_INVERTER 28
 #define QUDA_INVALID_INVERTER QUDA_INVALID_ENUM
 
 #define QudaEigType integer(4)
@@ -160,6 +165,17 @@
 #define QUDA_MULTIPLICATIVE_SCHWARZ 1
 #define QUDA_INVALID_SCHWARZ QUDA_INVALID_ENUM
 
+#define QudaCABasis integer(4)
+#define QUDA_POWER_BASIS 0
+#define QUDA_CHEBYSHEV_BASIS 1
+#define QUDA_INVALID_BASIS QUDA_INVALID_ENUM
+
+#define QudaChronoExtrapolationType integer(4)
+#define QUDA_CHRONO_MINRES_EXTRAPOLATION 0
+#define QUDA_CHRONO_POLYNOMIAL_EXTRAPOLATION 1
+#define QUDA_CHRONO_TIME_REVERSIBLE_EXTRAPOLATION 2
+#define QUDA_CHRONO_INVALID_EXTRAPOLATION QUDA_INVALID_ENUM
+
 #define QudaResidualType integer(4)
 #define QUDA_L2_RELATIVE_RESIDUAL 1
 #define QUDA_L2_ABSOLUTE_RESIDUAL 2
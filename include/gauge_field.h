@@ -47,6 +47,10 @@ namespace quda {
     /** Size of MILC site struct (only if gauge_order=MILC_SITE_GAUGE_ORDER) */
     size_t site_size;
 
+    /** Whether a fixed-point field carries one scale factor per
+        matrix row rather than one per field (coarse links only) */
+    bool row_scale;
+
     // Default constructor
   GaugeFieldParam(void* const h_gauge=NULL) : LatticeFieldParam(),
       location(QUDA_INVALID_FIELD_LOCATION),
@@ -67,7 +71,8 @@ namespace quda {
       staggeredPhaseApplied(false),
       i_mu(0.0),
       site_offset(0),
-      site_size(0)
+      site_size(0),
+      row_scale(false)
 	{ }
 
     GaugeFieldParam(const GaugeField &u);
@@ -81,7 +86,7 @@ namespace quda {
       link_type(QUDA_WILSON_LINKS), t_boundary(QUDA_INVALID_T_BOUNDARY), anisotropy(1.0),
       tadpole(1.0), gauge(0), create(QUDA_NULL_FIELD_CREATE), geometry(geometry),
       compute_fat_link_max(false), staggeredPhaseType(QUDA_STAGGERED_PHASE_NO),
-      staggeredPhaseApplied(false), i_mu(0.0), site_offset(0), site_size(0)
+      staggeredPhaseApplied(false), i_mu(0.0), site_offset(0), site_size(0), row_scale(false)
       { }
 
   GaugeFieldParam(void *h_gauge, const QudaGaugeParam &param, QudaLinkType link_type_=QUDA_INVALID_LINKS)
@@ -93,7 +98,7 @@ namespace quda {
       create(QUDA_REFERENCE_FIELD_CREATE), geometry(QUDA_VECTOR_GEOMETRY),
       compute_fat_link_max(false), staggeredPhaseType(param.staggered_phase_type),
       staggeredPhaseApplied(param.staggered_phase_applied), i_mu(param.i_mu),
-      site_offset(param.gauge_offset), site_size(param.site_size)
+      site_offset(param.gauge_offset), site_size(param.site_size), row_scale(false)
 	{
 	  switch(link_type) {
 	  case QUDA_SU3_LINKS:
@@ -119,7 +124,8 @@ namespace quda {
       if (precision == QUDA_DOUBLE_PRECISION) {
 	if (order  == QUDA_FLOAT2_GAUGE_ORDER) native = true;
       } else if (precision == QUDA_SINGLE_PRECISION ||
-		 precision == QUDA_HALF_PRECISION) {
+		 precision == QUDA_HALF_PRECISION ||
+		 precision == QUDA_QUARTER_PRECISION) {
 	if (reconstruct == QUDA_RECONSTRUCT_NO) {
 	  if (order == QUDA_FLOAT2_GAUGE_ORDER) native = true;
 	} else if (reconstruct == QUDA_RECONSTRUCT_12 || reconstruct == QUDA_RECONSTRUCT_13) {
@@ -206,6 +212,33 @@ namespace quda {
     */
     size_t site_size;
 
+    /**
+       Whether this fixed-point field stores one scale factor per
+       matrix row (the absolute maximum of the row)
+    */
+    bool row_scale;
+
+    /**
+       Per-row maxima of a row-scaled field
+    */
+    void *row_max;
+
+    /**
+       Bytes allocated for the per-row maxima
+    */
+    size_t row_max_bytes;
+
+    /**
+       @brief Bytes of a host ghost (or send) buffer for a given
+       dimension, including the per-row maxima of row-scaled fields,
+       which are stored after the link data
+       @param[in] d Dimension
+       @return Bytes of the buffer
+    */
+    size_t hostGhostBytes(int d) const {
+      return nFace*surface[d]*(nInternal*precision + (row_scale ? nColor*sizeof(float) : 0));
+    }
+
     /**
        Compute the required extended ghost zone sizes and offsets
        @param[in] R Radius of the ghost zone
@@ -242,6 +275,22 @@ namespace quda {
     QudaStaggeredPhase StaggeredPhase() const { return staggeredPhaseType; }
     bool StaggeredPhaseApplied() const { return staggeredPhaseApplied; }
 
+    /**
+       @return Whether this field stores one scale factor per matrix row
+    */
+    bool RowScaled() const { return row_scale; }
+
+    /**
+       @return Pointer to the per-row maxima (nullptr if not row scaled)
+    */
+    void* RowMax_p() { return row_max; }
+    const void* RowMax_p() const { return row_max; }
+
+    /**
+       @return Bytes allocated for the per-row maxima
+    */
+    size_t RowMaxBytes() const { return row_max_bytes; }
+
     /**
        Apply the staggered phase factors to the gauge field.
     */
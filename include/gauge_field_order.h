@@ -325,6 +325,26 @@ namespace quda {
       else return a + complex<Float>(b.v[b.idx].real(),b.v[b.idx].imag());;
     }
 
+    /**
+       @brief Return the factor that converts a value into the
+       fixed-point storage of a matrix row with absolute maximum max
+       @param max Absolute maximum of the row
+    */
+    template <typename Float, typename storeFloat>
+      __device__ __host__ inline Float rowScale(float max) {
+      return max > 0.0f ? static_cast<Float>(fixedMaxValue<storeFloat>::value / max) : static_cast<Float>(0.0);
+    }
+
+    /**
+       @brief Return the factor that converts the fixed-point storage
+       of a matrix row with absolute maximum max back into a value
+       @param max Absolute maximum of the row
+    */
+    template <typename Float, typename storeFloat>
+      __device__ __host__ inline Float rowScaleInv(float max) {
+      return static_cast<Float>(max * fixedInvMaxValue<storeFloat>::value);
+    }
+
     template<typename Float, int nColor, QudaGaugeFieldOrder order, typename storeFloat, bool use_tex>
     struct Accessor {
       mutable complex<Float> dummy;
@@ -334,6 +354,8 @@ namespace quda {
 
       void resetScale(Float dummy) { }
 
+      __device__ __host__ inline float* rowMax(int d, int parity, int x, int row) const { return nullptr; }
+
       __device__ __host__ complex<Float>& operator()(int d, int parity, int x, int row, int col) const {
 	return dummy;
       }
@@ -348,6 +370,8 @@ namespace quda {
 
       void resetScale(Float dummy) { }
 
+      __device__ __host__ inline float* rowMax(int d, int parity, int x, int row) const { return nullptr; }
+
       __device__ __host__ complex<Float>& operator()(int d, int parity, int x, int row, int col) const {
 	return dummy;
       }
@@ -361,11 +385,13 @@ namespace quda {
       const int cb_offset;
       Float scale;
       Float scale_inv;
+      float *row_max; // per-row maxima (row-scaled fields only)
       static constexpr bool fixed = fixed_point<Float,storeFloat>();
 
       Accessor(const GaugeField &U, void *gauge_=0, void **ghost_=0)
 	: volumeCB(U.VolumeCB()), geometry(U.Geometry()), cb_offset((U.Bytes()>>1) / (sizeof(complex<storeFloat>)*U.Geometry())),
-	scale(static_cast<Float>(1.0)), scale_inv(static_cast<Float>(1.0))
+	scale(static_cast<Float>(1.0)), scale_inv(static_cast<Float>(1.0)),
+	row_max(static_cast<float*>(const_cast<void*>(U.RowMax_p())))
       {
 	for (int d=0; d<U.Geometry(); d++)
 	  u[d] = gauge_ ? static_cast<complex<storeFloat>**>(gauge_)[d] :
@@ -374,7 +400,8 @@ namespace quda {
       }
 
     Accessor(const Accessor<Float,nColor,QUDA_QDP_GAUGE_ORDER,storeFloat,use_tex> &a)
-      : volumeCB(a.volumeCB), geometry(a.geometry), cb_offset(a.cb_offset), scale(a.scale), scale_inv(a.scale_inv) {
+      : volumeCB(a.volumeCB), geometry(a.geometry), cb_offset(a.cb_offset), scale(a.scale), scale_inv(a.scale_inv),
+	row_max(a.row_max) {
 	for (int d=0; d<QUDA_MAX_GEOMETRY; d++)
 	  u[d] = a.u[d];
       }
@@ -386,24 +413,39 @@ namespace quda {
 	}
       }
 
+      /**
+	 @return Pointer to the maximum of a matrix row (nullptr if the
+	 field is not row scaled)
+      */
+      __device__ __host__ inline float* rowMax(int d, int parity, int x, int row) const
+      { return row_max ? row_max + ((d*2 + parity)*volumeCB + x)*nColor + row : nullptr; }
+
       __device__ __host__ inline complex<Float> operator()(int d, int parity, int x, int row, int col) const
       {
 	complex<storeFloat> tmp = u[d][ parity*cb_offset + (x*nColor + row)*nColor + col];
 
 	if (fixed) {
-	  return scale_inv*complex<Float>(static_cast<Float>(tmp.x), static_cast<Float>(tmp.y));
+	  const Float s_inv = row_max ? rowScaleInv<Float,storeFloat>(*rowMax(d, parity, x, row)) : scale_inv;
+	  return s_inv*complex<Float>(static_cast<Float>(tmp.x), static_cast<Float>(tmp.y));
 	} else {
 	  return complex<Float>(tmp.x,tmp.y);
 	}
       }
 
       __device__ __host__ inline fieldorder_wrapper<Float,storeFloat> operator()(int d, int parity, int x, int row, int col)
-	{ return fieldorder_wrapper<Float,storeFloat>(u[d], parity*cb_offset + (x*nColor + row)*nColor + col,
-						      scale, scale_inv); }
+      {
+	const int index = parity*cb_offset + (x*nColor + row)*nColor + col;
+	if (fixed && row_max) {
+	  const float max_ = *rowMax(d, parity, x, row);
+	  return fieldorder_wrapper<Float,storeFloat>(u[d], index, rowScale<Float,storeFloat>(max_), rowScaleInv<Float,storeFloat>(max_));
+	}
+	return fieldorder_wrapper<Float,storeFloat>(u[d], index, scale, scale_inv);
+      }
 
       template<typename theirFloat>
       __device__ __host__ inline void atomic_add(int dim, int parity, int x_cb, int row, int col,
                                                  const complex<theirFloat> &val) const {
+	const Float scale = row_max ? rowScale<Float,storeFloat>(*rowMax(dim, parity, x_cb, row)) : this->scale;
 #ifdef __CUDA_ARCH__
 	typedef typename vector<storeFloat,2>::type vec2;
 	vec2 *u2 = reinterpret_cast<vec2*>(u[dim] + parity*cb_offset + (x_cb*nColor + row)*nColor + col);
@@ -455,6 +497,7 @@ namespace quda {
       struct GhostAccessor<Float,nColor,QUDA_QDP_GAUGE_ORDER,native_ghost,storeFloat,use_tex> {
       complex<storeFloat> *ghost[8];
       int ghostOffset[8];
+      float *ghost_row_max[8]; // per-row maxima, stored after the ghost links (row-scaled fields only)
       Float scale;
       Float scale_inv;
       static constexpr bool fixed = fixed_point<Float,storeFloat>();
@@ -472,6 +515,9 @@ namespace quda {
 	  ghostOffset[d+4] = U.Nface()*U.SurfaceCB(d)*U.Ncolor()*U.Ncolor();
 	}
 
+	for (int d=0; d<8; d++)
+	  ghost_row_max[d] = (U.RowScaled() && ghost[d]) ? reinterpret_cast<float*>(ghost[d] + 2*ghostOffset[d]) : nullptr;
+
 	resetScale(U.Scale());
       }
 
@@ -480,6 +526,7 @@ namespace quda {
 	for (int d=0; d<8; d++) {
 	  ghost[d] = a.ghost[d];
 	  ghostOffset[d] = a.ghostOffset[d];
+	  ghost_row_max[d] = a.ghost_row_max[d];
 	}
       }
 
@@ -490,19 +537,33 @@ namespace quda {
 	}
       }
 
+      /**
+	 @return Pointer to the maximum of a ghost matrix row (nullptr
+	 if the field is not row scaled)
+      */
+      __device__ __host__ inline float* rowMax(int d, int parity, int x, int row) const
+      { return ghost_row_max[d] ? ghost_row_max[d] + parity*(ghostOffset[d]/nColor) + x*nColor + row : nullptr; }
+
       __device__ __host__ inline complex<Float> operator()(int d, int parity, int x, int row, int col) const
       {
 	complex<storeFloat> tmp = ghost[d][ parity*ghostOffset[d] + (x*nColor + row)*nColor + col];
 	if (fixed) {
-	  return scale_inv*complex<Float>(static_cast<Float>(tmp.x), static_cast<Float>(tmp.y));
+	  const Float s_inv = ghost_row_max[d] ? rowScaleInv<Float,storeFloat>(*rowMax(d, parity, x, row)) : scale_inv;
+	  return s_inv*complex<Float>(static_cast<Float>(tmp.x), static_cast<Float>(tmp.y));
 	} else {
 	  return complex<Float>(tmp.x,tmp.y);
 	}
       }
 
       __device__ __host__ inline fieldorder_wrapper<Float,storeFloat> operator()(int d, int parity, int x, int row, int col)
-	{ return fieldorder_wrapper<Float,storeFloat>(ghost[d], parity*ghostOffset[d] + (x*nColor + row)*nColor + col,
-						      scale, scale_inv); }
+      {
+	const int index = parity*ghostOffset[d] + (x*nColor + row)*nColor + col;
+	if (fixed && ghost_row_max[d]) {
+	  const float max_ = *rowMax(d, parity, x, row);
+	  return fieldorder_wrapper<Float,storeFloat>(ghost[d], index, rowScale<Float,storeFloat>(max_), rowScaleInv<Float,storeFloat>(max_));
+	}
+	return fieldorder_wrapper<Float,storeFloat>(ghost[d], index, scale, scale_inv);
+      }
     };
 
     template<typename Float, int nColor, typename storeFloat, bool use_tex>
@@ -533,6 +594,8 @@ namespace quda {
 	}
       }
 
+      __device__ __host__ inline float* rowMax(int d, int parity, int x, int row) const { return nullptr; }
+
       __device__ __host__ inline complex<Float> operator()(int d, int parity, int x, int row, int col) const
       {
 	complex<storeFloat> tmp = u[(((parity*volumeCB+x)*geometry + d)*nColor + row)*nColor + col];
@@ -641,6 +704,8 @@ namespace quda {
 	}
       }
 
+      __device__ __host__ inline float* rowMax(int d, int parity, int x, int row) const { return nullptr; }
+
       __device__ __host__ inline complex<Float> operator()(int d, int parity, int x, int row, int col) const
       {
 	complex<storeFloat> tmp = ghost[d][ parity*ghostOffset[d] + (x*nColor + row)*nColor + col];
@@ -680,6 +745,7 @@ namespace quda {
       Float max;
       Float scale;
       Float scale_inv;
+      float *row_max; // per-row maxima (row-scaled fields only)
       static constexpr bool fixed = fixed_point<Float,storeFloat>();
 
     Accessor(const GaugeField &U, void *gauge_=0, void **ghost_=0, bool override=false)
@@ -690,7 +756,8 @@ namespace quda {
         tex(0),
 #endif
         volumeCB(U.VolumeCB()), stride(U.Stride()), geometry(U.Geometry()),
-        max(static_cast<Float>(1.0)), scale(static_cast<Float>(1.0)), scale_inv(static_cast<Float>(1.0))
+        max(static_cast<Float>(1.0)), scale(static_cast<Float>(1.0)), scale_inv(static_cast<Float>(1.0)),
+        row_max(static_cast<float*>(const_cast<void*>(U.RowMax_p())))
       {
 	resetScale(U.Scale());
 #ifdef USE_TEXTURE_OBJECTS
@@ -707,7 +774,7 @@ namespace quda {
         tex(a.tex),
 #endif
         volumeCB(a.volumeCB), stride(a.stride), geometry(a.geometry),
-	scale(a.scale), scale_inv(a.scale_inv) {  }
+	max(a.max), scale(a.scale), scale_inv(a.scale_inv), row_max(a.row_max) {  }
 
       void resetScale(Float max_) {
 	if (fixed) {
@@ -717,13 +784,22 @@ namespace quda {
 	}
       }
 
+      /**
+	 @return Pointer to the maximum of a matrix row (nullptr if the
+	 field is not row scaled).  The maxima are laid out like a
+	 real field with nColor components per link, so the padded
+	 region holds those of the native ghost zone.
+      */
+      __device__ __host__ inline float* rowMax(int dim, int parity, int x_cb, int row) const
+      { return row_max ? row_max + parity*geometry*nColor*stride + (dim*nColor + row)*stride + x_cb : nullptr; }
+
       __device__ __host__ inline const complex<Float> operator()(int dim, int parity, int x_cb, int row, int col) const
       {
 #if defined(USE_TEXTURE_OBJECTS) && defined(__CUDA_ARCH__)
 	if (use_tex) {
 	  TexVector vecTmp = tex1Dfetch<TexVector>(tex, parity*offset_cb + dim*stride*nColor*nColor + (row*nColor+col)*stride + x_cb);
 	  if (fixed) {
-	    return max*complex<Float>(vecTmp.x, vecTmp.y);
+	    return (row_max ? static_cast<Float>(*rowMax(dim, parity, x_cb, row)) : max)*complex<Float>(vecTmp.x, vecTmp.y);
 	  } else {
 	    return complex<Float>(vecTmp.x, vecTmp.y);
 	  }
@@ -732,7 +808,8 @@ namespace quda {
 	{
 	  complex<storeFloat> tmp = u[parity*offset_cb + dim*stride*nColor*nColor + (row*nColor+col)*stride + x_cb];
 	  if (fixed) {
-	    return scale_inv*complex<Float>(static_cast<Float>(tmp.x), static_cast<Float>(tmp.y));
+	    const Float s_inv = row_max ? rowScaleInv<Float,storeFloat>(*rowMax(dim, parity, x_cb, row)) : scale_inv;
+	    return s_inv*complex<Float>(static_cast<Float>(tmp.x), static_cast<Float>(tmp.y));
 	  } else {
 	    return complex<Float>(tmp.x, tmp.y);
 	  }
@@ -742,11 +819,16 @@ namespace quda {
       __device__ __host__ inline fieldorder_wrapper<Float,storeFloat> operator()(int dim, int parity, int x_cb, int row, int col)
       {
 	int index = parity*offset_cb + dim*stride*nColor*nColor + (row*nColor+col)*stride + x_cb;
+	if (fixed && row_max) {
+	  const float max_ = *rowMax(dim, parity, x_cb, row);
+	  return fieldorder_wrapper<Float,storeFloat>(u, index, rowScale<Float,storeFloat>(max_), rowScaleInv<Float,storeFloat>(max_));
+	}
 	return fieldorder_wrapper<Float,storeFloat>(u, index, scale, scale_inv);
       }
 
       template <typename theirFloat>
       __device__ __host__ void atomic_add(int dim, int parity, int x_cb, int row, int col, const complex<theirFloat> &val) const {
+	const Float scale = row_max ? rowScale<Float,storeFloat>(*rowMax(dim, parity, x_cb, row)) : this->scale;
 #ifdef __CUDA_ARCH__
 	typedef typename vector<storeFloat,2>::type vec2;
 	vec2 *u2 = reinterpret_cast<vec2*>(u + parity*offset_cb + dim*stride*nColor*nColor + (row*nColor+col)*stride + x_cb);
@@ -805,6 +887,7 @@ namespace quda {
       complex<storeFloat> *ghost[8];
       const int volumeCB;
       int ghostVolumeCB[8];
+      float *ghost_row_max[8]; // per-row maxima, stored after the ghost links (non-native row-scaled ghosts only)
       Float scale;
       Float scale_inv;
       static constexpr bool fixed = fixed_point<Float,storeFloat>();
@@ -821,6 +904,9 @@ namespace quda {
 	  ghost[d+4] = !native_ghost && U.Geometry() == QUDA_COARSE_GEOMETRY? static_cast<complex<storeFloat>*>(ghost_[d+4]) : nullptr;
 	  ghostVolumeCB[d+4] = U.Nface()*U.SurfaceCB(d);
 	}
+	for (int d=0; d<8; d++)
+	  ghost_row_max[d] = (U.RowScaled() && ghost[d]) ?
+	    reinterpret_cast<float*>(ghost[d] + 2*nColor*nColor*ghostVolumeCB[d]) : nullptr;
 	resetScale(U.Scale());
       }
 
@@ -830,6 +916,7 @@ namespace quda {
 	for (int d=0; d<8; d++) {
 	  ghost[d] = a.ghost[d];
 	  ghostVolumeCB[d] = a.ghostVolumeCB[d];
+	  ghost_row_max[d] = a.ghost_row_max[d];
 	}
       }
 
@@ -841,6 +928,18 @@ namespace quda {
 	}
       }
 
+      /**
+	 @return Pointer to the maximum of a ghost matrix row (nullptr
+	 if the field is not row scaled)
+      */
+      __device__ __host__ inline float* rowMax(int d, int parity, int x_cb, int row) const
+      {
+	if (native_ghost)
+	  return accessor.rowMax(d%4, parity, x_cb+(d/4)*ghostVolumeCB[d]+volumeCB, row);
+	else
+	  return ghost_row_max[d] ? ghost_row_max[d] + (parity*nColor + row)*ghostVolumeCB[d] + x_cb : nullptr;
+      }
+
       __device__ __host__ inline const complex<Float> operator()(int d, int parity, int x_cb, int row, int col) const
       {
 	if (native_ghost) {
@@ -848,7 +947,8 @@ namespace quda {
 	} else {
 	  complex<storeFloat> tmp = ghost[d][ ((parity*nColor + row)*nColor+col)*ghostVolumeCB[d] + x_cb ];
 	  if (fixed) {
-	    return scale_inv*complex<Float>(static_cast<Float>(tmp.x), static_cast<Float>(tmp.y));
+	    const Float s_inv = ghost_row_max[d] ? rowScaleInv<Float,storeFloat>(*rowMax(d, parity, x_cb, row)) : scale_inv;
+	    return s_inv*complex<Float>(static_cast<Float>(tmp.x), static_cast<Float>(tmp.y));
 	  } else {
 	    return complex<Float>(tmp.x, tmp.y);
 	  }
@@ -857,11 +957,16 @@ namespace quda {
 
       __device__ __host__ inline fieldorder_wrapper<Float,storeFloat> operator()(int d, int parity, int x_cb, int row, int col)
       {
-	if (native_ghost)
+	if (native_ghost) {
 	  return accessor(d%4, parity, x_cb+(d/4)*ghostVolumeCB[d]+volumeCB, row, col);
-	else
-	  return fieldorder_wrapper<Float,storeFloat>
-	    (ghost[d], ((parity*nColor + row)*nColor+col)*ghostVolumeCB[d] + x_cb, scale, scale_inv);
+	} else {
+	  const int index = ((parity*nColor + row)*nColor+col)*ghostVolumeCB[d] + x_cb;
+	  if (fixed && ghost_row_max[d]) {
+	    const float max_ = *rowMax(d, parity, x_cb, row);
+	    return fieldorder_wrapper<Float,storeFloat>(ghost[d], index, rowScale<Float,storeFloat>(max_), rowScaleInv<Float,storeFloat>(max_));
+	  }
+	  return fieldorder_wrapper<Float,storeFloat>(ghost[d], index, scale, scale_inv);
+	}
       }
     };
 
@@ -887,6 +992,7 @@ namespace quda {
 	const int nDim;
 	const int_fastdiv geometry;
 	const QudaFieldLocation location;
+	const bool row_scaled;
 	static constexpr int nColorCoarse = nColor / nSpinCoarse;
 
 	Accessor<Float,nColor,order,storeFloat,use_tex> accessor;
@@ -898,7 +1004,7 @@ namespace quda {
 	 */
       FieldOrder(GaugeField &U, void *gauge_=0, void **ghost_=0)
       : volumeCB(U.VolumeCB()), nDim(U.Ndim()), geometry(U.Geometry()),
-	  location(U.Location()),
+	  location(U.Location()), row_scaled(U.RowScaled()),
 	  accessor(U, gauge_, ghost_), ghostAccessor(U, gauge_, ghost_)
 	{
 	  if (U.Reconstruct() != QUDA_RECONSTRUCT_NO)
@@ -906,7 +1012,7 @@ namespace quda {
 	}
 
       FieldOrder(const FieldOrder &o) : volumeCB(o.volumeCB),
-	  nDim(o.nDim), geometry(o.geometry), location(o.location),
+	  nDim(o.nDim), geometry(o.geometry), location(o.location), row_scaled(o.row_scaled),
 	  accessor(o.accessor), ghostAccessor(o.ghostAccessor)
 	{ }
 
@@ -919,6 +1025,72 @@ namespace quda {
 
 	static constexpr bool fixedPoint() { return fixed_point<Float,storeFloat>(); }
 
+	/**
+	 * @return Whether the field stores one scale factor per matrix row
+	 */
+	__device__ __host__ inline bool RowScaled() const { return row_scaled; }
+
+	/**
+	 * Absolute maximum of a matrix row: the stored per-row maximum
+	 * of a row-scaled field, else computed from the row itself
+	 * @param d dimension index
+	 * @param parity Parity index
+	 * @param x 1-d site index
+	 * @param row row index
+	 */
+	__device__ __host__ inline Float RowMax(int d, int parity, int x, int row) const
+	{
+	  if (row_scaled) return *accessor.rowMax(d, parity, x, row);
+	  Float max_ = static_cast<Float>(0.0);
+	  for (int col=0; col<nColor; col++) {
+	    const Float a = abs(accessor(d, parity, x, row, col));
+	    max_ = a > max_ ? a : max_;
+	  }
+	  return max_;
+	}
+
+	/**
+	 * Absolute maximum of a ghost-zone matrix row (see RowMax)
+	 * @param d dimension index
+	 * @param parity Parity index
+	 * @param x 1-d site index
+	 * @param row row index
+	 */
+	__device__ __host__ inline Float GhostRowMax(int d, int parity, int x, int row) const
+	{
+	  if (row_scaled) return *ghostAccessor.rowMax(d, parity, x, row);
+	  Float max_ = static_cast<Float>(0.0);
+	  for (int col=0; col<nColor; col++) {
+	    const Float a = abs(ghostAccessor(d, parity, x, row, col));
+	    max_ = a > max_ ? a : max_;
+	  }
+	  return max_;
+	}
+
+	/**
+	 * Set the maximum of a matrix row of a row-scaled field (no-op
+	 * otherwise).  This must precede writing the row itself.
+	 * @param d dimension index
+	 * @param parity Parity index
+	 * @param x 1-d site index
+	 * @param row row index
+	 * @param max Absolute maximum of the row
+	 */
+	__device__ __host__ inline void setRowMax(int d, int parity, int x, int row, Float max)
+	{ if (row_scaled) *accessor.rowMax(d, parity, x, row) = max; }
+
+	/**
+	 * Set the maximum of a ghost-zone matrix row of a row-scaled
+	 * field (see setRowMax)
+	 * @param d dimension index
+	 * @param parity Parity index
+	 * @param x 1-d site index
+	 * @param row row index
+	 * @param max Absolute maximum of the row
+	 */
+	__device__ __host__ inline void setGhostRowMax(int d, int parity, int x, int row, Float max)
+	{ if (row_scaled) *ghostAccessor.rowMax(d, parity, x, row) = max; }
+
 	/**
 	 * Read-only complex-member accessor function
 	 * @param d dimension index
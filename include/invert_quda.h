@@ -127,6 +127,11 @@ namespace quda {
     /**< The precision used by the QUDA preconditioner */
     QudaPrecision precision_precondition;
 
+    /**< The precision CG starts its sloppy iterations in before being
+       promoted to precision_sloppy (QUDA_INVALID_PRECISION if adaptive
+       precision is disabled) */
+    QudaPrecision precision_adaptive;
+
     /**< Preserve the source or not in the linear solver (deprecated?) */
     QudaPreserveSource preserve_source;
 
@@ -169,6 +174,15 @@ namespace quda {
     /** Maximum size of Krylov space used by solver */
     int Nkrylov;
 
+    /** Basis for the s-step Krylov space of CA solvers */
+    QudaCABasis ca_basis;
+
+    /** Lower bound of the spectrum used for the Chebyshev basis */
+    double ca_lambda_min;
+
+    /** Upper bound of the spectrum used for the Chebyshev basis (estimated if not positive) */
+    double ca_lambda_max;
+
     /** Number of preconditioner cycles to perform per iteration */
     int precondition_cycle;
 
@@ -186,6 +200,9 @@ namespace quda {
     /** Whether to use additive or multiplicative Schwarz preconditioning */
     QudaSchwarzType schwarz_type;
 
+    /** Overlap depth of the restricted additive Schwarz domains (zero for non-overlapping domains) */
+    int schwarz_overlap;
+
     /**< The time taken by the solver */
     double secs;
 
@@ -206,6 +223,14 @@ namespace quda {
     double  inc_tol;
     double  eigenval_tol;
 
+    /** Identity of the operator family whose subspace GCRO-DR
+	recycles across solves (zero for no sharing between solvers) */
+    uint64_t recycle_key;
+
+    /** Identity of the operator itself, used by GCRO-DR to detect
+	when C = A U must be recomputed */
+    uint64_t recycle_op_key;
+
     QudaVerbosity verbosity_precondition; //! verbosity to use for preconditioner
 
     bool is_preconditioner; //! whether the solver acting as a preconditioner for another solver
@@ -224,7 +249,8 @@ namespace quda {
        Default constructor
      */
     SolverParam() : compute_null_vector(QUDA_COMPUTE_NULL_VECTOR_NO),
-      compute_true_res(true), sloppy_converge(false), verbosity_precondition(QUDA_SILENT), mg_instance(false) { ; }
+      compute_true_res(true), sloppy_converge(false), precision_adaptive(QUDA_INVALID_PRECISION), ca_basis(QUDA_POWER_BASIS), ca_lambda_min(0.0), ca_lambda_max(-1.0),
+      recycle_key(0), recycle_op_key(0), verbosity_precondition(QUDA_SILENT), mg_instance(false) { ; }
 
     /**
        Constructor that matches the initial values to that of the
@@ -245,16 +271,17 @@ namespace quda {
       true_res_hq(param.true_res_hq), maxiter(param.maxiter), iter(param.iter),
       precision(param.cuda_prec), precision_sloppy(param.cuda_prec_sloppy),
       precision_refinement_sloppy(param.cuda_prec_refinement_sloppy), precision_precondition(param.cuda_prec_precondition),
-      preserve_source(param.preserve_source),
+      precision_adaptive(QUDA_INVALID_PRECISION), preserve_source(param.preserve_source),
       return_residual(preserve_source == QUDA_PRESERVE_SOURCE_NO ? true : false),
       num_src(param.num_src), num_offset(param.num_offset),
-      Nsteps(param.Nsteps), Nkrylov(param.gcrNkrylov), precondition_cycle(param.precondition_cycle),
+      Nsteps(param.Nsteps), Nkrylov(param.gcrNkrylov), ca_basis(param.ca_basis),
+      ca_lambda_min(param.ca_lambda_min), ca_lambda_max(param.ca_lambda_max), precondition_cycle(param.precondition_cycle),
       tol_precondition(param.tol_precondition), maxiter_precondition(param.maxiter_precondition),
-      omega(param.omega), schwarz_type(param.schwarz_type), secs(param.secs), gflops(param.gflops),
+      omega(param.omega), schwarz_type(param.schwarz_type), schwarz_overlap(0), secs(param.secs), gflops(param.gflops),
       precision_ritz(param.cuda_prec_ritz), nev(param.nev), m(param.max_search_dim),
       deflation_grid(param.deflation_grid), rhs_idx(0),
       eigcg_max_restarts(param.eigcg_max_restarts), max_restart_num(param.max_restart_num),
-      inc_tol(param.inc_tol), eigenval_tol(param.eigenval_tol),
+      inc_tol(param.inc_tol), eigenval_tol(param.eigenval_tol), recycle_key(0), recycle_op_key(0),
       verbosity_precondition(param.verbosity_precondition),
       is_preconditioner(false), global_reduction(true), mg_instance(false), extlib_type(param.extlib_type)
     {
@@ -283,15 +310,17 @@ namespace quda {
       true_res_hq(param.true_res_hq), maxiter(param.maxiter), iter(param.iter),
       precision(param.precision), precision_sloppy(param.precision_sloppy),
       precision_refinement_sloppy(param.precision_refinement_sloppy), precision_precondition(param.precision_precondition),
-      preserve_source(param.preserve_source), return_residual(param.return_residual),
+      precision_adaptive(param.precision_adaptive), preserve_source(param.preserve_source), return_residual(param.return_residual),
       num_offset(param.num_offset),
-      Nsteps(param.Nsteps), Nkrylov(param.Nkrylov), precondition_cycle(param.precondition_cycle),
+      Nsteps(param.Nsteps), Nkrylov(param.Nkrylov), ca_basis(param.ca_basis),
+      ca_lambda_min(param.ca_lambda_min), ca_lambda_max(param.ca_lambda_max), precondition_cycle(param.precondition_cycle),
       tol_precondition(param.tol_precondition), maxiter_precondition(param.maxiter_precondition),
-      omega(param.omega), schwarz_type(param.schwarz_type), secs(param.secs), gflops(param.gflops),
+      omega(param.omega), schwarz_type(param.schwarz_type), schwarz_overlap(param.schwarz_overlap), secs(param.secs), gflops(param.gflops),
       precision_ritz(param.precision_ritz), nev(param.nev), m(param.m),
       deflation_grid(param.deflation_grid), rhs_idx(0),
       eigcg_max_restarts(param.eigcg_max_restarts), max_restart_num(param.max_restart_num),
       inc_tol(param.inc_tol), eigenval_tol(param.eigenval_tol),
+      recycle_key(param.recycle_key), recycle_op_key(param.recycle_op_key),
       verbosity_precondition(param.verbosity_precondition),
       is_preconditioner(param.is_preconditioner), global_reduction(param.global_reduction), mg_instance(param.mg_instance), extlib_type(param.extlib_type)
     {
@@ -336,6 +365,9 @@ namespace quda {
       }
       //for incremental eigCG:
       param.rhs_idx = rhs_idx;
+      // spectral bounds estimated by CA solvers
+      param.ca_lambda_min = ca_lambda_min;
+      param.ca_lambda_max = ca_lambda_max;
     }
 
     void updateRhsIndex(QudaInvertParam &param) {
@@ -424,8 +456,10 @@ namespace quda {
        @param[in] hq2 Heavy quark residual
        @param[in] r2_tol Solver L2 tolerance
        @param[in] hq_tol Solver heavy-quark tolerance
+       @param[in] trace Optional precision trace of an adaptive-precision solve
     */
-    void PrintSummary(const char *name, int k, double r2, double b2, double r2_tol, double hq_tol);
+    void PrintSummary(const char *name, int k, double r2, double b2, double r2_tol, double hq_tol,
+                      const char *trace = nullptr);
 
     /**
      * Return flops
@@ -448,8 +482,41 @@ namespace quda {
     std::vector<ColorSpinorField*> p;
     bool init;
 
+    DiracMatrix *matLow; //! operator in the starting precision of adaptive-precision CG
+    SolverParam param_low; //! parameters of the solver running in the starting precision
+    CG *cg_low; //! solver running in the starting precision
+    bool adaptive; //! whether an adaptive-precision solve is in progress
+
+    bool stagnation_exit; //! whether to stop once the true residual stagnates at a reliable update
+    int j_stagnated; //! index of the search direction at the stagnation exit (-1 if none)
+    double r2_old_stagnated; //! iterated residual preceding the stagnation exit
+
+    int iter_adaptive; //! iterations done in the starting precision, added to the summary count
+    std::string precision_trace; //! precisions used by an adaptive-precision solve
+
+    /**
+       @brief Run CG starting its sloppy iterations in
+       precision_adaptive.  Once the true residual computed at a
+       reliable update stagnates relative to the iterated residual,
+       the solve continues in precision_sloppy from the same Krylov
+       direction, so the low-precision iterations are not lost.
+       @param out Solution vector
+       @param in Right-hand side
+    */
+    void adaptiveSolve(ColorSpinorField &out, ColorSpinorField &in);
+
   public:
     CG(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile);
+
+    /**
+       @brief Constructor for adaptive-precision CG
+       @param mat Operator in the outer precision
+       @param matSloppy Operator in the sloppy precision
+       @param matLow Operator in the precision the sloppy iterations start in
+       @param param Solver parameters, with precision_adaptive set
+       @param profile Time profile
+    */
+    CG(DiracMatrix &mat, DiracMatrix &matSloppy, DiracMatrix &matLow, SolverParam &param, TimeProfile &profile);
     virtual ~CG();
     /**
      * @brief: Run CG.
@@ -546,6 +613,89 @@ namespace quda {
 
 
 
+  /**
+     @brief Pipelined CG (Ghysels and Vanroose).  The recurrences are
+     rearranged so that each iteration needs a single fused global
+     reduction, (r,r) and (w,r) with w = A r, which is started without
+     blocking and overlapped with the next operator application.  The
+     extra recurrences are less stable than those of CG, so reliable
+     updates replace the residual and rebuild the auxiliary vectors
+     from the true residual.
+   */
+  class PipelinedCG : public Solver {
+
+  private:
+    const DiracMatrix &mat;
+    const DiracMatrix &matSloppy;
+    bool init;
+
+    ColorSpinorField *rp;       // high-precision residual
+    ColorSpinorField *yp;       // high-precision accumulated solution
+    ColorSpinorField *rSloppyp; // residual
+    ColorSpinorField *xSloppyp; // partial solution since the last reliable update
+    ColorSpinorField *pp;       // search direction
+    ColorSpinorField *sp;       // s = A p
+    ColorSpinorField *wp;       // w = A r
+    ColorSpinorField *zp;       // z = A s
+    ColorSpinorField *qp;       // q = A w
+    ColorSpinorField *tmpp;
+    ColorSpinorField *tmp2p;
+    ColorSpinorField *tmp3p;
+
+    /**
+       @brief Initiate the fields needed by the solver
+       @param[in] x Solution vector used for the solver meta data
+    */
+    void create(ColorSpinorField &x);
+
+  public:
+    PipelinedCG(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile);
+    virtual ~PipelinedCG();
+
+    void operator()(ColorSpinorField &out, ColorSpinorField &in);
+  };
+
+  /**
+     @brief Multi-source CG: solves the num_src independent systems
+     A x_i = b_i in lock-step.  The operator is applied to the batch of
+     search directions in a single call, the per-source reductions of
+     each iteration are fused into one global reduction, and sources
+     drop out of the batch as they converge.  Reliable updates are
+     done per source.
+   */
+  class MultiSrcCG : public Solver {
+
+  private:
+    const DiracMatrix &mat;
+    const DiracMatrix &matSloppy;
+
+  public:
+    MultiSrcCG(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile);
+    virtual ~MultiSrcCG();
+
+    /**
+       @brief Solve the systems A x[i] = b[i] in lock-step.  The
+       per-source true residuals are returned in param.true_res_offset.
+       @param[in,out] x Solution vectors (initial guesses on input)
+       @param[in] b Right-hand sides
+     */
+    void solve(std::vector<ColorSpinorField*> &x, std::vector<ColorSpinorField*> &b);
+
+    /**
+       @brief Solve a single system
+       @param out Solution vector
+       @param in Right-hand side
+     */
+    void operator()(ColorSpinorField &out, ColorSpinorField &in);
+
+    /**
+       @brief Solve for all components of composite fields
+       @param out Composite field of solution vectors
+       @param in Composite field of right-hand sides
+     */
+    void blocksolve(ColorSpinorField &out, ColorSpinorField &in);
+  };
+
   class MPCG : public Solver {
     private:
       const DiracMatrix &mat;
@@ -756,13 +906,83 @@ namespace quda {
     void operator()(ColorSpinorField &out, ColorSpinorField &in);
   };
 
+  /**
+     @brief Fixed-polynomial smoother.  The solution is x = p(A) b for
+     a polynomial p of degree maxiter whose coefficients are computed
+     once, by setup() or else on the first application, from a few
+     Arnoldi steps with the operator; after that the polynomial is
+     applied by a fused
+     recurrence with one application of the operator and no
+     reductions per degree.  Two polynomials are supported:
+     - QUDA_GMRES_POLYNOMIAL_INVERTER: the GMRES residual polynomial,
+       applied in Newton form with its roots (the harmonic Ritz values
+       of the Arnoldi matrix) in Leja order;
+     - QUDA_CHEBYSHEV_INVERTER: Chebyshev iteration on the interval
+       spanned by the real parts of the Ritz values.
+   */
+  class PolySmoother : public Solver {
+
+  private:
+    const DiracMatrix &mat;
+    const DiracMatrix &matSloppy;
+    ColorSpinorField *rp;
+    ColorSpinorField *r_sloppy;
+    ColorSpinorField *Arp;
+    ColorSpinorField *dp;
+    ColorSpinorField *tmpp;
+    ColorSpinorField *tmp_sloppy;
+    ColorSpinorField *x_sloppy;
+    bool init;
+
+    /** Degree of the polynomial (zero until it has been computed) */
+    int degree;
+
+    /** Roots of the GMRES polynomial in Leja order */
+    std::vector<Complex> roots;
+
+    /** Center and half width of the Chebyshev interval */
+    double theta, delta;
+
+    /**
+       @brief Compute the polynomial from an Arnoldi process started
+       with the given vector
+       @param[in] v0 Starting vector
+       @param[in] tmp Temporary for the operator
+    */
+    void computePolynomial(ColorSpinorField &v0, ColorSpinorField &tmp);
+
+  public:
+    PolySmoother(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile);
+    virtual ~PolySmoother();
+
+    /**
+       @brief Compute the polynomial from a random vector, so it does
+       not depend on the first source the smoother is applied to
+       @param[in] meta Field defining the vectors the smoother is applied to
+    */
+    void setup(const ColorSpinorField &meta);
+
+    /**
+       @brief Adapt the polynomial to gamma5 A^dagger gamma5, the
+       operator after the sign of the twisted mass has been flipped.
+       Its spectrum is the complex conjugate of that of A, so the GMRES
+       roots are conjugated and the Chebyshev interval is kept.
+    */
+    void flipMu();
+
+    void operator()(ColorSpinorField &out, ColorSpinorField &in);
+  };
+
   /**
      @brief Communication-avoiding CG solver.  This solver does
      un-preconditioned CG, running in steps of nKrylov, build up a
      polynomial in the linear operator of length nKrylov, and then
      performs a steepest descent minimization on the resulting basis
-     vectors.  For now only implemented using the power basis so is
-     only useful as a preconditioner.
+     vectors.  The basis is either the power basis, which is only
+     well conditioned for short polynomials, or a Chebyshev basis on
+     an estimate of the spectrum.  All the inner products of a step
+     are summed in a single global reduction, and the step length is
+     adapted to the conditioning of their Gram matrix.
    */
   class CACG : public Solver {
 
@@ -771,7 +991,7 @@ namespace quda {
     const DiracMatrix &matSloppy;
     bool init;
 
-    Complex *W; // inner product matrix
+    Complex *W; // inner product matrices P^dagger [Q r] and Q^dagger Q
     Complex *C; // inner product matrix
     Complex *alpha;
     Complex *beta;
@@ -796,9 +1016,30 @@ namespace quda {
     void create(ColorSpinorField &b);
 
     /**
-       @brief Compute the alpha coefficients
+       @brief Compute the alpha coefficients, truncating the basis to
+       its leading vectors whose (equilibrated) Gram matrix is well
+       conditioned
+       @param[out] x The alpha coefficients
+       @param[in] W The Gram matrix (p_i, A p_j) of the basis
+       @param[in] phi The projected residual (p_i, r)
+       @param[in] n Size of the basis
+       @param[in] cond_max Maximum acceptable condition number
+       @param[out] n_next Suggested size of the next basis
+       @return Number of basis vectors used
+    */
+    int compute_alpha(Complex *x, Complex *W, Complex *phi, int n, double cond_max, int &n_next);
+
+    /**
+       @brief Estimate the spectral bounds of the operator for the
+       Chebyshev basis from the Lanczos tridiagonal matrix built from
+       the coefficients of a few CG iterations.  The iterations
+       advance the solution, so the warm-up is not wasted.
+       @param[in,out] x Solution vector
+       @param[in,out] r Residual vector (sloppy)
+       @param[in] n Number of CG iterations
+       @return Number of iterations performed
     */
-    void compute_alpha(Complex *x, Complex *W, Complex *phi);
+    int lanczos_warmup(ColorSpinorField &x, ColorSpinorField &r, int n);
 
     /**
        @brief Compute the beta coefficients
@@ -976,6 +1217,31 @@ namespace quda {
 
   };
 
+/**
+ * @brief Multi-Shift BiCGstab Solver.  Solves the shifted systems (M +
+ * offset[i]) x_i = b directly on a single Krylov space built from the
+ * lowest shift (the seed), without squaring the condition number
+ * through the normal equations (Jegerlehner, hep-lat/9612014).
+ */
+  class MultiShiftBiCGstab : public MultiShiftSolver {
+
+  protected:
+    const DiracMatrix &mat;
+    const DiracMatrix &matSloppy;
+
+  public:
+    MultiShiftBiCGstab(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile);
+    virtual ~MultiShiftBiCGstab();
+
+/**
+ * @brief Run the multi-shift solve.
+ *
+ * @param out std::vector of pointer to solutions for all the shifts.
+ * @param in right-hand side.
+ */
+    void operator()(std::vector<ColorSpinorField*> out, ColorSpinorField &in);
+  };
+
 
 
   /**
@@ -1039,6 +1305,105 @@ namespace quda {
 		    std::vector<ColorSpinorField*> q);
   };
 
+  /**
+     @brief Compressed chronological history for forecasting the
+     initial guess.  The history is held as an orthonormal basis P in
+     reduced precision (half and quarter precision fields carry their
+     own per-site norms) and each stored solution as its coordinates
+     in P, so that N solutions cost at most N reduced-precision
+     fields.  The projected matrix is kept alongside and updated
+     incrementally as the basis changes, for as long as the operator
+     stays the same: this is P^dag A P for a Hermitian operator, and
+     the normal matrix (A P)^dag (A P) otherwise, for which A P is
+     stored as well.  For time-reversible extrapolation the history
+     holds the latest solution and a sequence of auxiliary vectors,
+     also as coordinates in P.
+  */
+  class ChronoBasis {
+
+    std::vector<ColorSpinorField*> P;         //! orthonormal basis
+    std::vector<ColorSpinorField*> AP;        //! A P, only stored for a non-Hermitian operator
+    std::vector<std::vector<Complex> > coord; //! coordinates of the stored solutions in P, newest first
+    std::vector<std::vector<Complex> > aux;   //! coordinates of the auxiliary vectors of time-reversible extrapolation, newest first
+    int aux_dim;                              //! number of auxiliary vectors kept
+    std::vector<Complex> G;                   //! projected matrix, row major
+    uint64_t op_key;                          //! operator for which G is valid, zero if none
+    bool op_hermitian;                        //! whether G is P^dag A P or (A P)^dag (A P)
+
+    /**
+       @brief Drop a basis direction that none of the stored
+       solutions has a component along, rotating it onto the last
+       basis vector with a Householder reflection
+    */
+    void dropDirection();
+
+    /**
+       @brief Release the projected matrix and A P
+    */
+    void invalidateProjection();
+
+    /**
+       @brief Extend the projected matrix from the first j basis
+       vectors to the first j+1, which takes a single application of
+       the operator to P[j]
+    */
+    void extendProjection(int j, DiracMatrix &mat, QudaPrecision mat_precision, bool hermitian);
+
+    /**
+       @brief Compute the projected matrix from scratch
+    */
+    void computeProjection(DiracMatrix &mat, QudaPrecision mat_precision, bool hermitian);
+
+  public:
+    ChronoBasis() : aux_dim(0), op_key(0), op_hermitian(true) { }
+    ChronoBasis(const ChronoBasis &) = delete;
+    ~ChronoBasis() { flush(); }
+
+    /**
+       @return Number of solutions in the history
+    */
+    int Size() const { return coord.size(); }
+
+    /**
+       @brief Release the history
+    */
+    void flush();
+
+    /**
+       @brief Extrapolate an initial guess from the history
+       @param[out] x The initial guess
+       @param[in] b The source of the linear system
+       @param[in] mat The operator, used for minimum residual extrapolation
+       @param[in] mat_precision Precision the operator is applied in
+       @param[in] type Minimum residual, polynomial or time-reversible
+       extrapolation; the latter also advances the auxiliary sequence,
+       so it must alternate with push()
+       @param[in] hermitian Whether the operator is Hermitian
+       @param[in] key Identity of the operator, zero if unknown
+    */
+    void forecast(ColorSpinorField &x, ColorSpinorField &b, DiracMatrix &mat, QudaPrecision mat_precision,
+		  QudaChronoExtrapolationType type, bool hermitian, uint64_t key);
+
+    /**
+       @brief Add a solution to the history, discarding the oldest
+       entry beyond max_dim
+       @param[in] x The solution
+       @param[in] max_dim Maximum length of the history
+       @param[in] replace_last Whether x replaces the newest entry
+       @param[in] precision Precision to store the basis in
+       @param[in] type Extrapolation the history is used for: with
+       time-reversible extrapolation only x is kept as a solution,
+       next to max_dim-1 auxiliary vectors
+       @param[in] mat The operator x was solved with
+       @param[in] mat_precision Precision the operator is applied in
+       @param[in] hermitian Whether the operator is Hermitian
+       @param[in] key Identity of the operator, zero if unknown
+    */
+    void push(const ColorSpinorField &x, int max_dim, bool replace_last, QudaPrecision precision,
+	      QudaChronoExtrapolationType type, DiracMatrix &mat, QudaPrecision mat_precision,
+	      bool hermitian, uint64_t key);
+  };
+
   using ColorSpinorFieldSet = ColorSpinorField;
 
   //forward declaration
@@ -1138,6 +1503,55 @@ namespace quda {
 
   };
 
+  struct RecycleSpace;
+
+  /**
+     @brief Release the subspaces that GCRO-DR recycles across solves
+  */
+  void flushRecycleSpaces();
+
+  /**
+     @brief GCRO-DR: restarted GMRES that recycles a deflation
+     subspace U, with C = A U orthonormal, across restarts and across
+     solves.  Each cycle builds its Krylov space orthogonal to C, and
+     at each restart U is replaced by the harmonic Ritz vectors of
+     smallest magnitude over span{U, V}.  The dimension of U is given
+     by nev and the length of each cycle by Nkrylov.
+
+     Solvers created with the same SolverParam::recycle_key share
+     their subspace, which is kept until flushRecycleSpaces() is
+     called; C is recomputed whenever SolverParam::recycle_op_key
+     changes.  With a zero key the subspace is only recycled across
+     calls to the same solver instance.
+  */
+  class GCRODR : public Solver {
+
+  private:
+    DiracMatrix &mat;
+    DiracMatrix &matSloppy;
+
+    ColorSpinorField *rp;         //! residual vector
+    ColorSpinorField *yp;         //! temporary for mat-vec
+    ColorSpinorField *r_sloppy;   //! sloppy residual vector
+    ColorSpinorField *y_sloppy;   //! sloppy solution accumulator
+    ColorSpinorField *tmp_sloppy; //! temporary for sloppy mat-vec
+
+    std::vector<ColorSpinorField*> V;     //! Arnoldi basis, size Nkrylov+1
+    std::vector<ColorSpinorField*> U_new; //! work space for the subspace update
+    std::vector<ColorSpinorField*> C_new; //! work space for the subspace update
+
+    RecycleSpace *space; //! the recycled subspace
+    bool own_space;      //! whether the subspace is private to this solver
+
+    bool init;
+
+  public:
+    GCRODR(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile);
+    virtual ~GCRODR();
+
+    void operator()(ColorSpinorField &out, ColorSpinorField &in);
+  };
+
 } // namespace quda
 
 #endif // _INVERT_QUDA_H
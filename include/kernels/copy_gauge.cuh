@@ -37,10 +37,13 @@ namespace quda {
       for (int d=0; d<arg.geometry; d++) {
 	for (int x=0; x<arg.volume/2; x++) {
 #ifdef FINE_GRAINED_ACCESS
-	  for (int i=0; i<Ncolor(length); i++)
+	  for (int i=0; i<Ncolor(length); i++) {
+	    // a row-scaled output needs the row maximum before the row is written
+	    if (arg.out.RowScaled()) arg.out.setRowMax(d, parity, x, i, arg.in.RowMax(d, parity, x, i));
 	    for (int j=0; j<Ncolor(length); j++) {
 	      arg.out(d, parity, x, i, j) = arg.in(d, parity, x, i, j);
 	    }
+	  }
 #else
 	  RegTypeIn in[length];
 	  RegTypeOut out[length];
@@ -107,6 +110,7 @@ namespace quda {
 #ifdef FINE_GRAINED_ACCESS
     int i = blockIdx.y * blockDim.y + threadIdx.y;
     if (i >= Ncolor(length)) return;
+    if (arg.out.RowScaled()) arg.out.setRowMax(d, parity, x, i, arg.in.RowMax(d, parity, x, i));
     for (int j=0; j<Ncolor(length); j++) arg.out(d, parity, x, i, j) = arg.in(d, parity, x, i, j);
 #else
     RegTypeIn in[length];
@@ -130,9 +134,12 @@ namespace quda {
       for (int d=0; d<arg.nDim; d++) {
         for (int x=0; x<arg.faceVolumeCB[d]; x++) {
 #ifdef FINE_GRAINED_ACCESS
-          for (int i=0; i<Ncolor(length); i++)
+          for (int i=0; i<Ncolor(length); i++) {
+            if (arg.out.RowScaled())
+              arg.out.setGhostRowMax(d+arg.out_offset, parity, x, i, arg.in.GhostRowMax(d+arg.in_offset, parity, x, i));
             for (int j=0; j<Ncolor(length); j++)
               arg.out.Ghost(d+arg.out_offset, parity, x, i, j) = arg.in.Ghost(d+arg.in_offset, parity, x, i, j);
+          }
 #else
           RegTypeIn in[length];
           RegTypeOut out[length];
@@ -165,6 +172,8 @@ namespace quda {
 #ifdef FINE_GRAINED_ACCESS
     int i = blockIdx.y * blockDim.y + threadIdx.y;
     if (i >= Ncolor(length)) return;
+    if (arg.out.RowScaled())
+      arg.out.setGhostRowMax(d+arg.out_offset, parity, x, i, arg.in.GhostRowMax(d+arg.in_offset, parity, x, i));
     for (int j=0; j<Ncolor(length); j++)
       arg.out.Ghost(d+arg.out_offset, parity, x, i, j) = arg.in.Ghost(d+arg.in_offset, parity, x, i, j);
 #else
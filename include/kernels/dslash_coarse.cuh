@@ -149,10 +149,10 @@ namespace quda {
 		  int col = s_col*Nc + c_col + color_offset;
 		  if (!dagger)
 		    out[color_local] += arg.Y(d+4, parity, x_cb, row, col)
-		      * arg.inA.Ghost(d, 1, their_spinor_parity, ghost_idx + src_idx*arg.volumeCB, s_col, c_col+color_offset);
+		      * arg.inA.Ghost(d, 1, their_spinor_parity, ghost_idx, s_col, c_col+color_offset);
 		  else
 		    out[color_local] += arg.Y(d, parity, x_cb, row, col)
-		      * arg.inA.Ghost(d, 1, their_spinor_parity, ghost_idx + src_idx*arg.volumeCB, s_col, c_col+color_offset);
+		      * arg.inA.Ghost(d, 1, their_spinor_parity, ghost_idx, s_col, c_col+color_offset);
 		}
 	      }
 	    }
@@ -201,7 +201,11 @@ namespace quda {
 	const int gauge_idx = back_idx;
 	if ( arg.commDim[d] && (coord[d] - arg.nFace < 0) ) {
 	  if (doHalo<type>()) {
+	    // the spinor ghost index includes the source index, while the
+	    // link ghost is shared by all the sources
 	    const int ghost_idx = ghostFaceIndex<0>(coord, arg.dim, d, arg.nFace);
+	    const int coord_link[5] = { coord[0], coord[1], coord[2], coord[3], 0 };
+	    const int ghost_link_idx = ghostFaceIndex<0>(coord_link, arg.dim, d, arg.nFace);
 #pragma unroll
 	    for (int color_local=0; color_local<Mc; color_local++) {
 	      int c_row = color_block + color_local;
@@ -212,11 +216,11 @@ namespace quda {
 		for (int c_col=0; c_col<Nc; c_col+=color_stride) {
 		  int col = s_col*Nc + c_col + color_offset;
 		  if (!dagger)
-		    out[color_local] += conj(arg.Y.Ghost(d, 1-parity, ghost_idx, col, row))
-		      * arg.inA.Ghost(d, 0, their_spinor_parity, ghost_idx + src_idx*arg.volumeCB, s_col, c_col+color_offset);
+		    out[color_local] += conj(arg.Y.Ghost(d, 1-parity, ghost_link_idx, col, row))
+		      * arg.inA.Ghost(d, 0, their_spinor_parity, ghost_idx, s_col, c_col+color_offset);
 		  else
-		    out[color_local] += conj(arg.Y.Ghost(d+4, 1-parity, ghost_idx, col, row))
-		      * arg.inA.Ghost(d, 0, their_spinor_parity, ghost_idx + src_idx*arg.volumeCB, s_col, c_col+color_offset);
+		    out[color_local] += conj(arg.Y.Ghost(d+4, 1-parity, ghost_link_idx, col, row))
+		      * arg.inA.Ghost(d, 0, their_spinor_parity, ghost_idx, s_col, c_col+color_offset);
 		}
 	    }
 	  }
@@ -381,20 +385,32 @@ namespace quda {
     const int dir = 0;
     const int dim = 0;
 
+    // With multiple sources the sites are processed in blocks whose
+    // link matrices fit in cache, and all the sources are applied to
+    // a block before moving on, so the links are read from memory
+    // once rather than once per source.
+    constexpr int cache_bytes = 256*1024;
+    constexpr int site_bytes = (dslash*2*nDim + clover) * (Ns*Nc)*(Ns*Nc) * 2 * sizeof(Float);
+    const int block = arg.dim[4] == 1 ? arg.volumeCB : (site_bytes < cache_bytes ? cache_bytes / site_bytes : 1);
+
     for (int parity= 0; parity < arg.nParity; parity++) {
       // for full fields then set parity from loop else use arg setting
       parity = (arg.nParity == 2) ? parity : arg.parity;
 
-      for (int src_idx = 0; src_idx < arg.dim[4]; src_idx++) {
-	//#pragma omp parallel for
-	for(int x_cb = 0; x_cb < arg.volumeCB; x_cb++) { // 4-d volume
-	  for (int s=0; s<2; s++) {
-	    for (int color_block=0; color_block<Nc; color_block+=Mc) { // Mc=Nc means all colors in a thread
-	      coarseDslash<Float,nDim,Ns,Nc,Mc,color_stride,dim_thread_split,dslash,clover,dagger,type,dir,dim>(arg, x_cb, src_idx, parity, s, color_block, color_offset);
+      for (int x_begin = 0; x_begin < arg.volumeCB; x_begin += block) {
+	const int x_end = x_begin + block < arg.volumeCB ? x_begin + block : arg.volumeCB;
+
+	for (int src_idx = 0; src_idx < arg.dim[4]; src_idx++) {
+	  //#pragma omp parallel for
+	  for(int x_cb = x_begin; x_cb < x_end; x_cb++) { // 4-d volume block
+	    for (int s=0; s<2; s++) {
+	      for (int color_block=0; color_block<Nc; color_block+=Mc) { // Mc=Nc means all colors in a thread
+		coarseDslash<Float,nDim,Ns,Nc,Mc,color_stride,dim_thread_split,dslash,clover,dagger,type,dir,dim>(arg, x_cb, src_idx, parity, s, color_block, color_offset);
+	      }
 	    }
-	  }
-	} // 4-d volumeCB
-      } // src index
+	  } // 4-d volume block
+	} // src index
+      } // site blocks
     } // parity
 
   }
@@ -412,16 +428,19 @@ namespace quda {
 
     const int color_offset = lane_id / vector_site_width;
 
-    // for full fields set parity from y thread index else use arg setting
-#if 0  // disable multi-src since this has a measurable impact on single src performance
-    int paritySrc = blockDim.y*blockIdx.y + threadIdx.y;
-    if (paritySrc >= arg.nParity * arg.dim[4]) return;
-    const int src_idx = (arg.nParity == 2) ? paritySrc / 2 : paritySrc; // maybe want to swap order or source and parity for improved locality of same parity
-    const int parity = (arg.nParity == 2) ? paritySrc % 2 : arg.parity;
-#else
-    const int src_idx = 0;
-    const int parity = (arg.nParity == 2) ? blockDim.y*blockIdx.y + threadIdx.y : arg.parity;
-#endif
+    // for full fields set parity from y thread index else use arg setting; with
+    // multiple sources the y thread index also runs over the sources, so the
+    // sources of a block share the link loads through the cache.  The
+    // decomposition is skipped for a single source, where it has a
+    // measurable impact on performance.
+    int src_idx = 0;
+    int parity = (arg.nParity == 2) ? blockDim.y*blockIdx.y + threadIdx.y : arg.parity;
+    if (arg.dim[4] > 1) {
+      const int paritySrc = blockDim.y*blockIdx.y + threadIdx.y;
+      if (paritySrc >= arg.nParity * arg.dim[4]) return;
+      src_idx = (arg.nParity == 2) ? paritySrc / 2 : paritySrc;
+      parity = (arg.nParity == 2) ? paritySrc % 2 : arg.parity;
+    }
 
     // z thread dimension is (( s*(Nc/Mc) + color_block )*dim_thread_split + dim)*2 + dir
     int sMd = blockDim.z*blockIdx.z + threadIdx.z;
@@ -0,0 +1,106 @@
+#ifndef _KRYLOV_SCHUR_QUDA_H
+#define _KRYLOV_SCHUR_QUDA_H
+
+#include <quda_internal.h>
+#include <dirac_quda.h>
+#include <color_spinor_field.h>
+
+#include <vector>
+
+namespace quda {
+
+  /**
+     Block Krylov-Schur eigensolver (Stewart; Zhou and Saad) for a
+     general, non-Hermitian operator.  The Krylov basis is grown by
+     block Arnoldi, so each iteration applies the operator to
+     block_size vectors at once through the batched DiracMatrix
+     interface, and is orthogonalized with batched (multi-BLAS)
+     classical Gram-Schmidt.  On restart the Schur form of the
+     projected matrix is reordered to bring the wanted eigenvalues to
+     the front and the corresponding Schur vectors are kept.  The
+     fields may live on the host or the device; on the host the
+     multi-BLAS falls back to one single-field kernel per pair.
+   */
+  class BlockKrylovSchur {
+
+  private:
+    const DiracMatrix &mat;
+    TimeProfile &profile;
+
+    /** Number of wanted eigenpairs */
+    const int nev;
+
+    /** Dimension of the search space */
+    const int ncv;
+
+    /** Number of vectors the operator is applied to at once */
+    const int block_size;
+
+    /** Relative residual tolerance of the wanted Schur vectors */
+    const double tol;
+
+    /** Maximum number of restarts */
+    const int max_restarts;
+
+    /** Selection criterion, as for ARPACK: "{S,L}{M,R,I}" */
+    char target[3];
+
+    /** Number of applications of mat */
+    long long n_matvec;
+
+    /**
+       @brief Whether the eigenvalue a is wanted ahead of b
+    */
+    bool precedes(const Complex &a, const Complex &b) const;
+
+    /**
+       @brief Fill a field with random numbers
+    */
+    void random(ColorSpinorField &v, int seed) const;
+
+    /**
+       @brief Orthonormalize the block W against the first n basis
+       vectors with two passes of batched classical Gram-Schmidt, and
+       within itself.  The coefficients are accumulated into the
+       column-major matrix h with leading dimension ld, so that
+       W_in = V[0,n) h[0,n) + W_out h[n,n+b).
+    */
+    void orthonormalize(std::vector<ColorSpinorField*> &W, std::vector<ColorSpinorField*> &V, int n,
+                        Complex *h, int ld) const;
+
+  public:
+    /**
+       @param[in] mat Operator whose eigenpairs are computed
+       @param[in] nev Number of wanted eigenpairs
+       @param[in] ncv Dimension of the search space, a multiple of
+       block_size no smaller than nev + 2*block_size
+       @param[in] block_size Number of vectors the operator is applied to at once
+       @param[in] tol Relative residual tolerance
+       @param[in] max_restarts Maximum number of restarts
+       @param[in] target Selection criterion: "SM", "LM", "SR", "LR", "SI" or "LI"
+       @param[in] profile Profile for the solver
+    */
+    BlockKrylovSchur(const DiracMatrix &mat, int nev, int ncv, int block_size, double tol, int max_restarts,
+                     const char *target, TimeProfile &profile);
+    virtual ~BlockKrylovSchur() { }
+
+    /**
+       @brief Compute the nev wanted eigenpairs of the operator
+       @param[out] evecs The nev eigenvectors, normalized, in order of
+       the selection criterion.  The basis is created with the
+       parameters of these fields.
+       @param[out] evals Eigenvalues (Rayleigh quotients of evecs)
+       @param[out] residua Residual norms |A v - lambda v| (optional)
+       @return Number of eigenpairs that converged
+    */
+    int operator()(std::vector<ColorSpinorField*> &evecs, Complex *evals, double *residua = nullptr);
+
+    /**
+       @return Number of applications of the operator in the last solve
+    */
+    long long MatVecs() const { return n_matvec; }
+  };
+
+} // namespace quda
+
+#endif // _KRYLOV_SCHUR_QUDA_H
@@ -8,6 +8,8 @@
 #include <color_spinor_field.h>
 #include <eig_variables.h>
 
+#include <vector>
+
 namespace quda {
 
   /**
@@ -70,24 +72,63 @@ namespace quda {
                     cudaColorSpinorField &r, cudaColorSpinorField &Apsi, int k0, int m);
   };
     
-#if 0
   /**
-     Not implemented yet!!!, Implicitely restarted Lanczos algoritm can rapidly approach the solution than normal Lanczos, Chebychev acceleration and implicite restart processes are needed. At this moment external program call can do this.
+     Thick-restart Lanczos algorithm (Wu and Simon), which for a
+     Hermitian operator is equivalent to the implicitly restarted
+     Lanczos method.  The operator may be filtered with the Chebyshev
+     polynomial of RitzMat (NPoly > 0), which maps the unwanted part
+     of the spectrum [MatPoly_param[0]^2, (MatPoly_param[1] +
+     |eigen_shift|)^2] onto [-1,1] and amplifies the low modes.
+     Converged Ritz pairs are locked and the basis is kept orthogonal
+     with batched (multi-BLAS) classical Gram-Schmidt, which requires
+     the fields to live on the device.
   */
-
   class ImpRstLanczos : public Eig_Solver {
 
   private:
-    const RitzMat &ritz_mat;
+    const DiracMatrix &mat;
+
+    /** Number of applications of mat */
+    long long n_matvec;
+
+    /**
+       @brief Apply the (filtered) operator: out = T_N(x(A)) in, or A in if NPoly = 0
+    */
+    void apply(ColorSpinorField &out, ColorSpinorField &in, ColorSpinorField &t1, ColorSpinorField &t2);
+
+    /**
+       @brief Orthogonalize w against the first n basis vectors with two
+       passes of batched classical Gram-Schmidt
+    */
+    void orthogonalize(ColorSpinorField &w, std::vector<ColorSpinorField*> &V, int n);
 
   public:
     ImpRstLanczos(RitzMat &ritz_mat, QudaEigParam &eigParam, TimeProfile &profile);
+    ImpRstLanczos(DiracMatrix &mat, QudaEigParam &eigParam, TimeProfile &profile);
     virtual ~ImpRstLanczos();
 
-    void operator()(double *alpha, double *beta, cudaColorSpinorField **Eig_Vec, 
+    /**
+       @brief Compute the eigParam.nk lowest eigenpairs of the operator
+       @param[in,out] V Krylov basis, of dimension m > nk.  On return
+       the first nk fields hold the eigenvectors, in ascending order of
+       the eigenvalues
+       @param[in,out] r Starting vector, used as workspace
+       @param[out] evals Eigenvalues of the unfiltered operator
+       @param[out] residua Residual norms |A v - lambda v| of the eigenpairs
+       @param[in] nlock Number of leading fields of V that already hold
+       converged eigenvectors
+    */
+    void operator()(std::vector<ColorSpinorField*> &V, ColorSpinorField &r, double *evals, double *residua, int nlock = 0);
+
+    /**
+       @brief Eig_Solver interface: Eig_Vec holds the m basis vectors,
+       on return alpha and beta hold the eigenvalues and residual norms
+       of the nk lowest eigenpairs, and the first k0 vectors are taken
+       to be converged already
+    */
+    void operator()(double *alpha, double *beta, cudaColorSpinorField **Eig_Vec,
                     cudaColorSpinorField &r, cudaColorSpinorField &Apsi, int k0, int m);
   };
-#endif
 
 } // namespace quda
 
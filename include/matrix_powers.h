@@ -0,0 +1,144 @@
+#ifndef _MATRIX_POWERS_H
+#define _MATRIX_POWERS_H
+
+#include <vector>
+#include <complex>
+#include <quda_internal.h>
+#include <color_spinor_field.h>
+#include <gauge_field.h>
+
+/**
+   @file matrix_powers.h
+
+   Matrix-powers kernel for the coarse operator on host fields.  The
+   powers M v, M^2 v, ..., M^s v are computed from a single depth-s
+   halo exchange instead of one exchange per application of M.  The
+   fields are held on a local lattice extended by s sites in each
+   partitioned dimension, as for the extended gauge fields, and each
+   successive power is computed on a region that shrinks by one site
+   per application, so the boundary work is done redundantly on
+   neighboring ranks rather than communicated.
+ */
+
+namespace quda {
+
+  class CoarseMatrixPowers {
+
+    typedef std::complex<double> complex;
+
+    const int depth;  // maximum number of powers computed from a single halo exchange
+    const int nDim;   // number of lattice dimensions
+    const int n;      // number of spin-color components per site
+    const double kappa;
+
+    int X[4];         // local lattice dimensions
+    int R[4];         // halo depth in each dimension (zero if not communicated)
+    int E[4];         // extended lattice dimensions
+    int volumeEx;     // extended volume
+    int nPartitioned; // number of communicated dimensions
+
+    std::vector<complex> Y;  // extended coarse links, [site][dir][row][col]
+    std::vector<complex> Xc; // extended coarse clover, [site][row][col]
+    std::vector<complex> v;  // work space for the powers, [power][site][component]
+
+    long long messages;          // halo messages sent by the matrix-powers kernel
+    long long messages_baseline; // halo messages that applying M in turn would have sent
+    long long flops;
+
+    /**
+       @brief Extended lattice index of a local lattice coordinate
+       offset by the halo depth
+    */
+    inline int index(const int x[]) const
+    { return ((x[3]*E[2] + x[2])*E[1] + x[1])*E[0] + x[0]; }
+
+    /**
+       @brief Fill the halo of an extended field to a given depth.
+       The dimensions are exchanged in turn with the faces including
+       the halos of the previous dimensions, so the corner regions are
+       filled without diagonal messages.
+       @param[in,out] field Extended field
+       @param[in] site_len Number of complex numbers per site
+       @param[in] d Depth of the halo to fill
+       @return Number of messages sent
+    */
+    int exchange(complex *field, int site_len, int d);
+
+    /**
+       @brief Apply M to the region of the extended lattice whose
+       halo depth is r in the communicated dimensions
+       @param[out] out Extended output field
+       @param[in] in Extended input field, valid to depth r+1
+       @param[in] r Halo depth of the region computed
+       @param[in] dagger Whether to apply the dagger operator
+    */
+    void apply(complex *out, const complex *in, int r, bool dagger);
+
+    template <typename Float> void load(const ColorSpinorField &in);
+    template <typename Float> void store(ColorSpinorField &out, int power) const;
+
+  public:
+    /**
+       @param[in] Y Host coarse link field (QDP order)
+       @param[in] X Host coarse clover field (QDP order)
+       @param[in] kappa Hopping parameter of the coarse operator
+       @param[in] depth Maximum number of powers per halo exchange
+       @param[in] commDim Whether communications are enabled in each dimension
+    */
+    CoarseMatrixPowers(const cpuGaugeField &Y, const cpuGaugeField &X, double kappa, int depth,
+		       const int *commDim);
+
+    /**
+       @brief Compute out[k] = M^{k+1} in.  Powers beyond the depth of
+       the kernel are computed from further halo exchanges.
+       @param[out] out Powers of M applied to in
+       @param[in] in Input field
+       @param[in] dagger Whether to apply the dagger operator
+    */
+    void operator()(std::vector<ColorSpinorField*> &out, const ColorSpinorField &in, bool dagger);
+
+    /**
+       @brief Restricted additive Schwarz domain solve.  The source is
+       imported into a halo of the given overlap depth with a single
+       exchange, and the local domain extended by the overlap is solved
+       approximately by niter minimal-residual iterations with
+       Dirichlet boundary conditions and local inner products.  Only
+       the solution on the local sites is kept.  The kernel must have
+       been created with a depth greater than the overlap.
+       @param[out] x Solution on the local sites
+       @param[in] b Source
+       @param[in] overlap Depth of the overlap in the communicated dimensions
+       @param[in] niter Number of minimal-residual iterations
+       @param[in] omega Relaxation parameter of the iterations
+       @param[in] dagger Whether to apply the dagger operator
+    */
+    void solveDomain(ColorSpinorField &x, const ColorSpinorField &b, int overlap, int niter, double omega,
+		     bool dagger);
+
+    int Depth() const { return depth; }
+
+    /**
+       @return Whether the halo layout of this kernel matches the
+       given communication pattern
+    */
+    bool Matches(const int *commDim) const;
+
+    /**
+       @return Halo messages sent by the matrix-powers kernel
+    */
+    long long Messages() const { return messages; }
+
+    /**
+       @return Halo messages that applying M in turn would have sent
+    */
+    long long MessagesBaseline() const { return messages_baseline; }
+
+    /**
+       @return Flops done since the last call, including the redundant boundary work
+    */
+    long long Flops() { long long rtn = flops; flops = 0; return rtn; }
+  };
+
+} // namespace quda
+
+#endif // _MATRIX_POWERS_H
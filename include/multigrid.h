@@ -16,6 +16,7 @@ namespace quda {
   // forward declarations
   class MG;
   class DiracCoarse;
+  class Agglomerate;
 
   /**
      This struct contains all the metadata required to define the
@@ -96,6 +97,10 @@ namespace quda {
     /** Filename for where to load/store the null space */
     char filename[100];
 
+    /** Key identifying the gauge field and parameters the setup is
+        computed from, used to match setup checkpoints */
+    uint64_t checkpoint_key;
+
     /**
        This is top level instantiation done when we start creating the multigrid operator.
      */
@@ -124,7 +129,8 @@ namespace quda {
       coarse_grid_solution_type(param.coarse_grid_solution_type[level]),
       smoother_solve_type(param.smoother_solve_type[level]),
       location(param.location[level]),
-      setup_location(param.setup_location[level])
+      setup_location(param.setup_location[level]),
+      checkpoint_key(0)
       { 
 	// set the block size
 	for (int i=0; i<QUDA_MAX_DIM; i++) geoBlockSize[i] = param.geo_block_size[level][i];
@@ -160,7 +166,8 @@ namespace quda {
       coarse_grid_solution_type(param.mg_global.coarse_grid_solution_type[level]),
       smoother_solve_type(param.mg_global.smoother_solve_type[level]),
       location(param.mg_global.location[level]),
-      setup_location(param.mg_global.setup_location[level])
+      setup_location(param.mg_global.setup_location[level]),
+      checkpoint_key(param.checkpoint_key)
       {
 	// set the block size
 	for (int i=0; i<QUDA_MAX_DIM; i++) geoBlockSize[i] = param.mg_global.geo_block_size[level][i];
@@ -270,9 +277,27 @@ namespace quda {
     /** Wrapper for the sloppy smoothing coarse grid operator */
     DiracMatrix *matCoarseSmootherSloppy;
 
+    /** Low right singular vectors of the coarse operator, used to deflate the coarse solver */
+    std::vector<ColorSpinorField*> defl_right;
+
+    /** Left singular vectors of the coarse operator, D v_i = sigma_i u_i */
+    std::vector<ColorSpinorField*> defl_left;
+
+    /** Low singular values of the coarse operator */
+    std::vector<double> defl_sigma;
+
+    /** Coarse correction and residual vectors of the deflated coarse solve */
+    ColorSpinorField *defl_y, *defl_r;
+
+    /** Agglomeration of the coarse solve onto fewer processes (null if not agglomerated) */
+    Agglomerate *agglomerate;
+
     /** Parallel hyper-cubic random number generator for generating null-space vectors */
     RNG *rng;
 
+    /** Whether this level is being restored from a setup checkpoint */
+    bool restore;
+
   public:
     /** 
       Constructor for MG class
@@ -293,6 +318,17 @@ namespace quda {
      */
     void reset(bool refresh=false);
 
+    /**
+       @brief Flip the sign of the twisted-mass parameter on every
+       level, so the hierarchy built for mu also preconditions the
+       operator of the opposite flavor.  The null space and transfer
+       operators are kept, and the coarse operators are derived from
+       the existing coarse links rather than recomputed.  The coarse
+       deflation space is gamma5-rotated and the roots of the GMRES
+       polynomial smoothers are conjugated rather than recomputed.
+    */
+    void flipMu();
+
     /**
        @brief Create the smoothers
     */
@@ -303,6 +339,16 @@ namespace quda {
     */
     void destroySmoother();
 
+    /**
+       @brief Randomized estimate of the deviation of the unit-norm
+       null-space vectors from the span of the current prolongator,
+       |(1 - P P^dagger) sum_k z_k v_k| for random signs z_k.  Its
+       mean square is sum_k |(1 - P P^dagger) v_k|^2, which bounds the
+       largest deviation, at the cost of a single restriction and
+       prolongation
+    */
+    double nullSpaceDeviation();
+
     /**
        @brief Create the coarse dirac operator
     */
@@ -318,6 +364,48 @@ namespace quda {
     */
     void destroyCoarseSolver();
 
+    /**
+       @brief Compute the low singular vectors of the coarse operator
+       that deflate the coarse solver, if requested with
+       coarse_solver_deflate_nvec
+    */
+    void createCoarseDeflation();
+
+    /**
+       @brief Free the deflation space of the coarse solver
+    */
+    void destroyCoarseDeflation();
+
+    /**
+       @brief Gather the coarse solve onto fewer processes if the local
+       volume of the coarse lattice is below
+       coarse_solver_agglomerate_volume
+    */
+    void createCoarseAgglomeration();
+
+    /**
+       @brief Apply the coarse solver, agglomerated if requested
+       @param x Solution vector
+       @param b Right hand side
+    */
+    void applyCoarseSolver(ColorSpinorField &x, ColorSpinorField &b);
+
+    /**
+       @brief Add the deflated solution of the coarse system, x += V
+       Sigma^{-1} U^dagger b
+       @param x Solution vector that is updated
+       @param b Right hand side
+    */
+    void deflateCoarse(ColorSpinorField &x, ColorSpinorField &b);
+
+    /**
+       @brief Solve the coarse grid system x_coarse = D_c^{-1}
+       r_coarse.  With a deflation space the solver starts from the
+       deflated solution and the low modes of its residual are
+       projected out after the solve.
+    */
+    void solveCoarse();
+
     /**
        This method verifies the correctness of the MG method.  It checks:
        1. Null-space vectors are exactly preserved: v_k = P R v_k
@@ -333,6 +421,45 @@ namespace quda {
      */
     void operator()(ColorSpinorField &out, ColorSpinorField &in);
 
+    /**
+       @brief Apply the V-cycle to a batch of right-hand sides.  Each
+       one is smoothed in turn, but when the next level is the
+       coarsest their coarse systems are solved together with
+       solveCoarseBatch, which applies the coarse operator to the
+       whole batch at once.  Otherwise, or with a deflated or
+       agglomerated coarse solver, the V-cycle is applied to each in
+       turn.
+       @param out The solution vectors
+       @param in The residual vectors
+     */
+    void operator()(std::vector<ColorSpinorField*> &out, std::vector<ColorSpinorField*> &in);
+
+    /**
+       @brief Apply the V-cycle to the components of a composite
+       field as one batch
+       @param out The solution vectors
+       @param in The residual vectors
+     */
+    void blocksolve(ColorSpinorField &out, ColorSpinorField &in);
+
+    /**
+       @brief First half of the V-cycle: pre-smoothing and, once the
+       coarse level exists, restriction of the residual to r_coarse
+       @param x The solution vector
+       @param b The residual vector
+       @return The smoother solution field, to pass to postCycle
+     */
+    ColorSpinorField* preCycle(ColorSpinorField &x, ColorSpinorField &b);
+
+    /**
+       @brief Second half of the V-cycle: prolongation of the coarse
+       solution x_coarse, if the coarse level exists, and post-smoothing
+       @param x The solution vector
+       @param b The residual vector
+       @param out The smoother solution field returned by preCycle
+     */
+    void postCycle(ColorSpinorField &x, ColorSpinorField &b, ColorSpinorField *out);
+
     /**
        @brief Load the null space vectors in from file
        @param B Loaded null-space vectors (pre-allocated)
@@ -345,6 +472,27 @@ namespace quda {
     */
     void saveVectors(std::vector<ColorSpinorField*> &B);
 
+    /**
+       @brief Name of the setup checkpoint file of this level
+    */
+    std::string checkpointFile() const;
+
+    /**
+       @brief Save the setup of this and all coarser levels (null-space
+       vectors, prolongator and coarse link fields) to checkpoint files
+    */
+    void saveCheckpoint();
+
+    /**
+       @brief Restore part of the setup of this level from its
+       checkpoint file.  The null-space vectors and prolongator are
+       restored once the transfer operator exists, the coarse link
+       fields once the coarse operator has been allocated.
+       @param coarse_links Whether to restore the coarse link fields
+       (else the null-space vectors and prolongator)
+    */
+    void loadCheckpoint(bool coarse_links);
+
     /**
        @brief Generate the null-space vectors
        @param B Generated null-space vectors
@@ -352,6 +500,43 @@ namespace quda {
      */
     void generateNullVectors(std::vector<ColorSpinorField*> &B, bool refresh=false);
 
+    /**
+       @brief Solve the coarse systems M x_i = b_i of a batch of
+       right-hand sides together, with multi-source CG on the normal
+       equations.  The coarse operator is applied to the whole batch
+       at once, which loads the coarse links once for all sources.
+       @param[out] x Solution vectors
+       @param[in] b Right-hand sides
+       @param[in,out] solverParam Tolerance and iteration limit of the
+       solve, which accumulates its iterations and Gflops
+     */
+    void solveCoarseBatch(std::vector<ColorSpinorField*> &x, std::vector<ColorSpinorField*> &b, SolverParam &solverParam);
+
+    /**
+       @brief Measure the two-grid convergence of the current transfer
+       and coarse operators: the given errors of the homogeneous fine
+       system are relaxed with MR pre- and post-smoothing around a
+       coarse-grid correction, the coarse systems of all test vectors
+       being solved as one batch to the coarse solver tolerance.
+       @param[in] e0 Initial errors, which are left unchanged so that
+       every candidate operator is measured on the same vectors
+       @param[out] cost Flops of the fine and coarse operators and the
+       transfer per cycle
+       @return Geometric mean of the error reduction per cycle
+     */
+    double twoGridConvergence(const std::vector<ColorSpinorField*> &e0, double &cost);
+
+    /**
+       @brief Choose the number of null-space vectors of this level.
+       Starting from the fewest supported vectors, the next larger
+       count is accepted while it improves the error reduction per
+       flop, -log(rho) / cost, of the two-grid cycle.  All candidates
+       are measured on the same random test vectors.  The unused
+       null-space vectors are freed, and the chosen count is written
+       back to n_vec so that later runs can reuse it.
+     */
+    void selectNvec();
+
     /**
        @brief Build free-field null-space vectors
        @param B Free-field null-space vectors
@@ -0,0 +1,260 @@
+#ifndef _NATIVE_IO_H
+#define _NATIVE_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <enum_quda.h>
+
+/**
+   @file native_io.h
+
+   Parallel readers and writers for lattice field files that do not
+   depend on QIO/QMP.  Each rank opens the file independently and uses
+   positioned reads and writes on only its own hyperslab of the global
+   lattice, so there is no gather through a single I/O node.
+ */
+
+/**
+   File formats understood by the native gauge field I/O
+ */
+enum NativeFileFormat {
+  NATIVE_NERSC_FORMAT, // NERSC archive format, header followed by big-endian 3x3 links
+  NATIVE_ILDG_FORMAT   // ILDG binary data inside a SciDAC LIME file
+};
+
+/**
+   @brief Read a NERSC or ILDG (LIME) gauge configuration in
+   parallel.  The file format is detected from its leading bytes.
+   Byte swapping, precision conversion and reordering into the
+   requested gauge order are done on the fly, and the file checksum
+   (NERSC CHECKSUM / SciDAC suma-sumb) is verified with a global
+   reduction over all ranks.
+   @param[in] filename File to read
+   @param[out] gauge Host gauge field: for QUDA_QDP_GAUGE_ORDER this
+   is an array of four pointers (one per dimension), otherwise a
+   single pointer
+   @param[in] precision Precision of the host gauge field
+   @param[in] X Local lattice dimensions
+   @param[in] order Gauge field order of gauge (QDP or MILC)
+ */
+void read_gauge_field_native(const char *filename, void *gauge, QudaPrecision precision,
+			     const int *X, QudaGaugeFieldOrder order);
+
+/**
+   @brief Write a gauge field in parallel as a NERSC
+   (4D_SU3_GAUGE_3x3) or ILDG file in the host precision.  ILDG files
+   are written with the SciDAC records expected by QIO, so they can
+   be read back with read_gauge_field.  Packing and byte swapping of
+   each batch overlaps with the positioned writes of the previous
+   one, and the file checksum is computed on the fly.
+   @param[in] filename File to write
+   @param[in] gauge Host gauge field (see read_gauge_field_native)
+   @param[in] precision Precision of the host gauge field and the file
+   @param[in] X Local lattice dimensions
+   @param[in] order Gauge field order of gauge (QDP or MILC)
+   @param[in] format File format to write
+ */
+void write_gauge_field_native(const char *filename, void *gauge, QudaPrecision precision,
+			      const int *X, QudaGaugeFieldOrder order, NativeFileFormat format);
+
+/**
+   @brief Write a set of color-spinor fields in parallel as a single
+   SciDAC record, in the same layout as write_spinor_field, so the
+   file can be read back with read_spinor_field.
+   @param[in] filename File to write
+   @param[in] V Array of Nvec host fields in QUDA space-spin-color order
+   @param[in] precision Precision of the host fields and the file
+   @param[in] X Local lattice dimensions
+   @param[in] nColor Number of colors
+   @param[in] nSpin Number of spins
+   @param[in] Nvec Number of fields
+ */
+void write_spinor_field_native(const char *filename, void *V[], QudaPrecision precision, const int *X,
+			       int nColor, int nSpin, int Nvec);
+
+/**
+   @brief Write a set of color-spinor fields in parallel in the
+   compact vector format: each site stores a float norm per field and
+   the field components as 16-bit fixed-point numbers, as in
+   half-precision device fields.  This is intended for multigrid
+   null-space vectors, where the loss of precision is immaterial and
+   the files are 2-4x smaller than with write_spinor_field_native.
+   @param[in] filename File to write
+   @param[in] V Array of Nvec host fields in QUDA space-spin-color order
+   @param[in] precision Precision of the host fields
+   @param[in] X Local lattice dimensions
+   @param[in] nColor Number of colors
+   @param[in] nSpin Number of spins
+   @param[in] Nvec Number of fields
+ */
+void write_spinor_field_compact(const char *filename, void *V[], QudaPrecision precision, const int *X,
+				int nColor, int nSpin, int Nvec);
+
+/**
+   @brief Read a set of color-spinor fields in parallel from a file
+   written by write_spinor_field_compact, verifying its checksum.
+   @param[in] filename File to read
+   @param[out] V Array of Nvec host fields in QUDA space-spin-color order
+   @param[in] precision Precision of the host fields
+   @param[in] X Local lattice dimensions
+   @param[in] nColor Number of colors
+   @param[in] nSpin Number of spins
+   @param[in] Nvec Number of fields
+ */
+void read_spinor_field_compact(const char *filename, void *V[], QudaPrecision precision, const int *X,
+			       int nColor, int nSpin, int Nvec);
+
+/**
+   @brief Query whether a file is in the compact vector format
+   @param[in] filename File to query
+   @return Whether the file exists and is a compact vector file
+ */
+bool is_compact_spinor_file(const char *filename);
+
+/**
+   A set of host arrays stored together as one record of a checkpoint
+   file: Nvec arrays on a lattice with local dimensions X, each
+   holding len real numbers per site in QUDA even-odd site order.
+   Color-spinor fields in space-spin-color order and the per-direction
+   arrays of QDP-ordered gauge fields both have this layout.
+ */
+struct NativeRecord {
+  void **V;                // Nvec host arrays (nullptr to skip the record when reading)
+  int Nvec;                // number of arrays
+  int len;                 // real numbers per site per array
+  QudaPrecision precision; // precision of the host arrays and the file
+  const int *X;            // local lattice dimensions
+};
+
+/**
+   @brief Write a checkpoint file made of a sequence of records, each
+   written in parallel with its own checksum.  The file is tagged
+   with a key identifying what it was computed from, and the file
+   header is written last so an interrupted write never leaves a
+   valid checkpoint behind.
+   @param[in] filename File to write
+   @param[in] key Key identifying the checkpointed state
+   @param[in] record Array of records to write
+   @param[in] n_record Number of records
+ */
+void write_checkpoint_native(const char *filename, uint64_t key, const NativeRecord *record, int n_record);
+
+/**
+   @brief Read records from a checkpoint file written by
+   write_checkpoint_native, verifying their checksums.  Records whose
+   V pointer is null are skipped, so a checkpoint can be restored in
+   stages as its destination fields become available.
+   @param[in] filename File to read
+   @param[in] key Expected key of the checkpoint
+   @param[in,out] record Array of records to read into
+   @param[in] n_record Number of records, which must match the file
+   @return Whether the file exists and carries the expected key; if
+   not, nothing is read
+ */
+bool read_checkpoint_native(const char *filename, uint64_t key, const NativeRecord *record, int n_record);
+
+/**
+   @brief Query whether a file is a complete checkpoint with a given key
+   @param[in] filename File to query
+   @param[in] key Expected key of the checkpoint
+   @return Whether the file exists and carries the expected key
+ */
+bool is_checkpoint_native(const char *filename, uint64_t key);
+
+/**
+   Handle on an open vector store: a file holding a growing sequence
+   of distributed vectors together with a small block of metadata.
+   Each rank's part of each vector is stored contiguously and page
+   aligned in the rank's native in-memory layout, so the vectors of an
+   existing store can be memory mapped and are only paged in from disk
+   when first touched.  New vectors are appended in place, and each
+   commit writes the metadata into the slot not named by the header
+   before the header is switched over to it, so an interrupted update
+   leaves the last committed state behind.  A store must be reopened
+   with the same process grid it was written with.
+ */
+struct NativeVectorStore;
+
+/**
+   @brief Query whether a file is a vector store
+   @param[in] filename File to query
+   @return Whether the file exists and is a vector store
+ */
+bool is_vector_store(const char *filename);
+
+/**
+   @brief Open an existing vector store and map its committed vectors
+   @param[in] filename File to open
+   @param[in] key Key identifying what the stored vectors represent
+   @param[in] vec_bytes Bytes of each rank's part of a vector
+   @param[in] capacity Maximum number of vectors in the store
+   @param[in] meta_bytes Size of the metadata block
+   @param[in] writable Whether the store will be appended to
+   @return Handle on the store, or nullptr if the file does not exist
+   or was written with a different key, layout or process grid
+ */
+NativeVectorStore *open_vector_store(const char *filename, uint64_t key, size_t vec_bytes, int capacity,
+				     size_t meta_bytes, bool writable);
+
+/**
+   @brief Create a new, empty vector store, replacing any existing file
+   @param[in] filename File to create
+   @param[in] key Key identifying what the stored vectors represent
+   @param[in] vec_bytes Bytes of each rank's part of a vector
+   @param[in] capacity Maximum number of vectors in the store
+   @param[in] meta_bytes Size of the metadata block
+   @return Handle on the store
+ */
+NativeVectorStore *create_vector_store(const char *filename, uint64_t key, size_t vec_bytes, int capacity,
+				       size_t meta_bytes);
+
+/**
+   @brief Close a vector store, unmapping its vectors
+   @param[in] store Store to close
+ */
+void close_vector_store(NativeVectorStore *store);
+
+/**
+   @brief Return the number of committed vectors of a store
+   @param[in] store Store to query
+ */
+int vector_store_size(const NativeVectorStore *store);
+
+/**
+   @brief Return this rank's part of a vector that was committed when
+   the store was opened.  The data are paged in from disk on first
+   access.
+   @param[in] store Store to read from
+   @param[in] i Index of the vector
+   @return Pointer to the read-only mapped vector
+ */
+const void *vector_store_vector(NativeVectorStore *store, int i);
+
+/**
+   @brief Read the metadata block of a store
+   @param[in] store Store to read from
+   @param[out] meta Buffer of meta_bytes bytes
+ */
+void vector_store_read_meta(NativeVectorStore *store, void *meta);
+
+/**
+   @brief Write this rank's part of a vector.  The vector only
+   becomes part of the store once it is committed.
+   @param[in] store Store to write to
+   @param[in] i Index of the vector
+   @param[in] v This rank's part of the vector
+ */
+void vector_store_write(NativeVectorStore *store, int i, const void *v);
+
+/**
+   @brief Commit the first n_vec vectors of a store, once all ranks
+   have written them, together with a new metadata block.
+   Committing a smaller number of vectors than before discards the
+   remaining ones.
+   @param[in] store Store to commit
+   @param[in] n_vec Number of vectors in the store
+   @param[in] meta Metadata block of meta_bytes bytes (read on rank 0)
+ */
+void vector_store_commit(NativeVectorStore *store, int n_vec, const void *meta);
+
+#endif // _NATIVE_IO_H
@@ -240,6 +240,17 @@ extern "C" {
     /** Maximum size of Krylov space used by solver */
     int gcrNkrylov;
 
+    /** Basis for the s-step Krylov space of CA solvers */
+    QudaCABasis ca_basis;
+
+    /** Lower bound of the spectrum used for the Chebyshev basis of CA solvers */
+    double ca_lambda_min;
+
+    /** Upper bound of the spectrum used for the Chebyshev basis of
+        CA solvers.  If not positive, both bounds are estimated by the
+        solver, and returned here for use in subsequent solves. */
+    double ca_lambda_max;
+
     /*
      * The following parameters are related to the solver
      * preconditioner, if enabled.
@@ -254,7 +265,7 @@ extern "C" {
     /** Preconditioner instance, e.g., multigrid */
     void *preconditioner;
 
-    /** Deflation instance */
+    /** Deflation instance, also used to deflate multi-shift CG solves */
     void *deflation_op;
 
     /**
@@ -337,6 +348,26 @@ extern "C" {
     /** Precision to store the chronological basis in */
     QudaPrecision chrono_precision;
 
+    /** Whether to store the chronological history compressed, as an
+        orthonormal basis in chrono_precision with the solutions kept
+        as coordinates in that basis */
+    int chrono_compress;
+
+    /** How to extrapolate the initial guess from the chronological
+        history (polynomial and time-reversible extrapolation require
+        chrono_compress).  Time-reversible extrapolation propagates a
+        sequence of chrono_max_dim-1 auxiliary guesses alongside the
+        latest solution, with weights that are symmetric under
+        trajectory reversal (exactly so for chrono_max_dim < 5, and
+        up to a small dissipation term beyond), for use in HMC. */
+    QudaChronoExtrapolationType chrono_extrapolation;
+
+    /** The precision CG starts its sloppy iterations in when adaptive
+        precision is enabled.  The sloppy precision is promoted to
+        cuda_prec_sloppy once the true residual at a reliable update
+        stagnates (QUDA_INVALID_PRECISION or zero disables adaptive precision) */
+    QudaPrecision cuda_prec_adaptive;
+
     /** Which external library to use in the linear solvers (MAGMA or Eigen) */
     QudaExtLibType extlib_type;
 
@@ -366,6 +397,8 @@ extern "C" {
     int np;
     int f_size;
     double eigen_shift;
+    /** Maximum number of restarts of the thick-restart Lanczos solver */
+    int max_restarts;
 //more general stuff:
     /** Whether to load eigenvectors */
     QudaBoolean import_vectors;
@@ -388,6 +421,13 @@ extern "C" {
     /** Filename prefix for where to save the null-space vectors */
     char vec_outfile[256];
 
+    /** Whether to keep the deflation space in a native vector store,
+        which is appended to as the space grows and memory mapped when
+        loaded, rather than writing it once as a SciDAC file.  A store
+        must be read back on the same process grid.  Loading detects
+        the format automatically. */
+    QudaBoolean vec_store;
+
     /** The Gflops rate of the multigrid solver setup */
     double gflops;
 
@@ -419,6 +459,21 @@ extern "C" {
     /** Precision to store the null-space vectors in (post block orthogonalization) */
     QudaPrecision precision_null[QUDA_MAX_MG_LEVEL];
 
+    /** Precision to store the coarse link matrices (Y, X, Yhat and
+        Xinv) created on each level in, on both the host and the
+        device.  Half and quarter precision use a fixed-point format
+        with one scale factor per matrix row, computed when the coarse
+        operator is constructed.  QUDA_INVALID_PRECISION stores them in
+        the null-space precision. */
+    QudaPrecision precision_coarse_link[QUDA_MAX_MG_LEVEL];
+
+    /** Whether to choose the number of null-space vectors on each
+        level adaptively during the setup.  n_vec is then the maximum:
+        starting from the fewest supported vectors, more are added while
+        the measured two-grid convergence per flop improves, and n_vec
+        is overwritten with the chosen count. */
+    QudaBoolean setup_adaptive_nvec[QUDA_MAX_MG_LEVEL];
+
     /** Verbosity on each level of the multigrid */
     QudaVerbosity verbosity[QUDA_MAX_MG_LEVEL];
 
@@ -437,6 +492,14 @@ extern "C" {
     /** Maximum number of iterations for refreshing the null-space vectors */
     int setup_maxiter_refresh[QUDA_MAX_MG_LEVEL];
 
+    /** Tolerance of the incremental refresh: a random combination of
+        the refreshed null-space vectors is compared against the span
+        of the existing prolongator, which is only rebuilt if it
+        deviates by more than this amount, an estimate of the root sum
+        of squares of the relative deviations of the vectors (0 always
+        rebuilds it) */
+    double setup_refresh_tol[QUDA_MAX_MG_LEVEL];
+
     /** Null-space type to use in the setup phase */
     QudaSetupType setup_type;
 
@@ -455,6 +518,15 @@ extern "C" {
     /** Tolerance for the solver that wraps around the coarse grid correction and smoother */
     double coarse_solver_maxiter[QUDA_MAX_MG_LEVEL];
 
+    /** Number of low singular vectors of the coarse operator that
+        deflate the solver on each level (0 disables deflation) */
+    int coarse_solver_deflate_nvec[QUDA_MAX_MG_LEVEL];
+
+    /** Gather the coarsest-level solve onto fewer processes when the
+        local volume of that level is below this number of sites (0
+        disables agglomeration) */
+    int coarse_solver_agglomerate_volume[QUDA_MAX_MG_LEVEL];
+
     /** Smoother to use on each level */
     QudaInverterType smoother[QUDA_MAX_MG_LEVEL];
 
@@ -479,6 +551,9 @@ extern "C" {
     /** Number of Schwarz cycles to apply */
     int smoother_schwarz_cycle[QUDA_MAX_MG_LEVEL];
 
+    /** Overlap depth of the restricted additive Schwarz domains in the smoother (0 for non-overlapping domains, requires the level to be on the host) */
+    int smoother_schwarz_overlap[QUDA_MAX_MG_LEVEL];
+
     /** The type of residual to send to the next coarse grid, and thus the
 	type of solution to receive back from this coarse grid */
     QudaSolutionType coarse_grid_solution_type[QUDA_MAX_MG_LEVEL];
@@ -512,12 +587,31 @@ extern "C" {
     /** Whether to run the verification checks once set up is complete */
     QudaBoolean run_verify;
 
+    /** Number of eigenvectors of smallest magnitude of the smoother
+        operator on each level whose overlap with the null space the
+        verification reports (0 skips this check, which needs about
+        five times as many fields of that level where the level lives) */
+    int verify_n_evec[QUDA_MAX_MG_LEVEL];
+
     /** Filename prefix where to load the null-space vectors */
     char vec_infile[256];
 
     /** Filename prefix for where to save the null-space vectors */
     char vec_outfile[256];
 
+    /** Whether to save the null-space vectors in the compact native
+        format (16-bit components with per-site norms, parallel I/O
+        without QIO) rather than as SciDAC files.  Loading detects the
+        format automatically. */
+    QudaBoolean vec_compact;
+
+    /** Filename prefix for checkpointing the whole setup (null-space
+        vectors, prolongators and coarse operators of every level).
+        If a checkpoint computed from the same gauge field and setup
+        parameters exists it is restored and the setup is skipped,
+        otherwise the checkpoint is written once the setup is done. */
+    char setup_checkpoint[256];
+
     /** The Gflops rate of the multigrid solver setup */
     double gflops;
 
@@ -741,13 +835,23 @@ extern "C" {
   void freeCloverQuda(void);
 
   /**
-   * Perform the solve, according to the parameters set in param.  It
-   * is assumed that the gauge field has already been loaded via
-   * loadGaugeQuda().
-   * @param h_x    Solution spinor field
-   * @param h_b    Source spinor field
-   * @param param  Contains all metadata regarding host and device
-   *               storage and solver parameters
+   * Run the eigensolver selected by eig_param->eig_type.  It is
+   * assumed that the gauge field has already been loaded via
+   * loadGaugeQuda().  For QUDA_LANCZOS, m-k0 Lanczos steps are run
+   * from the k0-th basis vector and hp_alpha, hp_beta return the
+   * tridiagonal matrix.  For QUDA_IMP_RST_LANCZOS, the thick-restart
+   * Lanczos solver computes the eig_param->nk lowest eigenpairs on a
+   * basis of dimension m, returned in the first nk vectors of hp_V,
+   * with the eigenvalues in hp_alpha and the residual norms in hp_beta
+   * (the first k0 vectors of hp_V are taken to be converged already).
+   * @param k0       Starting index / number of converged vectors
+   * @param m        Dimension of the basis hp_V
+   * @param hp_Apsi  Work spinor field
+   * @param hp_r     Starting vector
+   * @param hp_V     Array of m basis spinor fields
+   * @param hp_alpha Array of m doubles
+   * @param hp_beta  Array of m doubles
+   * @param eig_param  Contains all metadata regarding the eigensolver
    */
   void lanczosQuda(int k0, int m, void *hp_Apsi, void *hp_r, void *hp_V,
                    void *hp_alpha, void *hp_beta, QudaEigParam *eig_param);
@@ -774,9 +878,31 @@ extern "C" {
    */
   void invertMultiSrcQuda(void **_hp_x, void **_hp_b, QudaInvertParam *param);
 
+  /**
+   * Solve for both flavors of a twisted-mass operator, mu and -mu,
+   * on the same source.  An unpreconditioned normal-error solve
+   * (QUDA_NORMERR_SOLVE with QUDA_MAT_SOLUTION) obtains both from a
+   * single Krylov sequence, since M(mu) M(mu)^dag = M(-mu) M(-mu)^dag.
+   * Otherwise the flavors are solved in turn, sharing no dslash
+   * applications, and a multigrid preconditioner built for mu has its
+   * coarse operators flipped to -mu in place rather than being set up
+   * again.
+   *
+   * @param h_x_plus   Solution spinor field for mu = param->mu
+   * @param h_x_minus  Solution spinor field for -param->mu
+   * @param h_b        Source spinor field
+   * @param param      Contains all metadata regarding host and device
+   *                   storage and solver parameters (param->iter is the total
+   *                   over both flavors)
+   */
+  void invertTwistedPairQuda(void *h_x_plus, void *h_x_minus, void *h_b, QudaInvertParam *param);
+
 
   /**
-   * Solve for multiple shifts (e.g., masses).
+   * Solve for multiple shifts (e.g., masses).  For Wilson-type
+   * fermions, inv_type = QUDA_BICGSTAB_INVERTER with a direct solve
+   * type solves (M + offset) x = b with multi-shift BiCGstab; otherwise
+   * multi-shift CG is used on the normal operator.
    * @param _hp_x    Array of solution spinor fields
    * @param _hp_b    Source spinor fields
    * @param param  Contains all metadata regarding host and device
@@ -800,7 +926,10 @@ extern "C" {
   void destroyMultigridQuda(void *mg_instance);
 
   /**
-   * @brief Updates the multigrid preconditioner for the new gauge / clover field
+   * @brief Updates the multigrid preconditioner for the new gauge / clover field.
+   * The null-space vectors are relaxed with setup_maxiter_refresh
+   * iterations and, if setup_refresh_tol is set, the prolongator of a
+   * level is only rebuilt if they have left its span.
    * @param mg_instance Pointer to instance of multigrid_solver
    */
   void updateMultigridQuda(void *mg_instance, QudaMultigridParam *param);
@@ -1155,6 +1284,12 @@ extern "C" {
    */
   void flushChronoQuda(int index);
 
+  /**
+   * @brief Release the subspaces recycled across solves by the
+   * GCRO-DR solver, e.g., before moving on to a new configuration
+   */
+  void flushRecycleQuda(void);
+
 
   /**
   * Open/Close MAGMA library
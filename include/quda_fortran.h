@@ -246,6 +246,11 @@ extern "C" {
    */
   void flush_chrono_quda_(int *index);
 
+  /**
+   * @brief Release the subspaces recycled across solves by GCRO-DR
+   */
+  void flush_recycle_quda_();
+
   /**
    * @brief Pinned a pre-existing memory allocation
    * @param[in] ptr Pointer to buffer to be pinned
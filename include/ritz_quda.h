@@ -45,6 +45,11 @@ namespace quda {
 
     void operator()(cudaColorSpinorField &out, const cudaColorSpinorField &in) const;
 
+    /**
+       @return The operator the polynomial is built from
+    */
+    const DiracMatrix& Mat() const { return dirac_mat; }
+
     //    unsigned long long flops() const { return (dirac_mat->dirac)->Flops(); }
 
     //    std::string Type() const { return typeid(*(dirac_mat->dirac)).name(); }
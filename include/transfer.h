@@ -164,9 +164,12 @@ namespace quda {
      * @param null_precision The precision to store the null-space basis vectors in
      * @param enable_gpu Whether to enable this to run on GPU (as well as CPU)
      * @param gpu_setup Whether to do the block-orthogonalization on the GPU
+     * @param orthogonalize Whether to block-orthogonalize B to form
+     * the prolongator now; when false the prolongator is left
+     * uninitialized to be restored through HostVectors()
      */
     Transfer(const std::vector<ColorSpinorField*> &B, int Nvec, int *geo_bs, int spin_bs,
-	     QudaPrecision null_precision, TimeProfile &profile);
+	     QudaPrecision null_precision, TimeProfile &profile, bool orthogonalize=true);
 
     /** The destructor for Transfer */
     virtual ~Transfer();
@@ -211,6 +214,20 @@ namespace quda {
       }
     }
 
+    /**
+     * @brief Returns the host copy of the prolongator, creating it
+     * from the device copy if needed.  If it is modified, e.g., when
+     * restored from a checkpoint, updateVectors() must be called
+     * afterwards.
+     * @return The host V field reference
+     */
+    ColorSpinorField& HostVectors() const;
+
+    /**
+     * @brief Propagate the host copy of the prolongator to the device
+     */
+    void updateVectors() const;
+
     /**
      * Returns the number of near nullvectors
      * @return Nvec
@@ -0,0 +1,360 @@
+#include <string.h>
+#include <agglomerate.h>
+
+namespace quda {
+
+  // lexicographic rank of a master on the process grid of the masters
+  static int groupRank(const int *coords, void *fdata)
+  {
+    const int *dims = static_cast<const int*>(fdata);
+    int rank = coords[3];
+    for (int d=2; d>=0; d--) rank = rank * dims[d] + coords[d];
+    return rank;
+  }
+
+  // step through the lexicographic coordinates of a block, x[0] running fastest
+  static bool advanceCoords(int *x, const int *dims)
+  {
+    for (int d=0; d<4; d++) {
+      if (++x[d] < dims[d]) return true;
+      x[d] = 0;
+    }
+    return false;
+  }
+
+  static int smallestFactor(int n)
+  {
+    for (int p=2; p*p<=n; p++) if (n % p == 0) return p;
+    return n;
+  }
+
+  Agglomerate::Agglomerate(const DiracCoarse &dirac, const ColorSpinorField &meta, int min_volume,
+                           SolverParam &param, bool matpc, const char *prefix_, TimeProfile &profile)
+    : dirac(dirac), profile(profile), param(param), matpc(matpc), nDim(meta.Ndim()), active(false),
+      master(true), master_rank(comm_rank()), group(nullptr),
+      Y_h(nullptr), X_h(nullptr), Xinv_h(nullptr), Yhat_h(nullptr),
+      dirac_agg(nullptr), dirac_solve(nullptr), mat(nullptr), solver_param(nullptr), solver(nullptr),
+      x_agg(nullptr), b_agg(nullptr), x_h(nullptr), b_h(nullptr)
+  {
+    if (nDim != 4) errorQuda("Agglomeration not supported for %d dimensions", nDim);
+    if (meta.SiteSubset() != QUDA_FULL_SITE_SUBSET) errorQuda("Agglomeration requires full fields");
+    strncpy(prefix, prefix_, sizeof(prefix)-1);
+    prefix[sizeof(prefix)-1] = '\0';
+
+    int volume = 1;
+    for (int d=0; d<QUDA_MAX_DIM; d++) {
+      X[d] = d < nDim ? meta.X(d) : 1;
+      agg[d] = 1;
+      volume *= X[d];
+    }
+
+    // grow the blocks along the shortest agglomerated extent until the volume is large enough
+    while (volume < min_volume) {
+      int dim = -1;
+      for (int d=0; d<nDim; d++) {
+	if (comm_dim(d) / agg[d] == 1) continue;
+	if (dim < 0 || X[d]*agg[d] < X[dim]*agg[dim]) dim = d;
+      }
+      if (dim < 0) break;
+      const int factor = smallestFactor(comm_dim(dim) / agg[dim]);
+      agg[dim] *= factor;
+      volume *= factor;
+    }
+
+    for (int d=0; d<nDim; d++) if (agg[d] > 1) active = true;
+    if (!active) return;
+
+    Topology *topo = comm_default_topology();
+    int coords[QUDA_MAX_DIM] = { };
+    int master_coords[QUDA_MAX_DIM] = { };
+    int group_coords[QUDA_MAX_DIM] = { };
+    int aggX[QUDA_MAX_DIM];
+    for (int d=0; d<QUDA_MAX_DIM; d++) {
+      coords[d] = d < nDim ? comm_coord(d) : 0;
+      group_dims[d] = d < nDim ? comm_dim(d) / agg[d] : 1;
+      group_coords[d] = coords[d] / agg[d];
+      master_coords[d] = group_coords[d] * agg[d];
+      if (coords[d] != master_coords[d]) master = false;
+      aggX[d] = X[d] * agg[d];
+    }
+    master_rank = comm_rank_from_coords(topo, master_coords);
+
+    if (master) {
+      // the processes of the block, starting with this one
+      int o[4] = { };
+      do {
+	int c[QUDA_MAX_DIM] = { };
+	std::vector<int> offset(4);
+	for (int d=0; d<4; d++) {
+	  c[d] = coords[d] + o[d];
+	  offset[d] = o[d] * X[d];
+	}
+	member_rank.push_back(comm_rank_from_coords(topo, c));
+	member_offset.push_back(offset);
+      } while (advanceCoords(o, agg));
+    }
+
+    group = comm_group_create(master, groupRank(group_coords, group_dims), 4, group_dims, groupRank, group_dims);
+
+    if (getVerbosity() >= QUDA_SUMMARIZE)
+      printfQuda("Agglomerating the coarse solve by %dx%dx%dx%d onto %d processes with local volume %dx%dx%dx%d\n",
+		 agg[0], agg[1], agg[2], agg[3], group_dims[0]*group_dims[1]*group_dims[2]*group_dims[3],
+		 aggX[0], aggX[1], aggX[2], aggX[3]);
+
+    cpuGaugeField *Y, *X_, *Xinv, *Yhat;
+    dirac.HostFields(Y, X_, Xinv, Yhat);
+    // the solve is done in the precision of the host links, or in single for fixed-point links
+    const QudaPrecision precision = Y->Precision() < QUDA_SINGLE_PRECISION ? QUDA_SINGLE_PRECISION : Y->Precision();
+
+    ColorSpinorParam csParam(meta);
+    csParam.location = QUDA_CPU_FIELD_LOCATION;
+    csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+    csParam.create = QUDA_ZERO_FIELD_CREATE;
+    csParam.setPrecision(precision);
+    x_h = ColorSpinorField::Create(csParam);
+    b_h = ColorSpinorField::Create(csParam);
+
+    if (master) {
+      // everything on the agglomerated lattice lives on the process grid of the masters
+      comm_group_push(group);
+
+      auto aggLinks = [&](const cpuGaugeField &local) {
+	GaugeFieldParam gParam(local);
+	gParam.create = QUDA_ZERO_FIELD_CREATE;
+	for (int d=0; d<nDim; d++) gParam.x[d] = aggX[d];
+	return new cpuGaugeField(gParam);
+      };
+      Y_h = aggLinks(*Y);
+      X_h = aggLinks(*X_);
+      Xinv_h = aggLinks(*Xinv);
+      Yhat_h = aggLinks(*Yhat);
+
+      DiracParam diracParam;
+      diracParam.type = QUDA_COARSE_DIRAC;
+      diracParam.kappa = dirac.Kappa();
+      diracParam.mu = dirac.Mu();
+      diracParam.mu_factor = dirac.MuFactor();
+      diracParam.matpcType = dirac.getMatPCType();
+      diracParam.dagger = QUDA_DAG_NO;
+      diracParam.halo_precision = precision;
+      dirac_agg = new DiracCoarse(diracParam, Y_h, X_h, Xinv_h, Yhat_h);
+
+      if (matpc) {
+	diracParam.type = QUDA_COARSEPC_DIRAC;
+	dirac_solve = new DiracCoarsePC(*dirac_agg, diracParam);
+      } else {
+	dirac_solve = new DiracCoarse(*dirac_agg, diracParam);
+      }
+      mat = new DiracM(*dirac_solve);
+
+      for (int d=0; d<nDim; d++) csParam.x[d] = aggX[d];
+      x_agg = ColorSpinorField::Create(csParam);
+      b_agg = ColorSpinorField::Create(csParam);
+
+      // the coarse-grid preconditioner is distributed, so the agglomerated solve goes without
+      solver_param = new SolverParam(param);
+      solver_param->inv_type_precondition = QUDA_INVALID_INVERTER;
+      solver_param->preconditioner = nullptr;
+      solver_param->precision = precision;
+      solver_param->precision_sloppy = precision;
+      solver_param->precision_precondition = precision;
+
+      Solver *s = Solver::create(*solver_param, *mat, *mat, *mat, profile);
+      solver = new PreconditionedSolver(*s, *dirac_solve, *solver_param, profile, prefix);
+
+      comm_group_pop();
+    }
+
+    gatherLinks();
+  }
+
+  Agglomerate::~Agglomerate()
+  {
+    if (master && active) {
+      comm_group_push(group);
+      if (solver) delete solver;
+      if (solver_param) delete solver_param;
+      if (mat) delete mat;
+      if (dirac_solve) delete dirac_solve;
+      if (dirac_agg) delete dirac_agg;
+      if (x_agg) delete x_agg;
+      if (b_agg) delete b_agg;
+      if (Y_h) delete Y_h;
+      if (X_h) delete X_h;
+      if (Xinv_h) delete Xinv_h;
+      if (Yhat_h) delete Yhat_h;
+      comm_group_pop();
+    }
+    if (x_h) delete x_h;
+    if (b_h) delete b_h;
+    comm_group_destroy(group);
+  }
+
+  void Agglomerate::copyBlock(char *agg_ptr, char *local_ptr, const int *offset, size_t site_bytes, bool to_agg) const
+  {
+    int aggX[4];
+    for (int d=0; d<4; d++) aggX[d] = X[d] * agg[d];
+    const size_t volumeCB = (size_t)X[0]*X[1]*X[2]*X[3] / 2;
+    const size_t aggVolumeCB = (size_t)aggX[0]*aggX[1]*aggX[2]*aggX[3] / 2;
+
+    for (size_t l=0; l<2*volumeCB; l++) {
+      int x[4], y[4];
+      size_t r = l;
+      for (int d=0; d<4; d++) {
+	x[d] = r % X[d];
+	r /= X[d];
+	y[d] = x[d] + offset[d];
+      }
+      const int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+      const int agg_parity = (y[0] + y[1] + y[2] + y[3]) & 1;
+      const size_t m = ((((size_t)y[3]*aggX[2] + y[2])*aggX[1] + y[1])*aggX[0] + y[0]);
+
+      char *a = agg_ptr + (agg_parity*aggVolumeCB + m/2)*site_bytes;
+      char *b = local_ptr + (parity*volumeCB + l/2)*site_bytes;
+      if (to_agg) memcpy(a, b, site_bytes);
+      else memcpy(b, a, site_bytes);
+    }
+  }
+
+  void Agglomerate::exchange(void * const *local, void * const *agglomerated, int n, size_t site_bytes, bool gather) const
+  {
+    const size_t bytes = (size_t)X[0]*X[1]*X[2]*X[3]*site_bytes;
+
+    if (!master) {
+      std::vector<MsgHandle*> mh(n);
+      for (int i=0; i<n; i++) {
+	mh[i] = gather ? comm_declare_send_rank(local[i], master_rank, i, bytes) :
+	  comm_declare_receive_rank(local[i], master_rank, i, bytes);
+	comm_start(mh[i]);
+      }
+      for (int i=0; i<n; i++) {
+	comm_wait(mh[i]);
+	comm_free(mh[i]);
+      }
+      return;
+    }
+
+    // staging buffers for the other processes of the block
+    const int n_member = member_rank.size();
+    char *buffer = static_cast<char*>(safe_malloc((n_member-1)*n*bytes));
+    auto staging = [&](int m, int i) { return buffer + ((size_t)(m-1)*n + i)*bytes; };
+
+    if (!gather) {
+      for (int m=1; m<n_member; m++)
+	for (int i=0; i<n; i++) copyBlock(static_cast<char*>(agglomerated[i]), staging(m,i), member_offset[m].data(), site_bytes, false);
+    }
+
+    std::vector<MsgHandle*> mh;
+    for (int m=1; m<n_member; m++) {
+      for (int i=0; i<n; i++) {
+	mh.push_back(gather ? comm_declare_receive_rank(staging(m,i), member_rank[m], i, bytes) :
+		     comm_declare_send_rank(staging(m,i), member_rank[m], i, bytes));
+	comm_start(mh.back());
+      }
+    }
+
+    // the block of this process is copied while the messages are in flight
+    for (int i=0; i<n; i++)
+      copyBlock(static_cast<char*>(agglomerated[i]), static_cast<char*>(local[i]), member_offset[0].data(), site_bytes, gather);
+
+    for (auto &h : mh) {
+      comm_wait(h);
+      comm_free(h);
+    }
+
+    if (gather) {
+      for (int m=1; m<n_member; m++)
+	for (int i=0; i<n; i++) copyBlock(static_cast<char*>(agglomerated[i]), staging(m,i), member_offset[m].data(), site_bytes, true);
+    }
+
+    host_free(buffer);
+  }
+
+  void Agglomerate::gatherLinks()
+  {
+    if (!active) return;
+
+    cpuGaugeField *Y, *X_, *Xinv, *Yhat;
+    dirac.HostFields(Y, X_, Xinv, Yhat);
+
+    // only the bulk is gathered, the halos are exchanged on the agglomerated lattice
+    auto gather = [&](cpuGaugeField *local, cpuGaugeField *agglomerated) {
+      const int n = local->Geometry();
+      const size_t site_bytes = 2 * local->Ncolor() * local->Ncolor() * local->Precision();
+      exchange(static_cast<void**>(local->Gauge_p()), master ? static_cast<void**>(agglomerated->Gauge_p()) : nullptr,
+	       n, site_bytes, true);
+
+      // fixed-point links also carry one scale per matrix row, stored site-major per dimension like the links
+      if (local->RowScaled()) {
+	const size_t row_bytes = local->Ncolor() * sizeof(float);
+	std::vector<void*> local_max(n), agglomerated_max(n);
+	for (int d=0; d<n; d++) {
+	  local_max[d] = static_cast<float*>(local->RowMax_p()) + (size_t)d * local->Volume() * local->Ncolor();
+	  if (master) agglomerated_max[d] = static_cast<float*>(agglomerated->RowMax_p()) + (size_t)d * agglomerated->Volume() * agglomerated->Ncolor();
+	}
+	exchange(local_max.data(), master ? agglomerated_max.data() : nullptr, n, row_bytes, true);
+      }
+    };
+    gather(Y, Y_h);
+    gather(X_, X_h);
+    gather(Xinv, Xinv_h);
+    gather(Yhat, Yhat_h);
+
+    if (master) {
+      comm_group_push(group);
+      dirac_agg->restoreCoarseOp();
+      comm_group_pop();
+    }
+  }
+
+  void Agglomerate::operator()(ColorSpinorField &x, ColorSpinorField &b)
+  {
+    const size_t site_bytes = 2 * b_h->Nspin() * b_h->Ncolor() * b_h->Precision();
+
+    *b_h = b;
+    void *b_local = b_h->V();
+    void *b_ = master ? b_agg->V() : nullptr;
+    exchange(&b_local, &b_, 1, site_bytes, true);
+
+    double stats[3] = { }; // iterations, Gflops and seconds of the agglomerated solve
+    if (master) {
+      comm_group_push(group);
+      const int iter0 = solver_param->iter;
+      const double gflops0 = solver_param->gflops;
+      const double secs0 = solver_param->secs;
+      (*solver)(*x_agg, *b_agg);
+      stats[0] = solver_param->iter - iter0;
+      stats[1] = solver_param->gflops - gflops0;
+      stats[2] = solver_param->secs - secs0;
+      comm_group_pop();
+    }
+
+    void *x_local = x_h->V();
+    void *x_ = master ? x_agg->V() : nullptr;
+    exchange(&x_local, &x_, 1, site_bytes, false);
+    x = *x_h;
+
+    // every process accounts for the agglomerated solve, which is the same on all masters
+    for (int i=0; i<3; i++) comm_allreduce_max(&stats[i]);
+    param.iter += static_cast<int>(stats[0]);
+    param.gflops += stats[1];
+    param.secs += stats[2];
+  }
+
+  void Agglomerate::flipMu()
+  {
+    if (!active) return;
+
+    // the distributed operator has already flipped its links
+    gatherLinks();
+
+    if (master) {
+      // the agglomerated operators do not own the gathered links, so this only flips mu
+      comm_group_push(group);
+      dirac_agg->flipMu();
+      dirac_solve->flipMu();
+      comm_group_pop();
+    }
+  }
+
+} // namespace quda
@@ -666,6 +666,28 @@ namespace quda {
                                            make_double2(0.0, 0.0), x, y, z, z);
     }
 
+    /**
+       void pipeCGUpdate(d a, d b, V x, V y, V z, V w){}
+       First performs the operation y[i] = x[i] + b*y[i]
+       Second performs the operation w[i] = z[i] + b*w[i]
+       Third performs the operation z[i] = z[i] - a*y[i]
+    */
+    template <typename Float2, typename FloatN>
+    struct pipeCGUpdate_ : public BlasFunctor<Float2,FloatN> {
+      Float2 a, b;
+      pipeCGUpdate_(const Float2 &a, const Float2 &b, const Float2 &c) : a(a), b(b) { ; }
+      __device__ __host__ void operator()(FloatN &x, FloatN &y, FloatN &z, FloatN &w)
+      { y = x + b.x*y; w = z + b.x*w; z -= a.x*y; }
+      static int streams() { return 7; } //! total number of input and output streams
+      static int flops() { return 6; } //! flops per element
+    };
+
+    void pipeCGUpdate(double a, double b, ColorSpinorField &x, ColorSpinorField &y,
+		      ColorSpinorField &z, ColorSpinorField &w) {
+      blasCuda<pipeCGUpdate_,0,1,1,1>(make_double2(a, 0.0), make_double2(b, 0.0),
+				      make_double2(0.0, 0.0), x, y, z, w);
+    }
+
   } // namespace blas
 
 } // namespace quda
@@ -155,6 +155,7 @@ void printQudaEigParam(QudaEigParam *param) {
   P(np, 0);
   P(f_size, 0);
   P(eigen_shift, 0.0);
+  P(max_restarts, 100);
   P(extlib_type, QUDA_EIGEN_EXTLIB);
   P(mem_type_ritz, QUDA_MEMORY_DEVICE);
 #else
@@ -164,6 +165,7 @@ void printQudaEigParam(QudaEigParam *param) {
   P(np, INVALID_INT);
   P(f_size, INVALID_INT);
   P(eigen_shift, INVALID_DOUBLE);
+  P(max_restarts, INVALID_INT);
   P(extlib_type, QUDA_EXTLIB_INVALID);
   P(mem_type_ritz, QUDA_MEMORY_INVALID);
 #endif
@@ -174,6 +176,12 @@ void printQudaEigParam(QudaEigParam *param) {
   P(location, QUDA_INVALID_FIELD_LOCATION);
 #endif
 
+#if defined INIT_PARAM
+  P(vec_store, QUDA_BOOLEAN_NO);
+#else
+  P(vec_store, QUDA_BOOLEAN_INVALID);
+#endif
+
 #ifdef INIT_PARAM
   return ret;
 #endif
@@ -362,6 +370,21 @@ void printQudaInvertParam(QudaInvertParam *param) {
   }
 #endif
 
+#if defined INIT_PARAM
+  P(ca_basis, QUDA_POWER_BASIS);
+  P(ca_lambda_min, 0.0);
+  P(ca_lambda_max, -1.0); // estimate the spectral bounds
+#else
+  if (param->inv_type == QUDA_CA_CG_INVERTER) {
+    P(gcrNkrylov, INVALID_INT);
+    P(ca_basis, QUDA_INVALID_BASIS);
+    if (param->ca_basis == QUDA_CHEBYSHEV_BASIS) {
+      P(ca_lambda_min, INVALID_DOUBLE);
+      P(ca_lambda_max, INVALID_DOUBLE);
+    }
+  }
+#endif
+
   // domain decomposition parameters
   //P(inv_type_sloppy, QUDA_INVALID_INVERTER); // disable since invalid means no preconditioner
 #if defined INIT_PARAM
@@ -511,6 +534,24 @@ void printQudaInvertParam(QudaInvertParam *param) {
   if (param->chrono_precision == QUDA_INVALID_PRECISION) param->chrono_precision = param->cuda_prec;
 #endif
 
+#if defined INIT_PARAM
+  P(chrono_compress, 0);
+  P(chrono_extrapolation, QUDA_CHRONO_MINRES_EXTRAPOLATION);
+#else
+  P(chrono_compress, INVALID_INT);
+  P(chrono_extrapolation, QUDA_CHRONO_INVALID_EXTRAPOLATION);
+#endif
+
+#if defined INIT_PARAM
+  P(cuda_prec_adaptive, QUDA_INVALID_PRECISION);
+#elif defined CHECK_PARAM
+  // adaptive precision is optional: a zero-initialized parameter
+  // disables it, the same as QUDA_INVALID_PRECISION
+  if (param->cuda_prec_adaptive == 0) param->cuda_prec_adaptive = QUDA_INVALID_PRECISION;
+#else
+  P(cuda_prec_adaptive, QUDA_INVALID_PRECISION);
+#endif
+
 #if defined INIT_PARAM
   P(extlib_type, QUDA_EIGEN_EXTLIB);
 #else
@@ -587,14 +628,23 @@ void printQudaMultigridParam(QudaMultigridParam *param) {
     P(setup_tol[i], 5e-6);
     P(setup_maxiter[i], 500);
     P(setup_maxiter_refresh[i], 0);
+    P(setup_refresh_tol[i], 0.0);
 #else
     P(setup_tol[i], INVALID_DOUBLE);
     P(setup_maxiter[i], INVALID_INT);
     P(setup_maxiter_refresh[i], INVALID_INT);
+    P(setup_refresh_tol[i], INVALID_DOUBLE);
 #endif
 
     P(coarse_solver[i], QUDA_INVALID_INVERTER);
     P(coarse_solver_maxiter[i], INVALID_INT);
+#ifdef INIT_PARAM
+    P(coarse_solver_deflate_nvec[i], 0);
+    P(coarse_solver_agglomerate_volume[i], 0);
+#else
+    P(coarse_solver_deflate_nvec[i], INVALID_INT);
+    P(coarse_solver_agglomerate_volume[i], INVALID_INT);
+#endif
     P(smoother[i], QUDA_INVALID_INVERTER);
     P(smoother_solve_type[i], QUDA_INVALID_SOLVE);
 
@@ -602,8 +652,10 @@ void printQudaMultigridParam(QudaMultigridParam *param) {
     P(smoother_halo_precision[i], QUDA_INVALID_PRECISION);
     P(smoother_schwarz_type[i], QUDA_INVALID_SCHWARZ);
     P(smoother_schwarz_cycle[i], 1);
+    P(smoother_schwarz_overlap[i], 0);
 #else
     P(smoother_schwarz_cycle[i], INVALID_INT);
+    P(smoother_schwarz_overlap[i], INVALID_INT);
 #endif
 
     // these parameters are not set for the bottom grid
@@ -615,6 +667,19 @@ void printQudaMultigridParam(QudaMultigridParam *param) {
       P(precision_null[i], QUDA_SINGLE_PRECISION);
 #else
       P(precision_null[i], INVALID_INT);
+#endif
+#ifndef CHECK_PARAM
+      P(precision_coarse_link[i], QUDA_INVALID_PRECISION);
+#endif
+#ifdef INIT_PARAM
+      P(setup_adaptive_nvec[i], QUDA_BOOLEAN_NO);
+#else
+      P(setup_adaptive_nvec[i], QUDA_BOOLEAN_INVALID);
+#endif
+#ifdef INIT_PARAM
+      P(verify_n_evec[i], 0);
+#else
+      P(verify_n_evec[i], INVALID_INT);
 #endif
       P(cycle_type[i], QUDA_MG_CYCLE_INVALID);
       P(nu_pre[i], INVALID_INT);
@@ -662,11 +727,26 @@ void printQudaMultigridParam(QudaMultigridParam *param) {
       if (param->n_vec[0] != param->n_vec[i])
 	errorQuda("n_vec %d != %d must be equal on all levels if generate_all_levels == false",
 		  param->n_vec[0], param->n_vec[i]);
+    for (int i=0; i<n_level-1; i++)
+      if (param->setup_adaptive_nvec[i] == QUDA_BOOLEAN_YES)
+	errorQuda("Adaptive n_vec on level %d requires generate_all_levels == true", i);
   }
 #endif
 
   P(run_verify, QUDA_BOOLEAN_INVALID);
 
+#ifdef INIT_PARAM
+  P(vec_compact, QUDA_BOOLEAN_NO);
+#else
+  P(vec_compact, QUDA_BOOLEAN_INVALID);
+#endif
+
+#ifdef INIT_PARAM
+  ret.setup_checkpoint[0] = '\0'; // no setup checkpointing by default
+#elif defined(PRINT_PARAM)
+  printfQuda("setup_checkpoint = %s\n", param->setup_checkpoint);
+#endif
+
 #ifdef INIT_PARAM
   P(gflops, 0.0);
   P(secs, 0.0);
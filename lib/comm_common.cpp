@@ -1,5 +1,6 @@
 #include <unistd.h> // for gethostname()
 #include <assert.h>
+#include <chrono>
 
 #include <quda_internal.h>
 #include <comm_quda.h>
@@ -365,9 +366,12 @@ int comm_rank_displaced(const Topology *topo, const int displacement[])
 
 Topology *default_topo = NULL;
 
+static bool neighbors_cached = false;
+
 void comm_set_default_topology(Topology *topo)
 {
   default_topo = topo;
+  neighbors_cached = false; // the neighbors are those of the new topology
 }
 
 
@@ -382,8 +386,6 @@ Topology *comm_default_topology(void)
 static int neighbor_rank[2][4] = { {-1,-1,-1,-1},
                                           {-1,-1,-1,-1} };
 
-static bool neighbors_cached = false;
-
 void comm_set_neighbor_ranks(Topology *topo){
 
   if(neighbors_cached) return;
@@ -673,12 +675,77 @@ bool comm_gdr_blacklist() {
 static bool globalReduce = true;
 static bool asyncReduce = false;
 
-void reduceMaxDouble(double &max) { comm_allreduce_max(&max); }
+/**
+   Artificial latency added to each global reduction, set in
+   microseconds with QUDA_REDUCTION_LATENCY
+ */
+static double reduction_latency()
+{
+  static double latency = -1.0;
+  if (latency < 0.0) {
+    char *latency_env = getenv("QUDA_REDUCTION_LATENCY");
+    latency = latency_env ? 1e-6 * atof(latency_env) : 0.0;
+    if (latency < 0.0) errorQuda("Invalid QUDA_REDUCTION_LATENCY=%s", latency_env);
+    if (latency > 0.0 && getVerbosity() > QUDA_SILENT)
+      printfQuda("Adding %g us of latency to global reductions\n", 1e6 * latency);
+  }
+  return latency;
+}
+
+static double reduction_clock()
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// spin until the artificial latency of a reduction started at start has elapsed
+static void reduction_delay(double start)
+{
+  const double latency = reduction_latency();
+  if (latency > 0.0) while (reduction_clock() - start < latency) { }
+}
+
+struct ReduceHandle_s {
+  MsgHandle *mh; // handle of the underlying reduction
+  bool global;   // whether this is a global reduction
+  double start;  // time at which the reduction was started
+};
 
-void reduceDouble(double &sum) { if (globalReduce) comm_allreduce(&sum); }
+void reduceMaxDouble(double &max) {
+  double start = reduction_clock();
+  comm_allreduce_max(&max);
+  reduction_delay(start);
+}
+
+void reduceDouble(double &sum) {
+  if (!globalReduce) return;
+  double start = reduction_clock();
+  comm_allreduce(&sum);
+  reduction_delay(start);
+}
 
 void reduceDoubleArray(double *sum, const int len)
-{ if (globalReduce) comm_allreduce_array(sum, len); }
+{
+  if (!globalReduce) return;
+  double start = reduction_clock();
+  comm_allreduce_array(sum, len);
+  reduction_delay(start);
+}
+
+ReduceHandle *reduceDoubleArrayStart(double *sum, const int len)
+{
+  ReduceHandle *handle = (ReduceHandle *)safe_malloc(sizeof(ReduceHandle));
+  handle->global = globalReduce;
+  handle->start = reduction_clock();
+  handle->mh = globalReduce ? comm_allreduce_array_async(sum, len) : NULL;
+  return handle;
+}
+
+void reduceDoubleArrayWait(ReduceHandle *handle)
+{
+  comm_allreduce_wait(handle->mh);
+  if (handle->global) reduction_delay(handle->start);
+  host_free(handle);
+}
 
 int commDim(int dir) { return comm_dim(dir); }
 
@@ -43,6 +43,27 @@ static int rank = -1;
 static int size = -1;
 static int gpuid = -1;
 
+/**
+   The communicator all messages and reductions go through: this is
+   MPI_COMM_WORLD unless a process group has been made active with
+   comm_group_push.
+ */
+static MPI_Comm active_comm = MPI_COMM_WORLD;
+
+struct CommGroup_s {
+  MPI_Comm comm;  // communicator of the group
+  int rank;       // rank of this process within the group
+  int size;       // number of processes in the group
+  Topology *topo; // process grid of the group
+};
+
+// state of the processes that were active before comm_group_push
+static bool group_active = false;
+static MPI_Comm saved_comm;
+static int saved_rank;
+static int saved_size;
+static Topology *saved_topo;
+
 static char partition_string[16];
 static char topology_string[16];
 
@@ -50,11 +71,11 @@ static char topology_string[16];
 void comm_gather_hostname(char *hostname_recv_buf) {
   // determine which GPU this rank will use
   char *hostname = comm_hostname();
-  MPI_CHECK( MPI_Allgather(hostname, 128, MPI_CHAR, hostname_recv_buf, 128, MPI_CHAR, MPI_COMM_WORLD) );
+  MPI_CHECK( MPI_Allgather(hostname, 128, MPI_CHAR, hostname_recv_buf, 128, MPI_CHAR, active_comm) );
 }
 
 void comm_gather_gpuid(int *gpuid_recv_buf) {
-  MPI_CHECK(MPI_Allgather(&gpuid, 1, MPI_INT, gpuid_recv_buf, 1, MPI_INT, MPI_COMM_WORLD));
+  MPI_CHECK(MPI_Allgather(&gpuid, 1, MPI_INT, gpuid_recv_buf, 1, MPI_INT, active_comm));
 }
 
 
@@ -67,8 +88,9 @@ void comm_init(int ndim, const int *dims, QudaCommsMap rank_from_coords, void *m
     errorQuda("MPI has not been initialized");
   }
 
-  MPI_CHECK( MPI_Comm_rank(MPI_COMM_WORLD, &rank) );
-  MPI_CHECK( MPI_Comm_size(MPI_COMM_WORLD, &size) );
+  active_comm = MPI_COMM_WORLD;
+  MPI_CHECK( MPI_Comm_rank(active_comm, &rank) );
+  MPI_CHECK( MPI_Comm_size(active_comm, &size) );
 
   int grid_size = 1;
   for (int i = 0; i < ndim; i++) {
@@ -161,7 +183,7 @@ MsgHandle *comm_declare_send_displaced(void *buffer, const int displacement[], s
   tag = tag >= 0 ? tag : 2*pow(4*max_displacement,ndim) + tag;
 
   MsgHandle *mh = (MsgHandle *)safe_malloc(sizeof(MsgHandle));
-  MPI_CHECK( MPI_Send_init(buffer, nbytes, MPI_BYTE, rank, tag, MPI_COMM_WORLD, &(mh->request)) );
+  MPI_CHECK( MPI_Send_init(buffer, nbytes, MPI_BYTE, rank, tag, active_comm, &(mh->request)) );
   mh->custom = false;
 
   return mh;
@@ -184,7 +206,7 @@ MsgHandle *comm_declare_receive_displaced(void *buffer, const int displacement[]
   tag = tag >= 0 ? tag : 2*pow(4*max_displacement,ndim) + tag;
 
   MsgHandle *mh = (MsgHandle *)safe_malloc(sizeof(MsgHandle));
-  MPI_CHECK( MPI_Recv_init(buffer, nbytes, MPI_BYTE, rank, tag, MPI_COMM_WORLD, &(mh->request)) );
+  MPI_CHECK( MPI_Recv_init(buffer, nbytes, MPI_BYTE, rank, tag, active_comm, &(mh->request)) );
   mh->custom = false;
 
   return mh;
@@ -214,7 +236,7 @@ MsgHandle *comm_declare_strided_send_displaced(void *buffer, const int displacem
   MPI_CHECK( MPI_Type_commit(&(mh->datatype)) );
   mh->custom = true;
 
-  MPI_CHECK( MPI_Send_init(buffer, 1, mh->datatype, rank, tag, MPI_COMM_WORLD, &(mh->request)) );
+  MPI_CHECK( MPI_Send_init(buffer, 1, mh->datatype, rank, tag, active_comm, &(mh->request)) );
 
   return mh;
 }
@@ -243,7 +265,33 @@ MsgHandle *comm_declare_strided_receive_displaced(void *buffer, const int displa
   MPI_CHECK( MPI_Type_commit(&(mh->datatype)) );
   mh->custom = true;
 
-  MPI_CHECK( MPI_Recv_init(buffer, 1, mh->datatype, rank, tag, MPI_COMM_WORLD, &(mh->request)) );
+  MPI_CHECK( MPI_Recv_init(buffer, 1, mh->datatype, rank, tag, active_comm, &(mh->request)) );
+
+  return mh;
+}
+
+
+/**
+ * Declare a message handle for sending to the process with a given rank
+ */
+MsgHandle *comm_declare_send_rank(void *buffer, int rank, int tag, size_t nbytes)
+{
+  MsgHandle *mh = (MsgHandle *)safe_malloc(sizeof(MsgHandle));
+  MPI_CHECK( MPI_Send_init(buffer, nbytes, MPI_BYTE, rank, tag, active_comm, &(mh->request)) );
+  mh->custom = false;
+
+  return mh;
+}
+
+
+/**
+ * Declare a message handle for receiving from the process with a given rank
+ */
+MsgHandle *comm_declare_receive_rank(void *buffer, int rank, int tag, size_t nbytes)
+{
+  MsgHandle *mh = (MsgHandle *)safe_malloc(sizeof(MsgHandle));
+  MPI_CHECK( MPI_Recv_init(buffer, nbytes, MPI_BYTE, rank, tag, active_comm, &(mh->request)) );
+  mh->custom = false;
 
   return mh;
 }
@@ -281,7 +329,7 @@ int comm_query(MsgHandle *mh)
 void comm_allreduce(double* data)
 {
   double recvbuf;
-  MPI_CHECK( MPI_Allreduce(data, &recvbuf, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD) );
+  MPI_CHECK( MPI_Allreduce(data, &recvbuf, 1, MPI_DOUBLE, MPI_SUM, active_comm) );
   *data = recvbuf;
 }
 
@@ -289,30 +337,50 @@ void comm_allreduce(double* data)
 void comm_allreduce_max(double* data)
 {
   double recvbuf;
-  MPI_CHECK( MPI_Allreduce(data, &recvbuf, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD) );
+  MPI_CHECK( MPI_Allreduce(data, &recvbuf, 1, MPI_DOUBLE, MPI_MAX, active_comm) );
   *data = recvbuf;
 }
 
 void comm_allreduce_min(double* data)
 {
   double recvbuf;
-  MPI_CHECK( MPI_Allreduce(data, &recvbuf, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD) );
+  MPI_CHECK( MPI_Allreduce(data, &recvbuf, 1, MPI_DOUBLE, MPI_MIN, active_comm) );
   *data = recvbuf;
 }
 
 void comm_allreduce_array(double* data, size_t size)
 {
   double *recvbuf = new double[size];
-  MPI_CHECK( MPI_Allreduce(data, recvbuf, size, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD) );
+  MPI_CHECK( MPI_Allreduce(data, recvbuf, size, MPI_DOUBLE, MPI_SUM, active_comm) );
   memcpy(data, recvbuf, size*sizeof(double));
   delete []recvbuf;
 }
 
+MsgHandle *comm_allreduce_array_async(double* data, size_t size)
+{
+#if MPI_VERSION >= 3
+  MsgHandle *mh = (MsgHandle *)safe_malloc(sizeof(MsgHandle));
+  MPI_CHECK( MPI_Iallreduce(MPI_IN_PLACE, data, size, MPI_DOUBLE, MPI_SUM, active_comm, &(mh->request)) );
+  mh->custom = false;
+  return mh;
+#else
+  comm_allreduce_array(data, size);
+  return NULL;
+#endif
+}
+
+void comm_allreduce_wait(MsgHandle *mh)
+{
+  if (!mh) return;
+  MPI_CHECK( MPI_Wait(&(mh->request), MPI_STATUS_IGNORE) );
+  host_free(mh);
+}
+
 
 void comm_allreduce_int(int* data)
 {
   int recvbuf;
-  MPI_CHECK( MPI_Allreduce(data, &recvbuf, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD) );
+  MPI_CHECK( MPI_Allreduce(data, &recvbuf, 1, MPI_INT, MPI_SUM, active_comm) );
   *data = recvbuf;
 }
 
@@ -320,7 +388,7 @@ void comm_allreduce_xor(uint64_t *data)
 {
   if (sizeof(uint64_t) != sizeof(unsigned long)) errorQuda("unsigned long is not 64-bit");
   uint64_t recvbuf;
-  MPI_CHECK( MPI_Allreduce(data, &recvbuf, 1, MPI_UNSIGNED_LONG, MPI_BXOR, MPI_COMM_WORLD) );
+  MPI_CHECK( MPI_Allreduce(data, &recvbuf, 1, MPI_UNSIGNED_LONG, MPI_BXOR, active_comm) );
   *data = recvbuf;
 }
 
@@ -328,13 +396,13 @@ void comm_allreduce_xor(uint64_t *data)
 /**  broadcast from rank 0 */
 void comm_broadcast(void *data, size_t nbytes)
 {
-  MPI_CHECK( MPI_Bcast(data, (int)nbytes, MPI_BYTE, 0, MPI_COMM_WORLD) );
+  MPI_CHECK( MPI_Bcast(data, (int)nbytes, MPI_BYTE, 0, active_comm) );
 }
 
 
 void comm_barrier(void)
 {
-  MPI_CHECK( MPI_Barrier(MPI_COMM_WORLD) );
+  MPI_CHECK( MPI_Barrier(active_comm) );
 }
 
 
@@ -346,6 +414,74 @@ void comm_abort(int status)
   MPI_Abort(MPI_COMM_WORLD, status) ;
 }
 
+CommGroup *comm_group_create(int join, int key, int ndim, const int *dims,
+                             QudaCommsMap rank_from_coords, void *map_data)
+{
+  if (group_active) errorQuda("Process groups cannot be nested");
+
+  MPI_Comm comm;
+  MPI_CHECK( MPI_Comm_split(active_comm, join ? 0 : MPI_UNDEFINED, key, &comm) );
+  if (!join) return NULL;
+
+  CommGroup *group = (CommGroup *)safe_malloc(sizeof(CommGroup));
+  group->comm = comm;
+  MPI_CHECK( MPI_Comm_rank(comm, &group->rank) );
+  MPI_CHECK( MPI_Comm_size(comm, &group->size) );
+
+  int grid_size = 1;
+  for (int i = 0; i < ndim; i++) grid_size *= dims[i];
+  if (grid_size != group->size) {
+    errorQuda("Process grid of the group does not match its number of processes (%d != %d)", grid_size, group->size);
+  }
+
+  // the topology is built from the rank within the group
+  int world_rank = rank;
+  rank = group->rank;
+  group->topo = comm_create_topology(ndim, dims, rank_from_coords, map_data);
+  rank = world_rank;
+
+  return group;
+}
+
+
+void comm_group_destroy(CommGroup *group)
+{
+  if (!group) return;
+  if (group_active) errorQuda("Cannot destroy a group while a group is active");
+  comm_destroy_topology(group->topo);
+  MPI_CHECK( MPI_Comm_free(&group->comm) );
+  host_free(group);
+}
+
+
+void comm_group_push(CommGroup *group)
+{
+  if (group_active) errorQuda("Process groups cannot be nested");
+
+  saved_comm = active_comm;
+  saved_rank = rank;
+  saved_size = size;
+  saved_topo = comm_default_topology();
+
+  active_comm = group->comm;
+  rank = group->rank;
+  size = group->size;
+  comm_set_default_topology(group->topo);
+  group_active = true;
+}
+
+
+void comm_group_pop(void)
+{
+  if (!group_active) errorQuda("No process group is active");
+
+  active_comm = saved_comm;
+  rank = saved_rank;
+  size = saved_size;
+  comm_set_default_topology(saved_topo);
+  group_active = false;
+}
+
 const char* comm_dim_partitioned_string() {
   return partition_string;
 }
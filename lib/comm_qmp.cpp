@@ -225,6 +225,38 @@ MsgHandle *comm_declare_strided_receive_displaced(void *buffer, const int displa
 }
 
 
+/**
+ * Declare a message handle for sending to the process with a given rank
+ */
+MsgHandle *comm_declare_send_rank(void *buffer, int rank, int tag, size_t nbytes)
+{
+  MsgHandle *mh = (MsgHandle *)safe_malloc(sizeof(MsgHandle));
+
+  mh->mem = QMP_declare_msgmem(buffer, nbytes);
+  if (mh->mem == NULL) errorQuda("Unable to allocate QMP message memory");
+
+  mh->handle = QMP_declare_send_to(mh->mem, rank, 0);
+  if (mh->handle == NULL) errorQuda("Unable to allocate QMP message handle");
+
+  return mh;
+}
+
+/**
+ * Declare a message handle for receiving from the process with a given rank
+ */
+MsgHandle *comm_declare_receive_rank(void *buffer, int rank, int tag, size_t nbytes)
+{
+  MsgHandle *mh = (MsgHandle *)safe_malloc(sizeof(MsgHandle));
+
+  mh->mem = QMP_declare_msgmem(buffer, nbytes);
+  if (mh->mem == NULL) errorQuda("Unable to allocate QMP message memory");
+
+  mh->handle = QMP_declare_receive_from(mh->mem, rank, 0);
+  if (mh->handle == NULL) errorQuda("Unable to allocate QMP message handle");
+
+  return mh;
+}
+
 void comm_free(MsgHandle *mh)
 {
   QMP_free_msghandle(mh->handle);
@@ -273,6 +305,15 @@ void comm_allreduce_array(double* data, size_t size)
   QMP_CHECK( QMP_sum_double_array(data, size) );
 }
 
+// QMP has no non-blocking reductions
+MsgHandle *comm_allreduce_array_async(double* data, size_t size)
+{
+  comm_allreduce_array(data, size);
+  return NULL;
+}
+
+void comm_allreduce_wait(MsgHandle *mh) {}
+
 
 void comm_allreduce_int(int* data)
 {
@@ -305,6 +346,28 @@ void comm_abort(int status)
   QMP_abort(status);
 }
 
+CommGroup *comm_group_create(int join, int key, int ndim, const int *dims,
+                             QudaCommsMap rank_from_coords, void *map_data)
+{
+  errorQuda("Process groups require the MPI communications backend");
+  return NULL;
+}
+
+void comm_group_destroy(CommGroup *group)
+{
+  if (group) errorQuda("Process groups require the MPI communications backend");
+}
+
+void comm_group_push(CommGroup *group)
+{
+  errorQuda("Process groups require the MPI communications backend");
+}
+
+void comm_group_pop(void)
+{
+  errorQuda("Process groups require the MPI communications backend");
+}
+
 const char* comm_dim_partitioned_string() {
   return partition_string;
 }
@@ -44,6 +44,12 @@ MsgHandle *comm_declare_strided_receive_displaced(void *buffer, const int displa
 						  size_t blksize, int nblocks, size_t stride)
 { return NULL; }
 
+MsgHandle *comm_declare_send_rank(void *buffer, int rank, int tag, size_t nbytes)
+{ return NULL; }
+
+MsgHandle *comm_declare_receive_rank(void *buffer, int rank, int tag, size_t nbytes)
+{ return NULL; }
+
 void comm_free(MsgHandle *mh) {}
 
 void comm_start(MsgHandle *mh) {}
@@ -60,6 +66,10 @@ void comm_allreduce_min(double* data) {}
 
 void comm_allreduce_array(double* data, size_t size) {}
 
+MsgHandle *comm_allreduce_array_async(double* data, size_t size) { return NULL; }
+
+void comm_allreduce_wait(MsgHandle *mh) {}
+
 void comm_allreduce_int(int* data) {}
 
 void comm_allreduce_xor(uint64_t *data) {}
@@ -75,6 +85,36 @@ void comm_abort(int status) {
   exit(status);
 }
 
+struct CommGroup_s {
+  Topology *topo;
+};
+
+static Topology *saved_topo = NULL;
+
+CommGroup *comm_group_create(int join, int key, int ndim, const int *dims,
+                             QudaCommsMap rank_from_coords, void *map_data)
+{
+  if (!join) return NULL;
+  CommGroup *group = (CommGroup *)malloc(sizeof(CommGroup));
+  group->topo = comm_create_topology(ndim, dims, rank_from_coords, map_data);
+  return group;
+}
+
+void comm_group_destroy(CommGroup *group) {
+  if (!group) return;
+  comm_destroy_topology(group->topo);
+  free(group);
+}
+
+void comm_group_push(CommGroup *group) {
+  saved_topo = comm_default_topology();
+  comm_set_default_topology(group->topo);
+}
+
+void comm_group_pop(void) {
+  comm_set_default_topology(saved_topo);
+}
+
 const char* comm_dim_partitioned_string() {
   return partition_string;
 }
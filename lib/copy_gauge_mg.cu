@@ -18,8 +18,9 @@ namespace quda {
       errorQuda("Reconstruct type %d not supported", out.Reconstruct());
 
 #ifdef FINE_GRAINED_ACCESS
-    if (out.Precision() == QUDA_HALF_PRECISION) {
-      if (in.Precision() == QUDA_HALF_PRECISION) {
+    // a row-scaled output takes its per-row scale from the copy itself
+    if ((out.Precision() == QUDA_HALF_PRECISION || out.Precision() == QUDA_QUARTER_PRECISION) && !out.RowScaled()) {
+      if (in.Precision() == out.Precision()) {
 	out.Scale(in.Scale());
       } else {
 	InOrder in_(const_cast<GaugeField&>(in));
@@ -147,7 +148,8 @@ namespace quda {
 			  void *Out, void *In, void **ghostOut, void **ghostIn, int type) {
 
 #ifndef FINE_GRAINED_ACCESS
-    if (out.Precision() == QUDA_HALF_PRECISION || in.Precision() == QUDA_HALF_PRECISION)
+    if (out.Precision() == QUDA_HALF_PRECISION || in.Precision() == QUDA_HALF_PRECISION ||
+        out.Precision() == QUDA_QUARTER_PRECISION || in.Precision() == QUDA_QUARTER_PRECISION)
       errorQuda("Precision format not supported");
 #endif
 
@@ -159,6 +161,8 @@ namespace quda {
 	copyGaugeMG(out, in, location, (double*)Out, (float*)In, (double**)ghostOut, (float**)ghostIn, type);
       } else if (in.Precision() == QUDA_HALF_PRECISION) {
 	copyGaugeMG(out, in, location, (double*)Out, (short*)In, (double**)ghostOut, (short**)ghostIn, type);
+      } else if (in.Precision() == QUDA_QUARTER_PRECISION) {
+	copyGaugeMG(out, in, location, (double*)Out, (char*)In, (double**)ghostOut, (char**)ghostIn, type);
       } else {
 	errorQuda("Precision %d not supported", in.Precision());
       }
@@ -176,6 +180,8 @@ namespace quda {
 	copyGaugeMG(out, in, location, (float*)Out, (float*)In, (float**)ghostOut, (float**)ghostIn, type);
       } else if (in.Precision() == QUDA_HALF_PRECISION) {
 	copyGaugeMG(out, in, location, (float*)Out, (short*)In, (float**)ghostOut, (short**)ghostIn, type);
+      } else if (in.Precision() == QUDA_QUARTER_PRECISION) {
+	copyGaugeMG(out, in, location, (float*)Out, (char*)In, (float**)ghostOut, (char**)ghostIn, type);
       } else {
 	errorQuda("Precision %d not supported", in.Precision());
       }
@@ -190,6 +196,24 @@ namespace quda {
 	copyGaugeMG(out, in, location, (short*)Out, (float*)In, (short**)ghostOut, (float**)ghostIn, type);
       } else if (in.Precision() == QUDA_HALF_PRECISION) {
 	copyGaugeMG(out, in, location, (short*)Out, (short*)In, (short**)ghostOut, (short**)ghostIn, type);
+      } else if (in.Precision() == QUDA_QUARTER_PRECISION) {
+	copyGaugeMG(out, in, location, (short*)Out, (char*)In, (short**)ghostOut, (char**)ghostIn, type);
+      } else {
+	errorQuda("Precision %d not supported", in.Precision());
+      }
+    } else if (out.Precision() == QUDA_QUARTER_PRECISION) {
+      if (in.Precision() == QUDA_DOUBLE_PRECISION) {
+#ifdef GPU_MULTIGRID_DOUBLE
+	copyGaugeMG(out, in, location, (char*)Out, (double*)In, (char**)ghostOut, (double**)ghostIn, type);
+#else
+	errorQuda("Double precision multigrid has not been enabled");
+#endif
+      } else if (in.Precision() == QUDA_SINGLE_PRECISION) {
+	copyGaugeMG(out, in, location, (char*)Out, (float*)In, (char**)ghostOut, (float**)ghostIn, type);
+      } else if (in.Precision() == QUDA_HALF_PRECISION) {
+	copyGaugeMG(out, in, location, (char*)Out, (short*)In, (char**)ghostOut, (short**)ghostIn, type);
+      } else if (in.Precision() == QUDA_QUARTER_PRECISION) {
+	copyGaugeMG(out, in, location, (char*)Out, (char*)In, (char**)ghostOut, (char**)ghostIn, type);
       } else {
 	errorQuda("Precision %d not supported", in.Precision());
       }
@@ -9,10 +9,11 @@ namespace quda {
   cpuGaugeField::cpuGaugeField(const GaugeFieldParam &param) :
     GaugeField(param)
   {
-    if (precision == QUDA_HALF_PRECISION) {
+    // fixed-point storage is only supported with per-row scaling
+    if (precision == QUDA_HALF_PRECISION && !row_scale) {
       errorQuda("CPU fields do not support half precision");
     }
-    if (precision == QUDA_QUARTER_PRECISION) {
+    if (precision == QUDA_QUARTER_PRECISION && !row_scale) {
       errorQuda("CPU fields do not support quarter precision");
     }
     if (pad != 0) {
@@ -76,12 +77,18 @@ namespace quda {
     } else {
       errorQuda("Unsupported gauge order type %d", order);
     }
+
+    if (row_scale) {
+      row_max_bytes = siteDim * volume * nColor * sizeof(float);
+      row_max = safe_malloc(row_max_bytes);
+      memset(row_max, 0, row_max_bytes);
+    }
   
     // no need to exchange data if this is a momentum field
     if (link_type != QUDA_ASQTAD_MOM_LINKS) {
       // Ghost zone is always 2-dimensional    
       for (int i=0; i<nDim; i++) {
-	size_t nbytes = nFace * surface[i] * nInternal * precision;
+	size_t nbytes = hostGhostBytes(i);
 	ghost[i] = nbytes ? safe_malloc(nbytes) : nullptr;
 	ghost[i+4] = (nbytes && geometry == QUDA_COARSE_GEOMETRY) ? safe_malloc(nbytes) : nullptr;
       }
@@ -123,6 +130,8 @@ namespace quda {
 	if (gauge) host_free(gauge);
       }
     }
+
+    if (row_max) host_free(row_max);
   
     if (link_type != QUDA_ASQTAD_MOM_LINKS) {
       for (int i=0; i<nDim; i++) {
@@ -143,8 +152,8 @@ namespace quda {
 
     void *send[2*QUDA_MAX_DIM];
     for (int d=0; d<nDim; d++) {
-      send[d] = safe_malloc(nFace*surface[d]*nInternal*precision);
-      if (geometry == QUDA_COARSE_GEOMETRY) send[d+4] = safe_malloc(nFace*surface[d]*nInternal*precision);
+      send[d] = safe_malloc(hostGhostBytes(d));
+      if (geometry == QUDA_COARSE_GEOMETRY) send[d+4] = safe_malloc(hostGhostBytes(d));
     }
 
     if (link_direction == QUDA_LINK_BACKWARDS || link_direction == QUDA_LINK_BIDIRECTIONAL) {
@@ -175,7 +184,7 @@ namespace quda {
       errorQuda("link_direction = %d not supported", link_direction);
 
     void *recv[QUDA_MAX_DIM];
-    for (int d=0; d<nDim; d++) recv[d] = safe_malloc(nFace*surface[d]*nInternal*precision);
+    for (int d=0; d<nDim; d++) recv[d] = safe_malloc(hostGhostBytes(d));
 
     // communicate between nodes
     exchange(recv, ghost, QUDA_BACKWARDS);
@@ -272,7 +281,25 @@ namespace quda {
       fat_link_max = 1.0;
     }
 
-    if (typeid(src) == typeid(cudaGaugeField)) {
+    if (typeid(src) == typeid(cudaGaugeField) && (row_scale || src.RowScaled())) {
+      // the per-row maxima are not carried through the reordering
+      // buffers, so go through a single-precision copy of the
+      // row-scaled field on its own side
+      GaugeFieldParam param(src.RowScaled() ? src : *this);
+      param.create = QUDA_NULL_FIELD_CREATE;
+      param.row_scale = false;
+      param.setPrecision(QUDA_SINGLE_PRECISION);
+      if (src.RowScaled()) {
+        cudaGaugeField tmp(param);
+        tmp.copy(src);
+        copy(tmp);
+      } else {
+        cpuGaugeField tmp(param);
+        tmp.copy(src);
+        copy(tmp);
+      }
+      return;
+    } else if (typeid(src) == typeid(cudaGaugeField)) {
 
       if (reorder_location() == QUDA_CPU_FIELD_LOCATION) {
 
@@ -357,6 +384,11 @@ namespace quda {
       memcpy(backup_h, gauge, bytes);
     }
 
+    if (row_max) {
+      backup_norm_h = new char[row_max_bytes];
+      memcpy(backup_norm_h, row_max, row_max_bytes);
+    }
+
     backed_up = true;
   }
 
@@ -375,11 +407,17 @@ namespace quda {
       delete []backup_h;
     }
 
+    if (row_max) {
+      memcpy(row_max, backup_norm_h, row_max_bytes);
+      delete []backup_norm_h;
+    }
+
     backed_up = false;
   }
 
   void cpuGaugeField::zero() {
     memset(gauge, 0, bytes);
+    if (row_max) memset(row_max, 0, row_max_bytes);
   }
 
 /*template <typename Float>
@@ -56,6 +56,14 @@ namespace quda {
       gauge = param.gauge;
     }
 
+    if (row_scale) {
+      // one maximum per row, laid out like a real-valued field of
+      // nColor components per link, so that the pad holds the ghosts
+      row_max_bytes = 2 * geometry * nColor * stride * sizeof(float);
+      row_max = pool_device_malloc(row_max_bytes);
+      cudaMemset(row_max, 0, row_max_bytes);
+    }
+
     if ( !isNative() ) {
       for (int i=0; i<nDim; i++) {
         size_t nbytes = nFace * surface[i] * nInternal * precision;
@@ -201,6 +209,8 @@ namespace quda {
       }
     }
 
+    if (row_max) pool_device_free(row_max);
+
     if ( !isNative() ) {
       for (int i=0; i<nDim; i++) {
         if (ghost[i]) pool_device_free(ghost[i]);
@@ -649,6 +659,24 @@ namespace quda {
         if (geometry == QUDA_COARSE_GEOMETRY) errorQuda("Extended gauge copy for coarse geometry not supported");
       }
 
+    } else if (typeid(src) == typeid(cpuGaugeField) && (row_scale || src.RowScaled())) {
+      // the per-row maxima are not carried through the reordering
+      // buffers, so go through a single-precision copy of the
+      // row-scaled field on its own side
+      GaugeFieldParam param(src.RowScaled() ? src : *this);
+      param.create = QUDA_NULL_FIELD_CREATE;
+      param.row_scale = false;
+      param.setPrecision(QUDA_SINGLE_PRECISION);
+      if (src.RowScaled()) {
+        cpuGaugeField tmp(param);
+        tmp.copy(src);
+        copy(tmp);
+      } else {
+        cudaGaugeField tmp(param);
+        tmp.copy(src);
+        copy(tmp);
+      }
+      return;
     } else if (typeid(src) == typeid(cpuGaugeField)) {
       if (reorder_location() == QUDA_CPU_FIELD_LOCATION) { // do reorder on the CPU
 	void *buffer = pool_pinned_malloc(bytes);
@@ -742,6 +770,25 @@ namespace quda {
   {
     static_cast<LatticeField&>(cpu).checkField(*this);
 
+    if (row_scale || cpu.RowScaled()) {
+      // as in copy(), stage through a single-precision field without
+      // per-row maxima on the side that is row scaled
+      GaugeFieldParam param(row_scale ? static_cast<const GaugeField&>(*this) : static_cast<const GaugeField&>(cpu));
+      param.create = QUDA_NULL_FIELD_CREATE;
+      param.row_scale = false;
+      param.setPrecision(QUDA_SINGLE_PRECISION);
+      if (row_scale) {
+        cudaGaugeField tmp(param);
+        tmp.copy(*this);
+        tmp.saveCPUField(cpu);
+      } else {
+        cpuGaugeField tmp(param);
+        saveCPUField(tmp);
+        cpu.copy(tmp);
+      }
+      return;
+    }
+
     if (reorder_location() == QUDA_CUDA_FIELD_LOCATION) {
 
       if (cpu.Order() == QUDA_MILC_SITE_GAUGE_ORDER || cpu.Order() == QUDA_BQCD_GAUGE_ORDER) {
@@ -817,6 +864,10 @@ namespace quda {
     if (backed_up) errorQuda("Gauge field already backed up");
     backup_h = new char[bytes];
     cudaMemcpy(backup_h, gauge, bytes, cudaMemcpyDeviceToHost);
+    if (row_max) {
+      backup_norm_h = new char[row_max_bytes];
+      cudaMemcpy(backup_norm_h, row_max, row_max_bytes, cudaMemcpyDeviceToHost);
+    }
     checkCudaError();
     backed_up = true;
   }
@@ -825,12 +876,17 @@ namespace quda {
     if (!backed_up) errorQuda("Cannot restore since not backed up");
     cudaMemcpy(gauge, backup_h, bytes, cudaMemcpyHostToDevice);
     delete []backup_h;
+    if (row_max) {
+      cudaMemcpy(row_max, backup_norm_h, row_max_bytes, cudaMemcpyHostToDevice);
+      delete []backup_norm_h;
+    }
     checkCudaError();
     backed_up = false;
   }
 
   void cudaGaugeField::zero() {
     cudaMemset(gauge, 0, bytes);
+    if (row_max) cudaMemset(row_max, 0, row_max_bytes);
   }
 
 
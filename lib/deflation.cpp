@@ -27,15 +27,81 @@ namespace quda {
 
   //static bool debug = false;
 
+  // host field used to move the Ritz vectors in and out of files
+  static ColorSpinorParam storeParam(const ColorSpinorField &v) {
+    ColorSpinorParam csParam(v);
+    csParam.location = QUDA_CPU_FIELD_LOCATION;
+    csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+    csParam.setPrecision(v.Precision() < QUDA_SINGLE_PRECISION ? QUDA_SINGLE_PRECISION : v.Precision());
+    csParam.is_composite = false;
+    csParam.is_component = false;
+    csParam.pad = 0;
+    csParam.create = QUDA_REFERENCE_FIELD_CREATE;
+    csParam.v = nullptr;
+    return csParam;
+  }
+
+  static size_t storeVectorBytes(const ColorSpinorField &v) {
+    std::unique_ptr<ColorSpinorField> ref(ColorSpinorField::Create(storeParam(v)));
+    return ref->Bytes();
+  }
+
+  /**
+     Metadata block of the deflation space store: this header is
+     followed by the inverse Ritz values and the projection matrix,
+     both sized for the full capacity of the deflation space
+   */
+  struct DeflationStoreMeta {
+    int tot_dim;
+    int use_inv_ritz;
+  };
+
+  static size_t storeMetaBytes(int capacity) {
+    return sizeof(DeflationStoreMeta) + capacity*sizeof(double) + (size_t)capacity*capacity*sizeof(Complex);
+  }
+
+  static void packStoreMeta(std::vector<char> &meta, const DeflationParam &param, int capacity) {
+    DeflationStoreMeta *header = reinterpret_cast<DeflationStoreMeta*>(meta.data());
+    header->tot_dim = param.tot_dim;
+    header->use_inv_ritz = param.use_inv_ritz;
+    double *invRitzVals = reinterpret_cast<double*>(header + 1);
+    memcpy(invRitzVals, param.invRitzVals, capacity*sizeof(double));
+    Complex *matProj = reinterpret_cast<Complex*>(invRitzVals + capacity);
+    for (int i = 0; i < capacity; i++) memcpy(matProj + i*capacity, param.matProj + i*param.ld, capacity*sizeof(Complex));
+  }
+
+  static void unpackStoreMeta(DeflationParam &param, const std::vector<char> &meta, int capacity) {
+    const DeflationStoreMeta *header = reinterpret_cast<const DeflationStoreMeta*>(meta.data());
+    param.tot_dim = header->tot_dim;
+    param.use_inv_ritz = header->use_inv_ritz;
+    const double *invRitzVals = reinterpret_cast<const double*>(header + 1);
+    memcpy(param.invRitzVals, invRitzVals, capacity*sizeof(double));
+    const Complex *matProj = reinterpret_cast<const Complex*>(invRitzVals + capacity);
+    for (int i = 0; i < capacity; i++) memcpy(param.matProj + i*param.ld, matProj + i*capacity, capacity*sizeof(Complex));
+  }
+
   Deflation::Deflation(DeflationParam &param, TimeProfile &profile)
     : param(param),   profile(profile),
-      r(nullptr), Av(nullptr), r_sloppy(nullptr), Av_sloppy(nullptr) {
+      r(nullptr), Av(nullptr), r_sloppy(nullptr), Av_sloppy(nullptr),
+      store_in(nullptr), store_out(nullptr), loaded_dim(param.cur_dim), stored_dim(0) {
 
 
     // for reporting level 1 is the fine level but internally use level 0 for indexing
     printfQuda("Creating deflation space of %d vectors.\n", param.tot_dim);
 
     if( param.eig_global.import_vectors ) loadVectors(param.RV);//whether to load eigenvectors
+
+    // the deflation space store is kept up to date as the space grows
+    if (strcmp(param.eig_global.vec_outfile,"")!=0 && param.eig_global.vec_store == QUDA_BOOLEAN_YES) {
+      if (store_in && strcmp(param.eig_global.vec_infile, param.eig_global.vec_outfile)==0) {
+        store_out = store_in;
+        stored_dim = param.cur_dim;
+      } else {
+        const int capacity = param.RV->CompositeDim();
+        store_out = create_vector_store(param.eig_global.vec_outfile, param.store_key, storeVectorBytes(param.RV->Component(0)),
+                                        capacity, storeMetaBytes(capacity));
+      }
+    }
     // create aux fields
     ColorSpinorParam csParam(param.RV->Component(0));
     csParam.create = QUDA_ZERO_FIELD_CREATE;
@@ -75,6 +141,14 @@ namespace quda {
 
   Deflation::~Deflation() {
 
+    if (store_out) {
+      if (stored_dim < param.cur_dim) saveVectors(param.RV);
+      close_vector_store(store_out);
+    } else if (strcmp(param.eig_global.vec_outfile,"")!=0) {
+      saveVectors(param.RV);
+    }
+    if (store_in && store_in != store_out) close_vector_store(store_in);
+
     if( param.eig_global.cuda_prec_ritz != QUDA_DOUBLE_PRECISION ) {
       if (r_sloppy) delete r_sloppy;
       if (Av_sloppy) delete Av_sloppy;
@@ -93,6 +167,27 @@ namespace quda {
     return flops;
   }
 
+  void Deflation::pageIn() {
+    if (loaded_dim >= param.cur_dim) return;
+
+    ColorSpinorParam csParam(storeParam(param.RV->Component(0)));
+    for (int i = loaded_dim; i < param.cur_dim; i++) {
+      csParam.v = const_cast<void*>(vector_store_vector(store_in, i));
+      std::unique_ptr<ColorSpinorField> v(ColorSpinorField::Create(csParam));
+      param.RV->Component(i) = *v;
+    }
+
+    if (getVerbosity() >= QUDA_VERBOSE)
+      printfQuda("Paged in %d Ritz vectors\n", param.cur_dim - loaded_dim);
+    loaded_dim = param.cur_dim;
+
+    // the mapping is no longer needed unless we append to this store
+    if (store_in != store_out) {
+      close_vector_store(store_in);
+      store_in = nullptr;
+    }
+  }
+
   /**
      Verification that the computed approximate eigenvectors are (not) valid
    */
@@ -101,6 +196,8 @@ namespace quda {
     const int nevs_to_print = param.cur_dim;
     if(nevs_to_print == 0) errorQuda("\nIncorrect size of current deflation space. \n"); 
 
+    pageIn();
+
     std::unique_ptr<Complex, decltype(pinned_deleter) > projm( pinned_allocator(param.ld*param.cur_dim * sizeof(Complex)), pinned_deleter);
 
     if (param.eig_global.extlib_type == QUDA_MAGMA_EXTLIB) {
@@ -155,6 +252,8 @@ namespace quda {
 
     if(param.cur_dim == 0) return;//nothing to do
 
+    pageIn();
+
     std::unique_ptr<Complex[] > vec(new Complex[param.ld]);
 
     double check_nrm2 = norm2(b);
@@ -204,6 +303,74 @@ namespace quda {
     return;
   }
 
+  void Deflation::operator()(std::vector<ColorSpinorField*> &x, ColorSpinorField &r, ColorSpinorField &b, const double *offset) {
+    const int num_offset = x.size();
+
+    if (&r != &b) blas::copy(r, b);
+    for (auto &xj : x) zero(*xj);
+
+    if (param.cur_dim == 0) return;//nothing to do
+
+    pageIn();
+
+    const int n = param.cur_dim;
+    std::unique_ptr<Complex[] > vec(new Complex[param.ld]);
+    std::unique_ptr<Complex[] > coeff(new Complex[n*num_offset]);
+
+    ColorSpinorField *b_sloppy = param.RV->Precision() != b.Precision() ? r_sloppy : &b;
+    if (b_sloppy != &b) *b_sloppy = b;
+
+    std::vector<ColorSpinorField*> rv_(param.RV->Components().begin(), param.RV->Components().begin()+n);
+    std::vector<ColorSpinorField*> in_;
+    in_.push_back(b_sloppy);
+
+    blas::cDotProduct(vec.get(), rv_, in_);//<i, b>
+
+    // project the low modes out of the common residual
+    for (int i = 0; i < n; i++) coeff[i] = -vec[i];
+    std::vector<ColorSpinorField*> r_;
+    r_.push_back(&r);
+    blas::caxpy(coeff.get(), rv_, r_);
+
+    // solve the shifted projected systems, coeff[i*num_offset+j] is the i-th component for shift j
+    for (int j = 0; j < num_offset; j++) {
+      if (!param.use_inv_ritz) {
+        if( param.eig_global.extlib_type == QUDA_MAGMA_EXTLIB ) {
+#ifdef MAGMA_LIB
+          std::unique_ptr<Complex[] > projm(new Complex[param.ld*n]);
+          std::unique_ptr<Complex[] > sol(new Complex[param.ld]);
+          memcpy(projm.get(), param.matProj, param.ld*n*sizeof(Complex));
+          memcpy(sol.get(), vec.get(), param.ld*sizeof(Complex));
+          for (int i = 0; i < n; i++) projm[i*param.ld+i] += offset[j];
+          magma_Xgesv(sol.get(), param.ld, n, projm.get(), param.ld, sizeof(Complex));
+          for (int i = 0; i < n; i++) coeff[i*num_offset+j] = sol[i];
+#else
+          errorQuda("MAGMA library was not built.\n");
+#endif
+        } else if( param.eig_global.extlib_type == QUDA_EIGEN_EXTLIB ) {
+          Map<MatrixXcd, Unaligned, DynamicStride> projm_(param.matProj, n, n, DynamicStride(param.ld, 1));
+          Map<VectorXcd, Unaligned> vec_ (vec.get(), n);
+
+          MatrixXcd shifted_ = projm_ + offset[j] * MatrixXcd::Identity(n, n);
+          VectorXcd sol_ = shifted_.fullPivHouseholderQr().solve(vec_);
+          for (int i = 0; i < n; i++) coeff[i*num_offset+j] = sol_(i);
+        } else {
+          errorQuda("Library type %d is currently not supported.\n", param.eig_global.extlib_type);
+        }
+      } else {
+        for (int i = 0; i < n; i++)
+          coeff[i*num_offset+j] = vec[i] * (param.invRitzVals[i] / (1.0 + offset[j]*param.invRitzVals[i]));
+      }
+    }
+
+    blas::caxpy(coeff.get(), rv_, x); //multiblas
+
+    if (getVerbosity() >= QUDA_VERBOSE)
+      printfQuda("Deflated %d shifts with %d vectors, |r|/|b| = %e\n", num_offset, n, sqrt(norm2(r) / norm2(b)));
+
+    return;
+  }
+
   void Deflation::increment(ColorSpinorField &Vm, int nev) {
     if(param.eig_global.invert_param->inv_type != QUDA_EIGCG_INVERTER && param.eig_global.invert_param->inv_type != QUDA_INC_EIGCG_INVERTER) 
        errorQuda("\nMethod is not implemented for %d inverter type.\n", param.eig_global.invert_param->inv_type);
@@ -217,6 +384,8 @@ namespace quda {
       return;
     }
 
+    pageIn();
+
     for(int i = 0; i < nev; i++) blas::copy(param.RV->Component(first_idx+i), Vm.Component(i));
 
     printfQuda("\nConstruct projection matrix..\n");
@@ -276,8 +445,11 @@ namespace quda {
     }
 
     param.cur_dim += nev;
+    loaded_dim = param.cur_dim;
 
     printfQuda("\nNew curr deflation space dim = %d\n", param.cur_dim);
+
+    if (store_out) saveVectors(param.RV);
     return;
   }
 
@@ -289,6 +461,8 @@ namespace quda {
         max_nev = param.cur_dim;
      }
 
+     pageIn();
+
      std::unique_ptr<double[] > evals(new double[param.cur_dim]);
      std::unique_ptr<Complex, decltype(pinned_deleter) > projm( pinned_allocator(param.ld*param.cur_dim * sizeof(Complex)), pinned_deleter);
 
@@ -376,6 +550,13 @@ namespace quda {
      //reset current dimension:
      param.cur_dim = idx;//idx never exceeds cur_dim.
      param.tot_dim = idx;
+     loaded_dim    = idx;
+
+     //the whole space has changed, so rewrite the store:
+     if (store_out) {
+       stored_dim = 0;
+       saveVectors(param.RV);
+     }
 
      return;
   }
@@ -383,13 +564,38 @@ namespace quda {
   //supports seperate reading or single file read
   void Deflation::loadVectors(ColorSpinorField *RV) {
 
-    if(RV->IsComposite()) errorQuda("\nNot a composite field.\n");
+    if(!RV->IsComposite()) errorQuda("\nNot a composite field.\n");
 
     profile.TPSTOP(QUDA_PROFILE_INIT);
     profile.TPSTART(QUDA_PROFILE_IO);
 
     std::string vec_infile(param.eig_global.vec_infile);
 
+    if (strcmp(vec_infile.c_str(),"")==0) errorQuda("No eigenspace file defined.");
+
+    if (is_vector_store(vec_infile.c_str())) {
+      // only map the store here: the Ritz vectors are paged in on first use
+      const int capacity = RV->CompositeDim();
+      const bool append = strcmp(param.eig_global.vec_infile, param.eig_global.vec_outfile)==0;
+      store_in = open_vector_store(vec_infile.c_str(), param.store_key, storeVectorBytes(RV->Component(0)),
+                                   capacity, storeMetaBytes(capacity), append);
+
+      if (store_in) {
+        std::vector<char> meta(storeMetaBytes(capacity));
+        vector_store_read_meta(store_in, meta.data());
+        unpackStoreMeta(param, meta, capacity);
+        param.cur_dim = vector_store_size(store_in);
+        loaded_dim    = 0;
+        printfQuda("Mapped deflation space of %d vectors from %s\n", param.cur_dim, vec_infile.c_str());
+      } else {
+        warningQuda("Deflation space store %s does not match this deflation space, ignoring it", vec_infile.c_str());
+      }
+
+      profile.TPSTOP(QUDA_PROFILE_IO);
+      profile.TPSTART(QUDA_PROFILE_INIT);
+      return;
+    }
+
     std::vector<ColorSpinorField*> &B = RV->Components(); 
 
     const int Nvec = B.size();
@@ -403,12 +609,10 @@ namespace quda {
       }
     }
 
-    if (strcmp(vec_infile.c_str(),"")!=0) {
-      read_spinor_field(vec_infile.c_str(), &V[0], B[0]->Precision(), B[0]->X(),
-			B[0]->Ncolor(), B[0]->Nspin(), Nvec, 0,  (char**)0);
-    } else {
-      errorQuda("No eigenspace file defined.");
-    }
+    read_spinor_field(vec_infile.c_str(), &V[0], B[0]->Precision(), B[0]->X(),
+		      B[0]->Ncolor(), B[0]->Nspin(), Nvec, 0,  (char**)0);
+
+    delete []V;
 
     printfQuda("Done loading vectors\n");
     profile.TPSTOP(QUDA_PROFILE_IO);
@@ -418,37 +622,63 @@ namespace quda {
   }
 
   void Deflation::saveVectors(ColorSpinorField *RV) {
-    if(RV->IsComposite()) errorQuda("\nNot a composite field.\n");
-
-    profile.TPSTOP(QUDA_PROFILE_INIT);
-    profile.TPSTART(QUDA_PROFILE_IO);
+    if(!RV->IsComposite()) errorQuda("\nNot a composite field.\n");
 
-    std::string vec_outfile(param.eig_global.vec_outfile);
+    pageIn();
 
+    if (!store_out) {
+      // the whole space is written at once as a SciDAC file
+      if (strcmp(param.eig_global.vec_outfile,"")==0 || param.cur_dim == 0) return;
 
-    std::vector<ColorSpinorField*> &B = RV->Components();
+      profile.TPSTOP(QUDA_PROFILE_INIT);
+      profile.TPSTART(QUDA_PROFILE_IO);
 
-    if (strcmp(param.eig_global.vec_outfile,"")!=0) {
-      const int Nvec = B.size();
-      printfQuda("Start saving %d vectors to %s\n", Nvec, vec_outfile.c_str());
+      const int Nvec = param.cur_dim;
+      printfQuda("Start saving %d vectors to %s\n", Nvec, param.eig_global.vec_outfile);
 
+      ColorSpinorParam csParam(storeParam(RV->Component(0)));
+      csParam.create = QUDA_NULL_FIELD_CREATE;
+      std::vector<ColorSpinorField*> B;
       void **V = static_cast<void**>(safe_malloc(Nvec*sizeof(void*)));
       for (int i=0; i<Nvec; i++) {
-	V[i] = B[i]->V();
-	if (V[i] == NULL) {
-	  printfQuda("Could not allocate V[%d]\n", i);
-	}
+        B.push_back(ColorSpinorField::Create(csParam));
+        *B[i] = RV->Component(i);
+        V[i] = B[i]->V();
       }
 
-      write_spinor_field(vec_outfile.c_str(), &V[0], B[0]->Precision(), B[0]->X(),
-			 B[0]->Ncolor(), B[0]->Nspin(), Nvec, 0,  (char**)0);
+      write_spinor_field(param.eig_global.vec_outfile, &V[0], B[0]->Precision(), B[0]->X(),
+                         B[0]->Ncolor(), B[0]->Nspin(), Nvec, 0,  (char**)0);
 
       host_free(V);
+      for (auto b : B) delete b;
       printfQuda("Done saving vectors\n");
+
+      profile.TPSTOP(QUDA_PROFILE_IO);
+      profile.TPSTART(QUDA_PROFILE_INIT);
+      return;
     }
 
-    profile.TPSTOP(QUDA_PROFILE_IO);
-    profile.TPSTART(QUDA_PROFILE_INIT);
+    const int capacity = RV->CompositeDim();
+    std::vector<char> meta(storeMetaBytes(capacity));
+    packStoreMeta(meta, param, capacity);
+
+    // discard stored vectors that are about to be overwritten
+    if (vector_store_size(store_out) > stored_dim) vector_store_commit(store_out, stored_dim, meta.data());
+
+    ColorSpinorParam csParam(storeParam(RV->Component(0)));
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    std::unique_ptr<ColorSpinorField> tmp(ColorSpinorField::Create(csParam));
+
+    for (int i = stored_dim; i < param.cur_dim; i++) {
+      *tmp = RV->Component(i);
+      vector_store_write(store_out, i, tmp->V());
+    }
+
+    vector_store_commit(store_out, param.cur_dim, meta.data());
+
+    if (getVerbosity() >= QUDA_VERBOSE)
+      printfQuda("Saved %d Ritz vectors to %s\n", param.cur_dim - stored_dim, param.eig_global.vec_outfile);
+    stored_dim = param.cur_dim;
 
     return;
   }
@@ -85,6 +85,28 @@ namespace quda {
 
 #undef flip
 
+  void Dirac::M(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in) const
+  {
+    if (out.size() != in.size()) errorQuda("Batch sizes %lu and %lu do not match", out.size(), in.size());
+    for (unsigned int i=0; i<in.size(); i++) M(*out[i], *in[i]);
+  }
+
+  void Dirac::MdagM(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in) const
+  {
+    if (out.size() != in.size()) errorQuda("Batch sizes %lu and %lu do not match", out.size(), in.size());
+    for (unsigned int i=0; i<in.size(); i++) MdagM(*out[i], *in[i]);
+  }
+
+  void Dirac::MPowers(std::vector<ColorSpinorField*> &out, const ColorSpinorField &in) const
+  {
+    for (unsigned int k=0; k<out.size(); k++) M(*out[k], k==0 ? in : *out[k-1]);
+  }
+
+  void Dirac::SolveDomain(ColorSpinorField &x, const ColorSpinorField &b, int overlap, int niter, double omega) const
+  {
+    errorQuda("Overlapping domain solves are not supported by Dirac type %d", type);
+  }
+
   void Dirac::checkParitySpinor(const ColorSpinorField &out, const ColorSpinorField &in) const
   {
     if ( (in.GammaBasis() != QUDA_UKQCD_GAMMA_BASIS || out.GammaBasis() != QUDA_UKQCD_GAMMA_BASIS) && 
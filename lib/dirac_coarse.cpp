@@ -1,17 +1,27 @@
 #include <string.h>
 #include <multigrid.h>
+#include <matrix_powers.h>
 #include <algorithm>
 
 namespace quda {
 
-  DiracCoarse::DiracCoarse(const DiracParam &param, bool gpu_setup, bool mapped)
+  DiracCoarse::DiracCoarse(const DiracParam &param, bool gpu_setup, bool mapped, bool compute)
     : Dirac(param), mu(param.mu), mu_factor(param.mu_factor), transfer(param.transfer), dirac(param.dirac),
       Y_h(nullptr), X_h(nullptr), Xinv_h(nullptr), Yhat_h(nullptr),
       Y_d(nullptr), X_d(nullptr), Xinv_d(nullptr), Yhat_d(nullptr),
       enable_gpu(false), enable_cpu(false), gpu_setup(gpu_setup),
-      init_gpu(gpu_setup), init_cpu(!gpu_setup), mapped(mapped)
+      init_gpu(gpu_setup), init_cpu(!gpu_setup), mapped(mapped), link_precision(param.link_precision),
+      matrix_powers(nullptr), schwarz_domain(nullptr)
   {
-    initializeCoarse();
+    if (compute) {
+      initializeCoarse();
+    } else {
+      // the link fields will be restored on the host and copied to the device on demand
+      createY(false);
+      createYhat(false);
+      enable_cpu = true;
+      init_cpu = true;
+    }
   }
 
   DiracCoarse::DiracCoarse(const DiracParam &param,
@@ -21,7 +31,8 @@ namespace quda {
       Y_h(Y_h), X_h(X_h), Xinv_h(Xinv_h), Yhat_h(Yhat_h),
       Y_d(Y_d), X_d(X_d), Xinv_d(Xinv_d), Yhat_d(Yhat_d),
       enable_gpu( Y_d ? true : false), enable_cpu(Y_h ? true : false), gpu_setup(true),
-      init_gpu(enable_gpu ? false : true), init_cpu(enable_cpu ? false : true), mapped(Y_d->MemType() == QUDA_MEMORY_MAPPED)
+      init_gpu(enable_gpu ? false : true), init_cpu(enable_cpu ? false : true), mapped(Y_d ? Y_d->MemType() == QUDA_MEMORY_MAPPED : false),
+      link_precision(Y_d ? Y_d->Precision() : QUDA_INVALID_PRECISION), matrix_powers(nullptr), schwarz_domain(nullptr)
   {
 
   }
@@ -32,13 +43,22 @@ namespace quda {
       Y_d(dirac.Y_d), X_d(dirac.X_d), Xinv_d(dirac.Xinv_d), Yhat_d(dirac.Yhat_d),
       enable_gpu(dirac.enable_gpu), enable_cpu(dirac.enable_cpu), gpu_setup(dirac.gpu_setup),
       init_gpu(enable_gpu ? false : true), init_cpu(enable_cpu ? false : true),
-      mapped(dirac.mapped)
+      mapped(dirac.mapped), link_precision(dirac.link_precision), matrix_powers(nullptr), schwarz_domain(nullptr)
   {
 
   }
 
   DiracCoarse::~DiracCoarse()
   {
+    if (matrix_powers) {
+      if (getVerbosity() >= QUDA_VERBOSE && matrix_powers->MessagesBaseline() > 0)
+	printfQuda("Matrix-powers kernel sent %lld halo messages instead of %lld (%.1f%% saved)\n",
+		   matrix_powers->Messages(), matrix_powers->MessagesBaseline(),
+		   100.0 * (1.0 - (double)matrix_powers->Messages() / matrix_powers->MessagesBaseline()));
+      delete matrix_powers;
+    }
+    if (schwarz_domain) delete schwarz_domain;
+
     if (init_cpu) {
       if (Y_h) delete Y_h;
       if (X_h) delete X_h;
@@ -53,7 +73,159 @@ namespace quda {
     }
   }
 
-  void DiracCoarse::createY(bool gpu, bool mapped) const
+  void DiracCoarse::HostFields(cpuGaugeField *&Y, cpuGaugeField *&X, cpuGaugeField *&Xinv, cpuGaugeField *&Yhat) const
+  {
+    initializeLazy(QUDA_CPU_FIELD_LOCATION);
+    Y = Y_h;
+    X = X_h;
+    Xinv = Xinv_h;
+    Yhat = Yhat_h;
+  }
+
+  // copy of a link field in another precision, with its halos
+  static GaugeField* createLinks(const GaugeField &links, QudaPrecision precision)
+  {
+    GaugeFieldParam param(links);
+    param.create = QUDA_NULL_FIELD_CREATE;
+    param.row_scale = true; // only takes effect for fixed-point precisions
+    param.setPrecision(precision, links.isNative());
+    GaugeField *copy = links.Location() == QUDA_CUDA_FIELD_LOCATION ?
+      static_cast<GaugeField*>(new cudaGaugeField(param)) : static_cast<GaugeField*>(new cpuGaugeField(param));
+    copy->copy(links);
+    if (links.Geometry() == QUDA_COARSE_GEOMETRY) copy->exchangeGhost(QUDA_LINK_BIDIRECTIONAL);
+    return copy;
+  }
+
+  // the matrix-powers kernel copies the host links in double
+  // precision, so fixed-point links are expanded first
+  static CoarseMatrixPowers* createMatrixPowers(const cpuGaugeField &Y, const cpuGaugeField &X, double kappa,
+						int depth, const int *commDim)
+  {
+    if (Y.Precision() >= QUDA_SINGLE_PRECISION && X.Precision() >= QUDA_SINGLE_PRECISION)
+      return new CoarseMatrixPowers(Y, X, kappa, depth, commDim);
+
+    GaugeField *Y_ = createLinks(Y, QUDA_SINGLE_PRECISION);
+    GaugeField *X_ = createLinks(X, QUDA_SINGLE_PRECISION);
+    CoarseMatrixPowers *powers = new CoarseMatrixPowers(static_cast<cpuGaugeField&>(*Y_), static_cast<cpuGaugeField&>(*X_),
+							kappa, depth, commDim);
+    delete Y_;
+    delete X_;
+    return powers;
+  }
+
+  void DiracCoarse::restoreCoarseOp()
+  {
+    if (!enable_cpu) errorQuda("Host coarse fields not initialized");
+
+    // the matrix-powers kernel holds its own copy of the links
+    if (matrix_powers) {
+      delete matrix_powers;
+      matrix_powers = nullptr;
+    }
+    if (schwarz_domain) {
+      delete schwarz_domain;
+      schwarz_domain = nullptr;
+    }
+
+    // only the bulk is stored, so rebuild the halos of both link directions
+    Y_h->exchangeGhost(QUDA_LINK_BIDIRECTIONAL);
+    Yhat_h->exchangeGhost(QUDA_LINK_BIDIRECTIONAL);
+
+    if (enable_gpu) {
+      Y_d->copy(*Y_h);
+      Yhat_d->copy(*Yhat_h);
+      X_d->copy(*X_h);
+      Xinv_d->copy(*Xinv_h);
+    }
+  }
+
+  // X -> Gamma5 X^dag Gamma5 on each site, with Gamma5 = +1 on the
+  // upper and -1 on the lower half of the coarse spin-color index
+  template <typename Float>
+  static void flipMuX(cpuGaugeField &X)
+  {
+    typedef std::complex<Float> complex;
+    const int n = X.Ncolor();
+    complex *X_ = static_cast<complex**>(X.Gauge_p())[0];
+    std::vector<complex> site(n*n);
+
+    for (int x=0; x<X.Volume(); x++) {
+      complex *Xx = X_ + (size_t)x*n*n;
+      std::copy(Xx, Xx + n*n, site.begin());
+      for (int i=0; i<n; i++) {
+	for (int j=0; j<n; j++) {
+	  const Float sign = ((i < n/2) == (j < n/2)) ? 1.0 : -1.0;
+	  Xx[i*n+j] = sign * std::conj(site[j*n+i]);
+	}
+      }
+    }
+  }
+
+  void DiracCoarse::flipMu()
+  {
+    mu = -mu;
+
+    // the matrix-powers kernel holds its own copy of the links
+    if (matrix_powers) {
+      delete matrix_powers;
+      matrix_powers = nullptr;
+    }
+    if (schwarz_domain) {
+      delete schwarz_domain;
+      schwarz_domain = nullptr;
+    }
+
+    const bool own_gpu = enable_gpu && init_gpu;
+    bool own_cpu = enable_cpu && init_cpu;
+    if (!own_cpu && !own_gpu) return; // the fields are shared with the instance this was cloned from
+
+    if (!enable_cpu) {
+      initializeLazy(QUDA_CPU_FIELD_LOCATION);
+      own_cpu = true;
+    }
+
+    if (own_cpu) {
+      if (X_h->Precision() == QUDA_DOUBLE_PRECISION) {
+	flipMuX<double>(*X_h);
+	createPreconditionedCoarseOp(*Yhat_h, *Xinv_h, *Y_h, *X_h);
+      } else if (X_h->Precision() == QUDA_SINGLE_PRECISION) {
+	flipMuX<float>(*X_h);
+	createPreconditionedCoarseOp(*Yhat_h, *Xinv_h, *Y_h, *X_h);
+      } else {
+	// fixed-point links are flipped and recomputed in single
+	// precision, then stored back with fresh per-row scales
+	GaugeField *Y = createLinks(*Y_h, QUDA_SINGLE_PRECISION);
+	GaugeField *X = createLinks(*X_h, QUDA_SINGLE_PRECISION);
+	GaugeField *Xinv = createLinks(*Xinv_h, QUDA_SINGLE_PRECISION);
+	GaugeField *Yhat = createLinks(*Yhat_h, QUDA_SINGLE_PRECISION);
+	flipMuX<float>(static_cast<cpuGaugeField&>(*X));
+	createPreconditionedCoarseOp(*Yhat, *Xinv, *Y, *X);
+	X_h->copy(*X);
+	Xinv_h->copy(*Xinv);
+	Yhat_h->copy(*Yhat);
+	Yhat_h->exchangeGhost(QUDA_LINK_BIDIRECTIONAL);
+	delete Y;
+	delete X;
+	delete Xinv;
+	delete Yhat;
+      }
+    }
+
+    if (own_gpu) {
+      X_d->copy(*X_h);
+      Xinv_d->copy(*Xinv_h);
+      Yhat_d->copy(*Yhat_h);
+    }
+  }
+
+  QudaPrecision DiracCoarse::LinkPrecision(bool gpu) const
+  {
+    QudaPrecision precision = transfer->NullPrecision(gpu ? QUDA_CUDA_FIELD_LOCATION : QUDA_CPU_FIELD_LOCATION);
+    if (link_precision != QUDA_INVALID_PRECISION && link_precision < precision) precision = link_precision;
+    return precision;
+  }
+
+  void DiracCoarse::createY(bool gpu, bool mapped, QudaPrecision precision) const
   {
     int ndim = transfer->Vectors().Ndim();
     int x[QUDA_MAX_DIM];
@@ -69,8 +241,9 @@ namespace quda {
     gParam.link_type = QUDA_COARSE_LINKS;
     gParam.t_boundary = QUDA_PERIODIC_T;
     gParam.create = QUDA_ZERO_FIELD_CREATE;
-    // use null-space precision for coarse links on gpu
-    gParam.setPrecision( transfer->NullPrecision(gpu ? QUDA_CUDA_FIELD_LOCATION : QUDA_CPU_FIELD_LOCATION) );
+    // use null-space precision for coarse links unless a lower storage precision is requested
+    gParam.setPrecision( precision == QUDA_INVALID_PRECISION ? LinkPrecision(gpu) : precision );
+    gParam.row_scale = true; // fixed-point links carry one scale per matrix row
     gParam.nDim = ndim;
     gParam.siteSubset = QUDA_FULL_SITE_SUBSET;
     gParam.ghostExchange = QUDA_GHOST_EXCHANGE_PAD;
@@ -93,7 +266,7 @@ namespace quda {
     else     X_h = new cpuGaugeField(gParam);
   }
 
-  void DiracCoarse::createYhat(bool gpu) const
+  void DiracCoarse::createYhat(bool gpu, QudaPrecision precision) const
   {
     int ndim = transfer->Vectors().Ndim();
     int x[QUDA_MAX_DIM];
@@ -110,8 +283,9 @@ namespace quda {
     gParam.link_type = QUDA_COARSE_LINKS;
     gParam.t_boundary = QUDA_PERIODIC_T;
     gParam.create = QUDA_ZERO_FIELD_CREATE;
-    // use null-space precision for preconditioned links on gpu
-    gParam.setPrecision( transfer->NullPrecision(gpu ? QUDA_CUDA_FIELD_LOCATION : QUDA_CPU_FIELD_LOCATION) );
+    // use null-space precision for preconditioned links unless a lower storage precision is requested
+    gParam.setPrecision( precision == QUDA_INVALID_PRECISION ? LinkPrecision(gpu) : precision );
+    gParam.row_scale = true; // fixed-point links carry one scale per matrix row
     gParam.nDim = ndim;
     gParam.siteSubset = QUDA_FULL_SITE_SUBSET;
     gParam.ghostExchange = QUDA_GHOST_EXCHANGE_PAD;
@@ -136,16 +310,21 @@ namespace quda {
 
   void DiracCoarse::initializeCoarse()
   {
-    createY(gpu_setup, mapped);
+    // the operator is always computed in the null-space precision
+    const QudaPrecision precision = transfer->NullPrecision(gpu_setup ? QUDA_CUDA_FIELD_LOCATION : QUDA_CPU_FIELD_LOCATION);
+
+    createY(gpu_setup, mapped, precision);
 
     if (gpu_setup) dirac->createCoarseOp(*Y_d,*X_d,*transfer,kappa,mass,Mu(),MuFactor());
     else dirac->createCoarseOp(*Y_h,*X_h,*transfer,kappa,mass,Mu(),MuFactor());
 
-    createYhat(gpu_setup);
+    createYhat(gpu_setup, precision);
 
     if (gpu_setup) createPreconditionedCoarseOp(*Yhat_d,*Xinv_d,*Y_d,*X_d);
     else createPreconditionedCoarseOp(*Yhat_h,*Xinv_h,*Y_h,*X_h);
 
+    if (LinkPrecision(gpu_setup) != precision) compressLinks();
+
     if (gpu_setup) {
       enable_gpu = true;
       init_gpu = true;
@@ -155,6 +334,45 @@ namespace quda {
     }
   }
 
+  void DiracCoarse::compressLinks() const
+  {
+    GaugeField *Y = gpu_setup ? static_cast<GaugeField*>(Y_d) : static_cast<GaugeField*>(Y_h);
+    GaugeField *X = gpu_setup ? static_cast<GaugeField*>(X_d) : static_cast<GaugeField*>(X_h);
+    GaugeField *Xinv = gpu_setup ? static_cast<GaugeField*>(Xinv_d) : static_cast<GaugeField*>(Xinv_h);
+    GaugeField *Yhat = gpu_setup ? static_cast<GaugeField*>(Yhat_d) : static_cast<GaugeField*>(Yhat_h);
+
+    createY(gpu_setup, mapped);
+    createYhat(gpu_setup);
+
+    GaugeField &Y_ = gpu_setup ? static_cast<GaugeField&>(*Y_d) : static_cast<GaugeField&>(*Y_h);
+    GaugeField &X_ = gpu_setup ? static_cast<GaugeField&>(*X_d) : static_cast<GaugeField&>(*X_h);
+    GaugeField &Xinv_ = gpu_setup ? static_cast<GaugeField&>(*Xinv_d) : static_cast<GaugeField&>(*Xinv_h);
+    GaugeField &Yhat_ = gpu_setup ? static_cast<GaugeField&>(*Yhat_d) : static_cast<GaugeField&>(*Yhat_h);
+
+    // the copies set the scale of each matrix row from its source
+    Y_.copy(*Y);
+    X_.copy(*X);
+    Xinv_.copy(*Xinv);
+    Yhat_.copy(*Yhat);
+
+    // rebuild the halos from the compressed bulk so they carry the same rounding
+    Y_.exchangeGhost(QUDA_LINK_BIDIRECTIONAL);
+    Yhat_.exchangeGhost(QUDA_LINK_BIDIRECTIONAL);
+
+    if (getVerbosity() >= QUDA_VERBOSE) {
+      printfQuda("Coarse links stored in precision %d (from %d) with one scale per matrix row\n",
+                 Y_.Precision(), Y->Precision());
+      printfQuda("Relative change of the coarse link norms Y = %e X = %e Yhat = %e Xinv = %e\n",
+                 std::abs(1.0 - Y_.norm2() / Y->norm2()), std::abs(1.0 - X_.norm2() / X->norm2()),
+                 std::abs(1.0 - Yhat_.norm2() / Yhat->norm2()), std::abs(1.0 - Xinv_.norm2() / Xinv->norm2()));
+    }
+
+    delete Y;
+    delete X;
+    delete Xinv;
+    delete Yhat;
+  }
+
   // we only copy to host or device lazily on demand
   void DiracCoarse::initializeLazy(QudaFieldLocation location) const
   {
@@ -263,6 +481,214 @@ namespace quda {
     flops += (9*(8*n*n)-2*n)*(long long)in.VolumeCB()*in.SiteSubset();
   }
 
+  /**
+     @brief Whether a batch can be applied as a single multi-RHS
+     field: fields of a single right-hand side on the full lattice,
+     all in the same location with matching layouts.  On the host
+     these are space-spin-color fields, on the device float2-ordered
+     fields without a norm array.
+  */
+  static bool batchable(const std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in)
+  {
+    if (out.size() != in.size()) errorQuda("Batch sizes %lu and %lu do not match", out.size(), in.size());
+    if (in.size() < 2) return false;
+
+    const QudaFieldLocation location = in[0]->Location();
+    const QudaFieldOrder order = location == QUDA_CPU_FIELD_LOCATION ? QUDA_SPACE_SPIN_COLOR_FIELD_ORDER : QUDA_FLOAT2_FIELD_ORDER;
+    if (location == QUDA_CUDA_FIELD_LOCATION && in[0]->Precision() < QUDA_SINGLE_PRECISION) return false;
+
+    for (unsigned int i=0; i<in.size(); i++) {
+      for (const ColorSpinorField *v : { in[i], out[i] }) {
+	if (v->Location() != location || v->SiteSubset() != QUDA_FULL_SITE_SUBSET ||
+	    v->FieldOrder() != order || v->Precision() != in[0]->Precision() ||
+	    (v->Ndim() == 5 && v->X(4) != 1) || v->Bytes() != in[0]->Bytes()) return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+     @brief Create a field holding a batch of n fields along the fifth
+     (source) dimension
+  */
+  static ColorSpinorField* createBatch(const ColorSpinorField &meta, int n)
+  {
+    ColorSpinorParam param(meta);
+    param.nDim = 5;
+    param.x[4] = n;
+    param.PCtype = QUDA_4D_PC;
+    param.create = QUDA_NULL_FIELD_CREATE;
+    return ColorSpinorField::Create(param);
+  }
+
+  /**
+     @brief Copy field v to or from source i of a batch.  On the host
+     each parity of the batch holds the parities of all the sources in
+     turn.  On the device each float2 component of a parity is strided
+     over the batch, with source i at checkerboard offset i*VolumeCB,
+     so the copy is a pitched one.
+  */
+  static void copyBatch(ColorSpinorField &batch, const ColorSpinorField &v, int i, bool to_batch)
+  {
+    char *batch_ptr = static_cast<char*>(batch.V());
+    char *v_ptr = static_cast<char*>(const_cast<void*>(v.V()));
+
+    if (v.Location() == QUDA_CUDA_FIELD_LOCATION) {
+      const size_t site_bytes = 2*v.Precision(); // one float2 component
+      const size_t width = v.VolumeCB()*site_bytes;
+      const size_t height = v.Nspin()*v.Ncolor();
+      const size_t b_pitch = batch.Stride()*site_bytes;
+      const size_t v_pitch = v.Stride()*site_bytes;
+      for (int parity=0; parity<2; parity++) {
+	char *b = batch_ptr + parity*(batch.Bytes()/2) + i*width;
+	char *f = v_ptr + parity*(v.Bytes()/2);
+	if (to_batch) {
+	  qudaMemcpy2DAsync(b, b_pitch, f, v_pitch, width, height, cudaMemcpyDeviceToDevice, 0);
+	} else {
+	  qudaMemcpy2DAsync(f, v_pitch, b, b_pitch, width, height, cudaMemcpyDeviceToDevice, 0);
+	}
+      }
+      return;
+    }
+
+    const size_t parity_bytes = v.Bytes() / 2;
+    for (int parity=0; parity<2; parity++) {
+      char *b = batch_ptr + parity*(batch.Bytes()/2) + i*parity_bytes;
+      char *f = v_ptr + parity*parity_bytes;
+      if (to_batch) memcpy(b, f, parity_bytes);
+      else memcpy(f, b, parity_bytes);
+    }
+  }
+
+  void DiracCoarse::M(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in) const
+  {
+    if (!batchable(out, in)) {
+      Dirac::M(out, in);
+      return;
+    }
+
+    const QudaFieldLocation location = in[0]->Location();
+    initializeLazy(location);
+    const GaugeField &Y = location == QUDA_CUDA_FIELD_LOCATION ? static_cast<const GaugeField&>(*Y_d) : *Y_h;
+    const GaugeField &X = location == QUDA_CUDA_FIELD_LOCATION ? static_cast<const GaugeField&>(*X_d) : *X_h;
+    const int nBatch = in.size();
+    ColorSpinorField *in_b = createBatch(*in[0], nBatch);
+    ColorSpinorField *out_b = createBatch(*in[0], nBatch);
+
+    for (int i=0; i<nBatch; i++) copyBatch(*in_b, *in[i], i, true);
+    ApplyCoarse(*out_b, *in_b, *in_b, Y, X, kappa, QUDA_INVALID_PARITY, true, true, dagger, commDim, halo_precision);
+    for (int i=0; i<nBatch; i++) copyBatch(*out_b, *out[i], i, false);
+    if (location == QUDA_CUDA_FIELD_LOCATION) qudaDeviceSynchronize(); // before the batch fields return to the pool
+
+    delete out_b;
+    delete in_b;
+
+    int n = in[0]->Nspin()*in[0]->Ncolor();
+    flops += (9*(8*n*n)-2*n)*(long long)in[0]->VolumeCB()*in[0]->SiteSubset()*nBatch;
+  }
+
+  void DiracCoarse::MdagM(std::vector<ColorSpinorField*> &out, const std::vector<ColorSpinorField*> &in) const
+  {
+    if (!batchable(out, in)) {
+      Dirac::MdagM(out, in);
+      return;
+    }
+
+    const QudaFieldLocation location = in[0]->Location();
+    initializeLazy(location);
+    const GaugeField &Y = location == QUDA_CUDA_FIELD_LOCATION ? static_cast<const GaugeField&>(*Y_d) : *Y_h;
+    const GaugeField &X = location == QUDA_CUDA_FIELD_LOCATION ? static_cast<const GaugeField&>(*X_d) : *X_h;
+    const int nBatch = in.size();
+    ColorSpinorField *in_b = createBatch(*in[0], nBatch);
+    ColorSpinorField *tmp_b = createBatch(*in[0], nBatch);
+
+    // the intermediate M in stays in the batch layout
+    for (int i=0; i<nBatch; i++) copyBatch(*in_b, *in[i], i, true);
+    ApplyCoarse(*tmp_b, *in_b, *in_b, Y, X, kappa, QUDA_INVALID_PARITY, true, true,
+		dagger == QUDA_DAG_YES, commDim, halo_precision);
+    ApplyCoarse(*in_b, *tmp_b, *tmp_b, Y, X, kappa, QUDA_INVALID_PARITY, true, true,
+		dagger != QUDA_DAG_YES, commDim, halo_precision);
+    for (int i=0; i<nBatch; i++) copyBatch(*in_b, *out[i], i, false);
+    if (location == QUDA_CUDA_FIELD_LOCATION) qudaDeviceSynchronize(); // before the batch fields return to the pool
+
+    delete tmp_b;
+    delete in_b;
+
+    int n = in[0]->Nspin()*in[0]->Ncolor();
+    flops += 2*(9*(8*n*n)-2*n)*(long long)in[0]->VolumeCB()*in[0]->SiteSubset()*nBatch;
+  }
+
+  void DiracCoarse::MPowers(std::vector<ColorSpinorField*> &out, const ColorSpinorField &in) const
+  {
+    const int nSrc = in.Ndim() == 5 ? in.X(4) : 1;
+    if (in.Location() != QUDA_CPU_FIELD_LOCATION || nSrc != 1 || out.size() < 2) {
+      Dirac::MPowers(out, in);
+      return;
+    }
+
+    initializeLazy(QUDA_CPU_FIELD_LOCATION);
+
+    // the halo cannot be deeper than the neighboring local lattice
+    int depth = out.size();
+    for (int d=0; d<4; d++) if (comm_dim_partitioned(d) && commDim[d]) depth = std::min(depth, in.X(d));
+    if (matrix_powers && (matrix_powers->Depth() < depth || !matrix_powers->Matches(commDim))) {
+      delete matrix_powers;
+      matrix_powers = nullptr;
+    }
+    if (!matrix_powers) matrix_powers = createMatrixPowers(*Y_h, *X_h, kappa, depth, commDim);
+
+    (*matrix_powers)(out, in, dagger == QUDA_DAG_YES);
+    flops += matrix_powers->Flops();
+  }
+
+  void DiracCoarse::SolveDomain(ColorSpinorField &x, const ColorSpinorField &b, int overlap, int niter,
+				double omega) const
+  {
+    if (b.Ndim() == 5 && b.X(4) != 1) errorQuda("Multiple right-hand sides not supported");
+    if (b.SiteSubset() != QUDA_FULL_SITE_SUBSET) errorQuda("Overlapping domains require the full operator");
+    if (x.Location() == QUDA_CUDA_FIELD_LOCATION || b.Location() == QUDA_CUDA_FIELD_LOCATION)
+      errorQuda("Overlapping domains are solved on the host, device fields are not supported");
+
+    initializeLazy(QUDA_CPU_FIELD_LOCATION);
+
+    // the domains overlap in every partitioned dimension, regardless
+    // of the communication pattern of this operator
+    const int depth = overlap + 1;
+    if (schwarz_domain && schwarz_domain->Depth() != depth) {
+      delete schwarz_domain;
+      schwarz_domain = nullptr;
+    }
+    if (!schwarz_domain) {
+      const int commDimAll[QUDA_MAX_DIM] = { 1, 1, 1, 1 };
+      schwarz_domain = createMatrixPowers(*Y_h, *X_h, kappa, depth, commDimAll);
+    }
+
+    const bool host = x.FieldOrder() == QUDA_SPACE_SPIN_COLOR_FIELD_ORDER && b.FieldOrder() == QUDA_SPACE_SPIN_COLOR_FIELD_ORDER &&
+      x.Precision() >= QUDA_SINGLE_PRECISION && b.Precision() >= QUDA_SINGLE_PRECISION;
+
+    if (host) {
+      schwarz_domain->solveDomain(x, b, overlap, niter, omega, dagger == QUDA_DAG_YES);
+    } else {
+      // stage fields in another order or precision
+      ColorSpinorParam param(b);
+      param.location = QUDA_CPU_FIELD_LOCATION;
+      param.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+      param.create = QUDA_NULL_FIELD_CREATE;
+      param.setPrecision(b.Precision() == QUDA_DOUBLE_PRECISION ? QUDA_DOUBLE_PRECISION : QUDA_SINGLE_PRECISION);
+      ColorSpinorField *x_h = ColorSpinorField::Create(param);
+      ColorSpinorField *b_h = ColorSpinorField::Create(param);
+
+      *b_h = b;
+      schwarz_domain->solveDomain(*x_h, *b_h, overlap, niter, omega, dagger == QUDA_DAG_YES);
+      x = *x_h;
+
+      delete b_h;
+      delete x_h;
+    }
+
+    flops += schwarz_domain->Flops();
+  }
+
   void DiracCoarse::MdagM(ColorSpinorField &out, const ColorSpinorField &in) const
   {
     bool reset1 = newTmp(&tmp1, in);
@@ -296,12 +722,27 @@ namespace quda {
   void DiracCoarse::createCoarseOp(GaugeField &Y, GaugeField &X, const Transfer &T, double kappa, double mass, double mu, double mu_factor) const
   {
     double a = 2.0 * kappa * mu * T.Vectors().TwistFlavor();
-    if (checkLocation(Y, X) == QUDA_CPU_FIELD_LOCATION) {
-      initializeLazy(QUDA_CPU_FIELD_LOCATION);
-      CoarseCoarseOp(Y, X, T, *(this->Y_h), *(this->X_h), *(this->Xinv_h), kappa, a, mu_factor, QUDA_COARSE_DIRAC, QUDA_MATPC_INVALID);
+    const QudaFieldLocation location = checkLocation(Y, X);
+    initializeLazy(location);
+
+    const GaugeField &Y_c = location == QUDA_CPU_FIELD_LOCATION ?
+      static_cast<const GaugeField&>(*(this->Y_h)) : static_cast<const GaugeField&>(*(this->Y_d));
+    const GaugeField &X_c = location == QUDA_CPU_FIELD_LOCATION ?
+      static_cast<const GaugeField&>(*(this->X_h)) : static_cast<const GaugeField&>(*(this->X_d));
+    const GaugeField &Xinv_c = location == QUDA_CPU_FIELD_LOCATION ?
+      static_cast<const GaugeField&>(*(this->Xinv_h)) : static_cast<const GaugeField&>(*(this->Xinv_d));
+
+    if (Y_c.Precision() != Y.Precision()) {
+      // links stored in a lower precision are expanded to the precision of the coarser operator
+      GaugeField *Y_ = createLinks(Y_c, Y.Precision());
+      GaugeField *X_ = createLinks(X_c, Y.Precision());
+      GaugeField *Xinv_ = createLinks(Xinv_c, Y.Precision());
+      CoarseCoarseOp(Y, X, T, *Y_, *X_, *Xinv_, kappa, a, mu_factor, QUDA_COARSE_DIRAC, QUDA_MATPC_INVALID);
+      delete Y_;
+      delete X_;
+      delete Xinv_;
     } else {
-      initializeLazy(QUDA_CUDA_FIELD_LOCATION);
-      CoarseCoarseOp(Y, X, T, *(this->Y_d), *(this->X_d), *(this->Xinv_d), kappa, a, mu_factor, QUDA_COARSE_DIRAC, QUDA_MATPC_INVALID);
+      CoarseCoarseOp(Y, X, T, Y_c, X_c, Xinv_c, kappa, a, mu_factor, QUDA_COARSE_DIRAC, QUDA_MATPC_INVALID);
     }
   }
 
@@ -476,12 +917,27 @@ namespace quda {
   void DiracCoarsePC::createCoarseOp(GaugeField &Y, GaugeField &X, const Transfer &T, double kappa, double mass, double mu, double mu_factor) const
   {
     double a = -2.0 * kappa * mu * T.Vectors().TwistFlavor();
-    if (checkLocation(Y, X) == QUDA_CPU_FIELD_LOCATION) {
-      initializeLazy(QUDA_CPU_FIELD_LOCATION);
-      CoarseCoarseOp(Y, X, T, *(this->Yhat_h), *(this->X_h), *(this->Xinv_h), kappa, a, -mu_factor, QUDA_COARSEPC_DIRAC, matpcType);
+    const QudaFieldLocation location = checkLocation(Y, X);
+    initializeLazy(location);
+
+    const GaugeField &Yhat_c = location == QUDA_CPU_FIELD_LOCATION ?
+      static_cast<const GaugeField&>(*(this->Yhat_h)) : static_cast<const GaugeField&>(*(this->Yhat_d));
+    const GaugeField &X_c = location == QUDA_CPU_FIELD_LOCATION ?
+      static_cast<const GaugeField&>(*(this->X_h)) : static_cast<const GaugeField&>(*(this->X_d));
+    const GaugeField &Xinv_c = location == QUDA_CPU_FIELD_LOCATION ?
+      static_cast<const GaugeField&>(*(this->Xinv_h)) : static_cast<const GaugeField&>(*(this->Xinv_d));
+
+    if (Yhat_c.Precision() != Y.Precision()) {
+      // links stored in a lower precision are expanded to the precision of the coarser operator
+      GaugeField *Y_ = createLinks(Yhat_c, Y.Precision());
+      GaugeField *X_ = createLinks(X_c, Y.Precision());
+      GaugeField *Xinv_ = createLinks(Xinv_c, Y.Precision());
+      CoarseCoarseOp(Y, X, T, *Y_, *X_, *Xinv_, kappa, a, -mu_factor, QUDA_COARSEPC_DIRAC, matpcType);
+      delete Y_;
+      delete X_;
+      delete Xinv_;
     } else {
-      initializeLazy(QUDA_CUDA_FIELD_LOCATION);
-      CoarseCoarseOp(Y, X, T, *(this->Yhat_d), *(this->X_d), *(this->Xinv_d), kappa, a, -mu_factor, QUDA_COARSEPC_DIRAC, matpcType);
+      CoarseCoarseOp(Y, X, T, Yhat_c, X_c, Xinv_c, kappa, a, -mu_factor, QUDA_COARSEPC_DIRAC, matpcType);
     }
   }
 
@@ -42,7 +42,7 @@ namespace quda {
     long long bytes() const
     {
      return (dslash||clover) * out.Bytes() + dslash*8*inA.Bytes() + clover*inB.Bytes() +
-       nSrc*nParity*(dslash*Y.Bytes()*Y.VolumeCB()/(2*Y.Stride()) + clover*X.Bytes()/2);
+       nParity*(dslash*(Y.Bytes()+Y.RowMaxBytes())*Y.VolumeCB()/(2*Y.Stride()) + clover*(X.Bytes()+X.RowMaxBytes())/2); // links are shared by the sources
     }
     unsigned int sharedBytesPerThread() const { return (sizeof(complex<Float>) * Mc); }
     unsigned int sharedBytesPerBlock(const TuneParam &param) const { return 0; }
@@ -568,6 +568,22 @@ namespace quda {
           } else if (halo_precision == QUDA_QUARTER_PRECISION) {
             ApplyCoarse<float,short,char>(out, inA, inB, Y, X, kappa, parity, dslash, clover,
                                           dagger, comms ? DSLASH_FULL : DSLASH_INTERIOR, halo_location);
+          } else if (halo_precision == QUDA_SINGLE_PRECISION) {
+            ApplyCoarse<float,short,float>(out, inA, inB, Y, X, kappa, parity, dslash, clover,
+                                           dagger, comms ? DSLASH_FULL : DSLASH_INTERIOR, halo_location);
+          } else {
+            errorQuda("Halo precision %d not supported with field precision %d and link precision %d", halo_precision, precision, Y.Precision());
+          }
+        } else if (Y.Precision() == QUDA_QUARTER_PRECISION) {
+          if (halo_precision == QUDA_QUARTER_PRECISION) {
+            ApplyCoarse<float,char,char>(out, inA, inB, Y, X, kappa, parity, dslash, clover,
+                                         dagger, comms ? DSLASH_FULL : DSLASH_INTERIOR, halo_location);
+          } else if (halo_precision == QUDA_HALF_PRECISION) {
+            ApplyCoarse<float,char,short>(out, inA, inB, Y, X, kappa, parity, dslash, clover,
+                                          dagger, comms ? DSLASH_FULL : DSLASH_INTERIOR, halo_location);
+          } else if (halo_precision == QUDA_SINGLE_PRECISION) {
+            ApplyCoarse<float,char,float>(out, inA, inB, Y, X, kappa, parity, dslash, clover,
+                                          dagger, comms ? DSLASH_FULL : DSLASH_INTERIOR, halo_location);
           } else {
             errorQuda("Halo precision %d not supported with field precision %d and link precision %d", halo_precision, precision, Y.Precision());
           }
@@ -752,8 +768,8 @@ namespace quda {
      int nParity = dslash.inA.SiteSubset();
      return (dslash.dslash||dslash.clover) * dslash.out.Bytes() +
        dslash.dslash*8*dslash.inA.Bytes() + dslash.clover*dslash.inB.Bytes() +
-       nParity*(dslash.dslash*dslash.Y.Bytes()*dslash.Y.VolumeCB()/(2*dslash.Y.Stride())
-		+ dslash.clover*dslash.X.Bytes()/2);
+       nParity*(dslash.dslash*(dslash.Y.Bytes()+dslash.Y.RowMaxBytes())*dslash.Y.VolumeCB()/(2*dslash.Y.Stride())
+		+ dslash.clover*(dslash.X.Bytes()+dslash.X.RowMaxBytes())/2);
      // multiply Y by volume / stride to correct for pad
    }
   };
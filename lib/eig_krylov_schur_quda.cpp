@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include <quda_internal.h>
+#include <color_spinor_field.h>
+#include <blas_quda.h>
+#include <util_quda.h>
+#include <krylov_schur_quda.h>
+
+#include <memory>
+#include <limits>
+#include <algorithm>
+
+#include <Eigen/Dense>
+
+namespace quda {
+
+  using namespace blas;
+  using Eigen::MatrixXcd;
+
+  BlockKrylovSchur::BlockKrylovSchur(const DiracMatrix &mat, int nev, int ncv, int block_size, double tol,
+                                     int max_restarts, const char *target, TimeProfile &profile) :
+    mat(mat), profile(profile), nev(nev), ncv(ncv), block_size(block_size), tol(tol),
+    max_restarts(max_restarts), n_matvec(0)
+  {
+    if (nev < 1) errorQuda("Invalid number of eigenpairs %d", nev);
+    if (block_size < 1 || ncv % block_size != 0)
+      errorQuda("Search space dimension ncv = %d is not a multiple of the block size %d", ncv, block_size);
+    if (ncv < nev + 2*block_size)
+      errorQuda("Search space dimension ncv = %d must be at least nev + 2*block_size = %d", ncv, nev + 2*block_size);
+    if (!target || strlen(target) != 2 || !strchr("SL", target[0]) || !strchr("MRI", target[1]))
+      errorQuda("Invalid selection criterion %s", target ? target : "(null)");
+    strcpy(this->target, target);
+  }
+
+  bool BlockKrylovSchur::precedes(const Complex &a, const Complex &b) const
+  {
+    const double x = target[1] == 'M' ? std::abs(a) : target[1] == 'R' ? a.real() : a.imag();
+    const double y = target[1] == 'M' ? std::abs(b) : target[1] == 'R' ? b.real() : b.imag();
+    return target[0] == 'S' ? x < y : x > y;
+  }
+
+  void BlockKrylovSchur::random(ColorSpinorField &v, int seed) const
+  {
+    if (v.Location() == QUDA_CPU_FIELD_LOCATION) v.Source(QUDA_RANDOM_SOURCE);
+    else spinorNoise(v, seed, QUDA_NOISE_UNIFORM);
+  }
+
+  void BlockKrylovSchur::orthonormalize(std::vector<ColorSpinorField*> &W, std::vector<ColorSpinorField*> &V,
+                                        int n, Complex *h, int ld) const
+  {
+    const int b = W.size();
+
+    // norms before orthogonalization, to detect an invariant subspace
+    std::vector<double> norm0(b);
+    for (int l = 0; l < b; l++) norm0[l] = sqrt(norm2(*W[l]));
+
+    if (n > 0) {
+      std::vector<ColorSpinorField*> V_(V.begin(), V.begin() + n);
+      std::unique_ptr<Complex[]> c(new Complex[n * b]);
+
+      // two passes of batched classical Gram-Schmidt against the basis
+      for (int pass = 0; pass < 2; pass++) {
+        cDotProduct(c.get(), V_, W);
+        for (int i = 0; i < n; i++) {
+          for (int l = 0; l < b; l++) {
+            h[i + l*ld] += c[i*b + l];
+            c[i*b + l] = -c[i*b + l];
+          }
+        }
+        caxpy(c.get(), V_, W);
+      }
+    }
+
+    // modified Gram-Schmidt within the block
+    for (int l = 0; l < b; l++) {
+      for (int p = 0; p < l; p++) {
+        Complex r = cDotProduct(*W[p], *W[l]);
+        caxpy(-r, *W[p], *W[l]);
+        h[n + p + l*ld] += r;
+      }
+
+      double norm = sqrt(norm2(*W[l]));
+      if (norm > sqrt(std::numeric_limits<double>::epsilon()) * norm0[l]) {
+        h[n + l + l*ld] = norm;
+      } else {
+        // the basis spans an invariant subspace: continue it with a random vector
+        if (getVerbosity() >= QUDA_VERBOSE) printfQuda("BlockKrylovSchur: invariant subspace of dimension %d\n", n + l);
+        h[n + l + l*ld] = 0.0;
+        random(*W[l], n + l);
+
+        std::vector<ColorSpinorField*> U(V.begin(), V.begin() + n);
+        U.insert(U.end(), W.begin(), W.begin() + l);
+        std::vector<ColorSpinorField*> w_;
+        w_.push_back(W[l]);
+        std::unique_ptr<Complex[]> c(new Complex[U.size()]);
+        for (int pass = 0; pass < 2; pass++) {
+          cDotProduct(c.get(), U, w_);
+          for (unsigned int i = 0; i < U.size(); i++) c[i] = -c[i];
+          caxpy(c.get(), U, w_);
+        }
+        norm = sqrt(norm2(*W[l]));
+      }
+      ax(1.0/norm, *W[l]);
+    }
+  }
+
+  /**
+     @brief Exchange the adjacent eigenvalues k and k+1 of the Schur
+     form H = Q T Q^dag with a Givens rotation, as LAPACK ztrexc
+   */
+  static void swapSchur(MatrixXcd &T, MatrixXcd &Q, int k)
+  {
+    const Complex t11 = T(k,k), t22 = T(k+1,k+1);
+
+    // eigenvector of the 2x2 block belonging to t22
+    Complex v0 = T(k,k+1), v1 = t22 - t11;
+    const double nv = sqrt(std::norm(v0) + std::norm(v1));
+    if (nv == 0.0) return;
+    v0 /= nv;
+    v1 /= nv;
+
+    Eigen::Matrix2cd G;
+    G << std::conj(v0), std::conj(v1), -v1, v0;
+
+    T.middleRows(k, 2) = G * T.middleRows(k, 2);
+    T.middleCols(k, 2) = T.middleCols(k, 2) * G.adjoint();
+    Q.middleCols(k, 2) = Q.middleCols(k, 2) * G.adjoint();
+
+    T(k,k) = t22;
+    T(k+1,k+1) = t11;
+    T(k+1,k) = 0.0;
+  }
+
+  int BlockKrylovSchur::operator()(std::vector<ColorSpinorField*> &evecs, Complex *evals, double *residua)
+  {
+    const int m = ncv;
+    const int b = block_size;
+
+    if ((int)evecs.size() < nev) errorQuda("Expected %d eigenvector fields, got %lu", nev, evecs.size());
+
+    profile.TPSTART(QUDA_PROFILE_INIT);
+
+    ColorSpinorParam csParam(*evecs[0]);
+    csParam.create = QUDA_ZERO_FIELD_CREATE;
+
+    // Krylov basis followed by the residual block that continues it
+    std::vector<ColorSpinorField*> V(m + b);
+    for (auto &v : V) v = ColorSpinorField::Create(csParam);
+
+    // Schur vectors kept over a restart
+    std::vector<ColorSpinorField*> Vrot(m - b);
+    for (auto &v : Vrot) v = ColorSpinorField::Create(csParam);
+
+    std::unique_ptr<ColorSpinorField> tmp1(ColorSpinorField::Create(csParam));
+    std::unique_ptr<ColorSpinorField> tmp2(ColorSpinorField::Create(csParam));
+
+    profile.TPSTOP(QUDA_PROFILE_INIT);
+    profile.TPSTART(QUDA_PROFILE_COMPUTE);
+
+    n_matvec = 0;
+
+    // projected operator: A V[0,m) = V[0,m+b) H
+    MatrixXcd H = MatrixXcd::Zero(m + b, m);
+    MatrixXcd T, Q, S;
+
+    // random starting block
+    {
+      std::vector<ColorSpinorField*> V0(V.begin(), V.begin() + b);
+      for (int l = 0; l < b; l++) random(*V0[l], 1234 + l);
+      MatrixXcd R = MatrixXcd::Zero(b, b);
+      orthonormalize(V0, V, 0, R.data(), b);
+    }
+
+    const double eps23 = pow(std::numeric_limits<double>::epsilon(), 2.0/3.0);
+
+    int k = 0; // number of Schur vectors kept over the last restart
+    int nconv = 0;
+    int restart = 0;
+
+    while (true) {
+
+      // block Arnoldi expansion of the basis from k to m
+      for (int j = k; j < m; j += b) {
+        std::vector<ColorSpinorField*> Vj(V.begin() + j, V.begin() + j + b);
+        std::vector<ColorSpinorField*> W(V.begin() + j + b, V.begin() + j + 2*b);
+        mat(W, Vj, *tmp1, *tmp2);
+        n_matvec += b;
+        orthonormalize(W, V, j + b, &H(0, j), m + b);
+      }
+
+      // Schur form of the projected operator, wanted eigenvalues first
+      Eigen::ComplexSchur<MatrixXcd> schur(H.topRows(m));
+      T = schur.matrixT();
+      Q = schur.matrixU();
+      for (int p = 0; p < m; p++) {
+        int i = p;
+        for (int t = p + 1; t < m; t++) if (precedes(T(t,t), T(i,i))) i = t;
+        for (int s = i - 1; s >= p; s--) swapSchur(T, Q, s);
+      }
+
+      // coupling of the Schur vectors to the residual block
+      S = H.bottomRows(b) * Q;
+
+      nconv = 0;
+      while (nconv < nev && S.col(nconv).norm() < tol * std::max(std::abs(T(nconv,nconv)), eps23)) nconv++;
+
+      if (getVerbosity() >= QUDA_VERBOSE)
+        printfQuda("BlockKrylovSchur: restart %d, %d converged, lowest unconverged residual %e\n", restart, nconv,
+                   nconv < nev ? S.col(nconv).norm() : 0.0);
+
+      if (nconv >= nev) break;
+      if (restart == max_restarts) {
+        warningQuda("BlockKrylovSchur: %d of %d eigenpairs converged after %d restarts", nconv, nev, restart);
+        break;
+      }
+
+      // keep half of the unwanted space, such that the expansion fills whole blocks
+      int kk = nev + (m - nev) / 2;
+      kk += (m - kk) % b;
+
+      // rotate the basis onto the kept Schur vectors
+      std::vector<ColorSpinorField*> Vm(V.begin(), V.begin() + m);
+      std::vector<ColorSpinorField*> Vr(Vrot.begin(), Vrot.begin() + kk);
+      std::unique_ptr<Complex[]> q(new Complex[m * kk]);
+      for (int i = 0; i < m; i++)
+        for (int l = 0; l < kk; l++) q[i * kk + l] = Q(i, l);
+      for (auto &v : Vr) zero(*v);
+      caxpy(q.get(), Vm, Vr);
+      for (int l = 0; l < kk; l++) std::swap(V[l], Vrot[l]);
+
+      // the residual block continues the basis
+      for (int l = 0; l < b; l++) std::swap(V[kk + l], V[m + l]);
+
+      H.setZero();
+      H.topLeftCorner(kk, kk) = T.topLeftCorner(kk, kk);
+      H.block(kk, 0, b, kk) = S.leftCols(kk);
+      // converged Schur vectors are deflated from the residual block
+      H.block(kk, 0, b, nconv).setZero();
+
+      k = kk;
+      restart++;
+    }
+
+    // eigenvectors of the leading triangular block by back substitution
+    MatrixXcd Y = MatrixXcd::Zero(nev, nev);
+    for (int i = 0; i < nev; i++) {
+      Y(i, i) = 1.0;
+      for (int r = i - 1; r >= 0; r--) {
+        Complex sum = 0.0;
+        for (int c = r + 1; c <= i; c++) sum += T(r, c) * Y(c, i);
+        Complex d = T(r, r) - T(i, i);
+        if (std::abs(d) < std::numeric_limits<double>::epsilon() * std::abs(T(i, i))) d = std::numeric_limits<double>::epsilon();
+        Y(r, i) = -sum / d;
+      }
+    }
+    Y = Q.leftCols(nev) * Y;
+
+    std::vector<ColorSpinorField*> Vm(V.begin(), V.begin() + m);
+    std::vector<ColorSpinorField*> X(evecs.begin(), evecs.begin() + nev);
+    std::unique_ptr<Complex[]> y(new Complex[m * nev]);
+    for (int i = 0; i < m; i++)
+      for (int l = 0; l < nev; l++) y[i * nev + l] = Y(i, l);
+    for (auto &x : X) zero(*x);
+    caxpy(y.get(), Vm, X);
+
+    // Rayleigh quotients and residua, applying the operator a block at a time
+    for (int i = 0; i < nev; i += b) {
+      const int nb = std::min(b, nev - i);
+      std::vector<ColorSpinorField*> Xi(X.begin() + i, X.begin() + i + nb);
+      std::vector<ColorSpinorField*> AXi(V.begin(), V.begin() + nb);
+      for (auto &x : Xi) ax(1.0/sqrt(norm2(*x)), *x);
+      mat(AXi, Xi, *tmp1, *tmp2);
+      n_matvec += nb;
+      for (int l = 0; l < nb; l++) {
+        evals[i + l] = cDotProduct(*Xi[l], *AXi[l]);
+        if (residua) {
+          caxpy(-evals[i + l], *Xi[l], *AXi[l]);
+          residua[i + l] = sqrt(norm2(*AXi[l]));
+        }
+      }
+    }
+
+    for (auto &v : V) delete v;
+    for (auto &v : Vrot) delete v;
+
+    profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+
+    if (getVerbosity() >= QUDA_SUMMARIZE) {
+      printfQuda("BlockKrylovSchur: %d of %d eigenpairs converged after %d restarts, %lld operator applications\n",
+                 nconv, nev, restart, n_matvec);
+      if (getVerbosity() >= QUDA_VERBOSE)
+        for (int i = 0; i < nev; i++)
+          printfQuda("Eigenvalue %d: (%1.12e, %1.12e) Residual: %1.12e\n", i, evals[i].real(), evals[i].imag(),
+                     residua ? residua[i] : 0.0);
+    }
+
+    return nconv;
+  }
+
+} // namespace quda
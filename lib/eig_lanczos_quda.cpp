@@ -12,6 +12,11 @@
 #include <lanczos_quda.h>
 
 #include <iostream>
+#include <memory>
+#include <limits>
+#include <algorithm>
+
+#include <Eigen/Dense>
 
 namespace quda {
 
@@ -91,17 +96,258 @@ namespace quda {
     return;
   }
   
-#if 0
   ImpRstLanczos::ImpRstLanczos(RitzMat &ritz_mat, QudaEigParam &eigParam, TimeProfile &profile) :
-    Eig_Solver(eigParam, profile), ritz_mat(ritz_mat)
+    Eig_Solver(eigParam, profile), mat(ritz_mat.Mat()), n_matvec(0)
+  { }
+
+  ImpRstLanczos::ImpRstLanczos(DiracMatrix &mat, QudaEigParam &eigParam, TimeProfile &profile) :
+    Eig_Solver(eigParam, profile), mat(mat), n_matvec(0)
   { }
 
   ImpRstLanczos::~ImpRstLanczos()
   { }
 
+  void ImpRstLanczos::apply(ColorSpinorField &out, ColorSpinorField &in, ColorSpinorField &t1, ColorSpinorField &t2)
+  {
+    using namespace blas;
+
+    if (eigParam.NPoly < 1) {
+      mat(out, in);
+      n_matvec++;
+      return;
+    }
+
+    // x = c1 A + c0 maps [a,b] onto [-1,1], with x > 1 below a
+    const double a = pow(eigParam.MatPoly_param[0], 2);
+    const double b = pow(eigParam.MatPoly_param[1] + fabs(eigParam.eigen_shift), 2);
+    const double c1 = 2.0 / (a - b);
+    const double c0 = -(a + b) / (a - b);
+
+    // T_0 = in, T_1 = x in, T_{k+1} = 2 x T_k - T_{k-1}
+    copy(t2, in);
+    mat(t1, in);
+    axpby(c0, in, c1, t1);
+    n_matvec++;
+
+    if (eigParam.NPoly == 1) {
+      copy(out, t1);
+      return;
+    }
+
+    for (int k = 2; k <= eigParam.NPoly; k++) {
+      mat(out, t1);
+      axpby(2.0*c0, t1, 2.0*c1, out);
+      axpy(-1.0, t2, out);
+      n_matvec++;
+
+      if (k < eigParam.NPoly) {
+        copy(t2, t1);
+        copy(t1, out);
+      }
+    }
+  }
+
+  void ImpRstLanczos::orthogonalize(ColorSpinorField &w, std::vector<ColorSpinorField*> &V, int n)
+  {
+    if (n == 0) return;
+
+    std::vector<ColorSpinorField*> V_(V.begin(), V.begin() + n);
+    std::vector<ColorSpinorField*> w_;
+    w_.push_back(&w);
+    std::unique_ptr<Complex[]> c(new Complex[n]);
+
+    // two passes restore orthogonality to working precision
+    for (int pass = 0; pass < 2; pass++) {
+      blas::cDotProduct(c.get(), V_, w_);
+      for (int i = 0; i < n; i++) c[i] = -c[i];
+      blas::caxpy(c.get(), V_, w_);
+    }
+  }
+
+  void ImpRstLanczos::operator()(std::vector<ColorSpinorField*> &V, ColorSpinorField &r, double *evals,
+                                 double *residua, int nlock)
+  {
+    using namespace blas;
+    using namespace Eigen;
+
+    const int m = V.size();
+    const int nk = eigParam.nk;
+    const double tol = eigParam.Stp_residual;
+    // with the polynomial filter the wanted modes are the largest ones of T_N(x(A))
+    const bool filter = eigParam.NPoly > 0;
+
+    if (nk < 1 || nk >= m) errorQuda("Thick-restart Lanczos requires 0 < nk = %d < m = %d", nk, m);
+    if (nlock < 0 || nlock > nk) errorQuda("Invalid number of converged vectors %d", nlock);
+
+    profile.TPSTART(QUDA_PROFILE_INIT);
+
+    ColorSpinorParam csParam(r);
+    csParam.create = QUDA_ZERO_FIELD_CREATE;
+    std::unique_ptr<ColorSpinorField> w(ColorSpinorField::Create(csParam));
+    std::unique_ptr<ColorSpinorField> t1(ColorSpinorField::Create(csParam));
+    std::unique_ptr<ColorSpinorField> t2(ColorSpinorField::Create(csParam));
+
+    // number of Ritz vectors kept over a restart
+    const int keep = std::min(nk + (m - nk) / 2, m - 1);
+    std::vector<ColorSpinorField*> Vrot(keep);
+    for (auto &v : Vrot) v = ColorSpinorField::Create(csParam);
+
+    std::vector<double> alpha(m), beta(m), theta(m), s(m);
+
+    profile.TPSTOP(QUDA_PROFILE_INIT);
+    profile.TPSTART(QUDA_PROFILE_COMPUTE);
+
+    n_matvec = 0;
+
+    // the starting vector is taken orthogonal to the converged vectors
+    orthogonalize(r, V, nlock);
+    double rnorm = sqrt(norm2(r));
+    if (rnorm == 0.0) errorQuda("Starting vector is zero or within the span of the converged vectors");
+    ax(1.0/rnorm, r);
+    copy(*V[nlock], r);
+
+    int k = nlock; // dimension of the basis kept over the last restart (locked and Ritz vectors)
+    int restart = 0;
+
+    while (true) {
+
+      // Lanczos expansion of the basis from k to m
+      for (int j = k; j < m; j++) {
+        apply(*w, *V[j], *t1, *t2);
+
+        if (j == k && k > nlock) {
+          // the first new vector couples to all of the kept Ritz vectors
+          std::vector<ColorSpinorField*> Vk(V.begin() + nlock, V.begin() + k);
+          std::vector<ColorSpinorField*> w_;
+          w_.push_back(w.get());
+          std::unique_ptr<Complex[]> c(new Complex[k - nlock]);
+          for (int i = nlock; i < k; i++) c[i - nlock] = -s[i];
+          caxpy(c.get(), Vk, w_);
+        } else if (j > nlock) {
+          axpy(-beta[j-1], *V[j-1], *w);
+        }
+
+        alpha[j] = reDotProduct(*V[j], *w);
+        axpy(-alpha[j], *V[j], *w);
+
+        // full reorthogonalization, which also deflates the locked vectors
+        orthogonalize(*w, V, j + 1);
+
+        beta[j] = sqrt(norm2(*w));
+        if (beta[j] == 0.0) errorQuda("Lanczos breakdown at basis dimension %d", j + 1);
+        ax(1.0/beta[j], *w);
+        copy(j + 1 < m ? *V[j+1] : r, *w);
+      }
+
+      // Rayleigh-Ritz on the unlocked part: arrowhead block of the
+      // kept Ritz vectors followed by the tridiagonal Lanczos block
+      const int n = m - nlock;
+      MatrixXd T = MatrixXd::Zero(n, n);
+      for (int i = nlock; i < k; i++) {
+        T(i - nlock, i - nlock) = theta[i];
+        T(i - nlock, k - nlock) = s[i];
+        T(k - nlock, i - nlock) = s[i];
+      }
+      for (int j = k; j < m; j++) {
+        T(j - nlock, j - nlock) = alpha[j];
+        if (j + 1 < m) {
+          T(j - nlock, j + 1 - nlock) = beta[j];
+          T(j + 1 - nlock, j - nlock) = beta[j];
+        }
+      }
+
+      SelfAdjointEigenSolver<MatrixXd> eig(T);
+      const VectorXd &lambda = eig.eigenvalues();
+      const MatrixXd &Y = eig.eigenvectors();
+
+      // wanted Ritz pairs first
+      std::vector<int> idx(n);
+      for (int i = 0; i < n; i++) idx[i] = filter ? n - 1 - i : i;
+
+      // lock the leading wanted pairs that have converged
+      int nconv = 0;
+      while (nlock + nconv < nk) {
+        const int i = idx[nconv];
+        const double res = fabs(beta[m-1] * Y(n-1, i));
+        if (res > tol * std::max(fabs(lambda(i)), fabs(lambda(idx[0])) * std::numeric_limits<double>::epsilon())) break;
+        nconv++;
+      }
+
+      if (getVerbosity() >= QUDA_VERBOSE)
+        printfQuda("ImpRstLanczos: restart %d, %d converged, lowest unconverged residual %e\n", restart,
+                   nlock + nconv, nlock + nconv < nk ? fabs(beta[m-1] * Y(n-1, idx[nconv])) : 0.0);
+
+      // thick restart: rotate the basis onto the wanted Ritz vectors
+      const int kk = keep - nlock;
+      std::vector<ColorSpinorField*> Vn(V.begin() + nlock, V.end());
+      std::vector<ColorSpinorField*> Vr(Vrot.begin(), Vrot.begin() + kk);
+      std::unique_ptr<Complex[]> Yk(new Complex[n * kk]);
+      for (int i = 0; i < n; i++)
+        for (int l = 0; l < kk; l++) Yk[i * kk + l] = Y(i, idx[l]);
+      if (kk > 0) {
+        for (auto &v : Vr) zero(*v);
+        caxpy(Yk.get(), Vn, Vr);
+      }
+      for (int l = 0; l < kk; l++) {
+        copy(*V[nlock + l], *Vr[l]);
+        theta[nlock + l] = lambda(idx[l]);
+        // locked pairs are decoupled from the rest of the basis
+        s[nlock + l] = l < nconv ? 0.0 : beta[m-1] * Y(n-1, idx[l]);
+      }
+
+      nlock += nconv;
+      k = keep;
+
+      if (nlock >= nk) break;
+      if (restart == eigParam.max_restarts) {
+        warningQuda("ImpRstLanczos: %d of %d eigenpairs converged after %d restarts", nlock, nk, restart);
+        break;
+      }
+
+      // the residual vector continues the basis
+      copy(*V[k], r);
+      restart++;
+    }
+
+    // eigenvalues and residua with respect to the unfiltered operator
+    for (int i = 0; i < nk; i++) {
+      mat(*w, *V[i]);
+      n_matvec++;
+      evals[i] = reDotProduct(*V[i], *w);
+      axpy(-evals[i], *V[i], *w);
+      residua[i] = sqrt(norm2(*w));
+    }
+
+    // sort in ascending order of the eigenvalues
+    for (int i = 0; i < nk; i++) {
+      int min = i;
+      for (int j = i + 1; j < nk; j++) if (evals[j] < evals[min]) min = j;
+      if (min == i) continue;
+      std::swap(evals[i], evals[min]);
+      std::swap(residua[i], residua[min]);
+      copy(*t1, *V[i]);
+      copy(*V[i], *V[min]);
+      copy(*V[min], *t1);
+    }
+
+    profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+
+    if (getVerbosity() >= QUDA_SUMMARIZE) {
+      printfQuda("ImpRstLanczos: %d eigenpairs after %d restarts, %lld operator applications\n", nk, restart, n_matvec);
+      if (getVerbosity() >= QUDA_VERBOSE)
+        for (int i = 0; i < nk; i++) printfQuda("Eigenvalue %d: %1.12e Residual: %1.12e\n", i, evals[i], residua[i]);
+    }
+
+    profile.TPSTART(QUDA_PROFILE_FREE);
+    for (auto &v : Vrot) delete v;
+    profile.TPSTOP(QUDA_PROFILE_FREE);
+  }
+
   void ImpRstLanczos::operator()(double *alpha, double *beta, cudaColorSpinorField **Eig_Vec,
 				 cudaColorSpinorField &r, cudaColorSpinorField &Apsi, int k0, int m)
-  { }
-#endif
+  {
+    std::vector<ColorSpinorField*> V(Eig_Vec, Eig_Vec + m);
+    (*this)(V, r, alpha, beta, k0);
+  }
 
 } // namespace quda
@@ -18,12 +18,10 @@ namespace quda {
       report("Lanczos solver");
       eig_solver = new Lanczos(ritz_mat, param, profile);
       break;
-#if 0
     case QUDA_IMP_RST_LANCZOS:
-      report("Implicitly restarted Lanczos");
+      report("Thick-restart Lanczos");
       eig_solver = new ImpRstLanczos(ritz_mat, param, profile);
       break;
-#endif
     default:
       errorQuda("Invalid eig solver type");
     }
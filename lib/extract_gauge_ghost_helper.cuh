@@ -64,6 +64,15 @@ namespace quda {
 		if (oddness == parity) {
 #ifdef FINE_GRAINED_ACCESS
 		  for (int i=0; i<gauge::Ncolor(length); i++) {
+		    if (arg.order.RowScaled()) { // the row maximum travels with the row
+		      if (extract) {
+			arg.order.setGhostRowMax(dim, (parity+arg.localParity[dim])&1, indexGhost, i,
+						 arg.order.RowMax(dim+arg.offset, parity, indexCB, i));
+		      } else {
+			arg.order.setRowMax(dim+arg.offset, parity, indexCB, i,
+					    arg.order.GhostRowMax(dim, (parity+arg.localParity[dim])&1, indexGhost, i));
+		      }
+		    }
 		    for (int j=0; j<gauge::Ncolor(length); j++) {
 		      if (extract) {
 			arg.order.Ghost(dim, (parity+arg.localParity[dim])&1, indexGhost, i, j)
@@ -137,6 +146,15 @@ namespace quda {
 #ifdef FINE_GRAINED_ACCESS
       int i = blockIdx.y * blockDim.y + threadIdx.y;
       if (i >= Ncolor(length)) return;
+      if (arg.order.RowScaled()) { // the row maximum travels with the row
+	if (extract) {
+	  arg.order.setGhostRowMax(dim, (parity+arg.localParity[dim])&1, X>>1, i,
+				   arg.order.RowMax(dim+arg.offset, parity, indexCB, i));
+	} else {
+	  arg.order.setRowMax(dim+arg.offset, parity, indexCB, i,
+			      arg.order.GhostRowMax(dim, (parity+arg.localParity[dim])&1, X>>1, i));
+	}
+      }
       for (int j=0; j<gauge::Ncolor(length); j++) {
 	if (extract) {
 	  arg.order.Ghost(dim, (parity+arg.localParity[dim])&1, X>>1, i, j)
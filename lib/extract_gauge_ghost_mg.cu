@@ -88,6 +88,8 @@ namespace quda {
       extractGhostMG(u, (float**)ghost, extract, offset);
     } else if (u.Precision() == QUDA_HALF_PRECISION) {
       extractGhostMG(u, (short**)ghost, extract, offset);
+    } else if (u.Precision() == QUDA_QUARTER_PRECISION) {
+      extractGhostMG(u, (char**)ghost, extract, offset);
     } else {
       errorQuda("Unknown precision type %d", u.Precision());
     }
@@ -22,7 +22,8 @@ namespace quda {
     staggeredPhaseApplied(u.StaggeredPhaseApplied()),
     i_mu(u.iMu()),
     site_offset(u.SiteOffset()),
-    site_size(u.SiteSize())
+    site_size(u.SiteSize()),
+    row_scale(u.RowScaled())
   { }
 
 
@@ -34,10 +35,18 @@ namespace quda {
     anisotropy(param.anisotropy), tadpole(param.tadpole), fat_link_max(0.0),
     create(param.create),
     staggeredPhaseType(param.staggeredPhaseType), staggeredPhaseApplied(param.staggeredPhaseApplied), i_mu(param.i_mu),
-    site_offset(param.site_offset), site_size(param.site_size)
+    site_offset(param.site_offset), site_size(param.site_size),
+    row_scale(param.row_scale && precision <= QUDA_HALF_PRECISION), row_max(nullptr), row_max_bytes(0)
   {
     if (ghost_precision != precision) ghost_precision = precision; // gauge fields require matching precision
 
+    if (row_scale) {
+      if (link_type != QUDA_COARSE_LINKS) errorQuda("Per-row scaling only supported for coarse links");
+      if (order != QUDA_FLOAT2_GAUGE_ORDER && order != QUDA_QDP_GAUGE_ORDER)
+        errorQuda("Per-row scaling not supported for order %d", order);
+      if (create == QUDA_REFERENCE_FIELD_CREATE) errorQuda("Per-row scaling not supported for reference fields");
+    }
+
     if (link_type != QUDA_COARSE_LINKS && nColor != 3)
       errorQuda("nColor must be 3, not %d for this link type", nColor);
     if (nDim != 4)
@@ -116,6 +125,7 @@ namespace quda {
       ghostOffset[i][1] = (bidir ? ghostOffset[i][0] + ghostFace[i]*geometry_comms*nInternal : ghostOffset[i][0]);
 
       ghost_face_bytes[i] = ghostFace[i] * geometry_comms * nInternal * ghost_precision;
+      if (row_scale) ghost_face_bytes[i] += ghostFace[i] * nColor * sizeof(float); // per-row maxima follow the links
       ghost_bytes += (bidir ? 2 : 1 ) * ghost_face_bytes[i]; // factor of two from direction
     }
 
@@ -152,7 +162,8 @@ namespace quda {
     if (precision == QUDA_DOUBLE_PRECISION) {
       if (order  == QUDA_FLOAT2_GAUGE_ORDER) return true;
     } else if (precision == QUDA_SINGLE_PRECISION || 
-	       precision == QUDA_HALF_PRECISION) {
+	       precision == QUDA_HALF_PRECISION ||
+	       precision == QUDA_QUARTER_PRECISION) {
       if (reconstruct == QUDA_RECONSTRUCT_NO) {
 	if (order == QUDA_FLOAT2_GAUGE_ORDER) return true;
       } else if (reconstruct == QUDA_RECONSTRUCT_12 || reconstruct == QUDA_RECONSTRUCT_13) {
@@ -171,7 +182,7 @@ namespace quda {
     MsgHandle *mh_recv[4];
     size_t bytes[4];
 
-    for (int i=0; i<nDimComms; i++) bytes[i] = 2*nFace*surfaceCB[i]*nInternal*precision;
+    for (int i=0; i<nDimComms; i++) bytes[i] = hostGhostBytes(i);
 
     // in general (standard ghost exchange) we always do the exchange
     // even if a dimension isn't partitioned.  However, this breaks
@@ -282,6 +293,7 @@ namespace quda {
     output << "geometry = " << param.geometry << std::endl;
     output << "staggeredPhaseType = " << param.staggeredPhaseType << std::endl;
     output << "staggeredPhaseApplied = " << param.staggeredPhaseApplied << std::endl;
+    output << "row_scale = " << param.row_scale << std::endl;
 
     return output;  // for multiple << operators.
   }
@@ -147,6 +147,12 @@ cudaCloverField *cloverSloppy = nullptr;
 cudaCloverField *cloverPrecondition = nullptr;
 cudaCloverField *cloverRefinement = nullptr;
 
+// fields in the starting precision of adaptive-precision CG, created
+// on first use and aliasing the sloppy or preconditioner fields when
+// these are already in that precision
+cudaGaugeField *gaugeAdaptive = nullptr;
+cudaCloverField *cloverAdaptive = nullptr;
+
 cudaGaugeField *momResident = nullptr;
 cudaGaugeField *extendedGaugeResident = nullptr;
 
@@ -156,6 +162,8 @@ std::vector<cudaColorSpinorField*> solutionResident;
 #define QUDA_MAX_CHRONO 12
 // each entry is one p 
 std::vector< std::vector<ColorSpinorField*> > chronoResident(QUDA_MAX_CHRONO);
+// compressed histories, used instead of the above with chrono_compress
+std::vector<ChronoBasis> chronoCompressed(QUDA_MAX_CHRONO);
 
 // Mapped memory buffer used to hold unitarization failures
 static int *num_failures_h = nullptr;
@@ -187,6 +195,9 @@ static TimeProfile profileInvert("invertQuda");
 //!< Profiler for invertMultiShiftQuda
 static TimeProfile profileMulti("invertMultiShiftQuda");
 
+//!< Profiler for invertTwistedPairQuda
+static TimeProfile profileTwistedPair("invertTwistedPairQuda");
+
 //!< Profiler for computeFatLinkQuda
 static TimeProfile profileFatLink("computeKSLinkQuda");
 
@@ -1205,6 +1216,9 @@ void loadSloppyCloverQuda(QudaPrecision prec_sloppy, QudaPrecision prec_precondi
 void freeSloppyGaugeQuda()
 {
   if (!initialized) errorQuda("QUDA not initialized");
+  if (gaugeAdaptive != gaugeSloppy && gaugeAdaptive != gaugePrecondition && gaugeAdaptive) delete gaugeAdaptive;
+  gaugeAdaptive = nullptr;
+
   if (gaugePrecondition != gaugeRefinement && gaugeRefinement) delete gaugeRefinement;
   if (gaugeSloppy != gaugePrecondition && gaugePrecondition) delete gaugePrecondition;
   if (gaugePrecise != gaugeSloppy && gaugeSloppy) delete gaugeSloppy;
@@ -1374,6 +1388,9 @@ void loadSloppyGaugeQuda(QudaPrecision prec_sloppy, QudaPrecision prec_precondit
 void freeSloppyCloverQuda()
 {
   if (!initialized) errorQuda("QUDA not initialized");
+  if (cloverAdaptive != cloverSloppy && cloverAdaptive != cloverPrecondition && cloverAdaptive) delete cloverAdaptive;
+  cloverAdaptive = nullptr;
+
   if (cloverRefinement != cloverSloppy && cloverRefinement) delete cloverRefinement;
   if (cloverPrecondition != cloverSloppy && cloverPrecondition) delete cloverPrecondition;
   if (cloverSloppy != cloverPrecise && cloverSloppy) delete cloverSloppy;
@@ -1402,6 +1419,13 @@ void flushChronoQuda(int i)
     if (v)  delete v;
   }
   basis.clear();
+
+  chronoCompressed[i].flush();
+}
+
+void flushRecycleQuda()
+{
+  flushRecycleSpaces();
 }
 
 void endQuda(void)
@@ -1414,6 +1438,7 @@ void endQuda(void)
   freeCloverQuda();
 
   for (int i=0; i<QUDA_MAX_CHRONO; i++) flushChronoQuda(i);
+  flushRecycleQuda();
 
   for (auto v : solutionResident) if (v) delete v;
   solutionResident.clear();
@@ -1459,6 +1484,7 @@ void endQuda(void)
     profileDslash.Print();
     profileInvert.Print();
     profileMulti.Print();
+    profileTwistedPair.Print();
     profileFatLink.Print();
     profileGaugeForce.Print();
     profileGaugeUpdate.Print();
@@ -1692,6 +1718,69 @@ namespace quda {
     dRef = Dirac::create(diracRefParam);
   }
 
+  // Replace the preconditioner operator, which CG does not otherwise
+  // use, with the sloppy operator in the starting precision of
+  // adaptive-precision CG, creating the gauge and clover fields in
+  // that precision if they do not yet exist
+  void createDiracAdaptive(Dirac *&dPre, QudaInvertParam &param, const bool pc_solve)
+  {
+    const QudaPrecision prec = param.cuda_prec_adaptive;
+
+    if (param.dslash_type == QUDA_ASQTAD_DSLASH || param.dslash_type == QUDA_STAGGERED_DSLASH)
+      errorQuda("Adaptive precision is not supported for staggered fermions");
+    if (prec < QUDA_HALF_PRECISION)
+      errorQuda("Adaptive precision %d not supported by the fine-grid operators", prec);
+    if (prec > param.cuda_prec_sloppy)
+      errorQuda("Adaptive precision %d exceeds sloppy precision %d", prec, param.cuda_prec_sloppy);
+
+    if (gaugeAdaptive && gaugeAdaptive->Precision() != prec) {
+      if (gaugeAdaptive != gaugeSloppy && gaugeAdaptive != gaugePrecondition) delete gaugeAdaptive;
+      gaugeAdaptive = nullptr;
+    }
+
+    if (!gaugeAdaptive) {
+      if (gaugeSloppy->Precision() == prec) {
+        gaugeAdaptive = gaugeSloppy;
+      } else if (gaugePrecondition->Precision() == prec) {
+        gaugeAdaptive = gaugePrecondition;
+      } else {
+        GaugeFieldParam gauge_param(*gaugeSloppy);
+        gauge_param.setPrecision(prec, true);
+        gauge_param.order = gauge_param.reconstruct == QUDA_RECONSTRUCT_NO ?
+          QUDA_FLOAT2_GAUGE_ORDER : QUDA_FLOAT4_GAUGE_ORDER;
+        gaugeAdaptive = new cudaGaugeField(gauge_param);
+        gaugeAdaptive->copy(*gaugeSloppy);
+      }
+    }
+
+    if (cloverAdaptive && cloverAdaptive->Precision() != prec) {
+      if (cloverAdaptive != cloverSloppy && cloverAdaptive != cloverPrecondition) delete cloverAdaptive;
+      cloverAdaptive = nullptr;
+    }
+
+    if (!cloverAdaptive && cloverSloppy) {
+      if (cloverSloppy->Precision() == prec) {
+        cloverAdaptive = cloverSloppy;
+      } else if (cloverPrecondition->Precision() == prec) {
+        cloverAdaptive = cloverPrecondition;
+      } else {
+        CloverFieldParam clover_param(*cloverSloppy);
+        clover_param.setPrecision(prec);
+        cloverAdaptive = new cudaCloverField(clover_param);
+        cloverAdaptive->copy(*cloverSloppy, clover_param.inverse);
+      }
+    }
+
+    DiracParam diracAdaptiveParam;
+    setDiracParam(diracAdaptiveParam, &param, pc_solve);
+    diracAdaptiveParam.gauge = gaugeAdaptive;
+    diracAdaptiveParam.clover = cloverAdaptive;
+    for (int i=0; i<4; i++) diracAdaptiveParam.commDim[i] = 1; // comms are always on
+
+    delete dPre;
+    dPre = Dirac::create(diracAdaptiveParam);
+  }
+
   static double unscaled_shifts[QUDA_MAX_MULTI_SHIFT];
 
   void massRescale(cudaColorSpinorField &b, QudaInvertParam &param) {
@@ -2402,6 +2491,9 @@ void lanczosQuda(int k0, int m, void *hp_Apsi, void *hp_r, void *hp_V,
   }
   profileInvert.TPSTOP(QUDA_PROFILE_H2D);
 
+  if (eig_param->eig_type == QUDA_IMP_RST_LANCZOS && eig_param->RitzMat_lanczos == QUDA_MATPC_DAG_SOLUTION)
+    errorQuda("Thick-restart Lanczos requires a Hermitian operator");
+
   if(eig_param->RitzMat_lanczos == QUDA_MATPC_DAG_SOLUTION)
   {
     DiracMdag mat(dirac);
@@ -2461,6 +2553,58 @@ void lanczosQuda(int k0, int m, void *hp_Apsi, void *hp_r, void *hp_V,
   profileInvert.TPSTOP(QUDA_PROFILE_TOTAL);
 }
 
+// FNV-1a hash of parameter values, used for the keys of setup
+// checkpoints, deflation spaces and recycled subspaces
+struct Fnv1a {
+  uint64_t key;
+  Fnv1a() : key(0xcbf29ce484222325ull) { }
+
+  void operator()(const void *data, size_t bytes) {
+    for (size_t i=0; i<bytes; i++) key = (key ^ static_cast<const unsigned char*>(data)[i]) * 0x100000001b3ull;
+  }
+
+  template <typename T> void operator()(const T &value) { (*this)(&value, sizeof(value)); }
+};
+
+// key identifying a multigrid setup: the checksum of the gauge field
+// combined with a hash of the parameters that determine the
+// null-space vectors and coarse operators
+static uint64_t multigridSetupKey(const QudaMultigridParam &mg_param, const cudaGaugeField &gauge)
+{
+  Fnv1a hash;
+  const QudaInvertParam &param = *mg_param.invert_param;
+  hash(param.dslash_type);
+  hash(param.kappa);
+  hash(param.mu);
+  hash(param.epsilon);
+  hash(param.twist_flavor);
+  hash(param.clover_coeff);
+  hash(param.matpc_type);
+
+  const int n = mg_param.n_level;
+  hash(mg_param.n_level);
+  hash(mg_param.geo_block_size, n*sizeof(mg_param.geo_block_size[0]));
+  hash(mg_param.spin_block_size, n*sizeof(mg_param.spin_block_size[0]));
+  hash(mg_param.n_vec, n*sizeof(mg_param.n_vec[0]));
+  hash(mg_param.precision_null, n*sizeof(mg_param.precision_null[0]));
+  hash(mg_param.setup_inv_type, n*sizeof(mg_param.setup_inv_type[0]));
+  hash(mg_param.num_setup_iter, n*sizeof(mg_param.num_setup_iter[0]));
+  hash(mg_param.setup_tol, n*sizeof(mg_param.setup_tol[0]));
+  hash(mg_param.setup_maxiter, n*sizeof(mg_param.setup_maxiter[0]));
+  hash(mg_param.setup_location, n*sizeof(mg_param.setup_location[0]));
+  hash(mg_param.coarse_grid_solution_type, n*sizeof(mg_param.coarse_grid_solution_type[0]));
+  hash(mg_param.smoother_solve_type, n*sizeof(mg_param.smoother_solve_type[0]));
+  hash(mg_param.mu_factor, n*sizeof(mg_param.mu_factor[0]));
+  hash(mg_param.setup_type);
+  hash(mg_param.pre_orthonormalize);
+  hash(mg_param.post_orthonormalize);
+  hash(mg_param.compute_null_vector);
+  hash(mg_param.generate_all_levels);
+  hash(mg_param.vec_infile, strlen(mg_param.vec_infile));
+
+  return hash.key ^ gauge.checksum();
+}
+
 multigrid_solver::multigrid_solver(QudaMultigridParam &mg_param, TimeProfile &profile)
   : profile(profile) {
   profile.TPSTART(QUDA_PROFILE_INIT);
@@ -2529,6 +2673,7 @@ multigrid_solver::multigrid_solver(QudaMultigridParam &mg_param, TimeProfile &pr
 
   // fill out the MG parameters for the fine level
   mgParam = new MGParam(mg_param, B, m, mSmooth, mSmoothSloppy);
+  if (strcmp(mg_param.setup_checkpoint,"")!=0) mgParam->checkpoint_key = multigridSetupKey(mg_param, *cudaGauge);
 
   mg = new MG(*mgParam, profile);
   mgParam->updateInvertParam(*param);
@@ -2640,6 +2785,29 @@ void updateMultigridQuda(void *mg_, QudaMultigridParam *mg_param)
   profilerStop(__func__);
 }
 
+// key identifying a deflation space: the checksum of the gauge field
+// combined with a hash of the parameters that determine the
+// deflation operator and the layout of the Ritz vectors
+static uint64_t deflationSpaceKey(const QudaEigParam &eig_param, const cudaGaugeField &gauge)
+{
+  Fnv1a hash;
+  const QudaInvertParam &param = *eig_param.invert_param;
+  hash(param.dslash_type);
+  hash(param.kappa);
+  hash(param.mu);
+  hash(param.epsilon);
+  hash(param.twist_flavor);
+  hash(param.clover_coeff);
+  hash(param.mass);
+  hash(param.m5);
+  hash(param.matpc_type);
+  hash(param.solve_type);
+  hash(param.cuda_prec_ritz);
+  hash(eig_param.location);
+
+  return hash.key ^ gauge.checksum();
+}
+
 deflated_solver::deflated_solver(QudaEigParam &eig_param, TimeProfile &profile)
   : d(nullptr), m(nullptr), RV(nullptr), deflParam(nullptr), defl(nullptr),  profile(profile) {
 
@@ -2699,6 +2867,8 @@ deflated_solver::deflated_solver(QudaEigParam &eig_param, TimeProfile &profile)
   RV = ColorSpinorField::Create(ritzParam);
 
   deflParam = new DeflationParam(eig_param, RV, *m);
+  if (strcmp(eig_param.vec_infile,"")!=0 || strcmp(eig_param.vec_outfile,"")!=0)
+    deflParam->store_key = deflationSpaceKey(eig_param, *cudaGauge);
 
   defl = new Deflation(*deflParam, profile);
 
@@ -2726,10 +2896,66 @@ void destroyDeflationQuda(void *df) {
   delete static_cast<deflated_solver*>(df);
 }
 
-void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
+// key identifying the operator being inverted: the checksum of the
+// gauge field combined with a hash of the operator parameters
+// (op distinguishes M, M^dag and the normal operators)
+static uint64_t operatorKey(const QudaInvertParam &param, const cudaGaugeField &gauge, int op)
 {
-  profilerStart(__func__);
+  Fnv1a hash;
+  hash(op);
+  hash(param.dslash_type);
+  hash(param.twist_flavor);
+  hash(param.matpc_type);
+  hash(param.solve_type);
+  hash(param.dagger);
+  hash(param.cuda_prec_sloppy);
+  hash(gauge.X(), 4*sizeof(int));
+  hash(param.kappa);
+  hash(param.mu);
+  hash(param.epsilon);
+  hash(param.clover_coeff);
+  hash(param.mass);
+  hash(param.m5);
+
+  return hash.key ^ gauge.checksum();
+}
 
+// keys under which GCRO-DR recycles its subspace across calls: the
+// subspace is shared by operators that differ only in their mass
+// parameters or gauge field, while C = A U is recomputed whenever the
+// operator itself changes (op distinguishes M, M^dag and the normal
+// operators, which are inverted on separate subspaces)
+static void setRecycleKeys(SolverParam &solverParam, const QudaInvertParam &param, const cudaGaugeField &gauge, int op)
+{
+  if (param.inv_type != QUDA_GCRODR_INVERTER) return;
+
+  Fnv1a hash;
+  hash(op);
+  hash(param.dslash_type);
+  hash(param.twist_flavor);
+  hash(param.matpc_type);
+  hash(param.solve_type);
+  hash(param.dagger);
+  hash(param.cuda_prec_sloppy);
+  hash(param.nev);
+  hash(gauge.X(), 4*sizeof(int));
+  solverParam.recycle_key = hash.key;
+
+  hash(param.kappa);
+  hash(param.mu);
+  hash(param.epsilon);
+  hash(param.clover_coeff);
+  hash(param.mass);
+  hash(param.m5);
+  solverParam.recycle_op_key = hash.key ^ gauge.checksum();
+}
+
+// invertQuda, additionally returning the solution for -mu in
+// hp_x_pair if that is set.  invertTwistedPairQuda sets it for an
+// unpreconditioned normal-error solve, where M(mu) M(mu)^dag =
+// M(-mu) M(-mu)^dag lets both flavors share one Krylov sequence.
+static void invertQudaWithPair(void *hp_x, void *hp_x_pair, void *hp_b, QudaInvertParam *param)
+{
   if (param->dslash_type == QUDA_DOMAIN_WALL_DSLASH ||
       param->dslash_type == QUDA_DOMAIN_WALL_4D_DSLASH ||
       param->dslash_type == QUDA_MOBIUS_DWF_DSLASH) setKernelPackT(true);
@@ -2772,6 +2998,10 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
   // create the dirac operator
   createDirac(d, dSloppy, dPre, *param, pc_solve);
 
+  // adaptive-precision CG runs its starting phase on the preconditioner operator
+  const bool adaptive = param->inv_type == QUDA_CG_INVERTER && param->cuda_prec_adaptive != QUDA_INVALID_PRECISION;
+  if (adaptive) createDiracAdaptive(dPre, *param, pc_solve);
+
   Dirac &dirac = *d;
   Dirac &diracSloppy = *dSloppy;
   Dirac &diracPre = *dPre;
@@ -2903,6 +3133,16 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
     errorQuda("Chronological forcasting only presently supported for M^dagger M solver");
   }
 
+  if (param->chrono_extrapolation != QUDA_CHRONO_MINRES_EXTRAPOLATION && !param->chrono_compress) {
+    errorQuda("Chronological extrapolation type %d requires chrono_compress", param->chrono_extrapolation);
+  }
+
+  if (hp_x_pair && (param->solve_type != QUDA_NORMERR_SOLVE || param->solution_type != QUDA_MAT_SOLUTION)) {
+    errorQuda("Paired flavor solve with a shared Krylov sequence requires an unpreconditioned normal-error solve");
+  }
+
+  ColorSpinorField *x_pair = nullptr;
+
   profileInvert.TPSTOP(QUDA_PROFILE_PREAMBLE);
 
   if (mat_solution && !direct_solve && !norm_error_solve) { // prepare source: b' = A^dag b
@@ -2911,6 +3151,8 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
   } else if (!mat_solution && direct_solve) { // perform the first of two solves: A^dag y = b
     DiracMdag m(dirac), mSloppy(diracSloppy), mPre(diracPre);
     SolverParam solverParam(*param);
+    setRecycleKeys(solverParam, *param, *cudaGauge, 1);
+    if (adaptive) solverParam.precision_adaptive = param->cuda_prec_adaptive;
     Solver *solve = Solver::create(solverParam, m, mSloppy, mPre, profileInvert);
     (*solve)(*out, *in);
     blas::copy(*in, *out);
@@ -2921,8 +3163,16 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
   if (direct_solve) {
     DiracM m(dirac), mSloppy(diracSloppy), mPre(diracPre);
     SolverParam solverParam(*param);
+    setRecycleKeys(solverParam, *param, *cudaGauge, 0);
+    if (adaptive) solverParam.precision_adaptive = param->cuda_prec_adaptive;
     // chronological forecasting
-    if (param->chrono_use_resident && chronoResident[param->chrono_index].size() > 0) {
+    if (param->chrono_use_resident && param->chrono_compress && chronoCompressed[param->chrono_index].Size() > 0) {
+      profileInvert.TPSTART(QUDA_PROFILE_CHRONO);
+      uint64_t key = param->chrono_extrapolation == QUDA_CHRONO_MINRES_EXTRAPOLATION ? operatorKey(*param, *cudaGauge, 0) : 0;
+      chronoCompressed[param->chrono_index].forecast(*out, *in, mSloppy, param->cuda_prec_sloppy,
+                                                     param->chrono_extrapolation, false, key);
+      profileInvert.TPSTOP(QUDA_PROFILE_CHRONO);
+    } else if (param->chrono_use_resident && chronoResident[param->chrono_index].size() > 0) {
       profileInvert.TPSTART(QUDA_PROFILE_CHRONO);
 
       auto &basis = chronoResident[param->chrono_index];
@@ -2968,9 +3218,17 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
   } else if (!norm_error_solve) {
     DiracMdagM m(dirac), mSloppy(diracSloppy), mPre(diracPre);
     SolverParam solverParam(*param);
+    setRecycleKeys(solverParam, *param, *cudaGauge, 2);
+    if (adaptive) solverParam.precision_adaptive = param->cuda_prec_adaptive;
 
     // chronological forecasting
-    if (param->chrono_use_resident && chronoResident[param->chrono_index].size() > 0) {
+    if (param->chrono_use_resident && param->chrono_compress && chronoCompressed[param->chrono_index].Size() > 0) {
+      profileInvert.TPSTART(QUDA_PROFILE_CHRONO);
+      uint64_t key = param->chrono_extrapolation == QUDA_CHRONO_MINRES_EXTRAPOLATION ? operatorKey(*param, *cudaGauge, 2) : 0;
+      chronoCompressed[param->chrono_index].forecast(*out, *in, mSloppy, param->cuda_prec_sloppy,
+                                                     param->chrono_extrapolation, true, key);
+      profileInvert.TPSTOP(QUDA_PROFILE_CHRONO);
+    } else if (param->chrono_use_resident && chronoResident[param->chrono_index].size() > 0) {
       profileInvert.TPSTART(QUDA_PROFILE_CHRONO);
 
       auto &basis = chronoResident[param->chrono_index];
@@ -3017,9 +3275,17 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
     DiracMMdag m(dirac), mSloppy(diracSloppy), mPre(diracPre);
     cudaColorSpinorField tmp(*out);
     SolverParam solverParam(*param);
+    setRecycleKeys(solverParam, *param, *cudaGauge, 3);
+    if (adaptive) solverParam.precision_adaptive = param->cuda_prec_adaptive;
     Solver *solve = Solver::create(solverParam, m, mSloppy, mPre, profileInvert);
     (*solve)(tmp, *in); // y = (M M^\dag) b
     dirac.Mdag(*out, tmp);  // x = M^dag y
+    if (hp_x_pair) { // x' = M(-mu)^dag y
+      x_pair = new cudaColorSpinorField(*out);
+      dirac.flipMu();
+      dirac.Mdag(*x_pair, tmp);
+      dirac.flipMu();
+    }
     solverParam.updateInvertParam(*param);
     delete solve;
   }
@@ -3039,26 +3305,36 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
     if (i >= QUDA_MAX_CHRONO)
       errorQuda("Requested chrono index %d is outside of max %d\n", i, QUDA_MAX_CHRONO);
 
-    auto &basis = chronoResident[i];
-
-    if(param->chrono_max_dim < (int)basis.size()){
-      errorQuda("Requested chrono_max_dim %i is smaller than already existing chroology %i",param->chrono_max_dim,(int)basis.size());
-    }
+    if (param->chrono_compress) {
+      // only a Hermitian operator allows the projected matrix to be extended in place
+      DiracMatrix *mSloppy = direct_solve ? static_cast<DiracMatrix*>(new DiracM(diracSloppy)) : new DiracMdagM(diracSloppy);
+      const int op = direct_solve ? 0 : 2;
+      uint64_t key = param->chrono_extrapolation == QUDA_CHRONO_MINRES_EXTRAPOLATION ? operatorKey(*param, *cudaGauge, op) : 0;
+      chronoCompressed[i].push(*out, param->chrono_max_dim, param->chrono_replace_last, param->chrono_precision,
+                               param->chrono_extrapolation, *mSloppy, param->cuda_prec_sloppy, !direct_solve, key);
+      delete mSloppy;
+    } else {
+      auto &basis = chronoResident[i];
 
-    if(not param->chrono_replace_last){
-      // if we have not filled the space yet just augment
-      if ((int)basis.size() < param->chrono_max_dim) {
-        ColorSpinorParam cs_param(*out);
-        cs_param.setPrecision(param->chrono_precision);
-        basis.emplace_back(ColorSpinorField::Create(cs_param));
+      if(param->chrono_max_dim < (int)basis.size()){
+        errorQuda("Requested chrono_max_dim %i is smaller than already existing chroology %i",param->chrono_max_dim,(int)basis.size());
       }
 
-      // shuffle every entry down one and bring the last to the front
-      ColorSpinorField *tmp = basis[basis.size()-1];
-      for (unsigned int j=basis.size()-1; j>0; j--) basis[j] = basis[j-1];
-        basis[0] = tmp;
+      if(not param->chrono_replace_last){
+        // if we have not filled the space yet just augment
+        if ((int)basis.size() < param->chrono_max_dim) {
+          ColorSpinorParam cs_param(*out);
+          cs_param.setPrecision(param->chrono_precision);
+          basis.emplace_back(ColorSpinorField::Create(cs_param));
+        }
+
+        // shuffle every entry down one and bring the last to the front
+        ColorSpinorField *tmp = basis[basis.size()-1];
+        for (unsigned int j=basis.size()-1; j>0; j--) basis[j] = basis[j-1];
+          basis[0] = tmp;
+      }
+      *(basis[0]) = *out; // set first entry to new solution
     }
-    *(basis[0]) = *out; // set first entry to new solution
   }
   dirac.reconstruct(*x, *b, param->solution_type);
 
@@ -3074,6 +3350,17 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
     profileInvert.TPSTOP(QUDA_PROFILE_D2H);
   }
 
+  if (x_pair) {
+    profileInvert.TPSTART(QUDA_PROFILE_D2H);
+    if (param->solver_normalization == QUDA_SOURCE_NORMALIZATION) blas::ax(sqrt(nb), *x_pair);
+    cpuParam.v = hp_x_pair;
+    ColorSpinorField *h_x_pair = ColorSpinorField::Create(cpuParam);
+    *h_x_pair = *x_pair;
+    delete h_x_pair;
+    delete x_pair;
+    profileInvert.TPSTOP(QUDA_PROFILE_D2H);
+  }
+
   profileInvert.TPSTART(QUDA_PROFILE_EPILOGUE);
 
   if (param->compute_action) {
@@ -3112,7 +3399,82 @@ void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
   saveTuneCache();
 
   profileInvert.TPSTOP(QUDA_PROFILE_TOTAL);
+}
 
+void invertQuda(void *hp_x, void *hp_b, QudaInvertParam *param)
+{
+  profilerStart(__func__);
+  invertQudaWithPair(hp_x, nullptr, hp_b, param);
+  profilerStop(__func__);
+}
+
+void invertTwistedPairQuda(void *hp_x_plus, void *hp_x_minus, void *hp_b, QudaInvertParam *param)
+{
+  profilerStart(__func__);
+
+  if (param->dslash_type != QUDA_TWISTED_MASS_DSLASH && param->dslash_type != QUDA_TWISTED_CLOVER_DSLASH)
+    errorQuda("Paired flavor solve requires a twisted dslash type, not %d", param->dslash_type);
+  if (param->twist_flavor != QUDA_TWIST_SINGLET)
+    errorQuda("Paired flavor solve requires a single-flavor twist, not %d", param->twist_flavor);
+
+  pushVerbosity(param->verbosity);
+  profileTwistedPair.TPSTART(QUDA_PROFILE_TOTAL);
+
+  const double mu = param->mu;
+  int iter[2] = { };
+  double secs = 0.0;
+  double gflops = 0.0;
+
+  if (param->solve_type == QUDA_NORMERR_SOLVE && param->solution_type == QUDA_MAT_SOLUTION) {
+    // one solve on M M^dag, shared by both flavors
+    invertQudaWithPair(hp_x_plus, hp_x_minus, hp_b, param);
+    iter[0] = param->iter;
+    secs = param->secs;
+    gflops = param->gflops;
+
+    if (getVerbosity() >= QUDA_SUMMARIZE)
+      printfQuda("Paired flavor solve: +mu and -mu from one Krylov sequence of %d iterations (two separate solves need twice that)\n",
+                 iter[0]);
+  } else {
+    // otherwise solve in turn: only a multigrid hierarchy, whose
+    // coarse operators are flipped in place, is shared, while each
+    // flavor does its own gauge field loads and dslash applications
+    multigrid_solver *mg = param->inv_type_precondition == QUDA_MG_INVERTER ?
+      static_cast<multigrid_solver*>(param->preconditioner) : nullptr;
+
+    for (int flavor=0; flavor<2; flavor++) {
+      if (flavor == 1) {
+        param->mu = -mu;
+        if (mg) {
+          profileTwistedPair.TPSTART(QUDA_PROFILE_PREAMBLE);
+          mg->mg->flipMu();
+          profileTwistedPair.TPSTOP(QUDA_PROFILE_PREAMBLE);
+        }
+      }
+
+      invertQuda(flavor == 0 ? hp_x_plus : hp_x_minus, hp_b, param);
+      iter[flavor] = param->iter;
+      secs += param->secs;
+      gflops += param->gflops;
+    }
+
+    param->mu = mu;
+    if (mg) mg->mg->flipMu();
+
+    if (getVerbosity() >= QUDA_SUMMARIZE)
+      printfQuda("Paired flavor solve: %d iterations for +mu, %d for -mu, hierarchy flipped in %g secs\n",
+                 iter[0], iter[1], mg ? profileTwistedPair.Last(QUDA_PROFILE_PREAMBLE) : 0.0);
+  }
+
+  param->iter = iter[0] + iter[1];
+  param->secs = secs;
+  param->gflops = gflops;
+
+  profileTwistedPair.TPSTOP(QUDA_PROFILE_TOTAL);
+  if (getVerbosity() >= QUDA_SUMMARIZE)
+    printfQuda("Paired flavor solve: wall time %g secs\n", profileTwistedPair.Last(QUDA_PROFILE_TOTAL));
+
+  popVerbosity();
   profilerStop(__func__);
 }
 
@@ -3506,10 +3868,12 @@ void invertMultiShiftQuda(void **_hp_x, void *_hp_b, QudaInvertParam *param)
   bool pc_solve = (param->solve_type == QUDA_DIRECT_PC_SOLVE) || (param->solve_type == QUDA_NORMOP_PC_SOLVE);
   bool mat_solution = (param->solution_type == QUDA_MAT_SOLUTION) || (param->solution_type ==  QUDA_MATPC_SOLUTION);
   bool direct_solve = (param->solve_type == QUDA_DIRECT_SOLVE) || (param->solve_type == QUDA_DIRECT_PC_SOLVE);
+  bool staggered = param->dslash_type == QUDA_ASQTAD_DSLASH || param->dslash_type == QUDA_STAGGERED_DSLASH;
 
+  // for Wilson-type fermions BiCGstab solves the shifted systems M + offset directly
+  bool bicgstab = !staggered && param->inv_type == QUDA_BICGSTAB_INVERTER;
 
-  if (param->dslash_type == QUDA_ASQTAD_DSLASH ||
-      param->dslash_type == QUDA_STAGGERED_DSLASH) {
+  if (staggered) {
 
     if (param->solution_type != QUDA_MATPC_SOLUTION) {
       errorQuda("For Staggered-type fermions, multi-shift solver only suports MATPC solution type");
@@ -3519,6 +3883,15 @@ void invertMultiShiftQuda(void **_hp_x, void *_hp_b, QudaInvertParam *param)
       errorQuda("For Staggered-type fermions, multi-shift solver only supports DIRECT_PC solve types");
     }
 
+  } else if (bicgstab) { // Wilson type, direct solve
+
+    if (!mat_solution || !direct_solve) {
+      errorQuda("For Wilson-type fermions, multi-shift BiCGstab only supports MAT or MATPC solution and DIRECT or DIRECT_PC solve types");
+    }
+    if (pc_solution != pc_solve) {
+      errorQuda("For Wilson-type fermions, multi-shift BiCGstab requires a PC solve_type for a PC solution_type and vice versa");
+    }
+
   } else { // Wilson type
 
     if (mat_solution) {
@@ -3659,8 +4032,7 @@ void invertMultiShiftQuda(void **_hp_x, void *_hp_b, QudaInvertParam *param)
 
   DiracMatrix *m, *mSloppy;
 
-  if (param->dslash_type == QUDA_ASQTAD_DSLASH ||
-      param->dslash_type == QUDA_STAGGERED_DSLASH) {
+  if (staggered || bicgstab) {
     m = new DiracM(dirac);
     mSloppy = new DiracM(diracSloppy);
   } else {
@@ -3669,8 +4041,13 @@ void invertMultiShiftQuda(void **_hp_x, void *_hp_b, QudaInvertParam *param)
   }
 
   SolverParam solverParam(*param);
-  MultiShiftCG cg_m(*m, *mSloppy, solverParam, profileMulti);
-  cg_m(x, *b, p, r2_old.get());
+  if (bicgstab) {
+    MultiShiftBiCGstab bicgstab_m(*m, *mSloppy, solverParam, profileMulti);
+    bicgstab_m(x, *b);
+  } else {
+    MultiShiftCG cg_m(*m, *mSloppy, solverParam, profileMulti);
+    cg_m(x, *b, p, r2_old.get());
+  }
   solverParam.updateInvertParam(*param);
 
   delete m;
@@ -3723,8 +4100,7 @@ void invertMultiShiftQuda(void **_hp_x, void *_hp_b, QudaInvertParam *param)
 
         DiracMatrix *m, *mSloppy;
 
-        if (param->dslash_type == QUDA_ASQTAD_DSLASH ||
-            param->dslash_type == QUDA_STAGGERED_DSLASH) {
+        if (staggered || bicgstab) {
           m = new DiracM(dirac);
           mSloppy = new DiracM(diracSloppy);
         } else {
@@ -3786,9 +4162,13 @@ void invertMultiShiftQuda(void **_hp_x, void *_hp_b, QudaInvertParam *param)
 	solverParam.tol_hq = param->tol_hq_offset[i]; // set heavy quark tolerance
         solverParam.delta = param->reliable_delta_refinement;
 
-        {
+        if (bicgstab) {
+          BiCGstab bicg(*m, *mSloppy, *mSloppy, solverParam, profileMulti);
+          bicg(*x[i], *b);
+        } else {
           CG cg(*m, *mSloppy, solverParam, profileMulti);
-          if (i==0)
+          // a deflated guess leaves the true residual off the multi-shift Krylov sequence
+          if (i==0 && !param->deflation_op)
             cg(*x[i], *b, p[i], r2_old[i]);
           else
             cg(*x[i], *b);
@@ -5084,6 +5464,8 @@ void invert_multishift_quda_(void *h_x, void *hp_b, QudaInvertParam *param) {
 
 void flush_chrono_quda_(int *index) { flushChronoQuda(*index); }
 
+void flush_recycle_quda_() { flushRecycleQuda(); }
+
 void register_pinned_quda_(void *ptr, size_t *bytes) {
   cudaHostRegister(ptr, *bytes, cudaHostRegisterDefault);
   checkCudaError();
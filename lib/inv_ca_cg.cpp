@@ -1,5 +1,6 @@
 #include <invert_quda.h>
 #include <blas_quda.h>
+#include <comm_quda.h>
 #include <Eigen/Dense>
 
 /**
@@ -8,16 +9,16 @@
    Implementation of the communication -avoiding CG algorithm.  Based
    on the description here:
    http://research.nvidia.com/sites/default/files/pubs/2016-04_S-Step-and-Communication-Avoiding/nvr-2016-003.pdf
+
+   The Chebyshev basis and the adaptive choice of the basis size
+   follow Carson, "Communication-Avoiding Krylov Subspace Methods in
+   Theory and Practice", PhD thesis, UC Berkeley (2015).
 */
 
 namespace quda {
 
-  enum Basis {
-    POWER_BASIS,
-    INVALID_BASIS
-  };
-
-  const static Basis basis = POWER_BASIS;
+  // number of CG iterations used to estimate the spectrum for the Chebyshev basis
+  static const int lanczos_warmup_iter = 20;
 
   CACG::CACG(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile)
     : Solver(param, profile), mat(mat), matSloppy(matSloppy), init(false),
@@ -36,7 +37,7 @@ namespace quda {
       bool use_source = (param.preserve_source == QUDA_PRESERVE_SOURCE_NO &&
                          param.precision == param.precision_sloppy &&
                          param.use_init_guess == QUDA_USE_INIT_GUESS_NO);
-      if (basis == POWER_BASIS) {
+      if (param.ca_basis == QUDA_POWER_BASIS) {
         for (int i=0; i<param.Nkrylov+1; i++) if (i>0 || !use_source) delete r[i];
       } else {
         for (int i=0; i<param.Nkrylov; i++) if (i>0 || !use_source) delete r[i];
@@ -64,7 +65,7 @@ namespace quda {
       alpha = new Complex[param.Nkrylov];
       beta = new Complex[param.Nkrylov*param.Nkrylov];
       phi = new Complex[param.Nkrylov];
-      W = new Complex[param.Nkrylov*(param.Nkrylov+1)];
+      W = new Complex[param.Nkrylov*(param.Nkrylov+1) + param.Nkrylov*param.Nkrylov];
       C = new Complex[param.Nkrylov*param.Nkrylov];
 
       bool mixed = param.precision != param.precision_sloppy;
@@ -83,7 +84,7 @@ namespace quda {
       // now allocate sloppy fields
       csParam.setPrecision(param.precision_sloppy);
 
-      if (basis == POWER_BASIS) {
+      if (param.ca_basis == QUDA_POWER_BASIS) {
         // in power basis q[k] = r[k+1], so we don't need a separate q array
         r.resize(param.Nkrylov+1);
         q.resize(param.Nkrylov);
@@ -114,7 +115,7 @@ namespace quda {
     } // init
   }
 
-  void CACG::compute_alpha(Complex *psi_, Complex *A_, Complex *phi_)
+  int CACG::compute_alpha(Complex *psi_, Complex *A_, Complex *phi_, int n, double cond_max, int &n_next)
   {
     if (!param.is_preconditioner) {
       profile.TPSTOP(QUDA_PROFILE_COMPUTE);
@@ -126,18 +127,48 @@ namespace quda {
     typedef Matrix<Complex, Dynamic, Dynamic, RowMajor> matrix;
     typedef Matrix<Complex, Dynamic, 1> vector;
 
-    const int N = q.size();
-    Map<matrix> A(W,N,N);
-    Map<vector> phi(phi_,N), psi(psi_,N);
+    Map<matrix> A(A_,n,n);
+    Map<vector> phi(phi_,n);
+
+    // equilibrate the Gram matrix so its condition number measures
+    // the linear dependence of the basis rather than its scaling
+    VectorXd d(n);
+    for (int i=0; i<n; i++) d(i) = A(i,i).real() > 0.0 ? 1.0/sqrt(A(i,i).real()) : 0.0;
+    matrix A_eq = d.asDiagonal() * A * d.asDiagonal();
+
+    // condition number of the leading m x m blocks
+    std::vector<double> cond(n+1, 1.0);
+    for (int m=2; m<=n; m++) {
+      SelfAdjointEigenSolver<matrix> eig(A_eq.topLeftCorner(m,m), EigenvaluesOnly);
+      double lambda_min = eig.eigenvalues()(0), lambda_max = eig.eigenvalues()(m-1);
+      cond[m] = lambda_min > 0.0 ? lambda_max / lambda_min : std::numeric_limits<double>::infinity();
+    }
 
-    JacobiSVD<matrix> svd(A, ComputeThinU | ComputeThinV);
-    psi = svd.solve(phi);
+    // use the largest leading part of the basis that is well conditioned
+    int m = n;
+    while (m > 1 && !(cond[m] <= cond_max)) m--;
+
+    // shrink the next basis if this one was truncated, and grow it if
+    // the condition number extrapolated to one more vector is acceptable
+    if (m < n) n_next = m;
+    else if (n < param.Nkrylov && (n == 1 || cond[n] * (cond[n] / cond[n-1]) <= cond_max)) n_next = n+1;
+    else n_next = n;
+
+    if (getVerbosity() >= QUDA_DEBUG_VERBOSE)
+      printfQuda("CA-CG: basis size %d, Gram condition number %e, using %d vectors\n", n, cond[n], m);
+
+    vector psi_eq = JacobiSVD<matrix>(A_eq.topLeftCorner(m,m), ComputeThinU | ComputeThinV).solve(d.head(m).asDiagonal() * phi.head(m));
+    Map<vector> psi(psi_,n);
+    psi.setZero();
+    psi.head(m) = d.head(m).asDiagonal() * psi_eq;
 
     if (!param.is_preconditioner) {
       profile.TPSTOP(QUDA_PROFILE_EIGEN);
       param.secs += profile.Last(QUDA_PROFILE_EIGEN);
       profile.TPSTART(QUDA_PROFILE_COMPUTE);
     }
+
+    return m;
   }
 
   void CACG::compute_beta(Complex *psi_, Complex *A_, Complex *phi_)
@@ -166,12 +197,70 @@ namespace quda {
     }
   }
 
+  int CACG::lanczos_warmup(ColorSpinorField &x, ColorSpinorField &r, int n)
+  {
+    ColorSpinorField &p_ = *p[0];
+    ColorSpinorField &Ap = *q[0];
+    ColorSpinorField &tmpSloppy = tmp_sloppy ? *tmp_sloppy : *tmpp;
+    ColorSpinorField &tmpSloppy2 = tmp_sloppy2 ? *tmp_sloppy2 : *tmpp2;
+
+    std::vector<ColorSpinorField*> P, X;
+    P.push_back(&p_);
+    X.push_back(&x);
+
+    std::vector<double> alpha_(n), beta_(n);
+    double r2 = blas::norm2(r);
+    blas::copy(p_, r);
+
+    int k = 0;
+    while (k < n && r2 > 0.0) {
+      matSloppy(Ap, p_, tmpSloppy, tmpSloppy2);
+      double pAp = blas::reDotProduct(p_, Ap);
+      if (pAp <= 0.0) break; // operator is not positive definite in this direction
+      alpha_[k] = r2 / pAp;
+
+      Complex a = alpha_[k];
+      blas::caxpy(&a, P, X);
+      double r2_new = blas::axpyNorm(-alpha_[k], Ap, r);
+      beta_[k] = r2_new / r2;
+      r2 = r2_new;
+      blas::xpay(r, beta_[k], p_);
+      k++;
+    }
+
+    if (k == 0) errorQuda("CA-CG: spectrum estimation failed");
+
+    // the Lanczos tridiagonal matrix from the CG coefficients
+    using namespace Eigen;
+    MatrixXd T = MatrixXd::Zero(k,k);
+    for (int j=0; j<k; j++) {
+      T(j,j) = 1.0/alpha_[j] + (j>0 ? beta_[j-1]/alpha_[j-1] : 0.0);
+      if (j<k-1) T(j,j+1) = T(j+1,j) = sqrt(beta_[j]) / alpha_[j];
+    }
+    SelfAdjointEigenSolver<MatrixXd> eig(T, EigenvaluesOnly);
+
+    // the Ritz values converge to the extremal eigenvalues from the
+    // inside; the largest converges fast so a small margin suffices,
+    // while an underestimated lower bound only weakens the basis
+    if (param.ca_lambda_min <= 0.0) param.ca_lambda_min = eig.eigenvalues()(0);
+    param.ca_lambda_max = 1.1 * eig.eigenvalues()(k-1);
+
+    if (getVerbosity() >= QUDA_VERBOSE)
+      printfQuda("CA-CG: estimated spectral bounds [%e, %e] from %d iterations\n", param.ca_lambda_min, param.ca_lambda_max, k);
+
+    return k;
+  }
+
   /*
     The main CA-CG algorithm, which consists of three main steps:
-    1. Build basis vectors q_k = A p_k for k = 1..Nkrlylov
+    1. Build basis vectors q_k = A p_k for k = 1..s, s <= Nkrylov
     2. Steepest descent minmization of the residual in this basis
     3. Update solution and residual vectors
     4. (Optional) restart if convergence or maxiter not reached
+
+    All the inner products of step 2 are computed locally and summed
+    in a single global reduction.  The basis size s is adapted to the
+    condition number of the resulting Gram matrix.
   */
   void CACG::operator()(ColorSpinorField &x, ColorSpinorField &b)
   {
@@ -257,13 +346,46 @@ namespace quda {
 
     blas::copy(*r[0], r_); // no op if uni-precision
 
+    // the Chebyshev basis needs the spectral bounds of the operator,
+    // which we estimate from a short CG run unless they were given
+    if (param.ca_basis == QUDA_CHEBYSHEV_BASIS && param.ca_lambda_max <= 0.0 && r2 > 0.0) {
+      total_iter += lanczos_warmup(x, *r[0], std::min(lanczos_warmup_iter, param.maxiter));
+
+      mat(r_, x, tmp, tmp2);
+      r2 = blas::xmyNorm(b, r_);
+      blas::copy(*r[0], r_);
+      r2_old = r2;
+    }
+
+    // the Chebyshev polynomials are shifted and scaled to the interval [lambda_min, lambda_max]
+    const double theta = 0.5 * (param.ca_lambda_max + param.ca_lambda_min);
+    const double delta = 0.5 * (param.ca_lambda_max - param.ca_lambda_min);
+    if (param.ca_basis == QUDA_CHEBYSHEV_BASIS && r2 > 0.0 && delta <= 0.0)
+      errorQuda("Invalid Chebyshev basis interval [%e, %e]", param.ca_lambda_min, param.ca_lambda_max);
+
+    // maximum acceptable condition number of the basis, depending on the sloppy precision
+    const double epsilon = param.precision_sloppy == QUDA_DOUBLE_PRECISION ? std::numeric_limits<double>::epsilon() :
+      param.precision_sloppy == QUDA_SINGLE_PRECISION ? std::numeric_limits<float>::epsilon() : pow(2.0, -11);
+    const double cond_max = 1e-2 / epsilon;
+
+    int s = nKrylov; // size of the current basis
+
     PrintStats("CA-CG", total_iter, r2, b2, heavy_quark_res);
     while ( !convergence(r2, heavy_quark_res, stop, param.tol_hq) && total_iter < param.maxiter) {
 
-      // build up a space of size nKrylov
-      for (int k=0; k<nKrylov; k++) {
+      // build up a space of size s
+      for (int k=0; k<s; k++) {
         matSloppy(*q[k], *r[k], tmpSloppy, tmpSloppy2);
-        if (k<nKrylov-1 && basis != POWER_BASIS) blas::copy(*r[k+1], *q[k]);
+        if (k<s-1 && param.ca_basis == QUDA_CHEBYSHEV_BASIS) {
+          // r_{k+1} = T_{k+1}((A - theta) / delta) r_0
+          if (k == 0) {
+            blas::copy(*r[1], *q[0]);
+            blas::axpby(-theta/delta, *r[0], 1.0/delta, *r[1]);
+          } else {
+            blas::zero(*r[k+1]);
+            blas::caxpbypczpw(2.0/delta, *q[k], -2.0*theta/delta, *r[k], -1.0, *r[k-1], *r[k+1]);
+          }
+        }
       }
 
       // for now just copy R into P since the beta computation is
@@ -271,7 +393,7 @@ namespace quda {
       // steepest descent between them
       if (total_iter == 0 || 1) {
         // first iteration P = R
-        for (int i=0; i<nKrylov; i++) *p[i] = *r[i];
+        for (int i=0; i<s; i++) *p[i] = *r[i];
       } else {
 
         // compute the beta coefficients for updating P
@@ -289,32 +411,55 @@ namespace quda {
       }
 
       // compute the alpha coefficients
-      // 1. Compute W = Q^\dagger P and phi = P^\dagger r
+      // 1. Compute W = P^\dagger Q, phi = P^\dagger r and, for the
+      //    residual estimate, Q^\dagger Q in a single reduction
       // 2. Solve W alpha = phi
+      int m = s;
+      double r2_est = 0.0;
       {
-        /*
-          // optimization we can make once we have p A-orthogonality fixed
-          std::vector<ColorSpinorField*> Q;
-          for (int i=0; i<nKrylov; i++) Q.push_back(q[i]);
-          Q.push_back(r[0]);
-
-          // only a single reduction but requires using the full dot product
-          // compute rhs vector phi = P* r = (p_i, r)
-          // Construct the matrix P* Q = P* (A R) = (p_i, q_j) = (p_i, A r_j)
-          //blas::cDotProduct(W, q, Q);
-        */
-        blas::cDotProduct(W, q, p);
-        std::vector<ColorSpinorField*> R;
-        R.push_back(r[0]);
-        blas::cDotProduct(phi, p, R);
+        std::vector<ColorSpinorField*> P(p.begin(), p.begin()+s);
+        std::vector<ColorSpinorField*> Q(q.begin(), q.begin()+s);
+        std::vector<ColorSpinorField*> QR(Q);
+        QR.push_back(r[0]);
+
+        Complex *G = W; // (p_i, q_j) and (p_i, r) with leading dimension s+1
+        Complex *QQ = W + s*(s+1);
+
+        const bool global_reduction = commGlobalReduction();
+        commGlobalReductionSet(false);
+        blas::cDotProduct(G, P, QR);
+        if (!fixed_iteration) blas::cDotProduct(QQ, Q, Q);
+        commGlobalReductionSet(global_reduction);
+        reduceDoubleArray(reinterpret_cast<double*>(W), 2*(s*(s+1) + (!fixed_iteration ? s*s : 0)));
+
+        std::vector<Complex> A(s*s);
+        for (int i=0; i<s; i++) {
+          for (int j=0; j<s; j++) A[i*s+j] = G[i*(s+1)+j];
+          phi[i] = G[i*(s+1)+s];
+        }
 
-        compute_alpha(alpha, W, phi);
-      }
+        int s_next;
+        m = compute_alpha(alpha, A.data(), phi, s, cond_max, s_next);
+
+        // estimate |r - Q alpha|^2 from the Gram matrices, using p_0 = r
+        if (!fixed_iteration) {
+          Complex rQa = 0.0, aQQa = 0.0;
+          for (int i=0; i<m; i++) {
+            rQa += G[i] * alpha[i];
+            for (int j=0; j<m; j++) aQQa += conj(alpha[i]) * QQ[i*s+j] * alpha[j];
+          }
+          r2_est = std::max(phi[0].real() - 2.0 * rQa.real() + aQQa.real(), 0.0);
+        }
 
-      // update the solution vector
-      std::vector<ColorSpinorField*> X;
-      X.push_back(&x);
-      blas::caxpy(alpha, p, X);
+        // update the solution vector
+        std::vector<ColorSpinorField*> X;
+        X.push_back(&x);
+        P.resize(m);
+        blas::caxpy(alpha, P, X);
+        total_iter += s;
+
+        if (!fixed_iteration) s = s_next;
+      }
 
       // no need to compute residual vector if not returning residual
       // vector and only doing a single fixed iteration
@@ -327,7 +472,8 @@ namespace quda {
         else blas::xpay(b, -1.0, *r[0]);
       }
 
-      total_iter+=nKrylov;
+      // the Gram estimate saves a reduction when we do not print the true norm
+      if (!fixed_iteration && getVerbosity() < QUDA_VERBOSE) r2 = r2_est;
 
       PrintStats("CA-CG", total_iter, r2, b2, heavy_quark_res);
 
@@ -358,7 +504,7 @@ namespace quda {
 	  restart++; // restarting if residual is still too great
 
 	  PrintStats("CA-CG (restart)", restart, r2, b2, heavy_quark_res);
-          blas::copy(*p[0], r_);
+          blas::copy(*r[0], r_);
 
 	  r2_old = r2;
 
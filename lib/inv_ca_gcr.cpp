@@ -155,7 +155,8 @@ namespace quda {
 
   /*
     The main CA-GCR algorithm, which consists of three main steps:
-    1. Build basis vectors q_k = A p_k for k = 1..Nkrlylov
+    1. Build basis vectors q_k = A p_k for k = 1..Nkrlylov, using the
+       matrix-powers kernel of the operator in the power basis
     2. Minimize the residual in this basis
     3. Update solution and residual vectors
     4. (Optional) restart if convergence or maxiter not reached
@@ -246,9 +247,14 @@ namespace quda {
     while ( !convergence(r2, heavy_quark_res, stop, param.tol_hq) && total_iter < param.maxiter) {
 
       // build up a space of size nKrylov
-      for (int k=0; k<nKrylov; k++) {
-        matSloppy(*q[k], *p[k], tmpSloppy);
-        if (k<nKrylov-1 && basis != POWER_BASIS) blas::copy(*p[k+1], *q[k]);
+      if (basis == POWER_BASIS) {
+        // q[k] = A^{k+1} p[0], so the matrix-powers kernel can be used where available
+        matSloppy.powers(q, *p[0], tmpSloppy);
+      } else {
+        for (int k=0; k<nKrylov; k++) {
+          matSloppy(*q[k], *p[k], tmpSloppy);
+          if (k<nKrylov-1) blas::copy(*p[k+1], *q[k]);
+        }
       }
 
       solve(alpha, q, *p[0]);
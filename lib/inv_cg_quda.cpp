@@ -4,6 +4,8 @@
 #include <limits>
 #include <memory>
 #include <iostream>
+#include <string>
+#include <algorithm>
 
 #ifdef BLOCKSOLVER
 #include <Eigen/Dense>
@@ -21,13 +23,40 @@ namespace quda {
   CG::CG(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile) :
     Solver(param, profile), mat(mat), matSloppy(matSloppy), yp(nullptr), rp(nullptr),
     rnewp(nullptr), pp(nullptr), App(nullptr), tmpp(nullptr), tmp2p(nullptr), tmp3p(nullptr),
-    rSloppyp(nullptr), xSloppyp(nullptr), init(false)
+    rSloppyp(nullptr), xSloppyp(nullptr), init(false), matLow(nullptr), cg_low(nullptr), adaptive(false),
+    stagnation_exit(false), j_stagnated(-1), r2_old_stagnated(0.0), iter_adaptive(0)
   {
 
   }
 
+  CG::CG(DiracMatrix &mat, DiracMatrix &matSloppy, DiracMatrix &matLow, SolverParam &param, TimeProfile &profile) :
+    CG(mat, matSloppy, param, profile)
+  {
+    if (param.precision_adaptive == QUDA_INVALID_PRECISION)
+      errorQuda("Adaptive-precision CG requires precision_adaptive to be set");
+    if (param.precision_adaptive > param.precision_sloppy)
+      errorQuda("Adaptive precision %d exceeds sloppy precision %d", param.precision_adaptive, param.precision_sloppy);
+    if (param.use_alternative_reliable)
+      errorQuda("Adaptive-precision CG is not supported with alternative reliable updates");
+    if (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL)
+      errorQuda("Adaptive-precision CG is not supported with the heavy-quark residual");
+    if (param.pipeline || param.solution_accumulator_pipeline > 1)
+      errorQuda("Adaptive-precision CG is not supported with pipelining");
+
+    this->matLow = &matLow;
+
+    // the starting phase only differs in its sloppy operator and precision
+    param_low = param;
+    param_low.precision_sloppy = param.precision_adaptive;
+    param_low.precision_adaptive = QUDA_INVALID_PRECISION;
+    param_low.compute_true_res = false;
+    cg_low = new CG(mat, matLow, param_low, profile);
+    cg_low->stagnation_exit = true;
+  }
+
   CG::~CG() {
     profile.TPSTART(QUDA_PROFILE_FREE);
+    if (cg_low) delete cg_low;
     if ( init ) {
       for (auto pi : p) if (pi) delete pi;
       if (rp) delete rp;
@@ -197,12 +226,74 @@ namespace quda {
 
   }
 
+  static const char *precisionName(QudaPrecision precision) {
+    switch (precision) {
+    case QUDA_QUARTER_PRECISION: return "quarter";
+    case QUDA_HALF_PRECISION: return "half";
+    case QUDA_SINGLE_PRECISION: return "single";
+    case QUDA_DOUBLE_PRECISION: return "double";
+    default: return "invalid";
+    }
+  }
+
+  void CG::adaptiveSolve(ColorSpinorField &x, ColorSpinorField &b) {
+    param_low.tol = param.tol;
+    param_low.delta = param.delta;
+    param_low.maxiter = param.maxiter;
+    param_low.use_init_guess = param.use_init_guess;
+    param_low.iter = 0;
+    param_low.secs = 0.0;
+    param_low.gflops = 0.0;
+
+    (*cg_low)(x, b);
+
+    // continue in the sloppy precision from the direction the starting
+    // phase stopped at, or restart from the residual if it converged
+    // or ran out of iterations
+    const bool stagnated = cg_low->j_stagnated >= 0;
+    ColorSpinorField *p_init = stagnated ? cg_low->p[cg_low->j_stagnated] : nullptr;
+    const double r2_old_init = stagnated ? cg_low->r2_old_stagnated : 0.0;
+
+    if (getVerbosity() >= QUDA_VERBOSE && stagnated)
+      printfQuda("CG: true residual stagnated in %s precision after %d iterations, switching to %s precision\n",
+                 precisionName(param.precision_adaptive), param_low.iter, precisionName(param.precision_sloppy));
+
+    char trace[64];
+    sprintf(trace, "%s x%d -> %s", precisionName(param.precision_adaptive), param_low.iter,
+            precisionName(param.precision_sloppy));
+    precision_trace = trace;
+    iter_adaptive = param_low.iter;
+
+    const QudaUseInitGuess use_init_guess = param.use_init_guess;
+    const int maxiter = param.maxiter;
+    param.use_init_guess = QUDA_USE_INIT_GUESS_YES;
+    param.maxiter = std::max(maxiter - param_low.iter, 0);
+
+    (*this)(x, b, p_init, r2_old_init);
+
+    param.use_init_guess = use_init_guess;
+    param.maxiter = maxiter;
+    param.iter += param_low.iter;
+    param.secs += param_low.secs;
+    param.gflops += param_low.gflops;
+
+    precision_trace.clear();
+    iter_adaptive = 0;
+  }
+
   void CG::operator()(ColorSpinorField &x, ColorSpinorField &b, ColorSpinorField* p_init, double r2_old_init) {
     if (checkLocation(x, b) != QUDA_CUDA_FIELD_LOCATION)
       errorQuda("Not supported");
     if (checkPrecision(x, b) != param.precision)
       errorQuda("Precision mismatch: expected=%d, received=%d", param.precision, x.Precision());
 
+    if (matLow && !adaptive && !p_init) {
+      adaptive = true;
+      adaptiveSolve(x, b);
+      adaptive = false;
+      return;
+    }
+
     if (param.maxiter == 0 || param.Nsteps == 0) {
       if (param.use_init_guess == QUDA_USE_INIT_GUESS_NO) blas::zero(x);
       return;
@@ -370,6 +461,14 @@ namespace quda {
     double maxrr = rNorm;
     double delta = param.delta;
 
+    // when running as the starting phase of adaptive-precision CG, the
+    // true residual is deemed to have stagnated at a reliable update
+    // if it exceeds the iterated residual by more than stagnation_gap,
+    // or has not decreased by at least sqrt(delta) since the previous
+    // reliable update
+    constexpr double stagnation_gap = 10.0;
+    j_stagnated = -1;
+
 
     // this parameter determines how many consective reliable update
     // residual increases we tolerate before terminating the solver,
@@ -535,6 +634,8 @@ namespace quda {
 
       } else {
 
+	const double rNorm_iter = rNorm;
+
 	{
 	  const auto alpha_ = std::unique_ptr<Complex[]>(new Complex[Np]);
 	  for (int i=0; i<=j; i++) alpha_[i] = alpha[i];
@@ -571,6 +672,15 @@ namespace quda {
         }
 
 
+        if (stagnation_exit && !convergence(r2, heavy_quark_res, stop, param.tol_hq) &&
+            (sqrt(r2) > stagnation_gap * rNorm_iter || sqrt(r2) > sqrt(param.delta) * r0Norm)) {
+          // hand the search direction over to the higher-precision phase
+          j_stagnated = j;
+          r2_old_stagnated = r2_old;
+          k++;
+          break;
+        }
+
         // calculate new reliable HQ resididual
         if (use_heavy_quark_res) heavy_quark_res = sqrt(blas::HeavyQuarkResidualNorm(y, r).z);
 
@@ -682,7 +792,14 @@ namespace quda {
       param.true_res_hq = sqrt(blas::HeavyQuarkResidualNorm(x, r).z);
     }
 
-    PrintSummary("CG", k, r2, b2, stop, param.tol_hq);
+    if (!stagnation_exit) {
+      if (precision_trace.empty()) {
+        PrintSummary("CG", k, r2, b2, stop, param.tol_hq);
+      } else {
+        const std::string trace = precision_trace + " x" + std::to_string(k);
+        PrintSummary("CG", iter_adaptive + k, r2, b2, stop, param.tol_hq, trace.c_str());
+      }
+    }
 
     // reset the flops counters
     blas::flops = 0;
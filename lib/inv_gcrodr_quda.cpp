@@ -0,0 +1,439 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <map>
+#include <numeric>
+#include <algorithm>
+
+#include <quda_internal.h>
+#include <color_spinor_field.h>
+#include <blas_quda.h>
+#include <invert_quda.h>
+#include <util_quda.h>
+
+#include <Eigen/Dense>
+#include <Eigen/Eigenvalues>
+
+/*
+GCRO-DR algorithm:
+M. L. Parks, E. de Sturler, G. Mackey, D. D. Johnson and S. Maiti, "Recycling Krylov subspaces for
+sequences of linear systems", SIAM J. Sci. Comput. 28 (2006) p. 1651-1674
+*/
+
+namespace quda {
+
+  using namespace Eigen;
+
+  using DenseMatrix = MatrixXcd;
+  using RowMajorDenseMatrix = Matrix<Complex, Dynamic, Dynamic, RowMajor>;
+
+  struct RecycleSpace {
+    std::vector<ColorSpinorField*> U; // recycled subspace
+    std::vector<ColorSpinorField*> C; // C = A U, with orthonormal columns
+    int k;                            // current dimension of the subspace
+    uint64_t op_key;                  // operator for which C = A U holds
+    int solves;                       // number of solves that have used this subspace
+    int baseline_iter;                // iterations of the first solve, which had nothing to recycle
+
+    RecycleSpace(const ColorSpinorParam &param, int nev) : k(0), op_key(0), solves(0), baseline_iter(0) {
+      for (int i=0; i<nev; i++) {
+	U.push_back(ColorSpinorField::Create(param));
+	C.push_back(ColorSpinorField::Create(param));
+      }
+    }
+
+    ~RecycleSpace() {
+      for (auto u : U) delete u;
+      for (auto c : C) delete c;
+    }
+
+    bool Matches(const ColorSpinorField &x, int nev) const {
+      return static_cast<int>(U.size()) == nev && U[0]->Precision() == x.Precision() &&
+	U[0]->Volume() == x.Volume() && U[0]->SiteSubset() == x.SiteSubset();
+    }
+  };
+
+  // subspaces recycled across solves, keyed by SolverParam::recycle_key
+  static std::map<uint64_t, RecycleSpace*> recycle_spaces;
+
+  void flushRecycleSpaces() {
+    for (auto &space : recycle_spaces) delete space.second;
+    recycle_spaces.clear();
+  }
+
+  /**
+     @brief Recompute C = A U after the operator has changed, and
+     orthonormalize C with modified Gram-Schmidt, applying the same
+     transformation to U so that A U = C continues to hold.  Vectors
+     whose image is (numerically) linearly dependent on the previous
+     ones are dropped from the subspace.
+     @return Number of operator applications
+  */
+  static int refreshSpace(RecycleSpace &space, DiracMatrix &mat, ColorSpinorField &tmp)
+  {
+    // relative norm below which an orthogonalized image is treated as zero
+    const double drop_tol = space.C[0]->Precision() == QUDA_DOUBLE_PRECISION ? 1e-12 : 1e-6;
+
+    int n_op = 0;
+    int dropped = 0;
+    for (int i=0; i<space.k; ) {
+      mat(*space.C[i], *space.U[i], tmp);
+      n_op++;
+      double nrm0 = sqrt(blas::norm2(*space.C[i]));
+      for (int l=0; l<i; l++) {
+	Complex alpha = blas::cDotProduct(*space.C[l], *space.C[i]);
+	blas::caxpy(-alpha, *space.C[l], *space.C[i]);
+	blas::caxpy(-alpha, *space.U[l], *space.U[i]);
+      }
+      double nrm = sqrt(blas::norm2(*space.C[i]));
+
+      // also catches a vanishing or non-finite image
+      if (!(nrm > drop_tol * nrm0)) {
+	std::swap(space.U[i], space.U[space.k-1]);
+	std::swap(space.C[i], space.C[space.k-1]);
+	space.k--;
+	dropped++;
+	continue;
+      }
+
+      blas::ax(1.0/nrm, *space.C[i]);
+      blas::ax(1.0/nrm, *space.U[i]);
+      i++;
+    }
+
+    if (dropped > 0) warningQuda("GCRODR: dropped %d linearly dependent vectors from the recycled subspace", dropped);
+    return n_op;
+  }
+
+  /**
+     @brief Replace the recycled subspace with the harmonic Ritz
+     vectors of smallest magnitude over span{U, V}.  With A Vhat =
+     What G, where Vhat = [U, V_m] and What = [C, V_{m+1}], these solve
+     G^dag G z = theta G^dag What^dag Vhat z.  The new subspace is U =
+     Vhat P R^{-1} and C = What Q, with G P = Q R.
+     @param[in,out] space The recycled subspace
+     @param[in] G Projected operator, (n+1) x n
+     @param[in] Vhat Search space [U, V_m]
+     @param[in] What Image space [C, V_{m+1}]
+     @param[in] nev Maximum dimension of the recycled subspace
+     @param[in,out] U_new Work space, swapped with space.U
+     @param[in,out] C_new Work space, swapped with space.C
+  */
+  static void updateSpace(RecycleSpace &space, const DenseMatrix &G, std::vector<ColorSpinorField*> &Vhat,
+			  std::vector<ColorSpinorField*> &What, int nev,
+			  std::vector<ColorSpinorField*> &U_new, std::vector<ColorSpinorField*> &C_new)
+  {
+    const int n = G.cols();
+    const int kc = space.k;
+
+    // C is orthonormal and V is orthonormal and orthogonal to C, so
+    // only the inner products with U need computing
+    DenseMatrix Phi = DenseMatrix::Zero(n+1, n);
+    Phi.bottomRightCorner(n+1-kc, n-kc).setIdentity();
+    if (kc > 0) {
+      std::vector<Complex> phi((n+1)*kc);
+      std::vector<ColorSpinorField*> U(Vhat.begin(), Vhat.begin()+kc);
+      blas::cDotProduct(phi.data(), What, U);
+      Phi.leftCols(kc) = Map<RowMajorDenseMatrix>(phi.data(), n+1, kc);
+    }
+
+    // solve the inverse problem (G^dag G)^{-1} G^dag Phi z = theta^{-1} z since G^dag G is positive definite
+    DenseMatrix GG = G.adjoint() * G;
+    ComplexEigenSolver<DenseMatrix> es(GG.llt().solve(G.adjoint() * Phi));
+
+    std::vector<int> idx(n);
+    std::iota(idx.begin(), idx.end(), 0);
+    std::sort(idx.begin(), idx.end(), [&es](int a, int b) {
+	return std::abs(es.eigenvalues()[a]) > std::abs(es.eigenvalues()[b]); });
+
+    const int k = std::min(nev, n);
+    DenseMatrix P(n, k);
+    for (int l=0; l<k; l++) P.col(l) = es.eigenvectors().col(idx[l]);
+
+    HouseholderQR<DenseMatrix> qr(G * P);
+    DenseMatrix Q = qr.householderQ() * DenseMatrix::Identity(n+1, k);
+    DenseMatrix R = qr.matrixQR().topLeftCorner(k, k).triangularView<Upper>();
+    DenseMatrix PRinv = R.triangularView<Upper>().solve<OnTheRight>(P);
+
+    std::vector<ColorSpinorField*> u(U_new.begin(), U_new.begin()+k);
+    std::vector<ColorSpinorField*> c(C_new.begin(), C_new.begin()+k);
+    for (int l=0; l<k; l++) {
+      blas::zero(*u[l]);
+      blas::zero(*c[l]);
+    }
+
+    RowMajorDenseMatrix alpha(PRinv);
+    blas::caxpy(static_cast<Complex*>(alpha.data()), Vhat, u);
+    RowMajorDenseMatrix beta(Q);
+    blas::caxpy(static_cast<Complex*>(beta.data()), What, c);
+
+    std::swap(space.U, U_new);
+    std::swap(space.C, C_new);
+    space.k = k;
+  }
+
+  GCRODR::GCRODR(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile) :
+    Solver(param, profile), mat(mat), matSloppy(matSloppy), rp(nullptr), yp(nullptr), r_sloppy(nullptr),
+    y_sloppy(nullptr), tmp_sloppy(nullptr), space(nullptr), own_space(false), init(false)
+  {
+    if (param.nev < 1 || param.nev >= param.Nkrylov)
+      errorQuda("Recycled subspace dimension %d must be positive and less than the Krylov dimension %d",
+		param.nev, param.Nkrylov);
+  }
+
+  GCRODR::~GCRODR() {
+    profile.TPSTART(QUDA_PROFILE_FREE);
+
+    if (init) {
+      for (auto v : V) delete v;
+      for (auto u : U_new) delete u;
+      for (auto c : C_new) delete c;
+      delete tmp_sloppy;
+      delete y_sloppy;
+      delete r_sloppy;
+      delete yp;
+      delete rp;
+    }
+    if (own_space) delete space;
+
+    profile.TPSTOP(QUDA_PROFILE_FREE);
+  }
+
+  void GCRODR::operator()(ColorSpinorField &x, ColorSpinorField &b)
+  {
+    profile.TPSTART(QUDA_PROFILE_INIT);
+
+    const int m = param.Nkrylov;
+
+    if (!init) {
+      ColorSpinorParam csParam(x);
+      csParam.create = QUDA_NULL_FIELD_CREATE;
+      rp = ColorSpinorField::Create(csParam);
+      yp = ColorSpinorField::Create(csParam);
+
+      csParam.setPrecision(param.precision_sloppy);
+      r_sloppy = ColorSpinorField::Create(csParam);
+      y_sloppy = ColorSpinorField::Create(csParam);
+      tmp_sloppy = ColorSpinorField::Create(csParam);
+      for (int i=0; i<=m; i++) V.push_back(ColorSpinorField::Create(csParam));
+      for (int i=0; i<param.nev; i++) {
+	U_new.push_back(ColorSpinorField::Create(csParam));
+	C_new.push_back(ColorSpinorField::Create(csParam));
+      }
+
+      // find the subspace recycled from earlier solves with this operator
+      if (param.recycle_key) {
+	auto it = recycle_spaces.find(param.recycle_key);
+	if (it != recycle_spaces.end() && !it->second->Matches(*r_sloppy, param.nev)) {
+	  delete it->second;
+	  recycle_spaces.erase(it);
+	  it = recycle_spaces.end();
+	}
+	if (it == recycle_spaces.end()) it = recycle_spaces.insert(std::make_pair(param.recycle_key, new RecycleSpace(csParam, param.nev))).first;
+	space = it->second;
+      } else {
+	space = new RecycleSpace(csParam, param.nev);
+	own_space = true;
+      }
+
+      init = true;
+    }
+
+    ColorSpinorField &r = *rp;
+    ColorSpinorField &y = *yp;
+    ColorSpinorField &rSloppy = *r_sloppy;
+    ColorSpinorField &ySloppy = *y_sloppy;
+    ColorSpinorField &tmpSloppy = *tmp_sloppy;
+
+    double b2 = blas::norm2(b);  // norm sq of source
+    double r2;                   // norm sq of residual
+
+    // compute initial residual depending on whether we have an initial guess or not
+    if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES) {
+      mat(r, x, y);
+      r2 = blas::xmyNorm(b, r);
+    } else {
+      blas::copy(r, b);
+      r2 = b2;
+      blas::zero(x);
+    }
+    blas::zero(ySloppy);
+
+    // Check to see that we're not trying to invert on a zero-field source
+    if (b2 == 0) {
+      if (param.compute_null_vector == QUDA_COMPUTE_NULL_VECTOR_NO) {
+	profile.TPSTOP(QUDA_PROFILE_INIT);
+	warningQuda("inverting on zero-field source\n");
+	x = b;
+	param.true_res = 0.0;
+	param.true_res_hq = 0.0;
+	return;
+      } else {
+	b2 = r2;
+      }
+    }
+
+    if (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL) errorQuda("GCRODR does not support the heavy quark residual");
+
+    const double stop = stopping(param.tol, b2, param.residual_type); // stopping condition of solver
+
+    profile.TPSTOP(QUDA_PROFILE_INIT);
+    profile.TPSTART(QUDA_PROFILE_PREAMBLE);
+
+    int total_iter = 0;
+
+    // the operator has changed since the subspace was last used
+    if (space->k > 0 && space->op_key != param.recycle_op_key) {
+      total_iter += refreshSpace(*space, matSloppy, tmpSloppy);
+      if (getVerbosity() >= QUDA_VERBOSE)
+	printfQuda("GCRODR: operator changed, recomputed C = A U for the recycled subspace of dimension %d\n", space->k);
+    }
+    space->op_key = param.recycle_op_key;
+
+    const int k_start = space->k;
+
+    profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
+    profile.TPSTART(QUDA_PROFILE_COMPUTE);
+    blas::flops = 0;
+
+    int restart = 0;
+    std::vector<ColorSpinorField*> rs{&rSloppy};
+    std::vector<ColorSpinorField*> ys{&ySloppy};
+
+    PrintStats("GCRODR", total_iter, r2, b2, 0.0);
+    while ( !convergence(r2, 0.0, stop, param.tol_hq) && total_iter < param.maxiter) {
+
+      const int kc = space->k;
+      std::vector<ColorSpinorField*> U(space->U.begin(), space->U.begin()+kc);
+      std::vector<ColorSpinorField*> C(space->C.begin(), space->C.begin()+kc);
+
+      blas::copy(rSloppy, r);
+
+      // project out range(C): x += U C^dag r, r -= C C^dag r
+      if (kc > 0) {
+	std::vector<Complex> alpha(kc);
+	blas::cDotProduct(alpha.data(), C, rs);
+	blas::caxpy(alpha.data(), U, ys);
+	for (auto &a : alpha) a = -a;
+	blas::caxpy(alpha.data(), C, rs);
+      }
+
+      const double beta = sqrt(blas::norm2(rSloppy));
+      blas::copy(*V[0], rSloppy);
+      blas::ax(1.0/beta, *V[0]);
+
+      // A [U, V_j] = [C, V_{j+1}] G, with G = [I B; 0 H]
+      DenseMatrix G = DenseMatrix::Zero(m+1, m);
+      G.topLeftCorner(kc, kc).setIdentity();
+      VectorXcd c = VectorXcd::Zero(m+1);
+      c(kc) = beta;
+      VectorXcd eta;
+
+      int j = 0;
+      while (j < m - kc && total_iter < param.maxiter) {
+	matSloppy(*V[j+1], *V[j], tmpSloppy);
+
+	// orthogonalize against [C, V_0 .. V_j] with two passes of block classical Gram-Schmidt
+	std::vector<ColorSpinorField*> W(C);
+	W.insert(W.end(), V.begin(), V.begin()+j+1);
+	std::vector<ColorSpinorField*> w{V[j+1]};
+	std::vector<Complex> h(W.size());
+	for (int pass=0; pass<2; pass++) {
+	  blas::cDotProduct(h.data(), W, w);
+	  for (unsigned int i=0; i<W.size(); i++) G(i, kc+j) += h[i];
+	  for (auto &hi : h) hi = -hi;
+	  blas::caxpy(h.data(), W, w);
+	}
+
+	const double h_next = sqrt(blas::norm2(*V[j+1]));
+	G(kc+j+1, kc+j) = h_next;
+	if (h_next > 0.0) blas::ax(1.0/h_next, *V[j+1]);
+
+	j++;
+	total_iter++;
+
+	// residual of the least-squares problem min |c - G eta|
+	const int n = kc + j;
+	eta = G.topLeftCorner(n+1, n).householderQr().solve(c.head(n+1));
+	const double r2_est = (c.head(n+1) - G.topLeftCorner(n+1, n) * eta).squaredNorm();
+
+	if (getVerbosity() >= QUDA_DEBUG_VERBOSE) PrintStats("GCRODR", total_iter, r2_est, b2, 0.0);
+	if (r2_est < stop || h_next == 0.0) break;
+      }
+
+      const int n = kc + j;
+      if (j > 0) {
+	std::vector<ColorSpinorField*> Vhat(U);
+	Vhat.insert(Vhat.end(), V.begin(), V.begin()+j);
+	std::vector<ColorSpinorField*> What(C);
+	What.insert(What.end(), V.begin(), V.begin()+j+1);
+
+	// update the solution: x += [U, V_j] eta
+	blas::caxpy(static_cast<Complex*>(eta.data()), Vhat, ys);
+
+	// update the recycled subspace at each restart
+	updateSpace(*space, G.topLeftCorner(n+1, n), Vhat, What, param.nev, U_new, C_new);
+      }
+
+      // recalculate residual in high precision
+      blas::xpy(ySloppy, x);
+      blas::zero(ySloppy);
+      mat(r, x, y);
+      r2 = blas::xmyNorm(b, r);
+
+      restart++;
+      PrintStats("GCRODR (restart)", restart, r2, b2, 0.0);
+    }
+
+    profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+    profile.TPSTART(QUDA_PROFILE_EPILOGUE);
+
+    param.secs += profile.Last(QUDA_PROFILE_COMPUTE);
+
+    double gflops = (blas::flops + mat.flops() + matSloppy.flops())*1e-9;
+
+    if (total_iter>=param.maxiter && getVerbosity() >= QUDA_SUMMARIZE)
+      warningQuda("Exceeded maximum iterations %d", param.maxiter);
+
+    if (getVerbosity() >= QUDA_VERBOSE) printfQuda("GCRODR: number of restarts = %d\n", restart);
+
+    // report the savings over the first solve, which had nothing to recycle
+    space->solves++;
+    if (k_start == 0) space->baseline_iter = total_iter;
+    if (getVerbosity() >= QUDA_SUMMARIZE) {
+      if (k_start > 0) {
+	printfQuda("GCRODR: solve %d recycled a subspace of dimension %d: %d iterations against %d without recycling (%d saved)\n",
+		   space->solves, k_start, total_iter, space->baseline_iter, space->baseline_iter - total_iter);
+      } else {
+	printfQuda("GCRODR: solve %d built a recycled subspace of dimension %d in %d iterations\n",
+		   space->solves, space->k, total_iter);
+      }
+    }
+
+    if (param.compute_true_res) {
+      // r was computed in full precision at the last restart
+      param.true_res = sqrt(r2 / b2);
+      param.true_res_hq = 0.0;
+    }
+    if (param.preserve_source == QUDA_PRESERVE_SOURCE_NO) blas::copy(b, r);
+
+    param.gflops += gflops;
+    param.iter += total_iter;
+
+    // reset the flops counters
+    blas::flops = 0;
+    mat.flops();
+    matSloppy.flops();
+
+    profile.TPSTOP(QUDA_PROFILE_EPILOGUE);
+    profile.TPSTART(QUDA_PROFILE_FREE);
+
+    PrintSummary("GCRODR", total_iter, r2, b2, stop, param.tol_hq);
+
+    profile.TPSTOP(QUDA_PROFILE_FREE);
+
+    return;
+  }
+
+} // namespace quda
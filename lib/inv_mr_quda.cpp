@@ -20,6 +20,9 @@ namespace quda {
     if (param.schwarz_type == QUDA_MULTIPLICATIVE_SCHWARZ && param.Nsteps % 2 == 1) {
       errorQuda("For multiplicative Schwarz, number of solver steps %d must be even", param.Nsteps);
     }
+    if (param.schwarz_overlap > 0 && param.schwarz_type != QUDA_ADDITIVE_SCHWARZ) {
+      errorQuda("Overlapping domains require additive Schwarz");
+    }
   }
 
   MR::~MR() {
@@ -52,10 +55,11 @@ namespace quda {
 
       // Source needs to be preserved if we're computing the true residual
       rp = (param.use_init_guess == QUDA_USE_INIT_GUESS_YES || param.preserve_source == QUDA_PRESERVE_SOURCE_YES
-	    || param.Nsteps > 1 || param.compute_true_res == 1) ?
+	    || param.Nsteps > 1 || param.compute_true_res == 1 || param.schwarz_overlap > 0) ?
 	ColorSpinorField::Create(csParam) : nullptr;
 
-      tmpp = (param.use_init_guess == QUDA_USE_INIT_GUESS_YES || param.Nsteps > 1 || param.compute_true_res) ?
+      tmpp = (param.use_init_guess == QUDA_USE_INIT_GUESS_YES || param.Nsteps > 1 || param.compute_true_res
+	      || param.schwarz_overlap > 0) ?
 	ColorSpinorField::Create(csParam) : nullptr;
 
       // now allocate sloppy fields
@@ -126,6 +130,13 @@ namespace quda {
 	int k = 0;
 	if (getVerbosity() >= QUDA_VERBOSE) printfQuda("MR: %d cycle, %d iterations, r2 = %e\n", step, k, r2);
 
+	if (param.schwarz_overlap > 0 && r2 > 0.0) {
+	  // restricted additive Schwarz: the overlap is imported once
+	  // and the MR iterations are done on the extended domains
+	  matSloppy.Expose()->SolveDomain(xSloppy, rSloppy, param.schwarz_overlap, param.maxiter, param.omega);
+	  k = param.maxiter;
+	}
+
 	double3 Ar3;
 	while (k < param.maxiter && r2 > 0.0) {
     
@@ -163,7 +174,8 @@ namespace quda {
       step++;
 
       // FIXME - add over/under relaxation in outer loop
-      if (param.compute_true_res || param.Nsteps > 1) {
+      // the iterated residual is not available for overlapping domains
+      if (param.compute_true_res || param.Nsteps > 1 || param.schwarz_overlap > 0) {
 	mat(r, x, tmp);
 	r2 = blas::xmyNorm(b, r);
 	param.true_res = sqrt(r2 / b2);
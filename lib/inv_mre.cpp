@@ -170,4 +170,295 @@ namespace quda {
 
 
 
+  // Weights of the dissipative time-reversible extrapolation of
+  // Niklasson et al., J. Chem. Phys. 130, 214109 (2009), for K = 3..7
+  // previous auxiliary vectors: kappa, alpha and c_0..c_K
+  static const double tr_kappa[] = { 1.69, 1.75, 1.82, 1.84, 1.86 };
+  static const double tr_alpha[] = { 0.150, 0.057, 0.018, 0.0055, 0.0016 };
+  static const double tr_c[][8] = { {  -2,  3,   0, -1 },
+				    {  -3,  6,  -2, -2,  1 },
+				    {  -6, 14,  -8, -3,  4,  -1 },
+				    { -14, 36, -27, -2, 12,  -6, 1 },
+				    { -36, 99, -88, 11, 32, -25, 8, -1 } };
+
+  void ChronoBasis::flush() {
+    invalidateProjection();
+    for (auto p : P) delete p;
+    P.clear();
+    coord.clear();
+    aux.clear();
+  }
+
+  void ChronoBasis::invalidateProjection() {
+    for (auto q : AP) delete q;
+    AP.clear();
+    G.clear();
+    op_key = 0;
+  }
+
+  void ChronoBasis::dropDirection() {
+    using namespace Eigen;
+    typedef Matrix<Complex, Dynamic, Dynamic> matrix;
+    typedef Matrix<Complex, Dynamic, 1> vector;
+
+    const int n = P.size();
+    const int ns = coord.size();
+    const int na = aux.size();
+
+    // a unit vector v orthogonal to the coordinates of all stored solutions and auxiliary vectors
+    matrix C(n, ns+na);
+    for (int j=0; j<ns; j++) for (int i=0; i<n; i++) C(i,j) = coord[j][i];
+    for (int j=0; j<na; j++) for (int i=0; i<n; i++) C(i,ns+j) = aux[j][i];
+    HouseholderQR<matrix> qr(C);
+    vector v = qr.householderQ() * vector::Unit(n, n-1);
+
+    // H = 1 - 2 u u^dag maps v onto alpha e_{n-1}
+    Complex alpha = std::abs(v(n-1)) > 0.0 ? -v(n-1) / std::abs(v(n-1)) : Complex(-1.0, 0.0);
+    vector u = v;
+    u(n-1) -= alpha;
+    u /= u.norm();
+
+    // V -> V H, which only takes s = V u
+    std::vector<Complex> a(n);
+    for (int j=0; j<n; j++) a[j] = -2.0 * std::conj(u(j));
+    auto reflect = [&](std::vector<ColorSpinorField*> &V) {
+      ColorSpinorParam param(*V[0]);
+      param.create = QUDA_NULL_FIELD_CREATE;
+      ColorSpinorField *s = ColorSpinorField::Create(param);
+      std::vector<ColorSpinorField*> S{s};
+      blas::zero(*s);
+      blas::caxpy(u.data(), V, S);
+      blas::caxpy(a.data(), S, V);
+      delete s;
+    };
+    reflect(P);
+    if (AP.size()) reflect(AP);
+
+    // coordinates c -> H c, which leaves the last component zero
+    auto rotate = [&](std::vector<Complex> &c) {
+      Map<vector> c_(c.data(), n);
+      c_ -= 2.0 * u * u.dot(c_);
+      c.resize(n-1);
+    };
+    for (auto &c : coord) rotate(c);
+    for (auto &c : aux) rotate(c);
+
+    // projected matrix G -> H G H, which holds for both P^dag A P and (A P)^dag (A P)
+    if (op_key) {
+      Map<Matrix<Complex, Dynamic, Dynamic, RowMajor> > G_(G.data(), n, n);
+      matrix H = matrix::Identity(n, n) - 2.0 * u * u.adjoint();
+      matrix HGH = H * G_ * H;
+      G.resize((n-1)*(n-1));
+      for (int i=0; i<n-1; i++) for (int j=0; j<n-1; j++) G[i*(n-1)+j] = HGH(i,j);
+    }
+
+    if (AP.size()) {
+      delete AP.back();
+      AP.pop_back();
+    }
+    delete P.back();
+    P.pop_back();
+  }
+
+  void ChronoBasis::extendProjection(int j, DiracMatrix &mat, QudaPrecision mat_precision, bool hermitian) {
+    ColorSpinorParam param(*P[j]);
+    param.create = QUDA_NULL_FIELD_CREATE;
+    ColorSpinorField *Ap_ = ColorSpinorField::Create(param);
+    param.setPrecision(mat_precision);
+    ColorSpinorField *p = ColorSpinorField::Create(param);
+    ColorSpinorField *Ap = ColorSpinorField::Create(param);
+    ColorSpinorField *tmp = ColorSpinorField::Create(param);
+
+    blas::copy(*p, *P[j]);
+    mat(*Ap, *p, *tmp);
+    blas::copy(*Ap_, *Ap);
+
+    delete tmp;
+    delete Ap;
+    delete p;
+
+    // the new column of P^dag A P, or of (A P)^dag (A P), and its
+    // Hermitian conjugate as the new row
+    std::vector<ColorSpinorField*> AP_j{Ap_};
+    std::vector<Complex> g(j+1);
+    if (hermitian) {
+      std::vector<ColorSpinorField*> P_(P.begin(), P.begin()+j+1);
+      blas::cDotProduct(g.data(), P_, AP_j);
+      delete Ap_;
+    } else {
+      AP.push_back(Ap_);
+      blas::cDotProduct(g.data(), AP, AP_j);
+    }
+
+    std::vector<Complex> G_new((j+1)*(j+1));
+    for (int k=0; k<j; k++) for (int l=0; l<j; l++) G_new[k*(j+1)+l] = G[k*j+l];
+    for (int k=0; k<j; k++) {
+      G_new[k*(j+1)+j] = g[k];
+      G_new[j*(j+1)+k] = std::conj(g[k]);
+    }
+    G_new[j*(j+1)+j] = g[j].real();
+    G = G_new;
+  }
+
+  void ChronoBasis::computeProjection(DiracMatrix &mat, QudaPrecision mat_precision, bool hermitian) {
+    invalidateProjection();
+    for (unsigned int j=0; j<P.size(); j++) extendProjection(j, mat, mat_precision, hermitian);
+  }
+
+  void ChronoBasis::forecast(ColorSpinorField &x, ColorSpinorField &b, DiracMatrix &mat, QudaPrecision mat_precision,
+			     QudaChronoExtrapolationType type, bool hermitian, uint64_t key) {
+    using namespace Eigen;
+    typedef Matrix<Complex, Dynamic, 1> vector;
+
+    const int n = P.size();
+    const int ns = coord.size();
+
+    if (ns == 0) {
+      blas::zero(x);
+      return;
+    }
+
+    ColorSpinorParam param(*P[0]);
+    param.create = QUDA_NULL_FIELD_CREATE;
+    ColorSpinorField *y = ColorSpinorField::Create(param);
+
+    vector psi = vector::Zero(n);
+    if (type == QUDA_CHRONO_TIME_REVERSIBLE_EXTRAPOLATION) {
+      // the guess is the next auxiliary vector p_{n+1}, propagated from
+      // the previous ones and the latest solution x_n = coord[0] by
+      //   p_{n+1} = 2 p_n - p_{n-1} + kappa (x_n - p_n) + alpha sum_k c_k p_{n-k}
+      // which is symmetric under n+1 <-> n-1 for alpha = 0.  Until
+      // enough auxiliary vectors exist, they are seeded with solutions.
+      if (aux_dim < 2) errorQuda("Time-reversible extrapolation needs a history set up for it by push()");
+      auto add = [&](double w, const std::vector<Complex> &c) {
+	for (unsigned int j=0; j<c.size(); j++) psi(j) += w * c[j];
+      };
+      if (static_cast<int>(aux.size()) < aux_dim) {
+	add(1.0, coord[0]);
+      } else {
+	const int K = aux_dim - 1;
+	if (K < 3) {
+	  // kappa = 2 without dissipation: p_{n+1} = 2 x_n - p_{n-1}
+	  add(2.0, coord[0]);
+	  add(-1.0, aux[1]);
+	} else {
+	  const int k = std::min(K, 7) - 3;
+	  add(tr_kappa[k], coord[0]);
+	  add(2.0 - tr_kappa[k], aux[0]);
+	  add(-1.0, aux[1]);
+	  for (int l=0; l<=k+3; l++) add(tr_alpha[k] * tr_c[k][l], aux[l]);
+	}
+      }
+      aux.insert(aux.begin(), std::vector<Complex>(psi.data(), psi.data()+n));
+      if (static_cast<int>(aux.size()) > aux_dim) aux.pop_back();
+    } else if (type == QUDA_CHRONO_POLYNOMIAL_EXTRAPOLATION) {
+      // extrapolate the polynomial of degree ns-1 through the history
+      // one step ahead, with weights (-1)^i binom(ns, i+1)
+      double w = ns;
+      for (int i=0; i<ns; i++) {
+	for (unsigned int j=0; j<coord[i].size(); j++) psi(j) += w * coord[i][j];
+	w *= -static_cast<double>(ns-i-1) / (i+2);
+      }
+    } else if (type == QUDA_CHRONO_MINRES_EXTRAPOLATION) {
+      // the projected matrix is only recomputed when the operator has changed
+      if (key == 0 || key != op_key || hermitian != op_hermitian || static_cast<int>(G.size()) != n*n)
+	computeProjection(mat, mat_precision, hermitian);
+      op_key = key;
+      op_hermitian = hermitian;
+
+      // as in MinResExt: a Hermitian system is solved in the basis,
+      // otherwise |b - A P psi| is minimized through the normal
+      // equations (A P)^dag (A P) psi = (A P)^dag b
+      blas::copy(*y, b);
+      std::vector<ColorSpinorField*> B{y};
+      std::vector<Complex> phi(n);
+      blas::cDotProduct(phi.data(), hermitian ? P : AP, B);
+
+      Map<Matrix<Complex, Dynamic, Dynamic, RowMajor> > G_(G.data(), n, n);
+      Map<vector> phi_(phi.data(), n);
+      psi = G_.ldlt().solve(phi_);
+    } else {
+      errorQuda("Unexpected chrono extrapolation type %d", type);
+    }
+
+    blas::zero(*y);
+    std::vector<ColorSpinorField*> Y{y};
+    blas::caxpy(psi.data(), P, Y);
+    blas::copy(x, *y);
+    delete y;
+
+    if (getVerbosity() >= QUDA_SUMMARIZE)
+      printfQuda("ChronoBasis: %s extrapolation from %d solutions in a basis of dimension %d\n",
+		 type == QUDA_CHRONO_POLYNOMIAL_EXTRAPOLATION ? "polynomial" :
+		 type == QUDA_CHRONO_TIME_REVERSIBLE_EXTRAPOLATION ? "time-reversible" : "minimum residual", ns, n);
+  }
+
+  void ChronoBasis::push(const ColorSpinorField &x, int max_dim, bool replace_last, QudaPrecision precision,
+			 QudaChronoExtrapolationType type, DiracMatrix &mat, QudaPrecision mat_precision,
+			 bool hermitian, uint64_t key) {
+    if (P.size() && P[0]->Precision() != precision) flush();
+    if (replace_last && coord.size()) coord.erase(coord.begin());
+
+    // time-reversible extrapolation only needs the latest solution,
+    // and spends the rest of the history on the auxiliary vectors
+    int n_solution = max_dim;
+    if (type == QUDA_CHRONO_TIME_REVERSIBLE_EXTRAPOLATION) {
+      if (max_dim < 3) errorQuda("Time-reversible extrapolation requires chrono_max_dim >= 3 (requested %d)", max_dim);
+      n_solution = 1;
+      aux_dim = max_dim - 1;
+    } else {
+      aux.clear();
+      aux_dim = 0;
+    }
+
+    ColorSpinorParam param(x);
+    param.create = QUDA_NULL_FIELD_CREATE;
+    param.setPrecision(precision);
+    ColorSpinorField *e = ColorSpinorField::Create(param);
+    blas::copy(*e, x);
+
+    // orthogonalize against the basis with two passes of block Gram-Schmidt
+    const int n = P.size();
+    std::vector<Complex> c(n+1, 0.0);
+    if (n > 0) {
+      std::vector<ColorSpinorField*> E{e};
+      std::vector<Complex> a(n);
+      for (int pass=0; pass<2; pass++) {
+	blas::cDotProduct(a.data(), P, E);
+	for (int i=0; i<n; i++) { c[i] += a[i]; a[i] = -a[i]; }
+	blas::caxpy(a.data(), P, E);
+      }
+    }
+
+    const double beta = sqrt(blas::norm2(*e));
+    if (beta == 0.0) {
+      delete e;
+      c.resize(n);
+    } else {
+      blas::ax(1.0/beta, *e);
+      P.push_back(e);
+      c[n] = beta;
+      for (auto &ci : coord) ci.resize(n+1, 0.0);
+      for (auto &ai : aux) ai.resize(n+1, 0.0);
+    }
+
+    coord.insert(coord.begin(), c);
+    while (static_cast<int>(coord.size()) > n_solution) coord.pop_back();
+    while (static_cast<int>(aux.size()) > aux_dim) aux.pop_back();
+
+    // extend the projected matrix by the new row and column, which
+    // takes a single application of the operator
+    if (static_cast<int>(P.size()) > n) {
+      if (key != 0 && key == op_key && hermitian == op_hermitian && static_cast<int>(G.size()) == n*n) {
+	extendProjection(n, mat, mat_precision, hermitian);
+      } else {
+	invalidateProjection();
+      }
+    }
+
+    // keep only the directions spanned by the retained solutions and auxiliary vectors
+    while (P.size() > coord.size() + aux.size()) dropDirection();
+  }
+
+
 } // namespace quda
@@ -10,11 +10,12 @@
 #include <util_quda.h>
 #include <sys/time.h>
 #include <iostream>
+#include <vector>
 
 namespace quda {
 
   MultiSrcCG::MultiSrcCG(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile) :
-    MultiSrcSolver(param, profile), mat(mat), matSloppy(matSloppy)
+    Solver(param, profile), mat(mat), matSloppy(matSloppy)
   {
 
   }
@@ -23,319 +24,264 @@ namespace quda {
 
   }
 
-  void MultiSrcCG::operator()(std::vector<ColorSpinorField*> out, std::vector<ColorSpinorField*> in) 
+  /**
+     Evaluate the local part of one reduction per source with f and
+     sum all of them over the nodes in a single global reduction.
+   */
+  template <typename F>
+  static void fusedReduce(std::vector<double> &sum, const std::vector<int> &idx, F f)
   {
-    
+    std::vector<double> local(idx.size());
 
+    const bool global_reduction = commGlobalReduction();
+    commGlobalReductionSet(false);
+    for (unsigned int j=0; j<idx.size(); j++) local[j] = f(idx[j]);
+    commGlobalReductionSet(global_reduction);
 
-#if 0
+    reduceDoubleArray(local.data(), local.size());
+    for (unsigned int j=0; j<idx.size(); j++) sum[idx[j]] = local[j];
+  }
+
+  void MultiSrcCG::operator()(ColorSpinorField &x, ColorSpinorField &b)
+  {
+    std::vector<ColorSpinorField*> x_(1, &x), b_(1, &b);
+    solve(x_, b_);
+    param.true_res = param.true_res_offset[0];
+    param.true_res_hq = param.true_res_hq_offset[0];
+  }
+
+  void MultiSrcCG::blocksolve(ColorSpinorField &x, ColorSpinorField &b)
+  {
+    if (!x.IsComposite() || !b.IsComposite() || x.CompositeDim() != b.CompositeDim())
+      errorQuda("Multi-source CG requires composite fields of equal dimension");
+    if (b.CompositeDim() != param.num_src)
+      errorQuda("Composite dimension %d does not match num_src = %d", b.CompositeDim(), param.num_src);
+
+    solve(x.Components(), b.Components());
+  }
 
-    if (Location(x, b) != QUDA_CUDA_FIELD_LOCATION)
-      errorQuda("Not supported");
+  void MultiSrcCG::solve(std::vector<ColorSpinorField*> &x, std::vector<ColorSpinorField*> &b)
+  {
+    const int n_src = b.size();
+    if (n_src > QUDA_MAX_MULTI_SHIFT)
+      errorQuda("Number of sources %d exceeds maximum %d", n_src, QUDA_MAX_MULTI_SHIFT);
+    if (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL)
+      errorQuda("Heavy-quark residual not supported by the multi-source CG");
 
     profile.TPSTART(QUDA_PROFILE_INIT);
 
-    // Check to see that we're not trying to invert on a zero-field source    
-    const double b2 = blas::norm2(b);
-    if(b2 == 0){
-      profile.TPSTOP(QUDA_PROFILE_INIT);
-      printfQuda("Warning: inverting on zero-field source\n");
-      x=b;
-      param.true_res = 0.0;
-      param.true_res_hq = 0.0;
-      return;
-    }
+    std::vector<int> all(n_src);
+    for (int i=0; i<n_src; i++) all[i] = i;
 
-    cudaColorSpinorField r(b);
+    std::vector<double> b2(n_src);
+    fusedReduce(b2, all, [&](int i) { return blas::norm2(*b[i]); });
 
-    ColorSpinorParam csParam(x);
+    ColorSpinorParam csParam(*x[0]);
+    csParam.is_composite = false;
+    csParam.is_component = false;
     csParam.create = QUDA_ZERO_FIELD_CREATE;
-    cudaColorSpinorField y(b, csParam); 
-  
-    mat(r, x, y);
-    double r2 = blas::xmyNorm(b, r);
 
-    csParam.setPrecision(param.precision_sloppy);
-    cudaColorSpinorField Ap(x, csParam);
-    cudaColorSpinorField tmp(x, csParam);
+    // per-source fields: y accumulates the solution in high precision,
+    // x is only used as a temporary until the end of the solve
+    std::vector<ColorSpinorField*> r(n_src), y(n_src), rSloppy(n_src), xSloppy(n_src), p(n_src), Ap(n_src);
 
-    // tmp2 only needed for multi-gpu Wilson-like kernels
-    cudaColorSpinorField *tmp2_p = !mat.isStaggered() ?
-      new cudaColorSpinorField(x, csParam) : &tmp;
-    cudaColorSpinorField &tmp2 = *tmp2_p;
-
-    cudaColorSpinorField *r_sloppy;
-    if (param.precision_sloppy == x.Precision()) {
-      r_sloppy = &r;
-    } else {
-      csParam.create = QUDA_COPY_FIELD_CREATE;
-      r_sloppy = new cudaColorSpinorField(r, csParam);
+    csParam.setPrecision(param.precision);
+    for (int i=0; i<n_src; i++) {
+      r[i] = ColorSpinorField::Create(csParam);
+      y[i] = ColorSpinorField::Create(csParam);
     }
+    ColorSpinorField *tmp3 = (param.precision != param.precision_sloppy && !mat.isStaggered()) ?
+      ColorSpinorField::Create(csParam) : nullptr;
 
-    cudaColorSpinorField *x_sloppy;
-    if (param.precision_sloppy == x.Precision() ||
-	!param.use_sloppy_partial_accumulator) {
-      x_sloppy = &static_cast<cudaColorSpinorField&>(x);
-    } else {
-      csParam.create = QUDA_COPY_FIELD_CREATE;
-      x_sloppy = new cudaColorSpinorField(x, csParam);
+    csParam.setPrecision(param.precision_sloppy);
+    for (int i=0; i<n_src; i++) {
+      rSloppy[i] = (param.precision_sloppy != param.precision) ? ColorSpinorField::Create(csParam) : r[i];
+      xSloppy[i] = ColorSpinorField::Create(csParam);
+      p[i] = ColorSpinorField::Create(csParam);
+      Ap[i] = ColorSpinorField::Create(csParam);
     }
+    ColorSpinorField *tmp = ColorSpinorField::Create(csParam);
+    // tmp2 only needed for multi-gpu Wilson-like kernels
+    ColorSpinorField *tmp2 = !mat.isStaggered() ? ColorSpinorField::Create(csParam) : tmp;
+    if (!tmp3) tmp3 = tmp;
 
-    // additional high-precision temporary if Wilson and mixed-precision
-    csParam.setPrecision(param.precision);
-    cudaColorSpinorField *tmp3_p =
-      (param.precision != param.precision_sloppy && !mat.isStaggered()) ?
-      new cudaColorSpinorField(x, csParam) : &tmp;
-    cudaColorSpinorField &tmp3 = *tmp3_p;
-
-    ColorSpinorField &xSloppy = *x_sloppy;
-    ColorSpinorField &rSloppy = *r_sloppy;
-
-    cudaColorSpinorField p(rSloppy);
-
-    if(&x != &xSloppy){
-      blas::copy(y,x);
-      blas::zero(xSloppy);
-    }else{
-      blas::zero(y);
-    }
-    
-    const bool use_heavy_quark_res = 
-      (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL) ? true : false;
-    bool heavy_quark_restart = false;
-    
     profile.TPSTOP(QUDA_PROFILE_INIT);
     profile.TPSTART(QUDA_PROFILE_PREAMBLE);
 
-    double r2_old;
-
-    double stop = stopping(param.tol, b2, param.residual_type); // stopping condition of solver
-
-    double heavy_quark_res = 0.0; // heavy quark residual
-    double heavy_quark_res_old = 0.0; // heavy quark residual
-
-    if (use_heavy_quark_res) {
-      heavy_quark_res = sqrt(blas::HeavyQuarkResidualNorm(x, r).z);
-      heavy_quark_res_old = heavy_quark_res; // heavy quark residual
-    }
-    const int heavy_quark_check = param.heavy_quark_check; // how often to check the heavy quark residual
-
-    double alpha=0.0, beta=0.0;
-    double pAp;
+    std::vector<double> r2(n_src), r2_old(n_src), pAp(n_src), stop(n_src);
+    std::vector<double> alpha(n_src), beta(n_src);
+    std::vector<double> r0Norm(n_src), maxrx(n_src), maxrr(n_src);
+    std::vector<int> iter(n_src, 0), resIncrease(n_src, 0), resIncreaseTotal(n_src, 0);
+    std::vector<bool> stalled(n_src, false);
+    std::vector<int> active;
     int rUpdate = 0;
 
-    double rNorm = sqrt(r2);
-    double r0Norm = rNorm;
-    double maxrx = rNorm;
-    double maxrr = rNorm;
-    double delta = param.delta;
+    // initial residuals: r = b - A x, with the initial guess moved to y
+    for (int i=0; i<n_src; i++) {
+      blas::copy(*y[i], *x[i]);
+      if (b2[i] == 0.0) {
+	warningQuda("MultiSrcCG: inverting on zero-field source %d", i);
+	blas::zero(*x[i]);
+	blas::zero(*y[i]);
+	continue;
+      }
+      mat(*r[i], *y[i], *x[i], *tmp3);
+      active.push_back(i);
+    }
+    fusedReduce(r2, active, [&](int i) { return blas::xmyNorm(*b[i], *r[i]); });
+
+    for (auto i : active) {
+      stop[i] = stopping(param.tol, b2[i], param.residual_type);
+      blas::copy(*rSloppy[i], *r[i]);
+      blas::copy(*p[i], *rSloppy[i]);
+      blas::zero(*xSloppy[i]);
+      r0Norm[i] = maxrx[i] = maxrr[i] = sqrt(r2[i]);
+    }
 
-    // this parameter determines how many consective reliable update
-    // reisudal increases we tolerate before terminating the solver,
-    // i.e., how long do we want to keep trying to converge
-    const int maxResIncrease = (use_heavy_quark_res ? 0 : param.max_res_increase); // check if we reached the limit of our tolerance
+    const int maxResIncrease = param.max_res_increase;
     const int maxResIncreaseTotal = param.max_res_increase_total;
-    // 0 means we have no tolerance
-    // maybe we should expose this as a parameter
-    const int hqmaxresIncrease = maxResIncrease + 1;
-
-    int resIncrease = 0;
-    int resIncreaseTotal = 0;
-    int hqresIncrease = 0;
-
-    // set this to true if maxResIncrease has been exceeded but when we use heavy quark residual we still want to continue the CG
-    // only used if we use the heavy_quark_res
-    bool L2breakdown =false;
 
     profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
     profile.TPSTART(QUDA_PROFILE_COMPUTE);
     blas::flops = 0;
 
-    int k=0;
-    
-    PrintStats("CG", k, r2, b2, heavy_quark_res);
-
-    int steps_since_reliable = 1;
-    bool converged = convergence(r2, heavy_quark_res, stop, param.tol_hq);
-
-    while ( !converged && k < param.maxiter) {
-      matSloppy(Ap, p, tmp, tmp2); // tmp as tmp
-    
-      double sigma;
-
-      bool breakdown = false;
-      if (param.pipeline) {
-	double3 triplet = blas::tripleCGReduction(rSloppy, Ap, p);
-	r2 = triplet.x; double Ap2 = triplet.y; pAp = triplet.z;
-	r2_old = r2;
-
-	alpha = r2 / pAp;        
-	sigma = alpha*(alpha * Ap2 - pAp);
-	if (sigma < 0.0 || steps_since_reliable==0) { // sigma condition has broken down
-	  r2 = blas::axpyNorm(-alpha, Ap, rSloppy);
-	  sigma = r2;
-	  breakdown = true;
-	}
-
-	r2 = sigma;
-      } else {
-	r2_old = r2;
-	pAp = blas::reDotProduct(p, Ap);
-	alpha = r2 / pAp;        
-
-	// here we are deploying the alternative beta computation 
-	Complex cg_norm = blas::axpyCGNorm(-alpha, Ap, rSloppy);
-	r2 = real(cg_norm); // (r_new, r_new)
-	sigma = imag(cg_norm) >= 0.0 ? imag(cg_norm) : r2; // use r2 if (r_k+1, r_k+1-r_k) breaks
+    // drop the converged sources from the batch
+    auto prune = [&](int k) {
+      std::vector<int> next;
+      for (auto i : active) {
+	if (r2[i] > stop[i] && !stalled[i]) next.push_back(i);
+	else if (getVerbosity() >= QUDA_VERBOSE)
+	  printfQuda("MultiSrcCG: source %d %s after %d iterations\n", i, stalled[i] ? "stalled" : "converged", k);
       }
-
-      // reliable update conditions
-      rNorm = sqrt(r2);
-      if (rNorm > maxrx) maxrx = rNorm;
-      if (rNorm > maxrr) maxrr = rNorm;
-      int updateX = (rNorm < delta*r0Norm && r0Norm <= maxrx) ? 1 : 0;
-      int updateR = ((rNorm < delta*maxrr && r0Norm <= maxrr) || updateX) ? 1 : 0;
-    
-      // force a reliable update if we are within target tolerance (only if doing reliable updates)
-      if ( convergence(r2, heavy_quark_res, stop, param.tol_hq) && param.delta >= param.tol) updateX = 1;
-
-      // For heavy-quark inversion force a reliable update if we continue after
-      if (use_heavy_quark_res and L2breakdown and convergenceHQ(r2, heavy_quark_res, stop, param.tol_hq) and param.delta >= param.tol) {
-	updateX = 1;
+      active = next;
+    };
+
+    // report the source that is furthest from convergence
+    auto stats = [&](int k) {
+      if (active.size() == 0) return;
+      int worst = active[0];
+      for (auto i : active) if (r2[i]/b2[i] > r2[worst]/b2[worst]) worst = i;
+      PrintStats("MultiSrcCG", k, r2[worst], b2[worst], 0.0);
+    };
+
+    int k = 0;
+    prune(k);
+    stats(k);
+
+    while (active.size() > 0 && k < param.maxiter) {
+      std::vector<ColorSpinorField*> p_, Ap_;
+      for (auto i : active) { p_.push_back(p[i]); Ap_.push_back(Ap[i]); }
+
+      // one operator application for the whole batch
+      matSloppy(Ap_, p_, *tmp, *tmp2);
+
+      fusedReduce(pAp, active, [&](int i) { return blas::reDotProduct(*p[i], *Ap[i]); });
+      for (auto i : active) {
+	r2_old[i] = r2[i];
+	alpha[i] = r2[i] / pAp[i];
       }
-
-      if ( !(updateR || updateX)) {
-	//beta = r2 / r2_old;
-	beta = sigma / r2_old; // use the alternative beta computation
-
-        if (param.pipeline && !breakdown) blas::tripleCGUpdate(alpha, beta, Ap, rSloppy, xSloppy, p);
-	else blas::axpyZpbx(alpha, p, xSloppy, rSloppy, beta);
-
-
-	if (use_heavy_quark_res && k%heavy_quark_check==0) { 
-	  if (&x != &xSloppy) {
-	    blas::copy(tmp,y);
-	    heavy_quark_res = sqrt(blas::xpyHeavyQuarkResidualNorm(xSloppy, tmp, rSloppy).z);
-	  } else {
-	    blas::copy(r, rSloppy);
-	    heavy_quark_res = sqrt(blas::xpyHeavyQuarkResidualNorm(x, y, r).z);	  
-	  }
-	}
-
-	steps_since_reliable++;
-      } else {
-	blas::axpy(alpha, p, xSloppy);
-	blas::copy(x, xSloppy); // nop when these pointers alias
-      
-	blas::xpy(x, y); // swap these around?
-	mat(r, y, x, tmp3); // here we can use x as tmp
-	r2 = blas::xmyNorm(b, r);
-
-	blas::copy(rSloppy, r); //nop when these pointers alias
-	blas::zero(xSloppy);
-
-	// calculate new reliable HQ resididual
-	if (use_heavy_quark_res) heavy_quark_res = sqrt(blas::HeavyQuarkResidualNorm(y, r).z);
-
-	// break-out check if we have reached the limit of the precision
-	if (sqrt(r2) > r0Norm && updateX) { // reuse r0Norm for this
-	  resIncrease++;
-	  resIncreaseTotal++;
-	  warningQuda("CG: new reliable residual norm %e is greater than previous reliable residual norm %e (total #inc %i)",
-		      sqrt(r2), r0Norm, resIncreaseTotal);
-	  if ( resIncrease > maxResIncrease or resIncreaseTotal > maxResIncreaseTotal) {
-            if (use_heavy_quark_res) {
-	      L2breakdown = true;
-            } else {
-	      warningQuda("CG: solver exiting due to too many true residual norm increases");
-	      break;
-	    }
-	  }
+      fusedReduce(r2, active, [&](int i) { return blas::axpyNorm(-alpha[i], *Ap[i], *rSloppy[i]); });
+
+      for (auto i : active) {
+	// reliable update conditions
+	const double rNorm = sqrt(r2[i]);
+	if (rNorm > maxrx[i]) maxrx[i] = rNorm;
+	if (rNorm > maxrr[i]) maxrr[i] = rNorm;
+	int updateX = (rNorm < param.delta*r0Norm[i] && r0Norm[i] <= maxrx[i]) ? 1 : 0;
+	int updateR = ((rNorm < param.delta*maxrr[i] && r0Norm[i] <= maxrr[i]) || updateX) ? 1 : 0;
+
+	// force a reliable update if we are within target tolerance (only if doing reliable updates)
+	if (r2[i] < stop[i] && param.delta >= param.tol) updateX = 1;
+
+	if ( !(updateR || updateX) ) {
+	  beta[i] = r2[i] / r2_old[i];
+	  blas::axpyZpbx(alpha[i], *p[i], *xSloppy[i], *rSloppy[i], beta[i]);
 	} else {
-	  resIncrease = 0;
-	}
-	// if L2 broke down already we turn off reliable updates and restart the CG
-	if (use_heavy_quark_res and L2breakdown) {
-	  delta = 0;
-	  warningQuda("CG: Restarting without reliable updates for heavy-quark residual");
-	  heavy_quark_restart = true;
-	  if (heavy_quark_res > heavy_quark_res_old) {
-	    hqresIncrease++;
-	    warningQuda("CG: new reliable HQ residual norm %e is greater than previous reliable residual norm %e", heavy_quark_res, heavy_quark_res_old);
-	    // break out if we do not improve here anymore
-	    if (hqresIncrease > hqmaxresIncrease) {
-	      warningQuda("CG: solver exiting due to too many heavy quark residual norm increases");
-	      break;
+	  blas::axpy(alpha[i], *p[i], *xSloppy[i]);
+	  blas::copy(*x[i], *xSloppy[i]);
+	  blas::xpy(*x[i], *y[i]);
+
+	  mat(*r[i], *y[i], *x[i], *tmp3); // here we can use x as tmp
+	  r2[i] = blas::xmyNorm(*b[i], *r[i]);
+
+	  blas::copy(*rSloppy[i], *r[i]); // nop when these pointers alias
+	  blas::zero(*xSloppy[i]);
+
+	  // break-out check if we have reached the limit of the precision
+	  if (sqrt(r2[i]) > r0Norm[i] && updateX) {
+	    resIncrease[i]++;
+	    resIncreaseTotal[i]++;
+	    warningQuda("MultiSrcCG: source %d new reliable residual norm %e is greater than previous reliable residual norm %e (total #inc %i)",
+			i, sqrt(r2[i]), r0Norm[i], resIncreaseTotal[i]);
+	    if (resIncrease[i] > maxResIncrease || resIncreaseTotal[i] > maxResIncreaseTotal) {
+	      warningQuda("MultiSrcCG: source %d exiting due to too many true residual norm increases", i);
+	      stalled[i] = true;
 	    }
+	  } else {
+	    resIncrease[i] = 0;
 	  }
-	}
 
-	rNorm = sqrt(r2);
-	maxrr = rNorm;
-	maxrx = rNorm;
-	r0Norm = rNorm;      
-	rUpdate++;
+	  r0Norm[i] = maxrx[i] = maxrr[i] = sqrt(r2[i]);
+	  rUpdate++;
 
-	if (use_heavy_quark_res and heavy_quark_restart) {
-	  // perform a restart
-	  blas::copy(p, rSloppy);
-	  heavy_quark_restart = false;
-	} else {
 	  // explicitly restore the orthogonality of the gradient vector
-	  double rp = blas::reDotProduct(rSloppy, p) / (r2);
-	  blas::axpy(-rp, rSloppy, p);
-          
-	  beta = r2 / r2_old;
-	  blas::xpay(rSloppy, beta, p);
-	}
+	  double rp = blas::reDotProduct(*rSloppy[i], *p[i]) / r2[i];
+	  blas::axpy(-rp, *rSloppy[i], *p[i]);
 
-
-        steps_since_reliable = 0;
-        heavy_quark_res_old = heavy_quark_res;
+	  beta[i] = r2[i] / r2_old[i];
+	  blas::xpay(*rSloppy[i], beta[i], *p[i]);
+	}
+	iter[i]++;
       }
 
-      breakdown = false;
       k++;
+      stats(k);
 
-      PrintStats("CG", k, r2, b2, heavy_quark_res);
-      // check convergence, if convergence is satisfied we only need to check that we had a reliable update for the heavy quarks recently
-      converged = convergence(r2, heavy_quark_res, stop, param.tol_hq);
-      
-      // check for recent enough reliable updates of the HQ residual if we use it
-      if (use_heavy_quark_res) {
-        // L2 is concverged or precision maxed out for L2
-        bool L2done = L2breakdown or convergenceL2(r2, heavy_quark_res, stop, param.tol_hq);
-        // HQ is converged and if we do reliable update the HQ residual has been calculated using a reliable update
-        bool HQdone = (steps_since_reliable == 0 and param.delta > 0) and convergenceHQ(r2, heavy_quark_res, stop, param.tol_hq);
-        converged = L2done and HQdone;
-      }
-
+      prune(k);
     }
 
-    blas::copy(x, xSloppy);
-    blas::xpy(y, x);
+    for (int i=0; i<n_src; i++) {
+      if (b2[i] == 0.0) continue;
+      blas::copy(*x[i], *xSloppy[i]);
+      blas::xpy(*y[i], *x[i]);
+    }
 
     profile.TPSTOP(QUDA_PROFILE_COMPUTE);
     profile.TPSTART(QUDA_PROFILE_EPILOGUE);
 
     param.secs = profile.Last(QUDA_PROFILE_COMPUTE);
     double gflops = (blas::flops + mat.flops() + matSloppy.flops())*1e-9;
-    reduceDouble(gflops);
     param.gflops = gflops;
     param.iter += k;
 
-    if (k==param.maxiter) 
-      warningQuda("Exceeded maximum iterations %d", param.maxiter);
+    if (k == param.maxiter) warningQuda("Exceeded maximum iterations %d", param.maxiter);
 
-    if (getVerbosity() >= QUDA_VERBOSE)
-      printfQuda("CG: Reliable updates = %d\n", rUpdate);
+    if (getVerbosity() >= QUDA_VERBOSE) printfQuda("MultiSrcCG: Reliable updates = %d\n", rUpdate);
 
     // compute the true residuals
-    mat(r, x, y, tmp3);
-    param.true_res = sqrt(blas::xmyNorm(b, r) / b2);
-    param.true_res_hq = sqrt(blas::HeavyQuarkResidualNorm(x,r).z);
+    std::vector<int> nonzero;
+    for (int i=0; i<n_src; i++) {
+      if (b2[i] == 0.0) {
+	param.true_res_offset[i] = 0.0;
+	param.true_res_hq_offset[i] = 0.0;
+      } else {
+	mat(*r[i], *x[i], *y[i], *tmp3);
+	nonzero.push_back(i);
+      }
+    }
 
-    PrintSummary("CG", k, r2, b2, stop, inv.tol_hq);
+    std::vector<double> true_r2(n_src, 0.0);
+    fusedReduce(true_r2, nonzero, [&](int i) { return blas::xmyNorm(*b[i], *r[i]); });
+
+    for (auto i : nonzero) {
+      param.true_res_offset[i] = sqrt(true_r2[i] / b2[i]);
+      param.true_res_hq_offset[i] = sqrt(blas::HeavyQuarkResidualNorm(*x[i], *r[i]).z);
+      param.true_res = param.true_res_offset[i];
+      param.true_res_hq = param.true_res_hq_offset[i];
+      char name[32];
+      sprintf(name, "MultiSrcCG (source %d)", i);
+      PrintSummary(name, iter[i], r2[i], b2[i], stop[i], param.tol_hq);
+    }
 
     // reset the flops counters
     blas::flops = 0;
@@ -345,14 +291,20 @@ namespace quda {
     profile.TPSTOP(QUDA_PROFILE_EPILOGUE);
     profile.TPSTART(QUDA_PROFILE_FREE);
 
-    if (&tmp3 != &tmp) delete tmp3_p;
-    if (&tmp2 != &tmp) delete tmp2_p;
-
-    if (rSloppy.Precision() != r.Precision()) delete r_sloppy;
-    if (xSloppy.Precision() != x.Precision()) delete x_sloppy;
+    if (tmp3 != tmp) delete tmp3;
+    if (tmp2 != tmp) delete tmp2;
+    delete tmp;
+
+    for (int i=0; i<n_src; i++) {
+      if (rSloppy[i] != r[i]) delete rSloppy[i];
+      delete xSloppy[i];
+      delete p[i];
+      delete Ap[i];
+      delete r[i];
+      delete y[i];
+    }
 
     profile.TPSTOP(QUDA_PROFILE_FREE);
-#endif
     return;
   }
 
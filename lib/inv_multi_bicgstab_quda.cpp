@@ -0,0 +1,309 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+
+#include <quda_internal.h>
+#include <color_spinor_field.h>
+#include <blas_quda.h>
+#include <dslash_quda.h>
+#include <invert_quda.h>
+#include <util_quda.h>
+
+/*!
+ * Multi-shift BiCGstab solver for the non-Hermitian shifted systems
+ *
+ *   (M + offset[i]) x_i = b
+ *
+ * The lowest offset (offset[0]) is the seed system on which BiCGstab
+ * is run.  The BiCG part of the residual of each shifted system is
+ * collinear with that of the seed, r_i = zeta_i r, as in multi-shift
+ * CG, while the stabilizing polynomial of the shifted system is
+ * chosen such that its factors are collinear with those of the seed,
+ * omega_i = omega / (1 + omega sigma_i), where sigma_i = offset[i] -
+ * offset[0] (Jegerlehner, hep-lat/9612014).  Each shifted system then
+ * only needs its own solution and search direction, which are
+ * updated from the seed residual and the seed matrix-vector products.
+ *
+ */
+
+namespace quda {
+
+  MultiShiftBiCGstab::MultiShiftBiCGstab(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param,
+                                         TimeProfile &profile)
+    : MultiShiftSolver(param, profile), mat(mat), matSloppy(matSloppy) {
+
+  }
+
+  MultiShiftBiCGstab::~MultiShiftBiCGstab() {
+
+  }
+
+  void MultiShiftBiCGstab::operator()(std::vector<ColorSpinorField*> x, ColorSpinorField &b)
+  {
+    if (checkLocation(*(x[0]), b) != QUDA_CUDA_FIELD_LOCATION)
+      errorQuda("Not supported");
+
+    profile.TPSTART(QUDA_PROFILE_INIT);
+
+    const int num_offset = param.num_offset;
+    const double *offset = param.offset;
+
+    if (num_offset == 0) return;
+
+    const double b2 = blas::norm2(b);
+    // Check to see that we're not trying to invert on a zero-field source
+    if (b2 == 0) {
+      profile.TPSTOP(QUDA_PROFILE_INIT);
+      printfQuda("Warning: inverting on zero-field source\n");
+      for (int i=0; i<num_offset; ++i) {
+        *(x[i]) = b;
+        param.true_res_offset[i] = 0.0;
+        param.true_res_hq_offset[i] = 0.0;
+      }
+      return;
+    }
+
+    const bool mixed = param.precision_sloppy != param.precision;
+
+    // this is the limit of precision possible
+    const double sloppy_tol= param.precision_sloppy == 8 ? std::numeric_limits<double>::epsilon() :
+      ((param.precision_sloppy == 4) ? std::numeric_limits<float>::epsilon() : pow(2.,-17));
+    const double fine_tol = pow(10.,(-2*(int)b.Precision()+1));
+    std::unique_ptr<double[]> prec_tol(new double[num_offset]);
+
+    prec_tol[0] = mixed ? sloppy_tol : fine_tol;
+    for (int i=1; i<num_offset; i++) {
+      prec_tol[i] = std::max(fine_tol,sqrt(param.tol_offset[i]*sloppy_tol));
+    }
+
+    ColorSpinorParam csParam(b);
+    csParam.create = QUDA_ZERO_FIELD_CREATE;
+    csParam.setPrecision(param.precision_sloppy);
+
+    // seed residual (also holds the intermediate residual s) and shadow residual
+    csParam.create = QUDA_COPY_FIELD_CREATE;
+    auto *r = new cudaColorSpinorField(b, csParam);
+    auto *r0 = new cudaColorSpinorField(b, csParam);
+
+    std::vector<ColorSpinorField*> x_sloppy(num_offset);
+    std::vector<ColorSpinorField*> p(num_offset);
+    for (int i=0; i<num_offset; i++) {
+      if (param.precision_sloppy == x[i]->Precision()) {
+        x_sloppy[i] = x[i];
+        blas::zero(*x_sloppy[i]);
+      } else {
+        csParam.create = QUDA_ZERO_FIELD_CREATE;
+        x_sloppy[i] = new cudaColorSpinorField(*x[i], csParam);
+      }
+      csParam.create = QUDA_COPY_FIELD_CREATE;
+      p[i] = new cudaColorSpinorField(b, csParam);
+    }
+
+    csParam.create = QUDA_ZERO_FIELD_CREATE;
+    auto *v = new cudaColorSpinorField(b, csParam);
+    auto *t = new cudaColorSpinorField(b, csParam);
+    cudaColorSpinorField tmp(b, csParam);
+
+    profile.TPSTOP(QUDA_PROFILE_INIT);
+    profile.TPSTART(QUDA_PROFILE_PREAMBLE);
+
+    // stopping condition of each shift
+    double stop[QUDA_MAX_MULTI_SHIFT];
+    double r2[QUDA_MAX_MULTI_SHIFT];
+    int iter[QUDA_MAX_MULTI_SHIFT]; // record how many iterations for each shift
+    bool active[QUDA_MAX_MULTI_SHIFT];
+
+    // coefficients of the shifted systems: zeta of the BiCG part at
+    // the current and previous iteration, and the accumulated
+    // stabilizing polynomial factor c
+    Complex zeta[QUDA_MAX_MULTI_SHIFT];
+    Complex zeta_old[QUDA_MAX_MULTI_SHIFT];
+    Complex c[QUDA_MAX_MULTI_SHIFT];
+
+    for (int i=0; i<num_offset; i++) {
+      r2[i] = b2;
+      stop[i] = Solver::stopping(param.tol_offset[i], b2, param.residual_type);
+      iter[i] = 0;
+      active[i] = true;
+      zeta[i] = zeta_old[i] = c[i] = 1.0;
+    }
+
+    Complex rho = b2;
+    Complex alpha_old = 1.0;
+    Complex beta_old = 0.0;
+
+    int k = 0;
+    int num_active = num_offset;
+    blas::flops = 0;
+
+    profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
+    profile.TPSTART(QUDA_PROFILE_COMPUTE);
+
+    if (getVerbosity() >= QUDA_VERBOSE)
+      printfQuda("MultiShift BiCGstab: %d iterations, <r,r> = %e, |r|/|b| = %e\n", k, r2[0], sqrt(r2[0]/b2));
+
+    while (num_active > 0 && k < param.maxiter) {
+
+      // v = (M + offset[0]) p
+      matSloppy(*v, *p[0], tmp);
+      if (offset[0] != 0.0) blas::axpy(offset[0], *p[0], *v);
+
+      Complex r0v = blas::cDotProduct(*r0, *v);
+      if (r0v == 0.0) {
+        warningQuda("MultiShift BiCGstab: breakdown, (r0, v) = 0 after %d iterations", k);
+        break;
+      }
+      Complex alpha = rho / r0v;
+
+      // s = r - alpha v
+      blas::caxpy(-alpha, *v, *r);
+
+      // t = (M + offset[0]) s
+      matSloppy(*t, *r, tmp);
+      if (offset[0] != 0.0) blas::axpy(offset[0], *r, *t);
+
+      double3 ts = blas::cDotProductNormA(*t, *r);
+      if (ts.z == 0.0) {
+        warningQuda("MultiShift BiCGstab: breakdown, |t| = 0 after %d iterations", k);
+        break;
+      }
+      Complex omega = Complex(ts.x, ts.y) / ts.z;
+
+      // update the solutions and the first half of the search
+      // directions, which needs s and v, before r is overwritten
+      for (int j=0; j<num_offset; j++) {
+        if (!active[j] && j > 0) continue;
+        const double sigma = offset[j] - offset[0];
+
+        Complex denom = alpha*beta_old*(zeta_old[j]-zeta[j]) + zeta_old[j]*alpha_old*(1.0+sigma*alpha);
+        Complex zeta_new = denom != 0.0 ? zeta[j]*zeta_old[j]*alpha_old / denom : 0.0;
+        Complex alpha_j = zeta[j] != 0.0 ? alpha*zeta_new / zeta[j] : 0.0;
+        Complex omega_j = omega / (1.0 + omega*sigma);
+
+        // x_j += alpha_j p_j + omega_j s_j, with s_j = c_j zeta_new s
+        blas::caxpbypz(alpha_j, *p[j], omega_j*c[j]*zeta_new, *r, *x_sloppy[j]);
+
+        // p_j -= (omega_j / alpha_j) (M + offset[j]) p_j, where
+        // alpha_j (M + offset[j]) p_j = r_j - s_j = c_j ((zeta_j - zeta_new) s + zeta_j alpha v)
+        if (alpha_j != 0.0) {
+          Complex a = -omega_j / alpha_j * c[j];
+          blas::caxpbypz(a*(zeta[j]-zeta_new), *r, a*zeta[j]*alpha, *v, *p[j]);
+        }
+
+        zeta_old[j] = zeta[j];
+        zeta[j] = zeta_new;
+        c[j] /= (1.0 + omega*sigma);
+      }
+
+      // r = s - omega t
+      double r2_seed = blas::caxpyNorm(-omega, *t, *r);
+
+      Complex rho_new = blas::cDotProduct(*r0, *r);
+      Complex beta = (alpha / omega) * (rho_new / rho);
+
+      // p_j = r_j + beta_j p_j, with r_j = c_j zeta_j r
+      for (int j=0; j<num_offset; j++) {
+        if (!active[j] && j > 0) continue;
+        Complex ratio = zeta_old[j] != 0.0 ? zeta[j] / zeta_old[j] : 0.0;
+        blas::caxpby(c[j]*zeta[j], *r, beta*ratio*ratio, *p[j]);
+        r2[j] = std::norm(c[j]*zeta[j]) * r2_seed;
+      }
+
+      alpha_old = alpha;
+      beta_old = beta;
+      rho = rho_new;
+      k++;
+
+      // remove the shifts that have converged from the updates
+      for (int j=0; j<num_offset; j++) {
+        if (active[j] && (r2[j] < stop[j] || sqrt(r2[j] / b2) < prec_tol[j])) {
+          active[j] = false;
+          num_active--;
+          iter[j] = k;
+          if (getVerbosity() >= QUDA_VERBOSE)
+            printfQuda("MultiShift BiCGstab: Shift %d converged after %d iterations\n", j, k);
+        }
+      }
+
+      if (getVerbosity() >= QUDA_VERBOSE)
+        printfQuda("MultiShift BiCGstab: %d iterations, <r,r> = %e, |r|/|b| = %e\n", k, r2[0], sqrt(r2[0]/b2));
+
+      if (rho == 0.0 && num_active > 0) {
+        warningQuda("MultiShift BiCGstab: breakdown, (r0, r) = 0 after %d iterations", k);
+        break;
+      }
+    }
+
+    for (int i=0; i<num_offset; i++) {
+      if (iter[i] == 0) iter[i] = k;
+      if (x_sloppy[i] != x[i]) blas::copy(*x[i], *x_sloppy[i]);
+    }
+
+    profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+    profile.TPSTART(QUDA_PROFILE_EPILOGUE);
+
+    if (k==param.maxiter) warningQuda("Exceeded maximum iterations %d\n", param.maxiter);
+
+    param.secs = profile.Last(QUDA_PROFILE_COMPUTE);
+    double gflops = (blas::flops + mat.flops() + matSloppy.flops())*1e-9;
+    param.gflops = gflops;
+    param.iter += k;
+
+    if (param.compute_true_res) {
+      csParam.setPrecision(param.precision);
+      csParam.create = QUDA_NULL_FIELD_CREATE;
+      cudaColorSpinorField r_true(b, csParam);
+      cudaColorSpinorField tmp_true(b, csParam);
+
+      for (int i = 0; i < num_offset; i++) {
+        mat(r_true, *x[i], tmp_true);
+        if (offset[i] != 0.0) blas::axpy(offset[i], *x[i], r_true);
+        double true_res = blas::xmyNorm(b, r_true);
+        param.true_res_offset[i] = sqrt(true_res / b2);
+        param.iter_res_offset[i] = sqrt(r2[i] / b2);
+        param.true_res_hq_offset[i] = sqrt(blas::HeavyQuarkResidualNorm(*x[i], r_true).z);
+      }
+
+      if (getVerbosity() >= QUDA_SUMMARIZE) {
+        printfQuda("MultiShift BiCGstab: Converged after %d iterations\n", k);
+        for (int i = 0; i < num_offset; i++) {
+          printfQuda(" shift=%d, %d iterations, relative residual: iterated = %e, true = %e\n",
+                     i, iter[i], param.iter_res_offset[i], param.true_res_offset[i]);
+        }
+      }
+    } else {
+      if (getVerbosity() >= QUDA_SUMMARIZE) {
+        printfQuda("MultiShift BiCGstab: Converged after %d iterations\n", k);
+        for (int i = 0; i < num_offset; i++) {
+          param.iter_res_offset[i] = sqrt(r2[i] / b2);
+          printfQuda(" shift=%d, %d iterations, relative residual: iterated = %e\n",
+                     i, iter[i], param.iter_res_offset[i]);
+        }
+      }
+    }
+
+    // reset the flops counters
+    blas::flops = 0;
+    mat.flops();
+    matSloppy.flops();
+
+    profile.TPSTOP(QUDA_PROFILE_EPILOGUE);
+    profile.TPSTART(QUDA_PROFILE_FREE);
+
+    for (int i=0; i<num_offset; i++) {
+      if (x_sloppy[i] != x[i]) delete x_sloppy[i];
+      delete p[i];
+    }
+
+    delete t;
+    delete v;
+    delete r0;
+    delete r;
+
+    profile.TPSTOP(QUDA_PROFILE_FREE);
+
+    return;
+  }
+
+} // namespace quda
@@ -9,6 +9,7 @@
 #include <dslash_quda.h>
 #include <invert_quda.h>
 #include <util_quda.h>
+#include <deflation.h>
 
 /*!
  * Generic Multi Shift Solver 
@@ -178,7 +179,33 @@ namespace quda {
       }
       return;
     }
-    
+
+    // with a deflation space the guess of every shift is deflated at
+    // once, and the iteration runs on the common projected residual
+    deflated_solver *defl = static_cast<deflated_solver*>(param.deflation_op);
+    const bool deflate = defl && defl->defl && defl->defl->size() > 0;
+    ColorSpinorField *b_defl = &b;
+    std::vector<ColorSpinorField*> x_defl;
+    if (deflate) {
+      // with approximate eigenvectors the deflated residuals of the
+      // shifts are no longer collinear, so only the true residual tells
+      // whether a shift has converged
+      if (!param.compute_true_res) errorQuda("Deflated multi-shift CG requires compute_true_res");
+      if (defl->RV->Component(0).Volume() != b.Volume())
+        errorQuda("Deflation space volume %d does not match the source volume %d", defl->RV->Component(0).Volume(), b.Volume());
+
+      ColorSpinorParam csParam(b);
+      csParam.create = QUDA_NULL_FIELD_CREATE;
+      b_defl = new cudaColorSpinorField(b, csParam);
+      for (int i=0; i<num_offset; i++) x_defl.push_back(new cudaColorSpinorField(b, csParam));
+
+      // for staggered the lowest shift is folded into the operator
+      double shift[QUDA_MAX_MULTI_SHIFT];
+      for (int i=0; i<num_offset; i++) shift[i] = b.Nspin() == 4 ? offset[i] : offset[i] - offset[0];
+      (*defl->defl)(x_defl, *b_defl, b, shift);
+    }
+    const double b2_defl = deflate ? blas::norm2(*b_defl) : b2;
+
     bool exit_early = false;
     bool mixed = param.precision_sloppy != param.precision;
     // whether we will switch to refinement on unshifted system after other shifts have converged
@@ -214,7 +241,7 @@ namespace quda {
       if (param.tol_offset[j] < param.delta) reliable = true;
 
 
-    auto *r = new cudaColorSpinorField(b);
+    auto *r = new cudaColorSpinorField(*b_defl);
     std::vector<ColorSpinorField*> x_sloppy;
     x_sloppy.resize(num_offset);
     std::vector<ColorSpinorField*> y;
@@ -277,12 +304,39 @@ namespace quda {
     double r2[QUDA_MAX_MULTI_SHIFT];
     int iter[QUDA_MAX_MULTI_SHIFT+1];     // record how many iterations for each shift
     for (int i=0; i<num_offset; i++) {
-      r2[i] = b2;
+      r2[i] = b2_defl;
       stop[i] = Solver::stopping(param.tol_offset[i], b2, param.residual_type);
       iter[i] = 0;
     }
+
+    // heavy shifts that have converged from the deflated guess alone
+    // take no part in the iteration, once their true residual confirms it
+    int num_offset_active = num_offset;
+    if (deflate) {
+      while (num_offset_active > 1 && r2[num_offset_active-1] < stop[num_offset_active-1]) {
+        const int i = num_offset_active-1;
+        mat(*r, *x_defl[i], *x[0], tmp3); // here we can use x as tmp
+        if (r->Nspin() == 4) blas::axpy(offset[i], *x_defl[i], *r);
+        else blas::axpy(offset[i] - offset[0], *x_defl[i], *r);
+        const double r2_true = blas::xmyNorm(b, *r);
+        if (r2_true >= stop[i]) {
+          if (getVerbosity() >= QUDA_VERBOSE)
+            printfQuda("MultiShift CG: Shift %d deflated residual %e but true residual %e, keeping it\n",
+                       i, sqrt(b2_defl / b2), sqrt(r2_true / b2));
+          break;
+        }
+        r2[i] = r2_true;
+        num_offset_active--;
+      }
+      blas::copy(*r, *b_defl);
+      blas::zero(*x_sloppy[0]);
+    }
+    num_offset_now = num_offset_active;
+    if (num_offset_active < num_offset && getVerbosity() >= QUDA_VERBOSE)
+      printfQuda("MultiShift CG: Shifts %d to %d converged after deflation\n", num_offset_active, num_offset-1);
+
     // this initial condition ensures that the heaviest shift can be removed
-    iter[num_offset] = 1;
+    iter[num_offset_active] = 1;
 
     double r2_old;
     double pAp;
@@ -392,7 +446,7 @@ namespace quda {
 	mat(*r, *y[0], *x[0], tmp3); // here we can use x as tmp
 	if (r->Nspin()==4) blas::axpy(offset[0], *y[0], *r);
 
-	r2[0] = blas::xmyNorm(b, *r);
+	r2[0] = blas::xmyNorm(*b_defl, *r);
 	for (int j=1; j<num_offset_now; j++) r2[j] = zeta[j] * zeta[j] * r2[0];
 	for (int j=0; j<num_offset_now; j++) blas::zero(*x_sloppy[j]);
 
@@ -482,9 +536,11 @@ namespace quda {
     }
     
     for (int i=0; i<num_offset; i++) {
-      if (iter[i] == 0) iter[i] = k;
+      if (i >= num_offset_active) iter[i] = 0;
+      else if (iter[i] == 0) iter[i] = k;
       blas::copy(*x[i], *x_sloppy[i]);
       if (reliable) blas::xpy(*y[i], *x[i]);
+      if (deflate) blas::xpy(*x_defl[i], *x[i]);
     }
 
     profile.TPSTOP(QUDA_PROFILE_COMPUTE);
@@ -493,6 +549,11 @@ namespace quda {
     if (getVerbosity() >= QUDA_VERBOSE)
       printfQuda("MultiShift CG: Reliable updates = %d\n", rUpdate);
 
+    if (deflate && getVerbosity() >= QUDA_SUMMARIZE)
+      printfQuda("MultiShift CG: Deflated with %d vectors, initial relative residual %e, %d iterations, "
+                 "%d shifts converged from the deflated guess\n",
+                 defl->defl->size(), sqrt(b2_defl / b2), k, num_offset - num_offset_active);
+
     if (k==param.maxiter) warningQuda("Exceeded maximum iterations %d\n", param.maxiter);
     
     param.secs = profile.Last(QUDA_PROFILE_COMPUTE);
@@ -573,6 +634,11 @@ namespace quda {
   
     delete r;
 
+    if (deflate) {
+      delete b_defl;
+      for (auto &xd : x_defl) delete xd;
+    }
+
     if (reliable) for (int i=0; i<num_offset; i++) delete y[i];
 
     delete Ap;
@@ -0,0 +1,342 @@
+#include <cmath>
+
+#include <quda_internal.h>
+#include <color_spinor_field.h>
+#include <blas_quda.h>
+#include <invert_quda.h>
+#include <util_quda.h>
+
+/**
+   @file inv_pipe_cg_quda.cpp
+
+   Implementation of the pipelined CG algorithm of Ghysels and
+   Vanroose, "Hiding global synchronization latency in the
+   preconditioned Conjugate Gradient algorithm", Parallel Computing
+   40 (2014) 224.  With w = A r, s = A p, z = A s and q = A w, each
+   iteration is
+
+     gamma = (r,r), delta = (w,r)   (non-blocking global reduction)
+     q = A w                        (overlapped with the reduction)
+     beta = gamma / gamma_old, alpha = gamma / (delta - beta * gamma / alpha_old)
+     z = q + beta z, s = w + beta s, w = w - alpha z
+     p = r + beta p, x = x + alpha p, r = r - alpha s
+
+   The residual replacement used for the reliable updates follows
+   Cools et al., "Analyzing the effect of local rounding error
+   propagation on the maximal attainable accuracy of the pipelined
+   Conjugate Gradient method", SIAM J. Matrix Anal. Appl. 39 (2018) 426.
+*/
+
+namespace quda {
+
+  PipelinedCG::PipelinedCG(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile) :
+    Solver(param, profile), mat(mat), matSloppy(matSloppy), init(false), rp(nullptr), yp(nullptr),
+    rSloppyp(nullptr), xSloppyp(nullptr), pp(nullptr), sp(nullptr), wp(nullptr), zp(nullptr), qp(nullptr),
+    tmpp(nullptr), tmp2p(nullptr), tmp3p(nullptr) { }
+
+  PipelinedCG::~PipelinedCG() {
+    profile.TPSTART(QUDA_PROFILE_FREE);
+    if (init) {
+      if (param.precision != param.precision_sloppy) {
+	if (rSloppyp) delete rSloppyp;
+	if (xSloppyp) delete xSloppyp;
+      }
+      if (rp) delete rp;
+      if (yp) delete yp;
+      if (pp) delete pp;
+      if (sp) delete sp;
+      if (wp) delete wp;
+      if (zp) delete zp;
+      if (qp) delete qp;
+      if (tmpp) delete tmpp;
+      if (!mat.isStaggered()) {
+	if (tmp2p && tmpp != tmp2p) delete tmp2p;
+	if (tmp3p && tmpp != tmp3p && param.precision != param.precision_sloppy) delete tmp3p;
+      }
+      init = false;
+    }
+    profile.TPSTOP(QUDA_PROFILE_FREE);
+  }
+
+  void PipelinedCG::create(ColorSpinorField &x)
+  {
+    if (init) return;
+
+    ColorSpinorParam csParam(x);
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    rp = ColorSpinorField::Create(csParam);
+    yp = ColorSpinorField::Create(csParam);
+
+    // sloppy fields: the partial solution is always accumulated in
+    // sloppy precision so that the fused updates see a single precision
+    csParam.setPrecision(param.precision_sloppy);
+    if (param.precision != param.precision_sloppy) {
+      rSloppyp = ColorSpinorField::Create(csParam);
+      xSloppyp = ColorSpinorField::Create(csParam);
+    } else {
+      rSloppyp = rp;
+    }
+    pp = ColorSpinorField::Create(csParam);
+    sp = ColorSpinorField::Create(csParam);
+    wp = ColorSpinorField::Create(csParam);
+    zp = ColorSpinorField::Create(csParam);
+    qp = ColorSpinorField::Create(csParam);
+
+    // temporary fields
+    tmpp = ColorSpinorField::Create(csParam);
+    if (!mat.isStaggered()) {
+      // tmp2 only needed for multi-gpu Wilson-like kernels
+      tmp2p = ColorSpinorField::Create(csParam);
+      // additional high-precision temporary if Wilson and mixed-precision
+      csParam.setPrecision(param.precision);
+      tmp3p = (param.precision != param.precision_sloppy) ? ColorSpinorField::Create(csParam) : tmpp;
+    } else {
+      tmp3p = tmp2p = tmpp;
+    }
+
+    init = true;
+  }
+
+  void PipelinedCG::operator()(ColorSpinorField &x, ColorSpinorField &b)
+  {
+    if (checkLocation(x, b) != QUDA_CUDA_FIELD_LOCATION)
+      errorQuda("Not supported");
+    if (checkPrecision(x, b) != param.precision)
+      errorQuda("Precision mismatch: expected=%d, received=%d", param.precision, x.Precision());
+    if (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL)
+      errorQuda("Heavy-quark residual not supported by pipelined CG");
+
+    if (param.maxiter == 0 || param.Nsteps == 0) {
+      if (param.use_init_guess == QUDA_USE_INIT_GUESS_NO) blas::zero(x);
+      return;
+    }
+
+    profile.TPSTART(QUDA_PROFILE_INIT);
+
+    // Check to see that we're not trying to invert on a zero-field source
+    double b2 = blas::norm2(b);
+    if (b2 == 0 && param.compute_null_vector == QUDA_COMPUTE_NULL_VECTOR_NO) {
+      profile.TPSTOP(QUDA_PROFILE_INIT);
+      printfQuda("Warning: inverting on zero-field source\n");
+      x = b;
+      param.true_res = 0.0;
+      param.true_res_hq = 0.0;
+      return;
+    }
+
+    create(x);
+
+    ColorSpinorField &r = *rp;
+    ColorSpinorField &y = *yp;
+    ColorSpinorField &rSloppy = *rSloppyp;
+    ColorSpinorField &xSloppy = param.precision != param.precision_sloppy ? *xSloppyp : x;
+    ColorSpinorField &p = *pp;
+    ColorSpinorField &s = *sp;
+    ColorSpinorField &w = *wp;
+    ColorSpinorField &z = *zp;
+    ColorSpinorField &q = *qp;
+    ColorSpinorField &tmp = *tmpp;
+    ColorSpinorField &tmp2 = *tmp2p;
+    ColorSpinorField &tmp3 = *tmp3p;
+
+    // compute initial residual
+    double r2 = 0.0;
+    if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES) {
+      mat(r, x, y, tmp3);
+      r2 = blas::xmyNorm(b, r);
+      if (b2 == 0) b2 = r2;
+      blas::copy(y, x);
+    } else {
+      if (&r != &b) blas::copy(r, b);
+      r2 = b2;
+      blas::zero(y);
+    }
+    blas::zero(x);
+    if (&x != &xSloppy) blas::zero(xSloppy);
+    blas::copy(rSloppy, r);
+
+    // the first iteration has beta = 0, but the recurrences must still be finite
+    blas::zero(p);
+    blas::zero(s);
+    blas::zero(z);
+
+    profile.TPSTOP(QUDA_PROFILE_INIT);
+    profile.TPSTART(QUDA_PROFILE_PREAMBLE);
+
+    const double stop = stopping(param.tol, b2, param.residual_type); // stopping condition of solver
+
+    double rNorm = sqrt(r2);
+    double r0Norm = rNorm;
+    double maxrx = rNorm;
+    double maxrr = rNorm;
+    const double delta = param.delta;
+
+    // this parameter determines how many consective reliable update
+    // residual increases we tolerate before terminating the solver
+    const int maxResIncrease = param.max_res_increase;
+    const int maxResIncreaseTotal = param.max_res_increase_total;
+    int resIncrease = 0;
+    int resIncreaseTotal = 0;
+    int rUpdate = 0;
+
+    // the reduction is done globally unless we are a local (e.g.,
+    // additive Schwarz) solver
+    const bool global_reduction = commGlobalReduction();
+
+    profile.TPSTOP(QUDA_PROFILE_PREAMBLE);
+    profile.TPSTART(QUDA_PROFILE_COMPUTE);
+    blas::flops = 0;
+
+    // (r,r) and (w,r), summed over ranks while the next operator is applied
+    double sum[2];
+
+    matSloppy(w, rSloppy, tmp, tmp2);
+    commGlobalReductionSet(false);
+    double3 rw = blas::cDotProductNormA(rSloppy, w);
+    commGlobalReductionSet(global_reduction);
+    sum[0] = rw.z;
+    sum[1] = rw.x;
+    ReduceHandle *reduction = reduceDoubleArrayStart(sum, 2);
+
+    int k = 0;
+    double r2_old = 0.0;
+    double alpha_old = 0.0;
+    bool restart = true; // whether the next iteration starts with beta = 0
+
+    PrintStats("PipelinedCG", k, r2, b2, 0.0);
+
+    while (true) {
+      // apply the operator while the reduction is in flight
+      matSloppy(q, w, tmp, tmp2);
+      reduceDoubleArrayWait(reduction);
+      r2 = sum[0];
+      double wr = sum[1];
+      if (k > 0) PrintStats("PipelinedCG", k, r2, b2, 0.0);
+
+      // reliable update conditions
+      rNorm = sqrt(r2);
+      if (rNorm > maxrx) maxrx = rNorm;
+      if (rNorm > maxrr) maxrr = rNorm;
+      int updateX = (rNorm < delta*r0Norm && r0Norm <= maxrx) ? 1 : 0;
+      int updateR = ((rNorm < delta*maxrr && r0Norm <= maxrr) || updateX) ? 1 : 0;
+
+      // force a reliable update if we are within target tolerance (only if doing reliable updates)
+      bool converged = convergence(r2, 0.0, stop, param.tol_hq);
+      if (converged && param.delta >= param.tol) updateX = 1;
+      if (k == 0) updateX = updateR = 0; // the residual is already the true one
+
+      if (converged && !(updateR || updateX)) break;
+
+      if (updateR || updateX) {
+	// accumulate the solution and replace the residual by the true one
+	blas::copy(x, xSloppy); // nop when these pointers alias
+	blas::xpy(x, y);
+	mat(r, y, x, tmp3); // here we can use x as tmp
+	r2 = blas::xmyNorm(b, r);
+	blas::copy(rSloppy, r); // nop when these pointers alias
+	blas::zero(xSloppy);
+	rUpdate++;
+
+	// break-out check if we have reached the limit of the precision
+	if (sqrt(r2) > r0Norm && updateX) { // reuse r0Norm for this
+	  resIncrease++;
+	  resIncreaseTotal++;
+	  warningQuda("PipelinedCG: new reliable residual norm %e is greater than previous reliable residual norm %e (total #inc %i)",
+		      sqrt(r2), r0Norm, resIncreaseTotal);
+	  if (resIncrease > maxResIncrease or resIncreaseTotal > maxResIncreaseTotal) {
+	    warningQuda("PipelinedCG: solver exiting due to too many true residual norm increases");
+	    break;
+	  }
+	} else {
+	  resIncrease = 0;
+	}
+
+	rNorm = sqrt(r2);
+	r0Norm = rNorm;
+	maxrr = rNorm;
+	maxrx = rNorm;
+
+	if (convergence(r2, 0.0, stop, param.tol_hq)) break;
+
+	// rebuild the auxiliary vectors from the true residual and the current direction
+	matSloppy(w, rSloppy, tmp, tmp2);
+	matSloppy(q, w, tmp, tmp2);
+	if (!restart) {
+	  matSloppy(s, p, tmp, tmp2);
+	  matSloppy(z, s, tmp, tmp2);
+	}
+	rw = blas::cDotProductNormA(rSloppy, w);
+	r2 = rw.z;
+	wr = rw.x;
+      }
+
+      if (k == param.maxiter) break;
+
+      double alpha, beta;
+      if (!restart) {
+	beta = r2 / r2_old;
+	alpha = r2 / (wr - beta * r2 / alpha_old);
+	if (!(alpha > 0.0)) {
+	  // the recurrence for alpha has broken down: restart from the current residual
+	  warningQuda("PipelinedCG: restarting at iteration %d since alpha = %e", k, alpha);
+	  restart = true;
+	}
+      }
+      if (restart) {
+	beta = 0.0;
+	alpha = r2 / wr;
+	if (!(alpha > 0.0)) errorQuda("PipelinedCG: operator is not positive definite, (w,r) = %e", wr);
+	restart = false;
+      }
+
+      // z = q + beta z, s = w + beta s, w = w - alpha z
+      blas::pipeCGUpdate(alpha, beta, q, z, w, s);
+
+      // p = r + beta p, x = x + alpha p, r = r - alpha s, with the local (r,r) and (w,r)
+      commGlobalReductionSet(false);
+      double2 rw_local = blas::pipeCGUpdateNorm(alpha, beta, rSloppy, p, s, xSloppy, w);
+      commGlobalReductionSet(global_reduction);
+      sum[0] = rw_local.x;
+      sum[1] = rw_local.y;
+      reduction = reduceDoubleArrayStart(sum, 2);
+
+      r2_old = r2;
+      alpha_old = alpha;
+      k++;
+    }
+
+    blas::copy(x, xSloppy);
+    blas::xpy(y, x);
+
+    profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+    profile.TPSTART(QUDA_PROFILE_EPILOGUE);
+
+    param.secs = profile.Last(QUDA_PROFILE_COMPUTE);
+    double gflops = (blas::flops + mat.flops() + matSloppy.flops())*1e-9;
+    param.gflops = gflops;
+    param.iter += k;
+
+    if (k == param.maxiter)
+      warningQuda("Exceeded maximum iterations %d", param.maxiter);
+
+    if (getVerbosity() >= QUDA_VERBOSE)
+      printfQuda("PipelinedCG: Reliable updates = %d\n", rUpdate);
+
+    if (param.compute_true_res) {
+      // compute the true residuals
+      mat(r, x, y, tmp3);
+      param.true_res = sqrt(blas::xmyNorm(b, r) / b2);
+      param.true_res_hq = 0.0;
+    }
+
+    PrintSummary("PipelinedCG", k, r2, b2, stop, param.tol_hq);
+
+    // reset the flops counters
+    blas::flops = 0;
+    mat.flops();
+    matSloppy.flops();
+
+    profile.TPSTOP(QUDA_PROFILE_EPILOGUE);
+  }
+
+} // namespace quda
@@ -0,0 +1,305 @@
+#include <invert_quda.h>
+#include <blas_quda.h>
+#include <util_quda.h>
+#include <Eigen/Dense>
+
+#include <cmath>
+#include <limits>
+
+namespace quda {
+
+  PolySmoother::PolySmoother(DiracMatrix &mat, DiracMatrix &matSloppy, SolverParam &param, TimeProfile &profile) :
+    Solver(param, profile), mat(mat), matSloppy(matSloppy), rp(nullptr), r_sloppy(nullptr), Arp(nullptr),
+    dp(nullptr), tmpp(nullptr), tmp_sloppy(nullptr), x_sloppy(nullptr), init(false), degree(0),
+    theta(0.0), delta(0.0)
+  {
+    if (param.inv_type != QUDA_GMRES_POLYNOMIAL_INVERTER && param.inv_type != QUDA_CHEBYSHEV_INVERTER)
+      errorQuda("Invalid polynomial type %d", param.inv_type);
+    if (param.schwarz_type == QUDA_MULTIPLICATIVE_SCHWARZ)
+      errorQuda("Multiplicative Schwarz not supported by the polynomial smoother");
+  }
+
+  PolySmoother::~PolySmoother() {
+    if (!param.is_preconditioner) profile.TPSTART(QUDA_PROFILE_FREE);
+    if (init) {
+      if (x_sloppy) delete x_sloppy;
+      if (tmp_sloppy) delete tmp_sloppy;
+      if (tmpp) delete tmpp;
+      if (dp) delete dp;
+      if (Arp) delete Arp;
+      if (r_sloppy) delete r_sloppy;
+      if (rp) delete rp;
+    }
+    if (!param.is_preconditioner) profile.TPSTOP(QUDA_PROFILE_FREE);
+  }
+
+  void PolySmoother::computePolynomial(ColorSpinorField &v0, ColorSpinorField &tmp)
+  {
+    const int m = param.maxiter;
+
+    // a zero residual leaves the polynomial to be computed by the next application
+    double v2 = blas::norm2(v0);
+    if (v2 == 0.0) return;
+
+    // Arnoldi basis and upper Hessenberg matrix
+    ColorSpinorParam csParam(v0);
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    std::vector<ColorSpinorField*> V(m+1);
+    for (int i=0; i<=m; i++) V[i] = ColorSpinorField::Create(csParam);
+
+    using namespace Eigen;
+    MatrixXcd H = MatrixXcd::Zero(m+1, m);
+
+    blas::copy(*V[0], v0);
+    blas::ax(1.0/sqrt(v2), *V[0]);
+
+    int k = 0;
+    while (k < m) {
+      matSloppy(*V[k+1], *V[k], tmp);
+
+      // modified Gram-Schmidt with one reorthogonalization pass
+      for (int pass=0; pass<2; pass++) {
+	for (int i=0; i<=k; i++) {
+	  Complex h = blas::cDotProduct(*V[i], *V[k+1]);
+	  H(i,k) += h;
+	  blas::caxpy(-h, *V[i], *V[k+1]);
+	}
+      }
+
+      const double h = sqrt(blas::norm2(*V[k+1]));
+      H(k+1,k) = h;
+      k++;
+
+      // an invariant subspace has been found
+      if (h <= 1e-12 * H.topLeftCorner(k+1,k).norm()) break;
+      blas::ax(1.0/h, *V[k]);
+    }
+
+    for (int i=0; i<=m; i++) delete V[i];
+
+    degree = k;
+    const MatrixXcd Hk = H.topLeftCorner(k,k);
+
+    if (param.inv_type == QUDA_GMRES_POLYNOMIAL_INVERTER) {
+      // the roots of the GMRES residual polynomial are the harmonic Ritz
+      // values, the eigenvalues of H_k + |h_{k+1,k}|^2 H_k^{-dagger} e_k e_k^T
+      VectorXcd e_k = VectorXcd::Zero(k);
+      e_k(k-1) = 1.0;
+      VectorXcd f = Hk.adjoint().fullPivLu().solve(e_k);
+      MatrixXcd G = Hk;
+      G.col(k-1) += std::norm(H(k,k-1)) * f;
+      ComplexEigenSolver<MatrixXcd> eig(G, false);
+
+      // Leja ordering keeps the intermediate products of the Newton form bounded
+      std::vector<Complex> theta_(eig.eigenvalues().data(), eig.eigenvalues().data() + k);
+      roots.clear();
+      std::vector<bool> used(k, false);
+      std::vector<double> log_dist(k, 0.0);
+      for (int j=0; j<k; j++) {
+	int next = -1;
+	for (int i=0; i<k; i++) {
+	  if (used[i]) continue;
+	  const double score = j == 0 ? std::abs(theta_[i]) : log_dist[i];
+	  if (next < 0 || score > (j == 0 ? std::abs(theta_[next]) : log_dist[next])) next = i;
+	}
+	used[next] = true;
+	roots.push_back(theta_[next]);
+	for (int i=0; i<k; i++) {
+	  if (!used[i]) log_dist[i] += std::log(std::abs(theta_[i] - theta_[next]) + std::numeric_limits<double>::min());
+	}
+      }
+
+      for (auto &root : roots) {
+	if (std::abs(root) == 0.0) errorQuda("GMRES polynomial has a zero root");
+      }
+
+      if (getVerbosity() >= QUDA_VERBOSE) {
+	printfQuda("GMRES polynomial of degree %d, roots:\n", degree);
+	for (auto &root : roots) printfQuda("  (%e, %e)\n", root.real(), root.imag());
+      }
+    } else {
+      // the Ritz values converge to the extremal eigenvalues from the
+      // inside, so the upper bound is given a margin
+      ComplexEigenSolver<MatrixXcd> eig(Hk, false);
+      double lambda_min = std::numeric_limits<double>::max(), lambda_max = -std::numeric_limits<double>::max();
+      for (int i=0; i<k; i++) {
+	lambda_min = std::min(lambda_min, eig.eigenvalues()(i).real());
+	lambda_max = std::max(lambda_max, eig.eigenvalues()(i).real());
+      }
+      lambda_max *= 1.1;
+      if (lambda_max <= 0.0) errorQuda("Chebyshev smoother requires a positive spectrum, lambda_max = %e", lambda_max);
+      if (lambda_min <= 0.0 || lambda_min >= lambda_max) {
+	warningQuda("Chebyshev smoother: lower spectral bound %e replaced by %e", lambda_min, 0.1 * lambda_max);
+	lambda_min = 0.1 * lambda_max;
+      }
+
+      theta = 0.5 * (lambda_max + lambda_min);
+      delta = 0.5 * (lambda_max - lambda_min);
+
+      if (getVerbosity() >= QUDA_VERBOSE)
+	printfQuda("Chebyshev polynomial of degree %d on [%e, %e]\n", degree, lambda_min, lambda_max);
+    }
+  }
+
+  void PolySmoother::setup(const ColorSpinorField &meta)
+  {
+    if (param.maxiter == 0 || param.Nsteps == 0) return;
+
+    ColorSpinorParam csParam(meta);
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    csParam.setPrecision(param.precision_sloppy);
+    ColorSpinorField *v0 = ColorSpinorField::Create(csParam);
+    ColorSpinorField *tmp = ColorSpinorField::Create(csParam);
+
+    if (v0->Location() == QUDA_CPU_FIELD_LOCATION) v0->Source(QUDA_RANDOM_SOURCE);
+    else spinorNoise(*v0, 1234, QUDA_NOISE_UNIFORM);
+
+    degree = 0;
+    commGlobalReductionSet(param.global_reduction);
+    computePolynomial(*v0, *tmp);
+    commGlobalReductionSet(true);
+
+    delete tmp;
+    delete v0;
+  }
+
+  void PolySmoother::flipMu()
+  {
+    for (auto &root : roots) root = std::conj(root);
+  }
+
+  void PolySmoother::operator()(ColorSpinorField &x, ColorSpinorField &b)
+  {
+    if (checkPrecision(x,b) != param.precision) errorQuda("Precision mismatch %d %d", checkPrecision(x,b), param.precision);
+
+    if (param.maxiter == 0 || param.Nsteps == 0) {
+      if (param.use_init_guess == QUDA_USE_INIT_GUESS_NO) blas::zero(x);
+      return;
+    }
+
+    if (!init) {
+      bool mixed = param.precision != param.precision_sloppy;
+
+      ColorSpinorParam csParam(x);
+      csParam.create = QUDA_NULL_FIELD_CREATE;
+
+      // Source needs to be preserved if we're computing the true residual
+      rp = (param.use_init_guess == QUDA_USE_INIT_GUESS_YES || param.preserve_source == QUDA_PRESERVE_SOURCE_YES
+	    || param.Nsteps > 1 || param.compute_true_res == 1) ?
+	ColorSpinorField::Create(csParam) : nullptr;
+
+      tmpp = (param.use_init_guess == QUDA_USE_INIT_GUESS_YES || param.Nsteps > 1 || param.compute_true_res) ?
+	ColorSpinorField::Create(csParam) : nullptr;
+
+      // now allocate sloppy fields
+      csParam.setPrecision(param.precision_sloppy);
+
+      r_sloppy = mixed ? ColorSpinorField::Create(csParam) : nullptr;
+      Arp = ColorSpinorField::Create(csParam);
+      dp = param.inv_type == QUDA_CHEBYSHEV_INVERTER ? ColorSpinorField::Create(csParam) : nullptr;
+      tmp_sloppy = (!tmpp || mixed) ? ColorSpinorField::Create(csParam) : nullptr;
+      x_sloppy = ColorSpinorField::Create(csParam);
+
+      init = true;
+    } // init
+
+    ColorSpinorField &r = rp ? *rp : b;
+    ColorSpinorField &rSloppy = r_sloppy ? *r_sloppy : r;
+    ColorSpinorField &Ar = *Arp;
+    ColorSpinorField &tmp = tmpp ? *tmpp : b;
+    ColorSpinorField &tmpSloppy = tmp_sloppy ? *tmp_sloppy : tmp;
+    ColorSpinorField &xSloppy = *x_sloppy;
+
+    if (!param.is_preconditioner) {
+      blas::flops = 0;
+      profile.TPSTART(QUDA_PROFILE_COMPUTE);
+    }
+
+    if (param.use_init_guess == QUDA_USE_INIT_GUESS_YES) {
+      mat(r, x, tmp);
+      blas::xpay(b, -1.0, r); // r = b - Ax0
+    } else {
+      blas::copy(r, b);
+      blas::zero(x);
+    }
+    blas::copy(rSloppy, r);
+
+    // without setup() the polynomial is computed once, from the first
+    // residual; with local reductions each domain gets the polynomial
+    // of its own block
+    if (!degree) {
+      commGlobalReductionSet(param.global_reduction);
+      computePolynomial(rSloppy, tmpSloppy);
+      commGlobalReductionSet(true);
+    }
+
+    for (int step=0; step<param.Nsteps; step++) {
+      const bool last = step == param.Nsteps - 1;
+
+      if (degree == 0) {
+	blas::zero(xSloppy);
+      } else if (param.inv_type == QUDA_GMRES_POLYNOMIAL_INVERTER) {
+	// Newton form of the residual polynomial: x += r / theta_j, r -= A r / theta_j
+	blas::zero(xSloppy);
+	for (int j=0; j<degree; j++) {
+	  matSloppy(Ar, rSloppy, tmpSloppy);
+	  blas::caxpyXmaz(1.0 / roots[j], rSloppy, xSloppy, Ar);
+	}
+      } else {
+	// Chebyshev iteration (Saad, Iterative Methods for Sparse Linear Systems, Alg. 12.1)
+	ColorSpinorField &d = *dp;
+	const double sigma = theta / delta;
+	double rho = 1.0 / sigma;
+	blas::zero(xSloppy);
+	blas::copy(d, rSloppy);
+	blas::ax(1.0 / theta, d);
+	for (int j=0; j<degree; j++) {
+	  matSloppy(Ar, d, tmpSloppy);
+	  blas::axpy(-1.0, Ar, rSloppy);
+	  const double rho_new = 1.0 / (2.0 * sigma - rho);
+	  // x += d, d = rho_new * rho * d + 2 rho_new / delta * r
+	  blas::axpyBzpcx(1.0, d, xSloppy, 2.0 * rho_new / delta, rSloppy, rho_new * rho);
+	  rho = rho_new;
+	}
+      }
+
+      blas::axpy(1.0, xSloppy, x);
+
+      if (param.compute_true_res || param.Nsteps > 1) {
+	mat(r, x, tmp);
+	const double r2 = blas::xmyNorm(b, r);
+	param.true_res = sqrt(r2 / blas::norm2(b));
+
+	// if not preserving source and finished then overide source with residual
+	if (param.preserve_source == QUDA_PRESERVE_SOURCE_NO && last) blas::copy(b, r);
+	else blas::copy(rSloppy, r);
+
+	if (getVerbosity() >= QUDA_SUMMARIZE)
+	  printfQuda("PolySmoother: %d cycle, degree %d, relative residual: true = %e\n", step+1, degree, param.true_res);
+      } else {
+	// the residual of the recurrence is used without any reduction
+	if (param.preserve_source == QUDA_PRESERVE_SOURCE_NO && last) blas::copy(b, rSloppy);
+	else blas::copy(r, rSloppy);
+
+	if (getVerbosity() >= QUDA_VERBOSE)
+	  printfQuda("PolySmoother: %d cycle, degree %d, iterated residual norm = %e\n", step+1, degree, sqrt(blas::norm2(rSloppy)));
+      }
+    }
+
+    if (!param.is_preconditioner) {
+      profile.TPSTOP(QUDA_PROFILE_COMPUTE);
+      profile.TPSTART(QUDA_PROFILE_EPILOGUE);
+      param.secs += profile.Last(QUDA_PROFILE_COMPUTE);
+
+      // store flops and reset counters
+      double gflops = (blas::flops + mat.flops() + matSloppy.flops())*1e-9;
+
+      param.gflops += gflops;
+      param.iter += param.Nsteps * degree;
+      blas::flops = 0;
+
+      profile.TPSTOP(QUDA_PROFILE_EPILOGUE);
+    }
+  }
+
+} // namespace quda
@@ -0,0 +1,342 @@
+#include <matrix_powers.h>
+#include <comm_quda.h>
+#include <algorithm>
+
+namespace quda {
+
+  /**
+     @brief Copy the sites of a box of an extended field to or from a
+     contiguous buffer
+     @param[in,out] field Extended field
+     @param[in,out] buffer Contiguous buffer
+     @param[in] E Extended lattice dimensions
+     @param[in] lo Lower corner of the box
+     @param[in] hi Upper corner of the box (exclusive)
+     @param[in] site_len Number of complex numbers per site
+     @param[in] pack Whether to copy from the field to the buffer or the other way around
+  */
+  static void copy_box(std::complex<double> *field, std::complex<double> *buffer, const int E[],
+		       const int lo[], const int hi[], int site_len, bool pack)
+  {
+    int i = 0;
+    for (int x3=lo[3]; x3<hi[3]; x3++)
+      for (int x2=lo[2]; x2<hi[2]; x2++)
+	for (int x1=lo[1]; x1<hi[1]; x1++)
+	  for (int x0=lo[0]; x0<hi[0]; x0++) {
+	    std::complex<double> *site = field + (size_t)(((x3*E[2] + x2)*E[1] + x1)*E[0] + x0)*site_len;
+	    if (pack) std::copy(site, site+site_len, buffer + (size_t)i*site_len);
+	    else std::copy(buffer + (size_t)i*site_len, buffer + (size_t)(i+1)*site_len, site);
+	    i++;
+	  }
+  }
+
+  CoarseMatrixPowers::CoarseMatrixPowers(const cpuGaugeField &Y_, const cpuGaugeField &X_, double kappa,
+					 int depth, const int *commDim)
+    : depth(depth), nDim(Y_.Ndim()), n(Y_.Ncolor()), kappa(kappa), volumeEx(1), nPartitioned(0),
+      messages(0), messages_baseline(0), flops(0)
+  {
+    if (nDim != 4) errorQuda("Number of dimensions %d not supported", nDim);
+    if (Y_.Order() != QUDA_QDP_GAUGE_ORDER || X_.Order() != QUDA_QDP_GAUGE_ORDER)
+      errorQuda("Gauge field orders %d %d not supported", Y_.Order(), X_.Order());
+    if (Y_.Geometry() != QUDA_COARSE_GEOMETRY) errorQuda("Unexpected link geometry %d", Y_.Geometry());
+    if (Y_.Precision() != X_.Precision()) errorQuda("Precisions %d %d do not match", Y_.Precision(), X_.Precision());
+    if (depth < 1) errorQuda("Invalid depth %d", depth);
+
+    for (int d=0; d<nDim; d++) {
+      X[d] = Y_.X()[d];
+      R[d] = (comm_dim_partitioned(d) && commDim[d]) ? depth : 0;
+      if (R[d] > X[d]) errorQuda("Halo depth %d exceeds the local lattice dimension X[%d] = %d", R[d], d, X[d]);
+      E[d] = X[d] + 2*R[d];
+      volumeEx *= E[d];
+      if (R[d]) nPartitioned++;
+    }
+
+    Y.resize((size_t)volumeEx*2*nDim*n*n);
+    Xc.resize((size_t)volumeEx*n*n);
+    v.resize((size_t)(depth+1)*volumeEx*n);
+
+    // copy the links into the interior of the extended fields
+    const int volumeCB = Y_.VolumeCB();
+    const int geometry = Y_.Geometry();
+    int x[4];
+    for (x[3]=0; x[3]<X[3]; x[3]++)
+      for (x[2]=0; x[2]<X[2]; x[2]++)
+	for (x[1]=0; x[1]<X[1]; x[1]++)
+	  for (x[0]=0; x[0]<X[0]; x[0]++) {
+	    const int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+	    const int x_cb = (((x[3]*X[2] + x[2])*X[1] + x[1])*X[0] + x[0]) >> 1;
+	    const int xe[4] = { x[0]+R[0], x[1]+R[1], x[2]+R[2], x[3]+R[3] };
+	    const int idx = index(xe);
+
+	    for (int i=0; i<n*n; i++) {
+	      for (int dir=0; dir<geometry; dir++) {
+		const size_t offset = (size_t)(parity*volumeCB + x_cb)*n*n + i;
+		Y[((size_t)idx*geometry + dir)*n*n + i] = Y_.Precision() == QUDA_DOUBLE_PRECISION ?
+		  std::complex<double>(static_cast<const std::complex<double>* const*>(Y_.Gauge_p())[dir][offset]) :
+		  std::complex<double>(static_cast<const std::complex<float>* const*>(Y_.Gauge_p())[dir][offset]);
+	      }
+	      const size_t offset = (size_t)(parity*volumeCB + x_cb)*n*n + i;
+	      Xc[(size_t)idx*n*n + i] = X_.Precision() == QUDA_DOUBLE_PRECISION ?
+		std::complex<double>(static_cast<const std::complex<double>* const*>(X_.Gauge_p())[0][offset]) :
+		std::complex<double>(static_cast<const std::complex<float>* const*>(X_.Gauge_p())[0][offset]);
+	    }
+	  }
+
+    // the link halos are filled once and reused for every application
+    exchange(Y.data(), geometry*n*n, depth);
+    exchange(Xc.data(), n*n, depth);
+  }
+
+  bool CoarseMatrixPowers::Matches(const int *commDim) const
+  {
+    for (int d=0; d<nDim; d++) if ((R[d] > 0) != (comm_dim_partitioned(d) && commDim[d])) return false;
+    return true;
+  }
+
+  int CoarseMatrixPowers::exchange(complex *field, int site_len, int d)
+  {
+    int sent = 0;
+
+    for (int dim=0; dim<nDim; dim++) {
+      if (!R[dim]) continue;
+
+      // the face spans the halos of the dimensions already exchanged
+      int lo[4], hi[4];
+      for (int e=0; e<nDim; e++) {
+	lo[e] = (R[e] && e < dim) ? R[e] - d : R[e];
+	hi[e] = (R[e] && e < dim) ? R[e] + X[e] + d : R[e] + X[e];
+      }
+
+      size_t face_volume = d;
+      for (int e=0; e<nDim; e++) if (e != dim) face_volume *= hi[e] - lo[e];
+      const size_t bytes = face_volume * site_len * sizeof(complex);
+
+      std::vector<complex> send_back(face_volume*site_len), send_fwd(face_volume*site_len);
+      std::vector<complex> recv_back(face_volume*site_len), recv_fwd(face_volume*site_len);
+
+      lo[dim] = R[dim]; hi[dim] = R[dim] + d;
+      copy_box(field, send_back.data(), E, lo, hi, site_len, true);
+      lo[dim] = R[dim] + X[dim] - d; hi[dim] = R[dim] + X[dim];
+      copy_box(field, send_fwd.data(), E, lo, hi, site_len, true);
+
+      MsgHandle *mh_recv_back = comm_declare_receive_relative(recv_back.data(), dim, -1, bytes);
+      MsgHandle *mh_recv_fwd = comm_declare_receive_relative(recv_fwd.data(), dim, +1, bytes);
+      MsgHandle *mh_send_back = comm_declare_send_relative(send_back.data(), dim, -1, bytes);
+      MsgHandle *mh_send_fwd = comm_declare_send_relative(send_fwd.data(), dim, +1, bytes);
+
+      comm_start(mh_recv_back);
+      comm_start(mh_recv_fwd);
+      comm_start(mh_send_fwd);
+      comm_start(mh_send_back);
+
+      comm_wait(mh_send_fwd);
+      comm_wait(mh_send_back);
+      comm_wait(mh_recv_back);
+      comm_wait(mh_recv_fwd);
+
+      comm_free(mh_send_fwd);
+      comm_free(mh_send_back);
+      comm_free(mh_recv_back);
+      comm_free(mh_recv_fwd);
+      sent += 2;
+
+      lo[dim] = R[dim] - d; hi[dim] = R[dim];
+      copy_box(field, recv_back.data(), E, lo, hi, site_len, false);
+      lo[dim] = R[dim] + X[dim]; hi[dim] = R[dim] + X[dim] + d;
+      copy_box(field, recv_fwd.data(), E, lo, hi, site_len, false);
+    }
+
+    return sent;
+  }
+
+  // out(x) = X(x) in(x) - kappa \sum_mu [ Y_{-mu}(x) in(x+mu) + Y^\dagger_mu(x-mu) in(x-mu) ]
+  void CoarseMatrixPowers::apply(complex *out, const complex *in, int r, bool dagger)
+  {
+    const int geometry = 2*nDim;
+    int lo[4], hi[4];
+    for (int d=0; d<nDim; d++) {
+      lo[d] = R[d] ? R[d] - r : 0;
+      hi[d] = R[d] ? R[d] + X[d] + r : X[d];
+    }
+
+    long long sites = 0;
+    std::vector<complex> hop(n);
+    int x[4];
+    for (x[3]=lo[3]; x[3]<hi[3]; x[3]++)
+      for (x[2]=lo[2]; x[2]<hi[2]; x[2]++)
+	for (x[1]=lo[1]; x[1]<hi[1]; x[1]++)
+	  for (x[0]=lo[0]; x[0]<hi[0]; x[0]++) {
+	    const int idx = index(x);
+	    complex *o = out + (size_t)idx*n;
+	    const complex *X_ = &Xc[(size_t)idx*n*n];
+	    const complex *i0 = in + (size_t)idx*n;
+
+	    std::fill(hop.begin(), hop.end(), 0.0);
+	    for (int d=0; d<nDim; d++) {
+	      // communicated dimensions are extended, the others are periodic
+	      int xf[4] = { x[0], x[1], x[2], x[3] }, xb[4] = { x[0], x[1], x[2], x[3] };
+	      xf[d] = R[d] ? x[d] + 1 : (x[d] + 1) % X[d];
+	      xb[d] = R[d] ? x[d] - 1 : (x[d] - 1 + X[d]) % X[d];
+	      const int fwd = index(xf), back = index(xb);
+
+	      const complex *Yf = &Y[((size_t)idx*geometry + (dagger ? d : d+4))*n*n];
+	      const complex *Yb = &Y[((size_t)back*geometry + (dagger ? d+4 : d))*n*n];
+	      const complex *in_f = in + (size_t)fwd*n;
+	      const complex *in_b = in + (size_t)back*n;
+
+	      for (int row=0; row<n; row++)
+		for (int col=0; col<n; col++)
+		  hop[row] += Yf[row*n+col] * in_f[col] + std::conj(Yb[col*n+row]) * in_b[col];
+	    }
+
+	    for (int row=0; row<n; row++) {
+	      complex sum = -kappa * hop[row];
+	      for (int col=0; col<n; col++) sum += (dagger ? std::conj(X_[col*n+row]) : X_[row*n+col]) * i0[col];
+	      o[row] = sum;
+	    }
+	    sites++;
+	  }
+
+    flops += sites * (2*nDim + 1) * 8ll*n*n;
+  }
+
+  template <typename Float>
+  void CoarseMatrixPowers::load(const ColorSpinorField &in)
+  {
+    const std::complex<Float> *src = static_cast<const std::complex<Float>*>(in.V());
+    const size_t offset_cb = (in.Bytes()>>1) / sizeof(std::complex<Float>);
+
+    int x[4];
+    for (x[3]=0; x[3]<X[3]; x[3]++)
+      for (x[2]=0; x[2]<X[2]; x[2]++)
+	for (x[1]=0; x[1]<X[1]; x[1]++)
+	  for (x[0]=0; x[0]<X[0]; x[0]++) {
+	    const int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+	    const int x_cb = (((x[3]*X[2] + x[2])*X[1] + x[1])*X[0] + x[0]) >> 1;
+	    const int xe[4] = { x[0]+R[0], x[1]+R[1], x[2]+R[2], x[3]+R[3] };
+	    for (int i=0; i<n; i++) v[(size_t)index(xe)*n + i] = src[parity*offset_cb + (size_t)x_cb*n + i];
+	  }
+  }
+
+  template <typename Float>
+  void CoarseMatrixPowers::store(ColorSpinorField &out, int power) const
+  {
+    std::complex<Float> *dst = static_cast<std::complex<Float>*>(out.V());
+    const size_t offset_cb = (out.Bytes()>>1) / sizeof(std::complex<Float>);
+    const complex *w = &v[(size_t)power*volumeEx*n];
+
+    int x[4];
+    for (x[3]=0; x[3]<X[3]; x[3]++)
+      for (x[2]=0; x[2]<X[2]; x[2]++)
+	for (x[1]=0; x[1]<X[1]; x[1]++)
+	  for (x[0]=0; x[0]<X[0]; x[0]++) {
+	    const int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+	    const int x_cb = (((x[3]*X[2] + x[2])*X[1] + x[1])*X[0] + x[0]) >> 1;
+	    const int xe[4] = { x[0]+R[0], x[1]+R[1], x[2]+R[2], x[3]+R[3] };
+	    for (int i=0; i<n; i++) dst[parity*offset_cb + (size_t)x_cb*n + i] = w[(size_t)index(xe)*n + i];
+	  }
+  }
+
+  static void checkField(const ColorSpinorField &a, int n, const int *X)
+  {
+    if (a.Location() != QUDA_CPU_FIELD_LOCATION) errorQuda("Field location %d not supported", a.Location());
+    if (a.Ndim() == 5 ? a.X(4) != 1 : a.Ndim() != 4) errorQuda("Multiple right-hand sides not supported");
+    if (a.SiteSubset() != QUDA_FULL_SITE_SUBSET) errorQuda("Site subset %d not supported", a.SiteSubset());
+    if (a.SiteOrder() != QUDA_EVEN_ODD_SITE_ORDER) errorQuda("Site order %d not supported", a.SiteOrder());
+    if (a.FieldOrder() != QUDA_SPACE_SPIN_COLOR_FIELD_ORDER) errorQuda("Field order %d not supported", a.FieldOrder());
+    if (a.Nspin()*a.Ncolor() != n) errorQuda("Field has %d components per site, expected %d", a.Nspin()*a.Ncolor(), n);
+    for (int d=0; d<4; d++) if (a.X(d) != X[d]) errorQuda("Field dimension X[%d] = %d does not match %d", d, a.X(d), X[d]);
+    if (a.Precision() != QUDA_DOUBLE_PRECISION && a.Precision() != QUDA_SINGLE_PRECISION)
+      errorQuda("Precision %d not supported", a.Precision());
+  }
+
+  void CoarseMatrixPowers::operator()(std::vector<ColorSpinorField*> &out, const ColorSpinorField &in, bool dagger)
+  {
+    checkField(in, n, X);
+    for (auto o : out) checkField(*o, n, X);
+
+    if (in.Precision() == QUDA_DOUBLE_PRECISION) load<double>(in);
+    else load<float>(in);
+
+    const int K = out.size();
+    for (int k=0; k<K; ) {
+      const int m = std::min(depth, K - k); // number of powers computed from this halo exchange
+
+      messages += exchange(v.data(), n, m);
+      messages_baseline += 2 * nPartitioned * m;
+
+      // each application shrinks the valid region by one site
+      for (int j=1; j<=m; j++) apply(&v[(size_t)j*volumeEx*n], &v[(size_t)(j-1)*volumeEx*n], m-j, dagger);
+
+      for (int j=1; j<=m; j++) {
+	if (out[k+j-1]->Precision() == QUDA_DOUBLE_PRECISION) store<double>(*out[k+j-1], j);
+	else store<float>(*out[k+j-1], j);
+      }
+
+      // the last power is the starting point of the next round
+      if (k + m < K) std::copy(v.begin() + (size_t)m*volumeEx*n, v.begin() + (size_t)(m+1)*volumeEx*n, v.begin());
+      k += m;
+    }
+  }
+
+  void CoarseMatrixPowers::solveDomain(ColorSpinorField &x, const ColorSpinorField &b, int overlap, int niter,
+				       double omega, bool dagger)
+  {
+    checkField(x, n, X);
+    checkField(b, n, X);
+    if (overlap < 1 || overlap >= depth) errorQuda("Overlap %d not supported by a kernel of depth %d", overlap, depth);
+
+    // r = v[0], e = v[1], Ar = v[2]; everything beyond the overlap stays zero
+    const size_t len = (size_t)volumeEx*n;
+    complex *r = v.data(), *e = r + len, *Ar = e + len;
+    std::fill(v.begin(), v.begin() + 3*len, 0.0);
+
+    if (b.Precision() == QUDA_DOUBLE_PRECISION) load<double>(b);
+    else load<float>(b);
+
+    messages += exchange(r, n, overlap);
+    messages_baseline += 2 * nPartitioned;
+
+    // sites of the local domain extended by the overlap
+    int lo[4], hi[4];
+    for (int d=0; d<nDim; d++) {
+      lo[d] = R[d] ? R[d] - overlap : 0;
+      hi[d] = R[d] ? R[d] + X[d] + overlap : X[d];
+    }
+    std::vector<int> domain;
+    int y[4];
+    for (y[3]=lo[3]; y[3]<hi[3]; y[3]++)
+      for (y[2]=lo[2]; y[2]<hi[2]; y[2]++)
+	for (y[1]=lo[1]; y[1]<hi[1]; y[1]++)
+	  for (y[0]=lo[0]; y[0]<hi[0]; y[0]++) domain.push_back(index(y));
+
+    for (int k=0; k<niter; k++) {
+      apply(Ar, r, overlap, dagger);
+
+      complex Ar_r = 0.0;
+      double Ar2 = 0.0;
+      for (auto idx : domain) {
+	for (int i=0; i<n; i++) {
+	  const size_t j = (size_t)idx*n + i;
+	  Ar_r += std::conj(Ar[j]) * r[j];
+	  Ar2 += std::norm(Ar[j]);
+	}
+      }
+      if (Ar2 == 0.0) break;
+
+      const complex alpha = omega * Ar_r / Ar2;
+      for (auto idx : domain) {
+	for (int i=0; i<n; i++) {
+	  const size_t j = (size_t)idx*n + i;
+	  e[j] += alpha * r[j];
+	  r[j] -= alpha * Ar[j];
+	}
+      }
+      flops += (long long)domain.size() * n * 24;
+    }
+
+    if (x.Precision() == QUDA_DOUBLE_PRECISION) store<double>(x, 1);
+    else store<float>(x, 1);
+  }
+
+} // namespace quda
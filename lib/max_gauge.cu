@@ -54,13 +54,32 @@ namespace quda {
     return norm_;
   }
 
+  /**
+     The reductions above apply a single scale factor to the whole
+     field, so row-scaled fields are reduced on a single-precision copy
+  */
+  double normRowScaled(const GaugeField &u, int d, norm_type_ type) {
+    GaugeFieldParam param(u);
+    param.create = QUDA_NULL_FIELD_CREATE;
+    param.row_scale = false;
+    param.setPrecision(QUDA_SINGLE_PRECISION);
+    GaugeField *tmp = u.Location() == QUDA_CUDA_FIELD_LOCATION ?
+      static_cast<GaugeField*>(new cudaGaugeField(param)) : static_cast<GaugeField*>(new cpuGaugeField(param));
+    tmp->copy(u);
+    double norm_ = norm<float>(*tmp, d, type);
+    delete tmp;
+    return norm_;
+  }
+
   double GaugeField::norm2(int d) const {
     if (reconstruct != QUDA_RECONSTRUCT_NO) errorQuda("Unsupported reconstruct=%d", reconstruct);
+    if (row_scale) return normRowScaled(*this, d, NORM2);
     double nrm2 = 0.0;
     switch(precision) {
     case QUDA_DOUBLE_PRECISION: nrm2 = norm<double>(*this, d, NORM2); break;
     case QUDA_SINGLE_PRECISION: nrm2 = norm< float>(*this, d, NORM2); break;
     case   QUDA_HALF_PRECISION: nrm2 = norm< short>(*this, d, NORM2); break;
+    case QUDA_QUARTER_PRECISION: nrm2 = norm<  char>(*this, d, NORM2); break;
     default: errorQuda("Unsupported precision %d", precision);
     }
     return nrm2;
@@ -68,11 +87,13 @@ namespace quda {
 
   double GaugeField::abs_max(int d) const {
     if (reconstruct != QUDA_RECONSTRUCT_NO) errorQuda("Unsupported reconstruct=%d", reconstruct);
+    if (row_scale) return normRowScaled(*this, d, ABS_MAX);
     double max = 0.0;
     switch(precision) {
     case QUDA_DOUBLE_PRECISION: max = norm<double>(*this, d, ABS_MAX); break;
     case QUDA_SINGLE_PRECISION: max = norm< float>(*this, d, ABS_MAX); break;
     case   QUDA_HALF_PRECISION: max = norm< short>(*this, d, ABS_MAX); break;
+    case QUDA_QUARTER_PRECISION: max = norm<  char>(*this, d, ABS_MAX); break;
     default: errorQuda("Unsupported precision %d", precision);
     }
     return max;
@@ -80,11 +101,13 @@ namespace quda {
 
   double GaugeField::abs_min(int d) const {
     if (reconstruct != QUDA_RECONSTRUCT_NO) errorQuda("Unsupported reconstruct=%d", reconstruct);
+    if (row_scale) return normRowScaled(*this, d, ABS_MIN);
     double min = 0.0;
     switch(precision) {
     case QUDA_DOUBLE_PRECISION: min = norm<double>(*this, d, ABS_MIN); break;
     case QUDA_SINGLE_PRECISION: min = norm< float>(*this, d, ABS_MIN); break;
     case   QUDA_HALF_PRECISION: min = norm< short>(*this, d, ABS_MIN); break;
+    case QUDA_QUARTER_PRECISION: min = norm<  char>(*this, d, ABS_MIN); break;
     default: errorQuda("Unsupported precision %d", precision);
     }
     return min;
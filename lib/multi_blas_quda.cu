@@ -349,6 +349,13 @@ namespace quda {
     }
 
     void caxpy(const Complex *a_, std::vector<ColorSpinorField*> &x, std::vector<ColorSpinorField*> &y) {
+      if (x[0]->Location() == QUDA_CPU_FIELD_LOCATION) {
+        // no multi-blas kernels for host fields: fall back to one caxpy per coefficient
+        for (unsigned int i = 0; i < x.size(); i++)
+          for (unsigned int j = 0; j < y.size(); j++) caxpy(a_[i*y.size()+j], *x[i], *y[j]);
+        return;
+      }
+
       // Enter a recursion. 
       // Pass a, x, y. (0,0) indexes the tiles. false specifies the matrix is unstructured.
       caxpy_recurse(a_, x, y, 0, 0, 0);
@@ -606,6 +606,12 @@ namespace quda {
 
     void cDotProduct(Complex* result, std::vector<ColorSpinorField*>& x, std::vector<ColorSpinorField*>& y){
       if (x.size() == 0 || y.size() == 0) errorQuda("vector.size() == 0");
+      if (x[0]->Location() == QUDA_CPU_FIELD_LOCATION) {
+        // no multi-reduce kernels for host fields: fall back to one dot product per pair
+        for (unsigned int i = 0; i < x.size(); i++)
+          for (unsigned int j = 0; j < y.size(); j++) result[i*y.size()+j] = cDotProduct(*x[i], *y[j]);
+        return;
+      }
       Complex* result_tmp = new Complex[x.size()*y.size()];
       for (unsigned int i = 0; i < x.size()*y.size(); i++) result_tmp[i] = 0.0;
 
@@ -1,8 +1,13 @@
 #include <multigrid.h>
 #include <qio_field.h>
+#include <native_io.h>
 #include <string.h>
+#include <algorithm>
+#include <memory>
+#include <random>
 
-#include <quda_arpack_interface.h>
+#include <krylov_schur_quda.h>
+#include <agglomerate.h>
 
 namespace quda {  
 
@@ -20,7 +25,7 @@ namespace quda {
       diracResidual(param.matResidual->Expose()), diracSmoother(param.matSmooth->Expose()), diracSmootherSloppy(param.matSmoothSloppy->Expose()),
       diracCoarseResidual(nullptr), diracCoarseSmoother(nullptr), diracCoarseSmootherSloppy(nullptr),
       matCoarseResidual(nullptr), matCoarseSmoother(nullptr), matCoarseSmootherSloppy(nullptr),
-      rng(nullptr)
+      defl_y(nullptr), defl_r(nullptr), agglomerate(nullptr), rng(nullptr), restore(false)
   {
     postTrace();
 
@@ -35,6 +40,11 @@ namespace quda {
     if (param.coarse_grid_solution_type == QUDA_MATPC_SOLUTION && param.smoother_solve_type != QUDA_DIRECT_PC_SOLVE)
       errorQuda("Cannot use preconditioned coarse grid solution without preconditioned smoother solve");
 
+    // the checkpoint key is computed from the maximum n_vec, not the chosen one
+    if (param.level < param.Nlevel-1 && param.mg_global.setup_adaptive_nvec[param.level] == QUDA_BOOLEAN_YES &&
+        strcmp(param.mg_global.setup_checkpoint,"")!=0)
+      errorQuda("Setup checkpoints require a fixed n_vec; rerun with the n_vec chosen by the adaptive setup");
+
     // allocating vectors
     {
       // create residual vectors
@@ -61,7 +71,13 @@ namespace quda {
     }
 
     if (param.level < param.Nlevel-1) {
-      if (param.mg_global.compute_null_vector == QUDA_COMPUTE_NULL_VECTOR_YES) {
+      // a matching setup checkpoint replaces the null-space generation and coarse-operator construction
+      restore = strcmp(param.mg_global.setup_checkpoint,"")!=0 &&
+        is_checkpoint_native(checkpointFile().c_str(), param.checkpoint_key);
+
+      if (restore) {
+        if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Restoring setup from checkpoint %s\n", checkpointFile().c_str());
+      } else if (param.mg_global.compute_null_vector == QUDA_COMPUTE_NULL_VECTOR_YES) {
         if (param.mg_global.generate_all_levels == QUDA_BOOLEAN_YES || param.level == 0) {
 
           if (param.B[0]->Location() == QUDA_CUDA_FIELD_LOCATION) {
@@ -88,6 +104,81 @@ namespace quda {
     // in case of iterative setup with MG the coarse level may be already built
     if (!transfer) reset();
 
+    // checkpoint the complete hierarchy once the setup is finished
+    if (param.level == 0 && strcmp(param.mg_global.setup_checkpoint,"")!=0) saveCheckpoint();
+
+    setOutputPrefix("");
+    postTrace();
+  }
+
+  // the coarse gamma5 is +1 on the upper and -1 on the lower half of
+  // the coarse spin index
+  template <typename Float>
+  static void coarseGamma5(cpuColorSpinorField &v)
+  {
+    typedef std::complex<Float> complex;
+    const int n = v.Nspin()*v.Ncolor();
+    complex *v_ = static_cast<complex*>(v.V());
+    for (int x=0; x<v.Volume(); x++)
+      for (int i=n/2; i<n; i++) v_[(size_t)x*n+i] = -v_[(size_t)x*n+i];
+  }
+
+  static void coarseGamma5(ColorSpinorField &v)
+  {
+    ColorSpinorParam csParam(v);
+    csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+    csParam.setPrecision(v.Precision() < QUDA_SINGLE_PRECISION ? QUDA_SINGLE_PRECISION : v.Precision());
+    csParam.location = QUDA_CPU_FIELD_LOCATION;
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    cpuColorSpinorField tmp(csParam);
+    tmp = v;
+    if (tmp.Precision() == QUDA_DOUBLE_PRECISION) coarseGamma5<double>(tmp);
+    else coarseGamma5<float>(tmp);
+    v = tmp;
+  }
+
+  void MG::flipMu() {
+    postTrace();
+    setOutputPrefix(prefix);
+
+    for (auto s : {presmoother, postsmoother})
+      if (auto poly = dynamic_cast<PolySmoother*>(s)) poly->flipMu();
+
+    // the fine-level operators are owned by the interface, the
+    // coarser ones are the coarse operators of the level above
+    if (param.level == 0) {
+      std::vector<Dirac*> fine_dirac;
+      for (auto d : {diracResidual, diracSmoother, diracSmootherSloppy})
+        if (std::find(fine_dirac.begin(), fine_dirac.end(), d) == fine_dirac.end()) fine_dirac.push_back(const_cast<Dirac*>(d));
+      for (auto d : fine_dirac) d->flipMu();
+    }
+
+    if (param.level < param.Nlevel-1) {
+      // the coarse links of the preconditioned operator depend on mu
+      if (param.coarse_grid_solution_type == QUDA_MATPC_SOLUTION && param.smoother_solve_type == QUDA_DIRECT_PC_SOLVE)
+        errorQuda("Flipping mu requires the unpreconditioned operator to be coarsened");
+
+      // the smoothing operators share the links of the residual operator, so this goes first
+      diracCoarseResidual->flipMu();
+      diracCoarseSmoother->flipMu();
+      diracCoarseSmootherSloppy->flipMu();
+      if (getVerbosity() >= QUDA_VERBOSE)
+	printfQuda("Flipped coarse operator to mu = %e\n", diracCoarseResidual->Mu());
+      if (coarse) coarse->flipMu();
+      setOutputPrefix(prefix);
+
+      // the agglomerated operator holds a copy of the coarse links
+      if (agglomerate) agglomerate->flipMu();
+
+      // D(-mu) = gamma5 D(mu)^dagger gamma5, so the singular triplets
+      // (u, sigma, v) of D(mu) become (gamma5 v, sigma, gamma5 u)
+      if (defl_right.size() > 0) {
+        std::swap(defl_right, defl_left);
+        for (auto v : defl_right) coarseGamma5(*v);
+        for (auto v : defl_left) coarseGamma5(*v);
+      }
+    }
+
     setOutputPrefix("");
     postTrace();
   }
@@ -119,15 +210,28 @@ namespace quda {
       if (transfer) {
         // restoring FULL parity in Transfer changed at the end of this procedure
         transfer->setSiteSubset(QUDA_FULL_SITE_SUBSET, QUDA_INVALID_PARITY);
-        if (resetTransfer || refresh) {
+
+        bool rebuild = resetTransfer || refresh;
+        // incremental refresh: keep the prolongator while it still spans the relaxed null space
+        if (refresh && !resetTransfer && param.mg_global.setup_refresh_tol[param.level] > 0.0) {
+          double deviation = nullSpaceDeviation();
+          rebuild = deviation > param.mg_global.setup_refresh_tol[param.level];
+          if (getVerbosity() >= QUDA_SUMMARIZE)
+            printfQuda("Null-space deviation from the prolongator = %e, %s the prolongator\n", deviation, rebuild ? "rebuilding" : "keeping");
+        }
+
+        if (rebuild) {
           transfer->reset();
           resetTransfer = false;
         }
       } else {
+        if (param.mg_global.setup_adaptive_nvec[param.level] == QUDA_BOOLEAN_YES) selectNvec();
+
         // create transfer operator
         if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Creating transfer operator\n");
         transfer = new Transfer(param.B, param.Nvec, param.geoBlockSize, param.spinBlockSize,
-                                param.mg_global.precision_null[param.level], profile);
+                                param.mg_global.precision_null[param.level], profile, !restore);
+        if (restore) loadCheckpoint(false);
         for (int i=0; i<QUDA_MAX_MG_LEVEL; i++) param.mg_global.geo_block_size[param.level][i] = param.geoBlockSize[i];
 
         // create coarse temporary vector
@@ -254,7 +358,11 @@ namespace quda {
 
     param_presmooth->inv_type = param.smoother;
     param_presmooth->inv_type_precondition = QUDA_INVALID_INVERTER;
-    param_presmooth->residual_type = (param_presmooth->inv_type == QUDA_MR_INVERTER) ? QUDA_INVALID_RESIDUAL : QUDA_L2_RELATIVE_RESIDUAL;
+    // MR and the polynomial smoothers run a fixed number of iterations
+    param_presmooth->residual_type = (param_presmooth->inv_type == QUDA_MR_INVERTER ||
+				      param_presmooth->inv_type == QUDA_GMRES_POLYNOMIAL_INVERTER ||
+				      param_presmooth->inv_type == QUDA_CHEBYSHEV_INVERTER) ?
+      QUDA_INVALID_RESIDUAL : QUDA_L2_RELATIVE_RESIDUAL;
     param_presmooth->Nsteps = param.mg_global.smoother_schwarz_cycle[param.level];
     param_presmooth->maxiter = (param.level < param.Nlevel-1) ? param.nu_pre : param.nu_pre + param.nu_post;
 
@@ -269,6 +377,20 @@ namespace quda {
     // inner solver should recompute the true residual after each cycle if using Schwarz preconditioning
     param_presmooth->compute_true_res = (param_presmooth->schwarz_type != QUDA_INVALID_SCHWARZ) ? true : false;
 
+    // restricted additive Schwarz with overlapping domains, solved on the extended halo of the coarse operator
+    param_presmooth->schwarz_overlap = param.mg_global.smoother_schwarz_overlap[param.level];
+    if (param_presmooth->schwarz_overlap > 0) {
+      if (param_presmooth->schwarz_type != QUDA_ADDITIVE_SCHWARZ)
+	errorQuda("Schwarz overlap %d requires additive Schwarz", param_presmooth->schwarz_overlap);
+      if (param_presmooth->inv_type != QUDA_MR_INVERTER)
+	errorQuda("Schwarz overlap %d requires the MR smoother", param_presmooth->schwarz_overlap);
+      if (param.level == 0) errorQuda("Schwarz overlap is not supported on the fine grid");
+      if (param.location == QUDA_CUDA_FIELD_LOCATION)
+	errorQuda("Schwarz overlap requires level %d to be on the host", param.level+1);
+      if (param.mg_global.smoother_solve_type[param.level] != QUDA_DIRECT_SOLVE)
+	errorQuda("Schwarz overlap requires smoother solve type %d", QUDA_DIRECT_SOLVE);
+    }
+
     presmoother = ( (param.level < param.Nlevel-1 || param_presmooth->schwarz_type != QUDA_INVALID_SCHWARZ) &&
                     param_presmooth->inv_type != QUDA_INVALID_INVERTER && param_presmooth->maxiter > 0) ?
       Solver::create(*param_presmooth, *param.matSmooth, *param.matSmoothSloppy, *param.matSmoothSloppy, profile) : nullptr;
@@ -288,10 +410,258 @@ namespace quda {
       postsmoother = (param_postsmooth->inv_type != QUDA_INVALID_INVERTER && param_postsmooth->maxiter > 0) ?
 	Solver::create(*param_postsmooth, *param.matSmooth, *param.matSmoothSloppy, *param.matSmoothSloppy, profile) : nullptr;
     }
+
+    // compute the polynomial coefficients now rather than in the first cycle
+    ColorSpinorField &smoother_meta = param.smoother_solve_type == QUDA_DIRECT_PC_SOLVE ? *b_tilde : *r;
+    for (auto s : {presmoother, postsmoother})
+      if (auto poly = dynamic_cast<PolySmoother*>(s)) poly->setup(smoother_meta);
+
     if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Smoother done\n");
     postTrace();
   }
 
+  double MG::nullSpaceDeviation() {
+    // a single probe v = sum_k z_k v_k with random signs z_k, which is
+    // formed with one block caxpy and then restricted and prolongated once
+    static unsigned int seed = 0;
+    std::mt19937 gen(seed++);
+    std::unique_ptr<Complex[]> z(new Complex[param.Nvec]);
+    for (int i=0; i<param.Nvec; i++) z[i] = (gen() & 1) ? 1.0 : -1.0;
+
+    ColorSpinorParam bParam(*param.B[0]);
+    bParam.create = QUDA_ZERO_FIELD_CREATE;
+    std::unique_ptr<ColorSpinorField> v(ColorSpinorField::Create(bParam));
+    std::vector<ColorSpinorField*> B(param.B.begin(), param.B.begin() + param.Nvec);
+    std::vector<ColorSpinorField*> v_;
+    v_.push_back(v.get());
+    caxpy(z.get(), B, v_);
+
+    ColorSpinorParam csParam(*r);
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    std::unique_ptr<ColorSpinorField> tmp1(ColorSpinorField::Create(csParam));
+    std::unique_ptr<ColorSpinorField> tmp2(ColorSpinorField::Create(csParam));
+
+    // as well as copying to the correct location this also changes basis if necessary
+    *tmp1 = *v;
+
+    transfer->R(*r_coarse, *tmp1);
+    transfer->P(*tmp2, *r_coarse);
+
+    // the null-space vectors have unit norm, so the mean square of
+    // |(1 - P P^dagger) v| is the sum of their squared deviations
+    return sqrt( xmyNorm(*tmp1, *tmp2) );
+  }
+
+  void MG::solveCoarseBatch(std::vector<ColorSpinorField*> &x, std::vector<ColorSpinorField*> &b, SolverParam &solverParam) {
+    const int n = b.size();
+
+    // multi-source CG on the normal equations M^dagger M x_i = M^dagger b_i
+    SolverParam msrcParam(solverParam);
+    msrcParam.inv_type = QUDA_CG_INVERTER;
+    msrcParam.num_src = n;
+    msrcParam.iter = 0;
+    DiracMdagM mdagm(*diracCoarseResidual);
+    MultiSrcCG cg(mdagm, mdagm, msrcParam, profile);
+
+    ColorSpinorParam csParam(*b[0]);
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    std::vector<ColorSpinorField*> b_(n);
+    for (int i=0; i<n; i++) {
+      b_[i] = ColorSpinorField::Create(csParam);
+      diracCoarseResidual->Mdag(*b_[i], *b[i]);
+      zero(*x[i]);
+    }
+
+    cg.solve(x, b_);
+    solverParam.iter += msrcParam.iter;
+    solverParam.gflops += msrcParam.gflops;
+
+    for (auto v : b_) delete v;
+  }
+
+  double MG::twoGridConvergence(const std::vector<ColorSpinorField*> &e0, double &cost) {
+    const int n_test = e0.size();
+    const int n_cycle = 3; // number of two-grid cycles per test vector
+
+    ColorSpinorParam csParam(*r);
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    std::vector<ColorSpinorField*> x(n_test), res(n_test);
+    for (int i=0; i<n_test; i++) {
+      x[i] = ColorSpinorField::Create(csParam);
+      res[i] = ColorSpinorField::Create(csParam);
+    }
+    std::unique_ptr<ColorSpinorField> Ar(ColorSpinorField::Create(csParam));
+
+    ColorSpinorParam coarseParam(*r_coarse);
+    coarseParam.create = QUDA_NULL_FIELD_CREATE;
+    std::vector<ColorSpinorField*> x_c(n_test), r_c(n_test);
+    for (int i=0; i<n_test; i++) {
+      x_c[i] = ColorSpinorField::Create(coarseParam);
+      r_c[i] = ColorSpinorField::Create(coarseParam);
+    }
+
+    // the coarse systems of all test vectors are solved as one batch, converged as far as the coarse solver of the cycle
+    SolverParam solverParam(param);
+    solverParam.inv_type_precondition = QUDA_INVALID_INVERTER;
+    solverParam.preconditioner = nullptr;
+    solverParam.schwarz_type = QUDA_INVALID_SCHWARZ;
+    solverParam.is_preconditioner = false;
+    solverParam.residual_type = QUDA_L2_RELATIVE_RESIDUAL;
+    solverParam.tol = param.mg_global.coarse_solver_tol[param.level+1];
+    solverParam.maxiter = param.mg_global.coarse_solver_maxiter[param.level+1];
+    solverParam.global_reduction = true;
+    solverParam.delta = 1e-8;
+    solverParam.precision = r_coarse->Precision();
+    solverParam.precision_sloppy = solverParam.precision;
+    solverParam.precision_precondition = solverParam.precision;
+    solverParam.iter = 0;
+    solverParam.gflops = 0.0;
+
+    // MR relaxation of M x = 0, updating the residual res = -M x
+    auto smooth = [&](ColorSpinorField &x, ColorSpinorField &res, int nu) {
+      for (int j=0; j<nu; j++) {
+        (*param.matResidual)(*Ar, res);
+        Complex alpha = cDotProduct(*Ar, res) / norm2(*Ar);
+        caxpy(alpha, res, x);
+        caxpy(-alpha, *Ar, res);
+      }
+    };
+
+    // reset the flop counters
+    diracResidual->Flops();
+    transfer->flops();
+
+    // the solution of the homogeneous system is zero, so x is the error
+    std::vector<double> e0_norm(n_test);
+    for (int i=0; i<n_test; i++) {
+      *x[i] = *e0[i];
+      e0_norm[i] = norm2(*x[i]);
+      (*param.matResidual)(*res[i], *x[i]);
+      ax(-1.0, *res[i]);
+    }
+
+    for (int k=0; k<n_cycle; k++) {
+      for (int i=0; i<n_test; i++) {
+        smooth(*x[i], *res[i], param.nu_pre);
+        transfer->R(*r_c[i], *res[i]);
+      }
+
+      solveCoarseBatch(x_c, r_c, solverParam);
+
+      for (int i=0; i<n_test; i++) {
+        transfer->P(*Ar, *x_c[i]);
+        xpy(*Ar, *x[i]);
+        (*param.matResidual)(*res[i], *x[i]);
+        ax(-1.0, *res[i]);
+
+        smooth(*x[i], *res[i], param.nu_post);
+      }
+    }
+
+    double log_rho = 0.0;
+    for (int i=0; i<n_test; i++) {
+      double e = norm2(*x[i]);
+      if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Test vector %d: |e_%d| / |e_0| = %e\n", i, n_cycle, sqrt(e / e0_norm[i]));
+      log_rho += 0.5 * log(e / e0_norm[i]) / n_cycle;
+    }
+
+    cost = (diracResidual->Flops() + transfer->flops() + 1e9 * solverParam.gflops) / (n_test * n_cycle);
+
+    for (int i=0; i<n_test; i++) {
+      delete r_c[i];
+      delete x_c[i];
+      delete res[i];
+      delete x[i];
+    }
+
+    return exp(log_rho / n_test);
+  }
+
+  // coarse colors for which the restrictor, prolongator and coarse-operator construction are instantiated
+  static bool supportedNvec(int fine_colors, int n_vec) {
+    switch (fine_colors) {
+    case 3: return n_vec == 6 || n_vec == 24 || n_vec == 32;
+    case 6: return n_vec == 6;
+    case 24: return n_vec == 24 || n_vec == 32;
+    case 32: return n_vec == 32;
+    default: return false;
+    }
+  }
+
+  void MG::selectNvec() {
+    postTrace();
+    std::vector<int> candidates;
+    for (int n : {6, 24, 32})
+      if (n <= (int)param.B.size() && supportedNvec(param.B[0]->Ncolor(), n)) candidates.push_back(n);
+    if (candidates.size() == 0)
+      errorQuda("No supported number of null-space vectors for %d fine colors and at most %lu vectors",
+                param.B[0]->Ncolor(), param.B.size());
+
+    if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Choosing the number of null-space vectors (at most %lu)\n", param.B.size());
+
+    // every candidate is measured on the same random errors
+    const int n_test = 2;
+    ColorSpinorParam csParam(*r);
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    std::vector<ColorSpinorField*> e0(n_test);
+    for (int i=0; i<n_test; i++) {
+      e0[i] = ColorSpinorField::Create(csParam);
+      e0[i]->Source(QUDA_RANDOM_SOURCE);
+    }
+
+    int n_best = candidates[0];
+    double efficiency_best = 0.0;
+    for (unsigned int c=0; c<candidates.size(); c++) {
+      param.Nvec = candidates[c];
+
+      transfer = new Transfer(param.B, param.Nvec, param.geoBlockSize, param.spinBlockSize,
+                              param.mg_global.precision_null[param.level], profile);
+      QudaFieldLocation location = param.mg_global.location[param.level+1];
+      tmp_coarse = param.B[0]->CreateCoarse(param.geoBlockSize, param.spinBlockSize, param.Nvec, r->Precision(), location);
+      r_coarse = param.B[0]->CreateCoarse(param.geoBlockSize, param.spinBlockSize, param.Nvec, r->Precision(), location);
+      x_coarse = param.B[0]->CreateCoarse(param.geoBlockSize, param.spinBlockSize, param.Nvec, r->Precision(), location);
+      createCoarseDirac();
+
+      double cost;
+      double rho = twoGridConvergence(e0, cost);
+      double efficiency = -log(rho) / cost;
+      if (getVerbosity() >= QUDA_SUMMARIZE)
+        printfQuda("Nvec = %d: two-grid convergence factor = %e, cost = %e flops per cycle, efficiency = %e\n",
+                   param.Nvec, rho, cost, efficiency);
+
+      delete matCoarseSmootherSloppy;
+      delete matCoarseSmoother;
+      delete matCoarseResidual;
+      delete diracCoarseSmootherSloppy;
+      delete diracCoarseSmoother;
+      delete diracCoarseResidual;
+      matCoarseSmootherSloppy = matCoarseSmoother = matCoarseResidual = nullptr;
+      diracCoarseSmootherSloppy = diracCoarseSmoother = diracCoarseResidual = nullptr;
+      delete x_coarse;
+      delete r_coarse;
+      delete tmp_coarse;
+      x_coarse = r_coarse = tmp_coarse = nullptr;
+      delete transfer;
+      transfer = nullptr;
+
+      // stop once the larger coarse operator no longer pays for itself
+      if (c > 0 && efficiency <= efficiency_best) break;
+      n_best = param.Nvec;
+      efficiency_best = efficiency;
+    }
+
+    for (int i=0; i<n_test; i++) delete e0[i];
+
+    // free the unused null-space vectors and export the choice
+    param.Nvec = n_best;
+    param.mg_global.n_vec[param.level] = n_best;
+    for (unsigned int i=n_best; i<param.B.size(); i++) delete param.B[i];
+    param.B.resize(n_best);
+
+    if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Using %d null-space vectors\n", n_best);
+    postTrace();
+  }
+
   void MG::createCoarseDirac() {
     postTrace();
     if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Creating coarse Dirac operator\n");
@@ -315,11 +685,17 @@ namespace quda {
     diracParam.halo_precision = param.mg_global.precision_null[param.level];
     constexpr int MAX_BLOCK_FLOAT_NC=32; // FIXME this is the maximum number of colors for which we support block-float format
     if (param.Nvec > MAX_BLOCK_FLOAT_NC) diracParam.halo_precision = QUDA_SINGLE_PRECISION;
+    diracParam.link_precision = param.mg_global.precision_coarse_link[param.level];
+
+    // only the first coarse operator of a restored level comes from the checkpoint
+    bool restore_links = restore && !diracCoarseResidual;
 
     // use even-odd preconditioning for the coarse grid solver
     if (diracCoarseResidual) delete diracCoarseResidual;
     diracCoarseResidual = new DiracCoarse(diracParam, param.setup_location == QUDA_CUDA_FIELD_LOCATION ? true : false,
-                                          param.mg_global.setup_minimize_memory == QUDA_BOOLEAN_YES ? true : false);
+                                          param.mg_global.setup_minimize_memory == QUDA_BOOLEAN_YES ? true : false,
+                                          !restore_links);
+    if (restore_links) loadCheckpoint(true);
 
     // create smoothing operators
     diracParam.dirac = const_cast<Dirac*>(param.matSmooth->Expose());
@@ -363,6 +739,10 @@ namespace quda {
     if (param.cycle_type == QUDA_MG_CYCLE_VCYCLE && param.level < param.Nlevel-2) {
       // nothing to do
     } else if (param.cycle_type == QUDA_MG_CYCLE_RECURSIVE || param.level == param.Nlevel-2) {
+      if (agglomerate) {
+        delete agglomerate;
+        agglomerate = nullptr;
+      }
       if (coarse_solver) {
         delete coarse_solver;
         coarse_solver = nullptr;
@@ -371,6 +751,7 @@ namespace quda {
         delete param_coarse_solver;
         param_coarse_solver = nullptr;
       }
+      destroyCoarseDeflation();
     } else {
       errorQuda("Multigrid cycle type %d not supported", param.cycle_type);
     }
@@ -424,6 +805,9 @@ namespace quda {
       }
 
       if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Assigned coarse solver to preconditioned GCR solver\n");
+
+      createCoarseAgglomeration();
+      createCoarseDeflation();
     } else {
       errorQuda("Multigrid cycle type %d not supported", param.cycle_type);
     }
@@ -431,19 +815,193 @@ namespace quda {
     postTrace();
   }
 
+  void MG::createCoarseAgglomeration() {
+    if (agglomerate) {
+      delete agglomerate;
+      agglomerate = nullptr;
+    }
+
+    // only the bottom solve is agglomerated, since the solvers above are preconditioned by the distributed levels below
+    const int min_volume = param.mg_global.coarse_solver_agglomerate_volume[param.level+1];
+    if (min_volume <= 0 || param.level != param.Nlevel-2 || !param_coarse_solver) return;
+
+    postTrace();
+    const bool matpc = param.mg_global.coarse_grid_solution_type[param.level+1] == QUDA_MATPC_SOLUTION &&
+      param.mg_global.smoother_solve_type[param.level+1] == QUDA_DIRECT_PC_SOLVE;
+    char agglomerate_prefix[128];
+    sprintf(agglomerate_prefix,"MG level %d (agglomerated): ", param.level+2);
+    agglomerate = new Agglomerate(static_cast<DiracCoarse&>(*diracCoarseResidual), *x_coarse, min_volume,
+                                  *param_coarse_solver, matpc, agglomerate_prefix, profile);
+    if (!agglomerate->Active()) {
+      if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Coarse solve on level %d is not agglomerated\n", param.level+2);
+      delete agglomerate;
+      agglomerate = nullptr;
+    }
+    setOutputPrefix(prefix);
+    postTrace();
+  }
+
+  void MG::applyCoarseSolver(ColorSpinorField &x, ColorSpinorField &b) {
+    if (agglomerate) (*agglomerate)(x, b);
+    else (*coarse_solver)(x, b);
+  }
+
+  void MG::createCoarseDeflation() {
+    destroyCoarseDeflation();
+
+    int nvec = param.mg_global.coarse_solver_deflate_nvec[param.level+1];
+    if (nvec <= 0 || !param_coarse_solver) return;
+
+    // on the host the projection costs 2*nvec separate reductions per coarse solve
+    if (x_coarse->Location() == QUDA_CPU_FIELD_LOCATION) {
+      warningQuda("Coarse solver deflation on level %d requires device fields, disabling it", param.level+2);
+      return;
+    }
+
+    postTrace();
+    if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Computing %d low singular vectors of the coarse operator\n", nvec);
+
+    ColorSpinorParam csParam(*x_coarse);
+    csParam.create = QUDA_ZERO_FIELD_CREATE;
+    defl_right.resize(nvec);
+    defl_left.resize(nvec);
+    for (auto &v : defl_right) v = ColorSpinorField::Create(csParam);
+    for (auto &v : defl_left) v = ColorSpinorField::Create(csParam);
+    defl_y = ColorSpinorField::Create(csParam);
+    defl_r = ColorSpinorField::Create(csParam);
+
+    // the right singular vectors are the lowest eigenvectors of D^dagger D
+    const int block_size = std::min(8, nvec);
+    int ncv = std::max(2*nvec, nvec + 2*block_size);
+    ncv = ((ncv + block_size - 1) / block_size) * block_size;
+    const int max_restarts = 200;
+    const double eig_tol = x_coarse->Precision() == QUDA_DOUBLE_PRECISION ? 1e-8 :
+      x_coarse->Precision() == QUDA_SINGLE_PRECISION ? 1e-5 : 1e-3;
+
+    DiracMdagM mdagm(*diracCoarseResidual);
+    std::vector<Complex> evals(nvec);
+    BlockKrylovSchur eig(mdagm, nvec, ncv, block_size, eig_tol, max_restarts, "SM", profile);
+    const int nconv = eig(defl_right, evals.data());
+
+    // only deflate with the converged singular vectors
+    if (nconv < nvec) {
+      warningQuda("Only %d of %d coarse singular vectors converged, deflating with those", nconv, nvec);
+      for (int i = nconv; i < nvec; i++) {
+        delete defl_right[i];
+        delete defl_left[i];
+      }
+      defl_right.resize(nconv);
+      defl_left.resize(nconv);
+      nvec = nconv;
+      if (nvec == 0) {
+        destroyCoarseDeflation();
+        postTrace();
+        return;
+      }
+    }
+
+    // left singular vectors u_i = D v_i / sigma_i
+    defl_sigma.resize(nvec);
+    for (int i = 0; i < nvec; i += block_size) {
+      const int nb = std::min(block_size, nvec - i);
+      std::vector<ColorSpinorField*> v(defl_right.begin() + i, defl_right.begin() + i + nb);
+      std::vector<ColorSpinorField*> u(defl_left.begin() + i, defl_left.begin() + i + nb);
+      (*matCoarseResidual)(u, v, *defl_y, *defl_r);
+    }
+    for (int i = 0; i < nvec; i++) {
+      defl_sigma[i] = sqrt(norm2(*defl_left[i]));
+      ax(1.0/defl_sigma[i], *defl_left[i]);
+      if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Coarse singular value %d = %e\n", i, defl_sigma[i]);
+    }
+
+    if (getVerbosity() >= QUDA_VERBOSE) {
+      // compare the coarse solver with and without deflation on a random source
+      ColorSpinorField *src = ColorSpinorField::Create(csParam);
+      if (src->Location() == QUDA_CPU_FIELD_LOCATION) src->Source(QUDA_RANDOM_SOURCE);
+      else spinorNoise(*src, 1234, QUDA_NOISE_UNIFORM);
+
+      const int iter0 = param_coarse_solver->iter;
+      *r_coarse = *src;
+      applyCoarseSolver(*x_coarse, *r_coarse);
+      const int iter_plain = param_coarse_solver->iter - iter0;
+
+      *r_coarse = *src;
+      solveCoarse();
+      const int iter_defl = param_coarse_solver->iter - iter0 - iter_plain;
+      param_coarse_solver->iter = iter0;
+      setOutputPrefix(prefix);
+
+      printfQuda("Coarse solver on level %d deflated with %d singular vectors: %d iterations reduced to %d on a random source\n",
+                 param.level+2, nvec, iter_plain, iter_defl);
+      delete src;
+    }
+
+    postTrace();
+  }
+
+  void MG::destroyCoarseDeflation() {
+    for (auto &v : defl_right) delete v;
+    for (auto &v : defl_left) delete v;
+    defl_right.resize(0);
+    defl_left.resize(0);
+    defl_sigma.resize(0);
+    if (defl_y) delete defl_y;
+    if (defl_r) delete defl_r;
+    defl_y = nullptr;
+    defl_r = nullptr;
+  }
+
+  void MG::deflateCoarse(ColorSpinorField &x, ColorSpinorField &b) {
+    if (x.Location() == QUDA_CPU_FIELD_LOCATION) errorQuda("Coarse solver deflation requires device fields");
+    const int n = defl_left.size();
+    std::vector<ColorSpinorField*> x_, b_;
+    x_.push_back(&x);
+    b_.push_back(&b);
+
+    std::unique_ptr<Complex[]> c(new Complex[n]);
+    cDotProduct(c.get(), defl_left, b_);
+    for (int i = 0; i < n; i++) c[i] /= defl_sigma[i];
+    caxpy(c.get(), defl_right, x_);
+  }
+
+  void MG::solveCoarse() {
+    if (defl_right.size() == 0) {
+      applyCoarseSolver(*x_coarse, *r_coarse);
+      return;
+    }
+
+    // start from the deflated solution, so the solver only sees the
+    // residual with the low modes projected out
+    zero(*x_coarse);
+    deflateCoarse(*x_coarse, *r_coarse);
+    (*matCoarseResidual)(*defl_r, *x_coarse);
+    xpay(*r_coarse, -1.0, *defl_r);
+    *r_coarse = *defl_r;
+
+    applyCoarseSolver(*defl_y, *r_coarse);
+    xpy(*defl_y, *x_coarse);
+
+    // project the low modes out of the remaining residual
+    (*matCoarseResidual)(*r_coarse, *defl_y);
+    xpay(*defl_r, -1.0, *r_coarse);
+    deflateCoarse(*x_coarse, *r_coarse);
+  }
+
   MG::~MG() {
     if (param.level < param.Nlevel-1) {
       if (rng) rng->Release();
       delete rng;
 
+      if (agglomerate) delete agglomerate;
       if (param.level == param.Nlevel-1 || param.cycle_type == QUDA_MG_CYCLE_RECURSIVE) {
 	if (coarse_solver) delete coarse_solver;
 	if (param_coarse_solver) delete param_coarse_solver;
       }
+      destroyCoarseDeflation();
 
       if (B_coarse) {
-	int nVec_coarse = std::max(param.Nvec, param.mg_global.n_vec[param.level+1]);
-	for (int i=0; i<nVec_coarse; i++) if ((*B_coarse)[i]) delete (*B_coarse)[i];
+	// the coarse level may have freed some of these when choosing its number of vectors
+	for (unsigned int i=0; i<B_coarse->size(); i++) if ((*B_coarse)[i]) delete (*B_coarse)[i];
 	delete B_coarse;
       }
       if (coarse) delete coarse;
@@ -515,6 +1073,9 @@ namespace quda {
 
     QudaPrecision prec = (param.mg_global.precision_null[param.level] < csParam.Precision())
       ? param.mg_global.precision_null[param.level]  : csParam.Precision();
+    // the coarse operator is only as accurate as its stored links
+    if (param.mg_global.precision_coarse_link[param.level] != QUDA_INVALID_PRECISION &&
+        param.mg_global.precision_coarse_link[param.level] < prec) prec = param.mg_global.precision_coarse_link[param.level];
     // may want to revisit this---these were relaxed for cases where ghost_precision < precision
     // these were set while hacking in tests of quarter precision ghosts
     double tol = (prec == QUDA_QUARTER_PRECISION || prec == QUDA_HALF_PRECISION) ? 5e-2 : prec == QUDA_SINGLE_PRECISION ? 1e-3 : 1e-8;
@@ -644,70 +1205,157 @@ namespace quda {
       if (deviation > tol) errorQuda("failed, deviation = %e (tol=%e)", deviation, tol);
     }
 
-#ifdef ARPACK_LIB
-    printfQuda("\nCheck eigenvector overlap for level %d\n", param.level);
+    const int nev = param.mg_global.verify_n_evec[param.level];
+    if (nev > 0) {
+      if (getVerbosity() >= QUDA_SUMMARIZE)
+        printfQuda("Checking the null-space overlap of the %d eigenvectors of smallest magnitude\n", nev);
+
+      const int block_size = 4;
+      const int max_restarts = 100;
+      const double eig_tol = 1e-7;
+      int ncv = std::max(2*nev, nev + 2*block_size);
+      ncv = ((ncv + block_size - 1) / block_size) * block_size;
+
+      // the eigenvectors live where the smoother operator is applied
+      ColorSpinorParam evParam(*r);
+      evParam.create = QUDA_ZERO_FIELD_CREATE;
+      if (param.smoother_solve_type == QUDA_DIRECT_PC_SOLVE) {
+        evParam.x[0] /= 2;
+        evParam.siteSubset = QUDA_PARITY_SITE_SUBSET;
+      }
+
+      std::vector<ColorSpinorField*> evecs(nev);
+      for (auto &v : evecs) v = ColorSpinorField::Create(evParam);
+      std::vector<Complex> evals(nev);
+      std::vector<double> residua(nev);
+
+      BlockKrylovSchur eig(*param.matSmooth, nev, ncv, block_size, eig_tol, max_restarts, "SM", profile);
+      const int nconv = eig(evecs, evals.data(), residua.data());
+      if (nconv < nev) warningQuda("Only %d of %d eigenvectors converged, checking those", nconv, nev);
 
-    int nmodes = 128;
-    int ncv    = 256;
-    double arpack_tol = 1e-7;
-    char *which = (char*)malloc(256*sizeof(char));
-    sprintf(which, "SM");/* ARPACK which="{S,L}{R,I,M}" */
+      double max_deviation = 0.0;
+      for (int i=0; i<nconv; i++) {
+        // as well as copying to the correct location this also changes basis if necessary
+        *tmp1 = *evecs[i];
 
-    ColorSpinorParam cpuParam(*param.B[0]);
-    cpuParam.create = QUDA_ZERO_FIELD_CREATE;
+        transfer->R(*r_coarse, *tmp1);
+        transfer->P(*tmp2, *r_coarse);
 
-    cpuParam.location = QUDA_CPU_FIELD_LOCATION;
-    cpuParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+        deviation = sqrt( xmyNorm(*tmp1, *tmp2) / norm2(*tmp1) );
+        max_deviation = std::max(max_deviation, deviation);
+        if (getVerbosity() >= QUDA_VERBOSE)
+          printfQuda("Eigenvector %d: lambda = (%e, %e), residual = %e, L2 relative deviation = %e\n",
+                     i, evals[i].real(), evals[i].imag(), residua[i], deviation);
+      }
+      if (getVerbosity() >= QUDA_SUMMARIZE)
+        printfQuda("Maximum L2 relative deviation (1 - P P^\\dagger) v_k over %d eigenvectors = %e\n", nconv, max_deviation);
 
-    if(param.smoother_solve_type == QUDA_DIRECT_PC_SOLVE) { 
-      cpuParam.x[0] /= 2; 
-      cpuParam.siteSubset = QUDA_PARITY_SITE_SUBSET; 
+      for (auto &v : evecs) delete v;
     }
 
-    std::vector<ColorSpinorField*> evecsBuffer;
-    evecsBuffer.reserve(nmodes);
+    delete tmp1;
+    delete tmp2;
+    delete tmp_coarse;
+  }
 
-    for (int i = 0; i < nmodes; i++) evecsBuffer.push_back( new cpuColorSpinorField(cpuParam) );
+  void MG::operator()(ColorSpinorField &x, ColorSpinorField &b) {
+    char prefix_bkup[100];  strncpy(prefix_bkup, prefix, 100);  setOutputPrefix(prefix);
 
-    QudaPrecision matPrecision = QUDA_SINGLE_PRECISION;//manually ajusted?
-    QudaPrecision arpPrecision = QUDA_DOUBLE_PRECISION;//precision used in ARPACK routines, may not coincide with matvec precision
-    
-    void *evalsBuffer =  arpPrecision == QUDA_DOUBLE_PRECISION ? static_cast<void*>(new std::complex<double>[nmodes+1]) : static_cast<void*>( new std::complex<float>[nmodes+1]);
-    //
-    arpackSolve( evecsBuffer, evalsBuffer, *param.matSmooth,  matPrecision,  arpPrecision, arpack_tol, nmodes, ncv,  which);
+    if ( debug ) printfQuda("entering V-cycle with x2=%e, r2=%e\n", norm2(x), norm2(b));
 
-    for (int i=0; i<nmodes; i++) {
-      // as well as copying to the correct location this also changes basis if necessary
-      *tmp1 = *evecsBuffer[i];
+    if (param.level < param.Nlevel-1) {
+      ColorSpinorField *out = preCycle(x, b);
 
-      transfer->R(*r_coarse, *tmp1);
-      transfer->P(*tmp2, *r_coarse);
+      // We need this to ensure that the coarse level has been created.
+      // e.g. in case of iterative setup with MG we use just pre- and post-smoothing at the first iteration.
+      if (transfer) {
+        // recurse to the next lower level
+        solveCoarse();
 
-      printfQuda("Vector %d: norms v_k = %e P^\\dagger v_k = %e P P^\\dagger v_k = %e\n",
-		 i, norm2(*tmp1), norm2(*r_coarse), norm2(*tmp2));
+        setOutputPrefix(prefix); // restore prefix after return from coarse grid
 
-      deviation = sqrt( xmyNorm(*tmp1, *tmp2) / norm2(*tmp1) );
-      printfQuda("L2 relative deviation = %e\n", deviation);
-    }
+        if ( debug ) printfQuda("after coarse solve x_coarse2 = %e r_coarse2 = %e\n", norm2(*x_coarse), norm2(*r_coarse));
+      }
 
-    for (unsigned int i = 0; i < evecsBuffer.size(); i++) delete evecsBuffer[i];
+      postCycle(x, b, out);
 
-    if( arpPrecision == QUDA_DOUBLE_PRECISION )  delete static_cast<std::complex<double>* >(evalsBuffer);
-    else                                         delete static_cast<std::complex<float>* > (evalsBuffer);
- 
-    free(which);
-#else
-    warningQuda("\nThis test requires ARPACK.\n");
-#endif
+    } else { // do the coarse grid solve
 
-    delete tmp1;
-    delete tmp2;
-    delete tmp_coarse;
+      QudaSolutionType outer_solution_type = b.SiteSubset() == QUDA_FULL_SITE_SUBSET ? QUDA_MAT_SOLUTION : QUDA_MATPC_SOLUTION;
+      ColorSpinorField *out=nullptr, *in=nullptr;
+
+      diracSmoother->prepare(in, out, x, b, outer_solution_type);
+
+      if (presmoother) (*presmoother)(*out, *in);
+      diracSmoother->reconstruct(x, b, outer_solution_type);
+    }
+
+    if ( debug ) {
+      (*param.matResidual)(*r, x);
+      double r2 = xmyNorm(b, *r);
+      printfQuda("leaving V-cycle with x2=%e, r2=%e\n", norm2(x), r2);
+    }
+
+    setOutputPrefix(param.level == 0 ? "" : prefix_bkup);
   }
 
-  void MG::operator()(ColorSpinorField &x, ColorSpinorField &b) {
+  void MG::operator()(std::vector<ColorSpinorField*> &x, std::vector<ColorSpinorField*> &b) {
+    const int n = b.size();
+
+    // the batched solve stands in for the coarse solver only when the
+    // next level is the coarsest one, and is not deflated or agglomerated
+    if (n < 2 || param.level != param.Nlevel-2 || !transfer || defl_right.size() || agglomerate) {
+      for (int i=0; i<n; i++) (*this)(*x[i], *b[i]);
+      return;
+    }
+
     char prefix_bkup[100];  strncpy(prefix_bkup, prefix, 100);  setOutputPrefix(prefix);
 
+    ColorSpinorParam csParam(*r_coarse);
+    csParam.create = QUDA_NULL_FIELD_CREATE;
+    std::vector<ColorSpinorField*> x_c(n), r_c(n), b_t(n, nullptr), out(n);
+
+    // the prepared sources are kept for the post smoothing of each right-hand side
+    ColorSpinorField *b_tilde_bkup = b_tilde;
+
+    for (int i=0; i<n; i++) {
+      x_c[i] = ColorSpinorField::Create(csParam);
+      r_c[i] = ColorSpinorField::Create(csParam);
+      if (param.smoother_solve_type == QUDA_DIRECT_PC_SOLVE) {
+        ColorSpinorParam tParam(*b_tilde_bkup);
+        tParam.create = QUDA_NULL_FIELD_CREATE;
+        b_tilde = b_t[i] = ColorSpinorField::Create(tParam);
+      }
+
+      out[i] = preCycle(*x[i], *b[i]);
+      *r_c[i] = *r_coarse;
+    }
+
+    solveCoarseBatch(x_c, r_c, *param_coarse_solver);
+    setOutputPrefix(prefix);
+
+    for (int i=0; i<n; i++) {
+      *x_coarse = *x_c[i];
+      if (b_t[i]) b_tilde = b_t[i];
+      postCycle(*x[i], *b[i], out[i]);
+    }
+
+    b_tilde = b_tilde_bkup;
+    for (int i=0; i<n; i++) {
+      delete x_c[i];
+      delete r_c[i];
+      if (b_t[i]) delete b_t[i];
+    }
+
+    setOutputPrefix(param.level == 0 ? "" : prefix_bkup);
+  }
+
+  void MG::blocksolve(ColorSpinorField &out, ColorSpinorField &in) {
+    std::vector<ColorSpinorField*> x(out.Components()), b(in.Components());
+    (*this)(x, b);
+  }
+
+  ColorSpinorField* MG::preCycle(ColorSpinorField &x, ColorSpinorField &b) {
     // if input vector is single parity then we must be solving the
     // preconditioned system in general this can only happen on the
     // top level
@@ -722,109 +1370,90 @@ namespace quda {
     if ( inner_solution_type == QUDA_MATPC_SOLUTION && param.smoother_solve_type != QUDA_DIRECT_PC_SOLVE)
       errorQuda("For this coarse grid solution type, a preconditioned smoother is required");
 
-    if ( debug ) printfQuda("entering V-cycle with x2=%e, r2=%e\n", norm2(x), norm2(b));
-
-    if (param.level < param.Nlevel-1) {
-      //transfer->setTransferGPU(false); // use this to force location of transfer (need to check if still works for multi-level)
-      
-      // do the pre smoothing
-      if ( debug ) printfQuda("pre-smoothing b2=%e\n", norm2(b));
-
-      ColorSpinorField *out=nullptr, *in=nullptr;
+    //transfer->setTransferGPU(false); // use this to force location of transfer (need to check if still works for multi-level)
 
-      ColorSpinorField &residual = b.SiteSubset() == QUDA_FULL_SITE_SUBSET ? *r : r->Even();
+    // do the pre smoothing
+    if ( debug ) printfQuda("pre-smoothing b2=%e\n", norm2(b));
 
-      // FIXME only need to make a copy if not preconditioning
-      residual = b; // copy source vector since we will overwrite source with iterated residual
+    ColorSpinorField *out=nullptr, *in=nullptr;
 
-      diracSmoother->prepare(in, out, x, residual, outer_solution_type);
+    ColorSpinorField &residual = b.SiteSubset() == QUDA_FULL_SITE_SUBSET ? *r : r->Even();
 
-      // b_tilde holds either a copy of preconditioned source or a pointer to original source
-      if (param.smoother_solve_type == QUDA_DIRECT_PC_SOLVE) *b_tilde = *in;
-      else b_tilde = &b;
+    // FIXME only need to make a copy if not preconditioning
+    residual = b; // copy source vector since we will overwrite source with iterated residual
 
-      if (presmoother) (*presmoother)(*out, *in); else zero(*out);
+    diracSmoother->prepare(in, out, x, residual, outer_solution_type);
 
-      ColorSpinorField &solution = inner_solution_type == outer_solution_type ? x : x.Even();
-      diracSmoother->reconstruct(solution, b, inner_solution_type);
+    // b_tilde holds either a copy of preconditioned source or a pointer to original source
+    if (param.smoother_solve_type == QUDA_DIRECT_PC_SOLVE) *b_tilde = *in;
+    else b_tilde = &b;
 
-      // if using preconditioned smoother then need to reconstruct full residual
-      // FIXME extend this check for precision, Schwarz, etc.
-      bool use_solver_residual =
-	( (param.smoother_solve_type == QUDA_DIRECT_PC_SOLVE && inner_solution_type == QUDA_MATPC_SOLUTION) ||
-	  (param.smoother_solve_type == QUDA_DIRECT_SOLVE && inner_solution_type == QUDA_MAT_SOLUTION) )
-	? true : false;
+    if (presmoother) (*presmoother)(*out, *in); else zero(*out);
 
-      // FIXME this is currently borked if inner solver is preconditioned
-      double r2 = 0.0;
-      if (use_solver_residual) {
-	if (debug) r2 = norm2(*r);
-      } else {
-	(*param.matResidual)(*r, x);
-	if (debug) r2 = xmyNorm(b, *r);
-	else axpby(1.0, b, -1.0, *r);
-      }
+    ColorSpinorField &solution = inner_solution_type == outer_solution_type ? x : x.Even();
+    diracSmoother->reconstruct(solution, b, inner_solution_type);
 
-      // We need this to ensure that the coarse level has been created.
-      // e.g. in case of iterative setup with MG we use just pre- and post-smoothing at the first iteration.
-      if (transfer) {
-        // restrict to the coarse grid
-        transfer->R(*r_coarse, residual);
-        if ( debug ) printfQuda("after pre-smoothing x2 = %e, r2 = %e, r_coarse2 = %e\n", norm2(x), r2, norm2(*r_coarse));
+    // if using preconditioned smoother then need to reconstruct full residual
+    // FIXME extend this check for precision, Schwarz, etc.
+    bool use_solver_residual =
+      ( (param.smoother_solve_type == QUDA_DIRECT_PC_SOLVE && inner_solution_type == QUDA_MATPC_SOLUTION) ||
+        (param.smoother_solve_type == QUDA_DIRECT_SOLVE && inner_solution_type == QUDA_MAT_SOLUTION) )
+      ? true : false;
 
-        // recurse to the next lower level
-        (*coarse_solver)(*x_coarse, *r_coarse);
+    // FIXME this is currently borked if inner solver is preconditioned
+    double r2 = 0.0;
+    if (use_solver_residual) {
+      if (debug) r2 = norm2(*r);
+    } else {
+      (*param.matResidual)(*r, x);
+      if (debug) r2 = xmyNorm(b, *r);
+      else axpby(1.0, b, -1.0, *r);
+    }
 
-        setOutputPrefix(prefix); // restore prefix after return from coarse grid
+    if (transfer) {
+      // restrict to the coarse grid
+      transfer->R(*r_coarse, residual);
+      if ( debug ) printfQuda("after pre-smoothing x2 = %e, r2 = %e, r_coarse2 = %e\n", norm2(x), r2, norm2(*r_coarse));
+    }
 
-        if ( debug ) printfQuda("after coarse solve x_coarse2 = %e r_coarse2 = %e\n", norm2(*x_coarse), norm2(*r_coarse));
+    return out;
+  }
 
-        // prolongate back to this grid
-        ColorSpinorField &x_coarse_2_fine = inner_solution_type == QUDA_MAT_SOLUTION ? *r : r->Even(); // define according to inner solution type
-        transfer->P(x_coarse_2_fine, *x_coarse); // repurpose residual storage
+  void MG::postCycle(ColorSpinorField &x, ColorSpinorField &b, ColorSpinorField *out) {
+    QudaSolutionType outer_solution_type = b.SiteSubset() == QUDA_FULL_SITE_SUBSET ? QUDA_MAT_SOLUTION : QUDA_MATPC_SOLUTION;
+    QudaSolutionType inner_solution_type = param.coarse_grid_solution_type;
+    ColorSpinorField &solution = inner_solution_type == outer_solution_type ? x : x.Even();
 
-        xpy(x_coarse_2_fine, solution); // sum to solution FIXME - sum should be done inside the transfer operator
+    if (transfer) {
+      // prolongate back to this grid
+      ColorSpinorField &x_coarse_2_fine = inner_solution_type == QUDA_MAT_SOLUTION ? *r : r->Even(); // define according to inner solution type
+      transfer->P(x_coarse_2_fine, *x_coarse); // repurpose residual storage
 
-        if ( debug ) {
-          printfQuda("Prolongated coarse solution y2 = %e\n", norm2(*r));
-          printfQuda("after coarse-grid correction x2 = %e, r2 = %e\n", 
-                     norm2(x), norm2(*r));
-        }
-      }
+      xpy(x_coarse_2_fine, solution); // sum to solution FIXME - sum should be done inside the transfer operator
 
-      // do the post smoothing
-      //residual = outer_solution_type == QUDA_MAT_SOLUTION ? *r : r->Even(); // refine for outer solution type
-      if (param.smoother_solve_type == QUDA_DIRECT_PC_SOLVE) {
-	in = b_tilde;
-      } else { // this incurs unecessary copying
-	*r = b;
-	in = r;
+      if ( debug ) {
+        printfQuda("Prolongated coarse solution y2 = %e\n", norm2(*r));
+        printfQuda("after coarse-grid correction x2 = %e, r2 = %e\n", 
+                   norm2(x), norm2(*r));
       }
-
-      // we should keep a copy of the prepared right hand side as we've already destroyed it
-      //dirac.prepare(in, out, solution, residual, inner_solution_type);
-
-      if (postsmoother) (*postsmoother)(*out, *in); // for inner solve preconditioned, in the should be the original prepared rhs
-
-      diracSmoother->reconstruct(x, b, outer_solution_type);
-
-    } else { // do the coarse grid solve
-
-      ColorSpinorField *out=nullptr, *in=nullptr;
-
-      diracSmoother->prepare(in, out, x, b, outer_solution_type);
-
-      if (presmoother) (*presmoother)(*out, *in);
-      diracSmoother->reconstruct(x, b, outer_solution_type);
     }
 
-    if ( debug ) {
-      (*param.matResidual)(*r, x);
-      double r2 = xmyNorm(b, *r);
-      printfQuda("leaving V-cycle with x2=%e, r2=%e\n", norm2(x), r2);
+    // do the post smoothing
+    //residual = outer_solution_type == QUDA_MAT_SOLUTION ? *r : r->Even(); // refine for outer solution type
+    ColorSpinorField *in = nullptr;
+    if (param.smoother_solve_type == QUDA_DIRECT_PC_SOLVE) {
+      in = b_tilde;
+    } else { // this incurs unecessary copying
+      *r = b;
+      in = r;
     }
 
-    setOutputPrefix(param.level == 0 ? "" : prefix_bkup);
+    // we should keep a copy of the prepared right hand side as we've already destroyed it
+    //dirac.prepare(in, out, solution, residual, inner_solution_type);
+
+    if (postsmoother) (*postsmoother)(*out, *in); // for inner solve preconditioned, in the should be the original prepared rhs
+
+    diracSmoother->reconstruct(x, b, outer_solution_type);
   }
 
   //supports seperate reading or single file read
@@ -841,7 +1470,11 @@ namespace quda {
     if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Start loading %d vectors from %s\n", Nvec, vec_infile.c_str());
 
     if (strcmp(vec_infile.c_str(),"")!=0) {
-#ifdef HAVE_QIO
+      // compact files are read natively, everything else goes through QIO
+      const bool compact = is_compact_spinor_file(vec_infile.c_str());
+#ifndef HAVE_QIO
+      if (!compact) errorQuda("\nQIO library was not built.\n");
+#endif
       std::vector<ColorSpinorField*> B_;
       if (B[0]->Location() == QUDA_CUDA_FIELD_LOCATION) {
         ColorSpinorParam csParam(*B[0]);
@@ -861,8 +1494,13 @@ namespace quda {
       void **V = static_cast<void**>(safe_malloc(Nvec*sizeof(void*)));
       for (int i=0; i<Nvec; i++) V[i] = B_[i]->V();
 
-      read_spinor_field(vec_infile.c_str(), &V[0], B[0]->Precision(), B[0]->X(),
-			B[0]->Ncolor(), B[0]->Nspin(), Nvec, 0,  (char**)0);
+      if (compact) {
+	read_spinor_field_compact(vec_infile.c_str(), &V[0], B_[0]->Precision(), B[0]->X(),
+				  B[0]->Ncolor(), B[0]->Nspin(), Nvec);
+      } else {
+	read_spinor_field(vec_infile.c_str(), &V[0], B[0]->Precision(), B[0]->X(),
+			  B[0]->Ncolor(), B[0]->Nspin(), Nvec, 0,  (char**)0);
+      }
 
       host_free(V);
 
@@ -872,10 +1510,6 @@ namespace quda {
           delete B_[i];
         }
       }
-
-#else
-      errorQuda("\nQIO library was not built.\n");      
-#endif
     } else {
       if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Using %d constant nullvectors\n", Nvec);
 
@@ -908,7 +1542,13 @@ namespace quda {
   }
 
   void MG::saveVectors(std::vector<ColorSpinorField*> &B) {
-#ifdef HAVE_QIO
+    if (strcmp(param.mg_global.vec_outfile,"")==0) return;
+
+    // the compact format is written natively, the SciDAC format through QIO
+    const bool compact = param.mg_global.vec_compact == QUDA_BOOLEAN_YES;
+#ifndef HAVE_QIO
+    if (!compact) errorQuda("\nQIO library was not built.\n");
+#endif
 
     profile_global.TPSTOP(QUDA_PROFILE_INIT);
     profile_global.TPSTART(QUDA_PROFILE_IO);
@@ -935,30 +1575,184 @@ namespace quda {
     vec_outfile += "_level_";
     vec_outfile += std::to_string(param.level);
 
-    if (strcmp(param.mg_global.vec_outfile,"")!=0) {
-      if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Start saving %d vectors to %s\n", Nvec, vec_outfile.c_str());
+    if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Start saving %d vectors to %s\n", Nvec, vec_outfile.c_str());
 
-      void **V = static_cast<void**>(safe_malloc(Nvec*sizeof(void*)));
-      for (int i=0; i<Nvec; i++) V[i] = B_[i]->V();
+    void **V = static_cast<void**>(safe_malloc(Nvec*sizeof(void*)));
+    for (int i=0; i<Nvec; i++) V[i] = B_[i]->V();
 
+    if (compact) {
+      write_spinor_field_compact(vec_outfile.c_str(), &V[0], B_[0]->Precision(), B[0]->X(),
+				 B[0]->Ncolor(), B[0]->Nspin(), Nvec);
+    } else {
       write_spinor_field(vec_outfile.c_str(), &V[0], B[0]->Precision(), B[0]->X(),
 			 B[0]->Ncolor(), B[0]->Nspin(), Nvec, 0,  (char**)0);
-
-      host_free(V);
-      if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Done saving vectors\n");
     }
 
+    host_free(V);
+    if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Done saving vectors\n");
+
     if (B[0]->Location() == QUDA_CUDA_FIELD_LOCATION) {
       for (int i=0; i<Nvec; i++) delete B_[i];
     }
 
     profile_global.TPSTOP(QUDA_PROFILE_IO);
     profile_global.TPSTART(QUDA_PROFILE_INIT);
-#else
-    if (strcmp(param.mg_global.vec_outfile,"")!=0) {
-      errorQuda("\nQIO library was not built.\n");
+  }
+
+  // records of a setup checkpoint
+  enum { CHECKPOINT_B, CHECKPOINT_V, CHECKPOINT_Y, CHECKPOINT_X, CHECKPOINT_YHAT, CHECKPOINT_XINV, CHECKPOINT_RECORDS };
+
+  static NativeRecord spinorRecord(const ColorSpinorField &f, void **V, int Nvec) {
+    NativeRecord record = { V, Nvec, 2*f.Nspin()*f.Ncolor(), f.Precision(), f.X() };
+    return record;
+  }
+
+  static NativeRecord gaugeRecord(cpuGaugeField &f) {
+    NativeRecord record = { static_cast<void**>(f.Gauge_p()), f.Geometry(), 2*f.Ncolor()*f.Ncolor(), f.Precision(), f.X() };
+    return record;
+  }
+
+  // fixed-point links are checkpointed in single precision, since
+  // their per-row scales are not part of the native record
+  static cpuGaugeField* checkpointLinks(cpuGaugeField *links) {
+    if (links->Precision() >= QUDA_SINGLE_PRECISION) return links;
+    GaugeFieldParam gParam(*links);
+    gParam.create = QUDA_ZERO_FIELD_CREATE;
+    gParam.row_scale = false;
+    gParam.setPrecision(QUDA_SINGLE_PRECISION);
+    return new cpuGaugeField(gParam);
+  }
+
+  // host copies of the null-space vectors, which are aliased if B is already on the host
+  static std::vector<ColorSpinorField*> hostVectors(std::vector<ColorSpinorField*> &B) {
+    std::vector<ColorSpinorField*> B_;
+    if (B[0]->Location() == QUDA_CUDA_FIELD_LOCATION) {
+      ColorSpinorParam csParam(*B[0]);
+      csParam.fieldOrder = QUDA_SPACE_SPIN_COLOR_FIELD_ORDER;
+      csParam.setPrecision(B[0]->Precision() < QUDA_SINGLE_PRECISION ? QUDA_SINGLE_PRECISION : B[0]->Precision());
+      csParam.location = QUDA_CPU_FIELD_LOCATION;
+      csParam.create = QUDA_NULL_FIELD_CREATE;
+      for (unsigned int i=0; i<B.size(); i++) B_.push_back(ColorSpinorField::Create(csParam));
+    } else {
+      for (unsigned int i=0; i<B.size(); i++) B_.push_back(B[i]);
     }
-#endif
+    return B_;
+  }
+
+  std::string MG::checkpointFile() const {
+    std::string filename(param.mg_global.setup_checkpoint);
+    filename += "_level_";
+    filename += std::to_string(param.level);
+    return filename;
+  }
+
+  void MG::saveCheckpoint() {
+    if (param.level >= param.Nlevel-1) return;
+
+    // levels restored from a checkpoint are already saved
+    if (!restore) {
+      profile_global.TPSTOP(QUDA_PROFILE_INIT);
+      profile_global.TPSTART(QUDA_PROFILE_IO);
+
+      std::vector<ColorSpinorField*> &B = param.B;
+      if (B[0]->SiteSubset() != QUDA_FULL_SITE_SUBSET) errorQuda("Setup checkpoints require full-field null-space vectors");
+
+      std::vector<ColorSpinorField*> B_ = hostVectors(B);
+      if (B[0]->Location() == QUDA_CUDA_FIELD_LOCATION)
+        for (unsigned int i=0; i<B.size(); i++) *B_[i] = *B[i];
+
+      std::vector<void*> V(B.size());
+      for (unsigned int i=0; i<B.size(); i++) V[i] = B_[i]->V();
+
+      ColorSpinorField &V_h = transfer->HostVectors();
+      void *V_v = V_h.V();
+
+      cpuGaugeField *links[4];
+      static_cast<DiracCoarse*>(diracCoarseResidual)->HostFields(links[0], links[1], links[2], links[3]);
+      cpuGaugeField *links_[4];
+      for (int i=0; i<4; i++) {
+        links_[i] = checkpointLinks(links[i]);
+        if (links_[i] != links[i]) links_[i]->copy(*links[i]);
+      }
+
+      NativeRecord record[CHECKPOINT_RECORDS];
+      record[CHECKPOINT_B] = spinorRecord(*B_[0], V.data(), B.size());
+      record[CHECKPOINT_V] = spinorRecord(V_h, &V_v, 1);
+      record[CHECKPOINT_Y] = gaugeRecord(*links_[0]);
+      record[CHECKPOINT_X] = gaugeRecord(*links_[1]);
+      record[CHECKPOINT_XINV] = gaugeRecord(*links_[2]);
+      record[CHECKPOINT_YHAT] = gaugeRecord(*links_[3]);
+
+      if (getVerbosity() >= QUDA_SUMMARIZE) printfQuda("Saving setup checkpoint %s\n", checkpointFile().c_str());
+      write_checkpoint_native(checkpointFile().c_str(), param.checkpoint_key, record, CHECKPOINT_RECORDS);
+
+      for (int i=0; i<4; i++) if (links_[i] != links[i]) delete links_[i];
+
+      if (B[0]->Location() == QUDA_CUDA_FIELD_LOCATION)
+        for (unsigned int i=0; i<B.size(); i++) delete B_[i];
+
+      profile_global.TPSTOP(QUDA_PROFILE_IO);
+      profile_global.TPSTART(QUDA_PROFILE_INIT);
+    }
+
+    coarse->saveCheckpoint();
+  }
+
+  void MG::loadCheckpoint(bool coarse_links) {
+    profile_global.TPSTOP(QUDA_PROFILE_INIT);
+    profile_global.TPSTART(QUDA_PROFILE_IO);
+
+    NativeRecord record[CHECKPOINT_RECORDS];
+    memset(record, 0, sizeof(record));
+
+    if (coarse_links) {
+      DiracCoarse *dirac = static_cast<DiracCoarse*>(diracCoarseResidual);
+      cpuGaugeField *links[4];
+      dirac->HostFields(links[0], links[1], links[2], links[3]);
+      cpuGaugeField *links_[4];
+      for (int i=0; i<4; i++) links_[i] = checkpointLinks(links[i]);
+      record[CHECKPOINT_Y] = gaugeRecord(*links_[0]);
+      record[CHECKPOINT_X] = gaugeRecord(*links_[1]);
+      record[CHECKPOINT_XINV] = gaugeRecord(*links_[2]);
+      record[CHECKPOINT_YHAT] = gaugeRecord(*links_[3]);
+
+      if (!read_checkpoint_native(checkpointFile().c_str(), param.checkpoint_key, record, CHECKPOINT_RECORDS))
+        errorQuda("Failed to restore coarse links from %s", checkpointFile().c_str());
+      for (int i=0; i<4; i++) {
+        if (links_[i] != links[i]) {
+          links[i]->copy(*links_[i]);
+          delete links_[i];
+        }
+      }
+      dirac->restoreCoarseOp();
+    } else {
+      std::vector<ColorSpinorField*> &B = param.B;
+      if (B[0]->SiteSubset() != QUDA_FULL_SITE_SUBSET) errorQuda("Setup checkpoints require full-field null-space vectors");
+
+      std::vector<ColorSpinorField*> B_ = hostVectors(B);
+      std::vector<void*> V(B.size());
+      for (unsigned int i=0; i<B.size(); i++) V[i] = B_[i]->V();
+
+      ColorSpinorField &V_h = transfer->HostVectors();
+      void *V_v = V_h.V();
+
+      record[CHECKPOINT_B] = spinorRecord(*B_[0], V.data(), B.size());
+      record[CHECKPOINT_V] = spinorRecord(V_h, &V_v, 1);
+
+      if (!read_checkpoint_native(checkpointFile().c_str(), param.checkpoint_key, record, CHECKPOINT_RECORDS))
+        errorQuda("Failed to restore null-space vectors from %s", checkpointFile().c_str());
+      transfer->updateVectors();
+
+      if (B[0]->Location() == QUDA_CUDA_FIELD_LOCATION) {
+        for (unsigned int i=0; i<B.size(); i++) {
+          *B[i] = *B_[i];
+          delete B_[i];
+        }
+      }
+    }
+
+    profile_global.TPSTOP(QUDA_PROFILE_IO);
+    profile_global.TPSTART(QUDA_PROFILE_INIT);
   }
 
   void MG::generateNullVectors(std::vector<ColorSpinorField*> &B, bool refresh) {
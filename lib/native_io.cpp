@@ -0,0 +1,1626 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <time.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <quda_internal.h>
+#include <util_quda.h>
+#include <comm_quda.h>
+#include <malloc_quda.h>
+#include <native_io.h>
+
+// header information, parsed on rank 0 and broadcast to all ranks
+struct GaugeFileInfo {
+  int format;
+  int dim[4];            // global lattice dimensions
+  int file_prec;         // bytes per real number in the file
+  int rows;              // number of rows stored per link (2 or 3)
+  int big_endian;        // byte order of the binary data
+  int64_t data_offset;   // offset of the binary data
+  int64_t data_bytes;    // size of the binary data
+
+  int has_nersc_checksum;
+  uint32_t nersc_checksum;
+  int has_link_trace;
+  double link_trace;
+
+  int has_scidac_checksum;
+  uint32_t scidac_suma;
+  uint32_t scidac_sumb;
+};
+
+static const uint32_t lime_magic = 0x456789ab;
+static const size_t lime_header_bytes = 144;
+
+// size of the staging buffer used for streaming the local hyperslab
+static const size_t io_batch_bytes = 16 << 20;
+
+static bool host_big_endian() {
+  const uint16_t one = 1;
+  return *reinterpret_cast<const uint8_t*>(&one) == 0;
+}
+
+static uint32_t be32(const unsigned char *p) {
+  return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
+}
+
+static uint64_t be64(const unsigned char *p) {
+  return (uint64_t)be32(p) << 32 | (uint64_t)be32(p+4);
+}
+
+static inline uint32_t rotl32(uint32_t x, int n) {
+  return n ? (x << n) | (x >> (32-n)) : x;
+}
+
+// byte reverse n words of size word in place: written as flat loops
+// over integer words so that the compiler can vectorize them
+static inline void byte_swap(void *buf, size_t n, int word) {
+  if (word == 8) {
+    uint64_t *p = static_cast<uint64_t*>(buf);
+    for (size_t i=0; i<n; i++) p[i] = __builtin_bswap64(p[i]);
+  } else if (word == 4) {
+    uint32_t *p = static_cast<uint32_t*>(buf);
+    for (size_t i=0; i<n; i++) p[i] = __builtin_bswap32(p[i]);
+  } else {
+    errorQuda("Unsupported word size %d", word);
+  }
+}
+
+// crc32 (zlib polynomial) used for the SciDAC checksum
+static uint32_t crc_table[256];
+static bool crc_table_init = false;
+
+static void init_crc_table() {
+  if (crc_table_init) return;
+  for (uint32_t n=0; n<256; n++) {
+    uint32_t c = n;
+    for (int k=0; k<8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+    crc_table[n] = c;
+  }
+  crc_table_init = true;
+}
+
+static inline uint32_t scidac_crc32(const unsigned char *buf, size_t len) {
+  uint32_t c = 0xffffffffu;
+  for (size_t i=0; i<len; i++) c = crc_table[(c ^ buf[i]) & 0xff] ^ (c >> 8);
+  return c ^ 0xffffffffu;
+}
+
+static double wall_time() {
+  timeval t;
+  gettimeofday(&t, NULL);
+  return t.tv_sec + 1e-6*t.tv_usec;
+}
+
+// strip leading and trailing white space in place
+static char *trim(char *s) {
+  while (*s == ' ' || *s == '\t') s++;
+  char *e = s + strlen(s);
+  while (e > s && (e[-1] == ' ' || e[-1] == '\t' || e[-1] == '\n' || e[-1] == '\r')) *--e = '\0';
+  return s;
+}
+
+static void parse_nersc_header(FILE *fp, const char *filename, GaugeFileInfo &info) {
+  char line[1024];
+  bool found_end = false;
+  int have_dim = 0;
+
+  info.format = NATIVE_NERSC_FORMAT;
+  info.rows = 3;
+  info.file_prec = 0;
+
+  while (fgets(line, sizeof(line), fp)) {
+    char *l = trim(line);
+    if (strcmp(l, "END_HEADER") == 0) { found_end = true; break; }
+
+    char *eq = strchr(l, '=');
+    if (!eq) continue;
+    *eq = '\0';
+    char *key = trim(l);
+    char *value = trim(eq + 1);
+
+    if (strncmp(key, "DIMENSION_", 10) == 0) {
+      int d = atoi(key + 10) - 1;
+      if (d < 0 || d > 3) errorQuda("Invalid key %s in %s", key, filename);
+      info.dim[d] = atoi(value);
+      have_dim++;
+    } else if (strcmp(key, "DATATYPE") == 0) {
+      if (strcmp(value, "4D_SU3_GAUGE_3x3") == 0) info.rows = 3;
+      else if (strcmp(value, "4D_SU3_GAUGE") == 0) info.rows = 2;
+      else errorQuda("Unsupported NERSC DATATYPE %s", value);
+    } else if (strcmp(key, "FLOATING_POINT") == 0) {
+      if (strncmp(value, "IEEE64", 6) == 0) info.file_prec = 8;
+      else if (strncmp(value, "IEEE32", 6) == 0) info.file_prec = 4;
+      else errorQuda("Unsupported NERSC FLOATING_POINT %s", value);
+      info.big_endian = strstr(value, "LITTLE") ? 0 : 1;
+    } else if (strcmp(key, "CHECKSUM") == 0) {
+      info.nersc_checksum = (uint32_t)strtoul(value, NULL, 16);
+      info.has_nersc_checksum = 1;
+    } else if (strcmp(key, "LINK_TRACE") == 0) {
+      info.link_trace = atof(value);
+      info.has_link_trace = 1;
+    }
+  }
+
+  if (!found_end) errorQuda("No END_HEADER found in %s", filename);
+  if (have_dim != 4) errorQuda("Incomplete NERSC header in %s", filename);
+  if (info.file_prec == 0) errorQuda("No FLOATING_POINT found in %s", filename);
+
+  info.data_offset = ftell(fp);
+}
+
+// extract the value of a simple <tag>value</tag> XML element
+static bool xml_value(const char *xml, const char *tag, char *value, size_t len) {
+  char open[64];
+  snprintf(open, sizeof(open), "<%s>", tag);
+  const char *s = strstr(xml, open);
+  if (!s) return false;
+  s += strlen(open);
+  const char *e = strchr(s, '<');
+  if (!e || (size_t)(e - s) >= len) return false;
+  memcpy(value, s, e - s);
+  value[e - s] = '\0';
+  return true;
+}
+
+static void parse_lime_header(int fd, const char *filename, GaugeFileInfo &info) {
+  unsigned char h[lime_header_bytes];
+  int64_t pos = 0;
+  bool found_format = false;
+  bool found_data = false;
+
+  info.format = NATIVE_ILDG_FORMAT;
+  info.rows = 3;
+  info.big_endian = 1;
+
+  while (pread(fd, h, lime_header_bytes, pos) == (ssize_t)lime_header_bytes) {
+    if (be32(h) != lime_magic) errorQuda("Corrupt LIME record at offset %lld in %s", (long long)pos, filename);
+    int64_t bytes = be64(h + 8);
+    char type[129];
+    memcpy(type, h + 16, 128);
+    type[128] = '\0';
+    int64_t payload = pos + lime_header_bytes;
+
+    if (strcmp(type, "ildg-format") == 0 || strcmp(type, "scidac-checksum") == 0) {
+      std::vector<char> xml(bytes + 1, '\0');
+      if (pread(fd, xml.data(), bytes, payload) != bytes) errorQuda("Failed to read %s record in %s", type, filename);
+      char value[64];
+      if (strcmp(type, "ildg-format") == 0) {
+	const char *tag[] = { "lx", "ly", "lz", "lt" };
+	for (int d=0; d<4; d++) {
+	  if (!xml_value(xml.data(), tag[d], value, sizeof(value))) errorQuda("No <%s> in ildg-format of %s", tag[d], filename);
+	  info.dim[d] = atoi(value);
+	}
+	if (!xml_value(xml.data(), "precision", value, sizeof(value))) errorQuda("No <precision> in ildg-format of %s", filename);
+	info.file_prec = atoi(value) / 8;
+	found_format = true;
+      } else if (found_data && !info.has_scidac_checksum) {
+	// only the checksum record that follows the binary data applies to it
+	if (xml_value(xml.data(), "suma", value, sizeof(value))) info.scidac_suma = (uint32_t)strtoul(value, NULL, 16);
+	if (xml_value(xml.data(), "sumb", value, sizeof(value))) info.scidac_sumb = (uint32_t)strtoul(value, NULL, 16);
+	info.has_scidac_checksum = 1;
+      }
+    } else if (strcmp(type, "ildg-binary-data") == 0) {
+      info.data_offset = payload;
+      info.data_bytes = bytes;
+      found_data = true;
+    }
+
+    pos = payload + ((bytes + 7) / 8) * 8; // records are padded to 8-byte boundaries
+  }
+
+  if (!found_format) errorQuda("No ildg-format record found in %s", filename);
+  if (!found_data) errorQuda("No ildg-binary-data record found in %s", filename);
+  if (info.file_prec != 4 && info.file_prec != 8) errorQuda("Unsupported ILDG precision %d", 8*info.file_prec);
+}
+
+static void parse_gauge_header(const char *filename, GaugeFileInfo &info) {
+  memset(&info, 0, sizeof(info));
+
+  if (comm_rank() == 0) {
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) errorQuda("Failed to open %s", filename);
+
+    unsigned char magic[4];
+    if (fread(magic, 1, 4, fp) != 4) errorQuda("Failed to read %s", filename);
+    rewind(fp);
+
+    if (be32(magic) == lime_magic) parse_lime_header(fileno(fp), filename, info);
+    else parse_nersc_header(fp, filename, info);
+
+    if (info.format == NATIVE_NERSC_FORMAT) {
+      struct stat st;
+      if (fstat(fileno(fp), &st) != 0) errorQuda("Failed to stat %s", filename);
+      info.data_bytes = st.st_size - info.data_offset;
+    }
+    fclose(fp);
+  }
+
+  comm_broadcast(&info, sizeof(info));
+}
+
+/**
+   Decomposition of the local sub-lattice into runs of sites that are
+   contiguous in a file stored in global lexicographic site order.
+   Runs are numbered in local lexicographic order, so run r covers
+   the local sites [r*run, (r+1)*run).
+ */
+struct Hyperslab {
+  int X[4];
+  int global_dim[4];
+  int origin[4];
+  int run_dim;
+  size_t run;
+  size_t n_run;
+  size_t volume;
+
+  Hyperslab(const int *X_) : run_dim(0), volume(1) {
+    for (int d=0; d<4; d++) {
+      X[d] = X_[d];
+      global_dim[d] = comm_dim(d) * X[d];
+      origin[d] = comm_coord(d) * X[d];
+      volume *= X[d];
+    }
+    // every leading dimension that is not partitioned extends the run
+    run = X[0];
+    while (run_dim < 3 && X[run_dim] == global_dim[run_dim]) run *= X[++run_dim];
+    n_run = volume / run;
+  }
+
+  size_t global_volume() const {
+    return (size_t)global_dim[0]*global_dim[1]*global_dim[2]*global_dim[3];
+  }
+
+  // global coordinates of local site l
+  inline void coords(int x[4], size_t l) const {
+    for (int d=0; d<4; d++) { x[d] = l % X[d] + origin[d]; l /= X[d]; }
+  }
+
+  inline uint64_t global_index(const int x[4]) const {
+    return (((uint64_t)x[3]*global_dim[2] + x[2])*global_dim[1] + x[1])*global_dim[0] + x[0];
+  }
+
+  // global index of the first site of run r
+  uint64_t run_start(size_t r) const {
+    int x[4] = { origin[0], origin[1], origin[2], origin[3] };
+    for (int d=run_dim+1; d<4; d++) { x[d] += r % X[d]; r /= X[d]; }
+    return global_index(x);
+  }
+};
+
+// partial checksums accumulated by each rank over its own sites
+struct FileChecksum {
+  uint32_t nersc;
+  uint32_t suma;
+  uint32_t sumb;
+  double trace;
+
+  FileChecksum() : nersc(0), suma(0), sumb(0), trace(0.0) { }
+
+  // combine the partial checksums so that no rank sees the whole file
+  void reduce() {
+    double sum = nersc; // partial sums are < 2^32 so exact in double
+    comm_allreduce(&sum);
+    nersc = (uint32_t)fmod(sum, 4294967296.0);
+
+    uint64_t ab = (uint64_t)suma << 32 | sumb;
+    comm_allreduce_xor(&ab);
+    suma = (uint32_t)(ab >> 32);
+    sumb = (uint32_t)ab;
+
+    comm_allreduce(&trace);
+  }
+};
+
+// SciDAC checksum contribution of one site, given the crc32 of its
+// file representation and its global lexicographic index
+static inline void scidac_checksum(uint32_t crc, uint64_t rank, uint32_t &suma, uint32_t &sumb) {
+  suma ^= rotl32(crc, rank % 29);
+  sumb ^= rotl32(crc, rank % 31);
+}
+
+/**
+   Unpack a batch of file sites that are contiguous in local
+   lexicographic order into the host gauge field.  The staging buffer
+   is modified in place by the byte swap.
+ */
+template <typename out_t, typename in_t>
+struct GaugeUnpacker {
+  void *gauge;
+  const QudaGaugeFieldOrder order;
+  const GaugeFileInfo &info;
+  const Hyperslab &slab;
+  const bool swap;
+
+  GaugeUnpacker(void *gauge, QudaGaugeFieldOrder order, const GaugeFileInfo &info, const Hyperslab &slab)
+    : gauge(gauge), order(order), info(info), slab(slab), swap(info.big_endian != host_big_endian()) { }
+
+  size_t site_bytes() const { return 4 * info.rows * 3 * 2 * sizeof(in_t); }
+
+  void operator()(unsigned char *buf, size_t l0, size_t nsite, FileChecksum &sum) const {
+    const int rows = info.rows;
+    const size_t bytes = site_bytes();
+    const size_t volumeCB = slab.volume / 2;
+
+    uint32_t nersc = 0, suma = 0, sumb = 0;
+    double trace = 0.0;
+
+#pragma omp parallel for reduction(+:nersc,trace) reduction(^:suma,sumb)
+    for (size_t i=0; i<nsite; i++) {
+      unsigned char *site = buf + i * bytes;
+      const size_t l = l0 + i;
+
+      int x[4];
+      slab.coords(x, l);
+      const int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+      const size_t x_cb = l / 2;
+
+      // checksum is defined on the file representation of the site
+      if (info.has_scidac_checksum) scidac_checksum(scidac_crc32(site, bytes), slab.global_index(x), suma, sumb);
+
+      if (swap) byte_swap(site, bytes / sizeof(in_t), sizeof(in_t));
+
+      const in_t *in = reinterpret_cast<const in_t*>(site);
+      for (int mu=0; mu<4; mu++) {
+	in_t U[18];
+	for (int j=0; j<rows*6; j++) U[j] = in[mu*rows*6 + j];
+	if (rows == 2) {
+	  // third row is the complex conjugate of the cross product of the first two
+	  for (int c=0; c<3; c++) {
+	    const int a = (c+1)%3, b = (c+2)%3;
+	    const in_t re = U[2*a]*U[6+2*b] - U[2*a+1]*U[6+2*b+1] - U[2*b]*U[6+2*a] + U[2*b+1]*U[6+2*a+1];
+	    const in_t im = U[2*a]*U[6+2*b+1] + U[2*a+1]*U[6+2*b] - U[2*b]*U[6+2*a+1] - U[2*b+1]*U[6+2*a];
+	    U[12+2*c] = re;
+	    U[12+2*c+1] = -im;
+	  }
+	}
+
+	if (info.has_nersc_checksum) {
+	  const uint32_t *w = reinterpret_cast<const uint32_t*>(U);
+	  for (size_t j=0; j<18*sizeof(in_t)/sizeof(uint32_t); j++) nersc += w[j];
+	}
+	trace += U[0] + U[8] + U[16];
+
+	out_t *out = (order == QUDA_QDP_GAUGE_ORDER) ?
+	  static_cast<out_t**>(gauge)[mu] + (parity*volumeCB + x_cb)*18 :
+	  static_cast<out_t*>(gauge) + ((parity*volumeCB + x_cb)*4 + mu)*18;
+	for (int j=0; j<18; j++) out[j] = U[j];
+      }
+    }
+
+    sum.nersc += nersc;
+    sum.suma ^= suma;
+    sum.sumb ^= sumb;
+    sum.trace += trace;
+  }
+};
+
+// pack a batch of host gauge field sites into 3x3 file representation
+template <typename T>
+struct GaugePacker {
+  void *gauge;
+  const QudaGaugeFieldOrder order;
+  const NativeFileFormat format;
+  const Hyperslab &slab;
+  const bool swap;
+
+  GaugePacker(void *gauge, QudaGaugeFieldOrder order, NativeFileFormat format, const Hyperslab &slab)
+    : gauge(gauge), order(order), format(format), slab(slab), swap(!host_big_endian()) { }
+
+  size_t site_bytes() const { return 4 * 18 * sizeof(T); }
+
+  void operator()(unsigned char *buf, size_t l0, size_t nsite, FileChecksum &sum) const {
+    const size_t bytes = site_bytes();
+    const size_t volumeCB = slab.volume / 2;
+
+    uint32_t nersc = 0, suma = 0, sumb = 0;
+    double trace = 0.0;
+
+#pragma omp parallel for reduction(+:nersc,trace) reduction(^:suma,sumb)
+    for (size_t i=0; i<nsite; i++) {
+      unsigned char *site = buf + i * bytes;
+      const size_t l = l0 + i;
+
+      int x[4];
+      slab.coords(x, l);
+      const int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+      const size_t x_cb = l / 2;
+
+      T *out = reinterpret_cast<T*>(site);
+      for (int mu=0; mu<4; mu++) {
+	const T *in = (order == QUDA_QDP_GAUGE_ORDER) ?
+	  static_cast<T**>(gauge)[mu] + (parity*volumeCB + x_cb)*18 :
+	  static_cast<T*>(gauge) + ((parity*volumeCB + x_cb)*4 + mu)*18;
+	for (int j=0; j<18; j++) out[mu*18 + j] = in[j];
+	trace += in[0] + in[8] + in[16];
+      }
+
+      if (format == NATIVE_NERSC_FORMAT) {
+	const uint32_t *w = reinterpret_cast<const uint32_t*>(site);
+	for (size_t j=0; j<bytes/sizeof(uint32_t); j++) nersc += w[j];
+      }
+
+      if (swap) byte_swap(site, bytes / sizeof(T), sizeof(T));
+
+      if (format == NATIVE_ILDG_FORMAT) scidac_checksum(scidac_crc32(site, bytes), slab.global_index(x), suma, sumb);
+    }
+
+    sum.nersc += nersc;
+    sum.suma ^= suma;
+    sum.sumb ^= sumb;
+    sum.trace += trace;
+  }
+};
+
+// pack a batch of host spinor sites: each file site holds all Nvec
+// vectors, each of length len in [spin][color][complex] order
+template <typename T>
+struct SpinorPacker {
+  void **V;
+  const int len;
+  const int Nvec;
+  const Hyperslab &slab;
+  const bool swap;
+
+  SpinorPacker(void **V, int len, int Nvec, const Hyperslab &slab)
+    : V(V), len(len), Nvec(Nvec), slab(slab), swap(!host_big_endian()) { }
+
+  size_t site_bytes() const { return (size_t)Nvec * len * sizeof(T); }
+
+  void operator()(unsigned char *buf, size_t l0, size_t nsite, FileChecksum &sum) const {
+    const size_t bytes = site_bytes();
+    const size_t volumeCB = slab.volume / 2;
+
+    uint32_t suma = 0, sumb = 0;
+
+#pragma omp parallel for reduction(^:suma,sumb)
+    for (size_t i=0; i<nsite; i++) {
+      unsigned char *site = buf + i * bytes;
+      const size_t l = l0 + i;
+
+      int x[4];
+      slab.coords(x, l);
+      const int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+      const size_t x_cb = l / 2;
+
+      T *out = reinterpret_cast<T*>(site);
+      for (int v=0; v<Nvec; v++) {
+	const T *in = static_cast<T*>(V[v]) + (parity*volumeCB + x_cb)*len;
+	for (int j=0; j<len; j++) out[v*len + j] = in[j];
+      }
+
+      if (swap) byte_swap(site, bytes / sizeof(T), sizeof(T));
+      scidac_checksum(scidac_crc32(site, bytes), slab.global_index(x), suma, sumb);
+    }
+
+    sum.suma ^= suma;
+    sum.sumb ^= sumb;
+  }
+};
+
+// unpack a batch of file sites written by SpinorPacker into host spinor fields
+template <typename T>
+struct SpinorUnpacker {
+  void **V;
+  const int len;
+  const int Nvec;
+  const Hyperslab &slab;
+  const bool swap;
+
+  SpinorUnpacker(void **V, int len, int Nvec, const Hyperslab &slab)
+    : V(V), len(len), Nvec(Nvec), slab(slab), swap(!host_big_endian()) { }
+
+  size_t site_bytes() const { return (size_t)Nvec * len * sizeof(T); }
+
+  void operator()(unsigned char *buf, size_t l0, size_t nsite, FileChecksum &sum) const {
+    const size_t bytes = site_bytes();
+    const size_t volumeCB = slab.volume / 2;
+
+    uint32_t suma = 0, sumb = 0;
+
+#pragma omp parallel for reduction(^:suma,sumb)
+    for (size_t i=0; i<nsite; i++) {
+      unsigned char *site = buf + i * bytes;
+      const size_t l = l0 + i;
+
+      int x[4];
+      slab.coords(x, l);
+      const int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+      const size_t x_cb = l / 2;
+
+      scidac_checksum(scidac_crc32(site, bytes), slab.global_index(x), suma, sumb);
+      if (swap) byte_swap(site, bytes / sizeof(T), sizeof(T));
+
+      const T *in = reinterpret_cast<const T*>(site);
+      for (int v=0; v<Nvec; v++) {
+	T *out = static_cast<T*>(V[v]) + (parity*volumeCB + x_cb)*len;
+	for (int j=0; j<len; j++) out[j] = in[v*len + j];
+      }
+    }
+
+    sum.suma ^= suma;
+    sum.sumb ^= sumb;
+  }
+};
+
+static void positioned_read(int fd, void *buf, size_t bytes, int64_t offset) {
+  size_t done = 0;
+  while (done < bytes) {
+    ssize_t rc = pread(fd, static_cast<char*>(buf) + done, bytes - done, offset + done);
+    if (rc <= 0) errorQuda("pread of %lu bytes at offset %lld failed", bytes, (long long)offset);
+    done += rc;
+  }
+}
+
+static void positioned_write(int fd, const void *buf, size_t bytes, int64_t offset) {
+  size_t done = 0;
+  while (done < bytes) {
+    ssize_t rc = pwrite(fd, static_cast<const char*>(buf) + done, bytes - done, offset + done);
+    if (rc <= 0) errorQuda("pwrite of %lu bytes at offset %lld failed", bytes, (long long)offset);
+    done += rc;
+  }
+}
+
+// read this rank's hyperslab in batches of runs and unpack each batch
+template <typename Unpacker>
+static void read_hyperslab(int fd, int64_t data_offset, const Hyperslab &slab, const Unpacker &unpack,
+			   FileChecksum &sum)
+{
+  const size_t site_bytes = unpack.site_bytes();
+  const size_t run_bytes = slab.run * site_bytes;
+  const size_t batch_runs = std::max<size_t>(1, io_batch_bytes / run_bytes);
+
+  unsigned char *buf = static_cast<unsigned char*>(safe_malloc(batch_runs * run_bytes));
+
+  for (size_t r0=0; r0<slab.n_run; r0+=batch_runs) {
+    const size_t nr = std::min(batch_runs, slab.n_run - r0);
+    for (size_t r=r0; r<r0+nr; r++)
+      positioned_read(fd, buf + (r - r0) * run_bytes, run_bytes, data_offset + slab.run_start(r) * site_bytes);
+    unpack(buf, r0 * slab.run, nr * slab.run, sum);
+  }
+
+  host_free(buf);
+}
+
+struct WriteArg {
+  int fd;
+  const unsigned char *buf;
+  size_t run_bytes;
+  std::vector<int64_t> offset; // file offset of each run in the batch
+};
+
+static void *issueWrite(void *arg_) {
+  const WriteArg &arg = *static_cast<WriteArg*>(arg_);
+  for (size_t r=0; r<arg.offset.size(); r++)
+    positioned_write(arg.fd, arg.buf + r*arg.run_bytes, arg.run_bytes, arg.offset[r]);
+  return NULL;
+}
+
+/**
+   Write this rank's hyperslab.  Batches are packed into two
+   alternating staging buffers, and each packed batch is handed to a
+   writer thread so that packing of the next batch (byte swapping,
+   conversion and checksumming) overlaps with the positioned writes.
+ */
+template <typename Packer>
+static void write_hyperslab(int fd, int64_t data_offset, const Hyperslab &slab, const Packer &pack,
+			    FileChecksum &sum)
+{
+  const size_t site_bytes = pack.site_bytes();
+  const size_t run_bytes = slab.run * site_bytes;
+  const size_t batch_runs = std::max<size_t>(1, io_batch_bytes / run_bytes);
+
+  unsigned char *buf[2];
+  for (int b=0; b<2; b++) buf[b] = static_cast<unsigned char*>(safe_malloc(batch_runs * run_bytes));
+
+  WriteArg arg[2];
+  pthread_t writeThread;
+  bool writing = false;
+
+  for (size_t r0=0, k=0; r0<slab.n_run; r0+=batch_runs, k++) {
+    const int b = k % 2;
+    const size_t nr = std::min(batch_runs, slab.n_run - r0);
+
+    pack(buf[b], r0 * slab.run, nr * slab.run, sum);
+
+    if (writing && pthread_join(writeThread, NULL)) errorQuda("pthread_join failed");
+
+    arg[b].fd = fd;
+    arg[b].buf = buf[b];
+    arg[b].run_bytes = run_bytes;
+    arg[b].offset.resize(nr);
+    for (size_t r=r0; r<r0+nr; r++) arg[b].offset[r-r0] = data_offset + slab.run_start(r) * site_bytes;
+
+    if (pthread_create(&writeThread, NULL, issueWrite, &arg[b])) errorQuda("pthread_create failed");
+    writing = true;
+  }
+
+  if (writing && pthread_join(writeThread, NULL)) errorQuda("pthread_join failed");
+
+  for (int b=0; b<2; b++) host_free(buf[b]);
+}
+
+void read_gauge_field_native(const char *filename, void *gauge, QudaPrecision precision,
+			     const int *X, QudaGaugeFieldOrder order)
+{
+  if (order != QUDA_QDP_GAUGE_ORDER && order != QUDA_MILC_GAUGE_ORDER)
+    errorQuda("Gauge order %d not supported", order);
+
+  double t0 = wall_time();
+
+  GaugeFileInfo info;
+  parse_gauge_header(filename, info);
+
+  Hyperslab slab(X);
+  for (int d=0; d<4; d++) {
+    if (info.dim[d] != slab.global_dim[d])
+      errorQuda("File dimension %d = %d does not match %d x %d", d, info.dim[d], comm_dim(d), X[d]);
+  }
+
+  const size_t global_volume = slab.global_volume();
+  const size_t site_bytes = 4 * info.rows * 3 * 2 * info.file_prec;
+  if ((size_t)info.data_bytes < global_volume * site_bytes)
+    errorQuda("File %s has %lld bytes of data, expected %lu", filename, (long long)info.data_bytes,
+	      global_volume * site_bytes);
+
+  if (getVerbosity() >= QUDA_VERBOSE)
+    printfQuda("%s: %s file %dx%dx%dx%d, %d-bit %s-endian, %d rows per link\n", __func__,
+	       info.format == NATIVE_ILDG_FORMAT ? "ILDG" : "NERSC", info.dim[0], info.dim[1],
+	       info.dim[2], info.dim[3], 8*info.file_prec, info.big_endian ? "big" : "little", info.rows);
+
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) errorQuda("Failed to open %s", filename);
+  init_crc_table();
+
+  FileChecksum sum;
+  if (precision == QUDA_DOUBLE_PRECISION) {
+    if (info.file_prec == 8) read_hyperslab(fd, info.data_offset, slab, GaugeUnpacker<double,double>(gauge, order, info, slab), sum);
+    else read_hyperslab(fd, info.data_offset, slab, GaugeUnpacker<double,float>(gauge, order, info, slab), sum);
+  } else if (precision == QUDA_SINGLE_PRECISION) {
+    if (info.file_prec == 8) read_hyperslab(fd, info.data_offset, slab, GaugeUnpacker<float,double>(gauge, order, info, slab), sum);
+    else read_hyperslab(fd, info.data_offset, slab, GaugeUnpacker<float,float>(gauge, order, info, slab), sum);
+  } else {
+    errorQuda("Unsupported precision %d", precision);
+  }
+
+  close(fd);
+
+  sum.reduce();
+
+  if (info.has_nersc_checksum && sum.nersc != info.nersc_checksum) {
+    // for 4D_SU3_GAUGE the checksum covers the reconstructed third
+    // row, whose rounding depends on the writer's arithmetic
+    if (info.rows == 3) errorQuda("NERSC checksum mismatch for %s: computed %x, header %x", filename, sum.nersc, info.nersc_checksum);
+    else warningQuda("NERSC checksum mismatch for %s: computed %x, header %x", filename, sum.nersc, info.nersc_checksum);
+  }
+
+  if (info.has_scidac_checksum && (sum.suma != info.scidac_suma || sum.sumb != info.scidac_sumb))
+    errorQuda("SciDAC checksum mismatch for %s: computed %x %x, file %x %x", filename,
+	      sum.suma, sum.sumb, info.scidac_suma, info.scidac_sumb);
+
+  if (info.has_link_trace) {
+    double trace = sum.trace / (3.0 * 4.0 * global_volume);
+    if (fabs(trace - info.link_trace) > 1e-6 * std::max(1.0, fabs(info.link_trace)))
+      errorQuda("Link trace mismatch for %s: computed %.12e, header %.12e", filename, trace, info.link_trace);
+  }
+
+  if (!info.has_nersc_checksum && !info.has_scidac_checksum)
+    warningQuda("No checksum found in %s", filename);
+
+  double t = wall_time() - t0;
+  comm_allreduce_max(&t);
+  if (getVerbosity() >= QUDA_SUMMARIZE) {
+    double local_gb = (double)global_volume * site_bytes / comm_size() * 1e-9;
+    printfQuda("%s: read %s in %g secs (%g GB/s per rank, %g GB/s aggregate)\n", __func__,
+	       filename, t, local_gb / t, local_gb * comm_size() / t);
+  }
+}
+
+// a LIME record header announcing a payload of the given size
+static std::string lime_header(const char *type, uint64_t bytes, bool mb, bool me) {
+  unsigned char h[lime_header_bytes];
+  memset(h, 0, sizeof(h));
+  const uint16_t flags = (mb ? 0x8000 : 0) | (me ? 0x4000 : 0);
+  for (int i=0; i<4; i++) h[i] = (lime_magic >> (24 - 8*i)) & 0xff;
+  h[5] = 1; // LIME version
+  h[6] = flags >> 8;
+  h[7] = flags & 0xff;
+  for (int i=0; i<8; i++) h[8+i] = (bytes >> (56 - 8*i)) & 0xff;
+  strncpy(reinterpret_cast<char*>(h + 16), type, 128);
+  return std::string(reinterpret_cast<char*>(h), lime_header_bytes);
+}
+
+// a complete LIME record: header, payload and padding to 8 bytes
+static std::string lime_record(const char *type, const std::string &data, bool mb, bool me) {
+  std::string record = lime_header(type, data.size(), mb, me) + data;
+  record.append((8 - data.size() % 8) % 8, '\0');
+  return record;
+}
+
+// the SciDAC file message followed by the leading records of a field
+// record message, up to but excluding the binary data record header
+static std::string scidac_header(const Hyperslab &slab, const char *datatype, QudaPrecision precision,
+				 int nColor, int nSpin, int typesize, int datacount) {
+  char xml[1024];
+  time_t now = time(NULL);
+  char date[64];
+  strftime(date, sizeof(date), "%a %b %d %H:%M:%S %Y UTC", gmtime(&now));
+
+  snprintf(xml, sizeof(xml), "<?xml version=\"1.0\" encoding=\"UTF-8\"?><scidacFile><version>1.1</version>"
+	   "<spacetime>4</spacetime><dims>%d %d %d %d </dims><volfmt>0</volfmt></scidacFile>",
+	   slab.global_dim[0], slab.global_dim[1], slab.global_dim[2], slab.global_dim[3]);
+  std::string header = lime_record("scidac-private-file-xml", xml, true, false);
+  header += lime_record("scidac-file-xml", "QUDA native parallel writer", false, true);
+
+  snprintf(xml, sizeof(xml), "<?xml version=\"1.0\" encoding=\"UTF-8\"?><scidacRecord><version>1.1</version>"
+	   "<date>%s</date><recordtype>0</recordtype><datatype>%s</datatype><precision>%s</precision>"
+	   "<colors>%d</colors><spins>%d</spins><typesize>%d</typesize><datacount>%d</datacount></scidacRecord>",
+	   date, datatype, precision == QUDA_DOUBLE_PRECISION ? "D" : "F", nColor, nSpin, typesize, datacount);
+  header += lime_record("scidac-private-record-xml", xml, true, false);
+  header += lime_record("scidac-record-xml", datatype, false, false);
+  return header;
+}
+
+static std::string scidac_checksum_record(const FileChecksum &sum) {
+  char xml[256];
+  snprintf(xml, sizeof(xml), "<?xml version=\"1.0\" encoding=\"UTF-8\"?><scidacChecksum><version>1.0</version>"
+	   "<suma>%x</suma><sumb>%x</sumb></scidacChecksum>", sum.suma, sum.sumb);
+  return lime_record("scidac-checksum", xml, false, true);
+}
+
+// NERSC header: all values are printed with a fixed width so that the
+// header length, and hence the data offset, is known before the checksum
+static std::string nersc_header(const Hyperslab &slab, QudaPrecision precision, uint32_t checksum, double trace) {
+  char header[1024];
+  if (fabs(trace) < 1e-99) trace = 0.0;
+  snprintf(header, sizeof(header), "BEGIN_HEADER\nHDR_VERSION = 1.0\nDATATYPE = 4D_SU3_GAUGE_3x3\n"
+	   "DIMENSION_1 = %d\nDIMENSION_2 = %d\nDIMENSION_3 = %d\nDIMENSION_4 = %d\n"
+	   "LINK_TRACE = %+.15e\nCHECKSUM = %08x\nFLOATING_POINT = %s\nEND_HEADER\n",
+	   slab.global_dim[0], slab.global_dim[1], slab.global_dim[2], slab.global_dim[3], trace, checksum,
+	   precision == QUDA_DOUBLE_PRECISION ? "IEEE64BIG" : "IEEE32BIG");
+  return header;
+}
+
+// rank 0 creates (truncates) the file, then every rank opens it
+static int open_for_write(const char *filename) {
+  if (comm_rank() == 0) {
+    int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) errorQuda("Failed to create %s", filename);
+    close(fd);
+  }
+  comm_barrier();
+  int fd = open(filename, O_WRONLY);
+  if (fd < 0) errorQuda("Failed to open %s", filename);
+  return fd;
+}
+
+static void report_write(const char *func, const char *filename, double t0, size_t bytes) {
+  double t = wall_time() - t0;
+  comm_allreduce_max(&t);
+  if (getVerbosity() >= QUDA_SUMMARIZE) {
+    double local_gb = (double)bytes / comm_size() * 1e-9;
+    printfQuda("%s: wrote %s in %g secs (%g GB/s per rank, %g GB/s aggregate)\n", func,
+	       filename, t, local_gb / t, local_gb * comm_size() / t);
+  }
+}
+
+void write_gauge_field_native(const char *filename, void *gauge, QudaPrecision precision,
+			      const int *X, QudaGaugeFieldOrder order, NativeFileFormat format)
+{
+  if (order != QUDA_QDP_GAUGE_ORDER && order != QUDA_MILC_GAUGE_ORDER)
+    errorQuda("Gauge order %d not supported", order);
+  if (precision != QUDA_DOUBLE_PRECISION && precision != QUDA_SINGLE_PRECISION)
+    errorQuda("Unsupported precision %d", precision);
+
+  double t0 = wall_time();
+  init_crc_table();
+
+  Hyperslab slab(X);
+  const size_t data_bytes = slab.global_volume() * 4 * 18 * precision;
+
+  // the header is built on rank 0 only, since it contains the date
+  std::string header;
+  int64_t data_offset = 0;
+  if (comm_rank() == 0) {
+    if (format == NATIVE_ILDG_FORMAT) {
+      char datatype[128], xml[512];
+      sprintf(datatype, "QUDA_%sNc3_GaugeField", precision == QUDA_DOUBLE_PRECISION ? "D" : "F");
+      header = scidac_header(slab, datatype, precision, 3, 1, 18*precision, 4);
+      snprintf(xml, sizeof(xml), "<?xml version=\"1.0\" encoding=\"UTF-8\"?><ildgFormat><version>1.0</version>"
+	       "<field>su3gauge</field><precision>%d</precision><lx>%d</lx><ly>%d</ly><lz>%d</lz><lt>%d</lt>"
+	       "</ildgFormat>", 8*precision, slab.global_dim[0], slab.global_dim[1], slab.global_dim[2],
+	       slab.global_dim[3]);
+      header += lime_record("ildg-format", xml, false, false);
+      // binary record header only: the payload is written by all ranks
+      header += lime_header("ildg-binary-data", data_bytes, false, false);
+    } else {
+      header = nersc_header(slab, precision, 0, 0.0);
+    }
+    data_offset = header.size();
+  }
+  comm_broadcast(&data_offset, sizeof(data_offset));
+
+  int fd = open_for_write(filename);
+
+  FileChecksum sum;
+  if (precision == QUDA_DOUBLE_PRECISION)
+    write_hyperslab(fd, data_offset, slab, GaugePacker<double>(gauge, order, format, slab), sum);
+  else
+    write_hyperslab(fd, data_offset, slab, GaugePacker<float>(gauge, order, format, slab), sum);
+
+  sum.reduce();
+
+  if (comm_rank() == 0) {
+    if (format == NATIVE_ILDG_FORMAT) {
+      positioned_write(fd, header.data(), header.size(), 0);
+      std::string trailer = scidac_checksum_record(sum);
+      positioned_write(fd, trailer.data(), trailer.size(), data_offset + ((data_bytes + 7) / 8) * 8);
+    } else {
+      header = nersc_header(slab, precision, sum.nersc, sum.trace / (3.0 * 4.0 * slab.global_volume()));
+      if ((int64_t)header.size() != data_offset) errorQuda("NERSC header size changed");
+      positioned_write(fd, header.data(), header.size(), 0);
+    }
+  }
+
+  close(fd);
+  comm_barrier();
+
+  report_write(__func__, filename, t0, data_bytes);
+}
+
+void write_spinor_field_native(const char *filename, void *V[], QudaPrecision precision, const int *X,
+			       int nColor, int nSpin, int Nvec)
+{
+  if (precision != QUDA_DOUBLE_PRECISION && precision != QUDA_SINGLE_PRECISION)
+    errorQuda("Unsupported precision %d", precision);
+
+  double t0 = wall_time();
+  init_crc_table();
+
+  Hyperslab slab(X);
+  const int len = 2 * nSpin * nColor;
+  const size_t data_bytes = slab.global_volume() * Nvec * len * precision;
+
+  std::string header;
+  int64_t data_offset = 0;
+  if (comm_rank() == 0) {
+    char datatype[128];
+    sprintf(datatype, "QUDA_%sNs%dNc%d_ColorSpinorField", precision == QUDA_DOUBLE_PRECISION ? "D" : "F", nSpin, nColor);
+    header = scidac_header(slab, datatype, precision, nColor, nSpin, len*precision, Nvec);
+    header += lime_header("scidac-binary-data", data_bytes, false, false);
+    data_offset = header.size();
+  }
+  comm_broadcast(&data_offset, sizeof(data_offset));
+
+  int fd = open_for_write(filename);
+
+  FileChecksum sum;
+  if (precision == QUDA_DOUBLE_PRECISION)
+    write_hyperslab(fd, data_offset, slab, SpinorPacker<double>(V, len, Nvec, slab), sum);
+  else
+    write_hyperslab(fd, data_offset, slab, SpinorPacker<float>(V, len, Nvec, slab), sum);
+
+  sum.reduce();
+
+  if (comm_rank() == 0) {
+    positioned_write(fd, header.data(), header.size(), 0);
+    std::string trailer = scidac_checksum_record(sum);
+    positioned_write(fd, trailer.data(), trailer.size(), data_offset + ((data_bytes + 7) / 8) * 8);
+  }
+
+  close(fd);
+  comm_barrier();
+
+  report_write(__func__, filename, t0, data_bytes);
+}
+
+/*
+  Compact null-space vector format.  A fixed-size header is followed by
+  the sites in global lexicographic order; each site holds, for every
+  vector, a float norm (the largest absolute value of the site's
+  components) followed by the components as 16-bit fixed-point
+  numbers relative to that norm, in the same way as QUDA's
+  half-precision fields.  All values are stored little endian.
+*/
+
+static const char compact_magic[8] = { 'Q', 'U', 'D', 'A', 'V', 'E', 'C', '1' };
+static const size_t compact_header_bytes = 64;
+static const float compact_max_short = 32767.0f;
+
+// header of a compact vector file, parsed on rank 0 and broadcast
+struct CompactFileInfo {
+  int dim[4];
+  int nSpin;
+  int nColor;
+  int Nvec;
+  uint32_t suma;
+  uint32_t sumb;
+};
+
+static inline void put_le16(unsigned char *p, uint16_t v) {
+  p[0] = v & 0xff;
+  p[1] = v >> 8;
+}
+
+static inline uint16_t get_le16(const unsigned char *p) {
+  return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static inline void put_le32(unsigned char *p, uint32_t v) {
+  for (int i=0; i<4; i++) p[i] = (v >> 8*i) & 0xff;
+}
+
+static inline uint32_t get_le32(const unsigned char *p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static std::string compact_header(const Hyperslab &slab, int nSpin, int nColor, int Nvec, const FileChecksum &sum) {
+  unsigned char h[compact_header_bytes];
+  memset(h, 0, sizeof(h));
+  memcpy(h, compact_magic, sizeof(compact_magic));
+  for (int d=0; d<4; d++) put_le32(h + 8 + 4*d, slab.global_dim[d]);
+  put_le32(h + 24, nSpin);
+  put_le32(h + 28, nColor);
+  put_le32(h + 32, Nvec);
+  put_le32(h + 36, sum.suma);
+  put_le32(h + 40, sum.sumb);
+  return std::string(reinterpret_cast<char*>(h), compact_header_bytes);
+}
+
+// pack host spinor sites into the compact representation
+template <typename T>
+struct CompactSpinorPacker {
+  void **V;
+  const int len;
+  const int Nvec;
+  const Hyperslab &slab;
+
+  CompactSpinorPacker(void **V, int len, int Nvec, const Hyperslab &slab)
+    : V(V), len(len), Nvec(Nvec), slab(slab) { }
+
+  size_t site_bytes() const { return (size_t)Nvec * (sizeof(float) + len * sizeof(int16_t)); }
+
+  void operator()(unsigned char *buf, size_t l0, size_t nsite, FileChecksum &sum) const {
+    const size_t bytes = site_bytes();
+    const size_t volumeCB = slab.volume / 2;
+
+    uint32_t suma = 0, sumb = 0;
+
+#pragma omp parallel for reduction(^:suma,sumb)
+    for (size_t i=0; i<nsite; i++) {
+      unsigned char *site = buf + i * bytes;
+      const size_t l = l0 + i;
+
+      int x[4];
+      slab.coords(x, l);
+      const int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+      const size_t x_cb = l / 2;
+
+      unsigned char *out = site;
+      for (int v=0; v<Nvec; v++) {
+	const T *in = static_cast<T*>(V[v]) + (parity*volumeCB + x_cb)*len;
+	float norm = 0.0f;
+	for (int j=0; j<len; j++) norm = std::max(norm, (float)fabs(in[j]));
+	uint32_t norm_bits;
+	memcpy(&norm_bits, &norm, sizeof(norm));
+	put_le32(out, norm_bits);
+	out += sizeof(float);
+
+	const float scale = norm > 0.0f ? compact_max_short / norm : 0.0f;
+	for (int j=0; j<len; j++) put_le16(out + 2*j, (uint16_t)(int16_t)lrintf(in[j] * scale));
+	out += len * sizeof(int16_t);
+      }
+
+      scidac_checksum(scidac_crc32(site, bytes), slab.global_index(x), suma, sumb);
+    }
+
+    sum.suma ^= suma;
+    sum.sumb ^= sumb;
+  }
+};
+
+// unpack compact sites into host spinor fields
+template <typename T>
+struct CompactSpinorUnpacker {
+  void **V;
+  const int len;
+  const int Nvec;
+  const Hyperslab &slab;
+
+  CompactSpinorUnpacker(void **V, int len, int Nvec, const Hyperslab &slab)
+    : V(V), len(len), Nvec(Nvec), slab(slab) { }
+
+  size_t site_bytes() const { return (size_t)Nvec * (sizeof(float) + len * sizeof(int16_t)); }
+
+  void operator()(unsigned char *buf, size_t l0, size_t nsite, FileChecksum &sum) const {
+    const size_t bytes = site_bytes();
+    const size_t volumeCB = slab.volume / 2;
+
+    uint32_t suma = 0, sumb = 0;
+
+#pragma omp parallel for reduction(^:suma,sumb)
+    for (size_t i=0; i<nsite; i++) {
+      const unsigned char *site = buf + i * bytes;
+      const size_t l = l0 + i;
+
+      int x[4];
+      slab.coords(x, l);
+      const int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+      const size_t x_cb = l / 2;
+
+      scidac_checksum(scidac_crc32(site, bytes), slab.global_index(x), suma, sumb);
+
+      const unsigned char *in = site;
+      for (int v=0; v<Nvec; v++) {
+	T *out = static_cast<T*>(V[v]) + (parity*volumeCB + x_cb)*len;
+	const uint32_t norm_bits = get_le32(in);
+	float norm;
+	memcpy(&norm, &norm_bits, sizeof(norm));
+	in += sizeof(float);
+
+	const T scale = norm / compact_max_short;
+	for (int j=0; j<len; j++) out[j] = scale * (int16_t)get_le16(in + 2*j);
+	in += len * sizeof(int16_t);
+      }
+    }
+
+    sum.suma ^= suma;
+    sum.sumb ^= sumb;
+  }
+};
+
+bool is_compact_spinor_file(const char *filename)
+{
+  int compact = 0;
+  if (comm_rank() == 0) {
+    FILE *fp = fopen(filename, "rb");
+    if (fp) {
+      char magic[sizeof(compact_magic)];
+      compact = fread(magic, 1, sizeof(magic), fp) == sizeof(magic) && !memcmp(magic, compact_magic, sizeof(magic));
+      fclose(fp);
+    }
+  }
+  comm_broadcast(&compact, sizeof(compact));
+  return compact;
+}
+
+void write_spinor_field_compact(const char *filename, void *V[], QudaPrecision precision, const int *X,
+				int nColor, int nSpin, int Nvec)
+{
+  if (precision != QUDA_DOUBLE_PRECISION && precision != QUDA_SINGLE_PRECISION)
+    errorQuda("Unsupported precision %d", precision);
+
+  double t0 = wall_time();
+  init_crc_table();
+
+  Hyperslab slab(X);
+  const int len = 2 * nSpin * nColor;
+
+  int fd = open_for_write(filename);
+
+  FileChecksum sum;
+  if (precision == QUDA_DOUBLE_PRECISION) {
+    CompactSpinorPacker<double> pack(V, len, Nvec, slab);
+    write_hyperslab(fd, compact_header_bytes, slab, pack, sum);
+  } else {
+    CompactSpinorPacker<float> pack(V, len, Nvec, slab);
+    write_hyperslab(fd, compact_header_bytes, slab, pack, sum);
+  }
+
+  sum.reduce();
+
+  if (comm_rank() == 0) {
+    std::string header = compact_header(slab, nSpin, nColor, Nvec, sum);
+    positioned_write(fd, header.data(), header.size(), 0);
+  }
+
+  close(fd);
+  comm_barrier();
+
+  report_write(__func__, filename, t0, slab.global_volume() * Nvec * (sizeof(float) + len * sizeof(int16_t)));
+}
+
+void read_spinor_field_compact(const char *filename, void *V[], QudaPrecision precision, const int *X,
+			       int nColor, int nSpin, int Nvec)
+{
+  if (precision != QUDA_DOUBLE_PRECISION && precision != QUDA_SINGLE_PRECISION)
+    errorQuda("Unsupported precision %d", precision);
+
+  double t0 = wall_time();
+
+  CompactFileInfo info;
+  memset(&info, 0, sizeof(info));
+  if (comm_rank() == 0) {
+    unsigned char h[compact_header_bytes];
+    FILE *fp = fopen(filename, "rb");
+    if (!fp) errorQuda("Failed to open %s", filename);
+    if (fread(h, 1, compact_header_bytes, fp) != compact_header_bytes || memcmp(h, compact_magic, sizeof(compact_magic)))
+      errorQuda("%s is not a compact vector file", filename);
+    fclose(fp);
+    for (int d=0; d<4; d++) info.dim[d] = get_le32(h + 8 + 4*d);
+    info.nSpin = get_le32(h + 24);
+    info.nColor = get_le32(h + 28);
+    info.Nvec = get_le32(h + 32);
+    info.suma = get_le32(h + 36);
+    info.sumb = get_le32(h + 40);
+  }
+  comm_broadcast(&info, sizeof(info));
+
+  Hyperslab slab(X);
+  for (int d=0; d<4; d++) {
+    if (info.dim[d] != slab.global_dim[d])
+      errorQuda("File dimension %d = %d does not match %d x %d", d, info.dim[d], comm_dim(d), X[d]);
+  }
+  if (info.nSpin != nSpin || info.nColor != nColor || info.Nvec != Nvec)
+    errorQuda("File %s has nSpin=%d nColor=%d Nvec=%d, expected %d %d %d", filename,
+	      info.nSpin, info.nColor, info.Nvec, nSpin, nColor, Nvec);
+
+  const int len = 2 * nSpin * nColor;
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) errorQuda("Failed to open %s", filename);
+  init_crc_table();
+
+  FileChecksum sum;
+  if (precision == QUDA_DOUBLE_PRECISION)
+    read_hyperslab(fd, compact_header_bytes, slab, CompactSpinorUnpacker<double>(V, len, Nvec, slab), sum);
+  else
+    read_hyperslab(fd, compact_header_bytes, slab, CompactSpinorUnpacker<float>(V, len, Nvec, slab), sum);
+
+  close(fd);
+
+  sum.reduce();
+  if (sum.suma != info.suma || sum.sumb != info.sumb)
+    errorQuda("Checksum mismatch for %s: computed %x %x, file %x %x", filename, sum.suma, sum.sumb, info.suma, info.sumb);
+
+  double t = wall_time() - t0;
+  comm_allreduce_max(&t);
+  if (getVerbosity() >= QUDA_SUMMARIZE) {
+    double local_gb = (double)slab.global_volume() * Nvec * (sizeof(float) + len * sizeof(int16_t)) / comm_size() * 1e-9;
+    printfQuda("%s: read %s in %g secs (%g GB/s per rank, %g GB/s aggregate)\n", __func__,
+	       filename, t, local_gb / t, local_gb * comm_size() / t);
+  }
+}
+
+/*
+  Checkpoint format.  A fixed-size file header holding the key is
+  followed by the records, each made of a fixed-size record header and
+  the record's sites in global lexicographic order, laid out as by
+  write_spinor_field_native (big endian, all arrays of a site
+  together).  Headers are stored little endian.
+*/
+
+static const char checkpoint_magic[8] = { 'Q', 'U', 'D', 'A', 'C', 'K', 'P', '1' };
+static const size_t checkpoint_header_bytes = 64;
+static const int checkpoint_max_record = 32;
+
+// header of a checkpoint file and its records, parsed on rank 0 and broadcast
+struct CheckpointFileInfo {
+  int valid;
+  uint64_t key;
+  int n_record;
+  struct {
+    int dim[4];
+    int Nvec;
+    int len;
+    int precision;
+    uint32_t suma;
+    uint32_t sumb;
+    int64_t offset; // file offset of the record data
+  } record[checkpoint_max_record];
+};
+
+static inline void put_le64(unsigned char *p, uint64_t v) {
+  for (int i=0; i<8; i++) p[i] = (v >> 8*i) & 0xff;
+}
+
+static inline uint64_t get_le64(const unsigned char *p) {
+  return (uint64_t)get_le32(p) | (uint64_t)get_le32(p + 4) << 32;
+}
+
+static size_t record_bytes(const NativeRecord &record) {
+  size_t volume = 1;
+  for (int d=0; d<4; d++) volume *= (size_t)comm_dim(d) * record.X[d];
+  return volume * record.Nvec * record.len * record.precision;
+}
+
+static void parse_checkpoint_header(const char *filename, CheckpointFileInfo &info) {
+  memset(&info, 0, sizeof(info));
+  if (comm_rank() == 0) {
+    FILE *fp = fopen(filename, "rb");
+    unsigned char h[checkpoint_header_bytes];
+    if (fp && fread(h, 1, checkpoint_header_bytes, fp) == checkpoint_header_bytes &&
+	!memcmp(h, checkpoint_magic, sizeof(checkpoint_magic))) {
+      info.key = get_le64(h + 8);
+      info.n_record = get_le32(h + 16);
+      info.valid = info.n_record <= checkpoint_max_record;
+
+      int64_t offset = checkpoint_header_bytes;
+      for (int i=0; i<info.n_record && info.valid; i++) {
+	if (fseek(fp, offset, SEEK_SET) || fread(h, 1, checkpoint_header_bytes, fp) != checkpoint_header_bytes) {
+	  info.valid = 0;
+	  break;
+	}
+	size_t volume = 1;
+	for (int d=0; d<4; d++) volume *= info.record[i].dim[d] = get_le32(h + 4*d);
+	info.record[i].Nvec = get_le32(h + 16);
+	info.record[i].len = get_le32(h + 20);
+	info.record[i].precision = get_le32(h + 24);
+	info.record[i].suma = get_le32(h + 28);
+	info.record[i].sumb = get_le32(h + 32);
+	info.record[i].offset = offset + checkpoint_header_bytes;
+	offset = info.record[i].offset + volume * info.record[i].Nvec * info.record[i].len * info.record[i].precision;
+      }
+    }
+    if (fp) fclose(fp);
+  }
+  comm_broadcast(&info, sizeof(info));
+}
+
+bool is_checkpoint_native(const char *filename, uint64_t key)
+{
+  CheckpointFileInfo info;
+  parse_checkpoint_header(filename, info);
+  return info.valid && info.key == key;
+}
+
+void write_checkpoint_native(const char *filename, uint64_t key, const NativeRecord *record, int n_record)
+{
+  if (n_record > checkpoint_max_record) errorQuda("Number of records %d exceeds maximum %d", n_record, checkpoint_max_record);
+
+  double t0 = wall_time();
+  init_crc_table();
+
+  int fd = open_for_write(filename);
+
+  int64_t offset = checkpoint_header_bytes;
+  size_t total_bytes = 0;
+  for (int i=0; i<n_record; i++) {
+    const NativeRecord &r = record[i];
+    if (r.precision != QUDA_DOUBLE_PRECISION && r.precision != QUDA_SINGLE_PRECISION)
+      errorQuda("Unsupported precision %d for record %d", r.precision, i);
+
+    Hyperslab slab(r.X);
+    const int64_t data_offset = offset + checkpoint_header_bytes;
+
+    FileChecksum sum;
+    if (r.precision == QUDA_DOUBLE_PRECISION)
+      write_hyperslab(fd, data_offset, slab, SpinorPacker<double>(r.V, r.len, r.Nvec, slab), sum);
+    else
+      write_hyperslab(fd, data_offset, slab, SpinorPacker<float>(r.V, r.len, r.Nvec, slab), sum);
+    sum.reduce();
+
+    if (comm_rank() == 0) {
+      unsigned char h[checkpoint_header_bytes];
+      memset(h, 0, sizeof(h));
+      for (int d=0; d<4; d++) put_le32(h + 4*d, slab.global_dim[d]);
+      put_le32(h + 16, r.Nvec);
+      put_le32(h + 20, r.len);
+      put_le32(h + 24, r.precision);
+      put_le32(h + 28, sum.suma);
+      put_le32(h + 32, sum.sumb);
+      positioned_write(fd, h, sizeof(h), offset);
+    }
+
+    offset = data_offset + record_bytes(r);
+    total_bytes += record_bytes(r);
+  }
+
+  // the file header is written last so that an interrupted write leaves no valid checkpoint
+  if (comm_rank() == 0) {
+    unsigned char h[checkpoint_header_bytes];
+    memset(h, 0, sizeof(h));
+    memcpy(h, checkpoint_magic, sizeof(checkpoint_magic));
+    put_le64(h + 8, key);
+    put_le32(h + 16, n_record);
+    positioned_write(fd, h, sizeof(h), 0);
+  }
+
+  close(fd);
+  comm_barrier();
+
+  report_write(__func__, filename, t0, total_bytes);
+}
+
+bool read_checkpoint_native(const char *filename, uint64_t key, const NativeRecord *record, int n_record)
+{
+  double t0 = wall_time();
+
+  CheckpointFileInfo info;
+  parse_checkpoint_header(filename, info);
+  if (!info.valid || info.key != key) {
+    if (getVerbosity() >= QUDA_VERBOSE)
+      printfQuda("%s: %s is not a checkpoint with key %016llx\n", __func__, filename, (unsigned long long)key);
+    return false;
+  }
+  if (info.n_record != n_record)
+    errorQuda("Checkpoint %s has %d records, expected %d", filename, info.n_record, n_record);
+
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) errorQuda("Failed to open %s", filename);
+  init_crc_table();
+
+  size_t total_bytes = 0;
+  for (int i=0; i<n_record; i++) {
+    const NativeRecord &r = record[i];
+    if (!r.V) continue; // record not requested
+
+    Hyperslab slab(r.X);
+    for (int d=0; d<4; d++) {
+      if (info.record[i].dim[d] != slab.global_dim[d])
+	errorQuda("Record %d dimension %d = %d does not match %d x %d", i, d, info.record[i].dim[d], comm_dim(d), r.X[d]);
+    }
+    if (info.record[i].Nvec != r.Nvec || info.record[i].len != r.len || info.record[i].precision != r.precision)
+      errorQuda("Record %d of %s has Nvec=%d len=%d precision=%d, expected %d %d %d", i, filename,
+		info.record[i].Nvec, info.record[i].len, info.record[i].precision, r.Nvec, r.len, r.precision);
+
+    FileChecksum sum;
+    if (r.precision == QUDA_DOUBLE_PRECISION)
+      read_hyperslab(fd, info.record[i].offset, slab, SpinorUnpacker<double>(r.V, r.len, r.Nvec, slab), sum);
+    else
+      read_hyperslab(fd, info.record[i].offset, slab, SpinorUnpacker<float>(r.V, r.len, r.Nvec, slab), sum);
+
+    sum.reduce();
+    if (sum.suma != info.record[i].suma || sum.sumb != info.record[i].sumb)
+      errorQuda("Checksum mismatch for record %d of %s: computed %x %x, file %x %x", i, filename,
+		sum.suma, sum.sumb, info.record[i].suma, info.record[i].sumb);
+
+    total_bytes += record_bytes(r);
+  }
+
+  close(fd);
+
+  double t = wall_time() - t0;
+  comm_allreduce_max(&t);
+  if (getVerbosity() >= QUDA_SUMMARIZE) {
+    double local_gb = (double)total_bytes / comm_size() * 1e-9;
+    printfQuda("%s: read %s in %g secs (%g GB/s per rank, %g GB/s aggregate)\n", __func__,
+	       filename, t, local_gb / t, local_gb * comm_size() / t);
+  }
+
+  return true;
+}
+
+/*
+  Vector store format.  The first page holds the header, followed by
+  two metadata slots and then the vectors.  Each rank's part of vector
+  i is stored at
+
+    vec_offset + (i * n_rank + rank) * slice_bytes
+
+  with slice_bytes the local vector size padded to whole pages, so it
+  can be mapped on its own.  The header is stored little endian, the
+  metadata and vectors in the native byte order of the host, which is
+  recorded in the header.
+
+  The header names the metadata slot that belongs to the committed
+  state.  A commit writes the new metadata into the other slot and
+  flushes it before the header, which fits in a single sector, is
+  rewritten to point at it; an interrupted commit therefore leaves the
+  previous header and metadata intact.
+*/
+
+static const char store_magic[8] = { 'Q', 'U', 'D', 'A', 'V', 'S', 'T', '2' };
+static const size_t store_header_bytes = 72;
+static const size_t store_page_bytes = 65536; // a multiple of the page size on all supported hosts
+static const uint32_t store_byte_order = 0x01020304;
+
+struct NativeVectorStore {
+  int fd;
+  bool writable;
+  uint64_t key;
+  int capacity;
+  int n_vec;               // number of committed vectors
+  size_t vec_bytes;        // bytes of each rank's part of a vector
+  size_t slice_bytes;      // vec_bytes padded to whole pages
+  size_t meta_bytes;
+  int meta_slot;           // metadata slot of the committed state
+  int64_t vec_offset;      // file offset of the first vector
+  std::vector<void*> map;  // mapped vectors (nullptr if not mapped yet)
+};
+
+// header of a vector store, parsed on rank 0 and broadcast
+struct VectorStoreInfo {
+  int valid;
+  uint64_t key;
+  uint32_t byte_order;
+  int capacity;
+  int n_vec;
+  int n_rank;
+  int grid[4];
+  uint64_t vec_bytes;
+  uint64_t meta_bytes;
+  int meta_slot;
+};
+
+static inline size_t store_pad(size_t bytes) {
+  return (bytes + store_page_bytes - 1) / store_page_bytes * store_page_bytes;
+}
+
+static void parse_store_header(const char *filename, VectorStoreInfo &info) {
+  memset(&info, 0, sizeof(info));
+  if (comm_rank() == 0) {
+    FILE *fp = fopen(filename, "rb");
+    unsigned char h[store_header_bytes];
+    if (fp && fread(h, 1, store_header_bytes, fp) == store_header_bytes && !memcmp(h, store_magic, sizeof(store_magic))) {
+      info.valid = 1;
+      info.key = get_le64(h + 8);
+      memcpy(&info.byte_order, h + 16, sizeof(info.byte_order));
+      info.capacity = get_le32(h + 20);
+      info.n_vec = get_le32(h + 24);
+      info.n_rank = get_le32(h + 28);
+      for (int d=0; d<4; d++) info.grid[d] = get_le32(h + 32 + 4*d);
+      info.vec_bytes = get_le64(h + 48);
+      info.meta_bytes = get_le64(h + 56);
+      info.meta_slot = get_le32(h + 64);
+    }
+    if (fp) fclose(fp);
+  }
+  comm_broadcast(&info, sizeof(info));
+}
+
+// only called on rank 0
+static void write_store_header(const NativeVectorStore &store, int n_vec, int meta_slot) {
+  unsigned char h[store_header_bytes];
+  memset(h, 0, sizeof(h));
+  memcpy(h, store_magic, sizeof(store_magic));
+  put_le64(h + 8, store.key);
+  memcpy(h + 16, &store_byte_order, sizeof(store_byte_order));
+  put_le32(h + 20, store.capacity);
+  put_le32(h + 24, n_vec);
+  put_le32(h + 28, comm_size());
+  for (int d=0; d<4; d++) put_le32(h + 32 + 4*d, comm_dim(d));
+  put_le64(h + 48, store.vec_bytes);
+  put_le64(h + 56, store.meta_bytes);
+  put_le32(h + 64, meta_slot);
+  positioned_write(store.fd, h, store_header_bytes, 0);
+}
+
+static NativeVectorStore *new_vector_store(int fd, bool writable, uint64_t key, size_t vec_bytes, int capacity,
+					   size_t meta_bytes, int n_vec, int meta_slot) {
+  if (store_page_bytes % sysconf(_SC_PAGESIZE) != 0)
+    errorQuda("Vector store page size %lu is not a multiple of the system page size %ld", store_page_bytes, sysconf(_SC_PAGESIZE));
+
+  NativeVectorStore *store = new NativeVectorStore;
+  store->fd = fd;
+  store->writable = writable;
+  store->key = key;
+  store->capacity = capacity;
+  store->n_vec = n_vec;
+  store->vec_bytes = vec_bytes;
+  store->slice_bytes = store_pad(vec_bytes);
+  store->meta_bytes = meta_bytes;
+  store->meta_slot = meta_slot;
+  store->vec_offset = store_page_bytes + 2 * store_pad(meta_bytes);
+  store->map.resize(capacity, nullptr);
+  return store;
+}
+
+static inline int64_t store_meta_offset(const NativeVectorStore &store, int slot) {
+  return store_page_bytes + slot * store_pad(store.meta_bytes);
+}
+
+static inline int64_t store_offset(const NativeVectorStore &store, int i) {
+  return store.vec_offset + ((int64_t)i * comm_size() + comm_rank()) * store.slice_bytes;
+}
+
+bool is_vector_store(const char *filename)
+{
+  VectorStoreInfo info;
+  parse_store_header(filename, info);
+  return info.valid;
+}
+
+NativeVectorStore *open_vector_store(const char *filename, uint64_t key, size_t vec_bytes, int capacity,
+				     size_t meta_bytes, bool writable)
+{
+  VectorStoreInfo info;
+  parse_store_header(filename, info);
+  if (!info.valid) return nullptr;
+
+  bool match = info.key == key && info.byte_order == store_byte_order && info.capacity == capacity &&
+    info.vec_bytes == vec_bytes && info.meta_bytes == meta_bytes && info.n_rank == comm_size() &&
+    (info.meta_slot == 0 || info.meta_slot == 1);
+  for (int d=0; d<4; d++) match = match && info.grid[d] == comm_dim(d);
+  if (!match) {
+    if (getVerbosity() >= QUDA_VERBOSE) printfQuda("Vector store %s does not match the requested layout\n", filename);
+    return nullptr;
+  }
+
+  int fd = open(filename, writable ? O_RDWR : O_RDONLY);
+  if (fd < 0) errorQuda("Failed to open %s", filename);
+
+  return new_vector_store(fd, writable, key, vec_bytes, capacity, meta_bytes, info.n_vec, info.meta_slot);
+}
+
+NativeVectorStore *create_vector_store(const char *filename, uint64_t key, size_t vec_bytes, int capacity,
+				       size_t meta_bytes)
+{
+  NativeVectorStore *store = nullptr;
+  if (comm_rank() == 0) {
+    int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) errorQuda("Failed to create %s", filename);
+    store = new_vector_store(fd, true, key, vec_bytes, capacity, meta_bytes, 0, 0);
+    write_store_header(*store, 0, 0);
+    close(fd);
+    delete store;
+  }
+  comm_barrier();
+
+  int fd = open(filename, O_RDWR);
+  if (fd < 0) errorQuda("Failed to open %s", filename);
+  return new_vector_store(fd, true, key, vec_bytes, capacity, meta_bytes, 0, 0);
+}
+
+void close_vector_store(NativeVectorStore *store)
+{
+  for (auto v : store->map) if (v) munmap(v, store->vec_bytes);
+  close(store->fd);
+  delete store;
+}
+
+int vector_store_size(const NativeVectorStore *store) { return store->n_vec; }
+
+const void *vector_store_vector(NativeVectorStore *store, int i)
+{
+  if (i < 0 || i >= store->n_vec) errorQuda("Vector %d is not in the store (size %d)", i, store->n_vec);
+
+  if (!store->map[i]) {
+    void *v = mmap(nullptr, store->vec_bytes, PROT_READ, MAP_SHARED, store->fd, store_offset(*store, i));
+    if (v == MAP_FAILED) errorQuda("Failed to map vector %d of the store", i);
+    madvise(v, store->vec_bytes, MADV_SEQUENTIAL);
+    store->map[i] = v;
+  }
+  return store->map[i];
+}
+
+void vector_store_read_meta(NativeVectorStore *store, void *meta)
+{
+  positioned_read(store->fd, meta, store->meta_bytes, store_meta_offset(*store, store->meta_slot));
+}
+
+void vector_store_write(NativeVectorStore *store, int i, const void *v)
+{
+  if (!store->writable) errorQuda("Vector store is not writable");
+  if (i < 0 || i >= store->capacity) errorQuda("Vector %d exceeds the store capacity %d", i, store->capacity);
+  positioned_write(store->fd, v, store->vec_bytes, store_offset(*store, i));
+}
+
+void vector_store_commit(NativeVectorStore *store, int n_vec, const void *meta)
+{
+  if (!store->writable) errorQuda("Vector store is not writable");
+  if (n_vec < 0 || n_vec > store->capacity) errorQuda("Vector count %d exceeds the store capacity %d", n_vec, store->capacity);
+
+  // all ranks must have flushed their part before the header is updated
+  if (fdatasync(store->fd) != 0) errorQuda("Failed to flush the vector store");
+  comm_barrier();
+
+  // the metadata goes into the inactive slot, which the header only
+  // names once it is on disk
+  const int meta_slot = 1 - store->meta_slot;
+  if (comm_rank() == 0) {
+    positioned_write(store->fd, meta, store->meta_bytes, store_meta_offset(*store, meta_slot));
+    if (fdatasync(store->fd) != 0) errorQuda("Failed to flush the vector store");
+    write_store_header(*store, n_vec, meta_slot);
+    if (fdatasync(store->fd) != 0) errorQuda("Failed to flush the vector store");
+  }
+  comm_barrier();
+  store->meta_slot = meta_slot;
+
+  // discarded vectors are no longer valid
+  for (int i=n_vec; i<store->n_vec; i++) {
+    if (store->map[i]) munmap(store->map[i], store->vec_bytes);
+    store->map[i] = nullptr;
+  }
+  store->n_vec = n_vec;
+}
@@ -918,6 +918,36 @@ namespace quda {
         (make_double2(a, 0.0), make_double2(b, 1.0-b), x, y, z, z, z);
     }
 
+    /**
+       double2 pipeCGUpdateNorm(d a, d b, V x, V y, V z, V w, V v){}
+        y = x + b*y;
+        w += a*y;
+        x -= a*z;
+        norm2(x);
+        dotProduct(v, x);
+    */
+    template <typename ReduceType, typename Float2, typename FloatN>
+    struct pipeCGUpdateNorm_ : public ReduceFunctor<ReduceType, Float2, FloatN> {
+      Float2 a, b;
+      pipeCGUpdateNorm_(const Float2 &a, const Float2 &b) : a(a), b(b) { ; }
+      __device__ __host__ void operator()(ReduceType &sum, FloatN &x, FloatN &y, FloatN &z, FloatN &w, FloatN &v) {
+	typedef typename ScalarType<ReduceType>::type scalar;
+        y = x + b.x*y;
+        w += a.x*y;
+        x -= a.x*z;
+        norm2_<scalar>(sum.x,x);
+        dot_<scalar>(sum.y,v,x);
+      }
+      static int streams() { return 8; } //! total number of input and output streams
+      static int flops() { return 10; } //! flops per element
+    };
+
+    double2 pipeCGUpdateNorm(double a, double b, ColorSpinorField &x, ColorSpinorField &y,
+			     ColorSpinorField &z, ColorSpinorField &w, ColorSpinorField &v) {
+      return reduce::reduceCuda<double2,QudaSumFloat2,pipeCGUpdateNorm_,1,1,0,1,0,false>
+        (make_double2(a, 0.0), make_double2(b, 0.0), x, y, z, w, v);
+    }
+
    } // namespace blas
 
 } // namespace quda
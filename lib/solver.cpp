@@ -30,7 +30,11 @@ namespace quda {
     switch (param.inv_type) {
     case QUDA_CG_INVERTER:
       report("CG");
-      solver = new CG(mat, matSloppy, param, profile);
+      if (param.precision_adaptive != QUDA_INVALID_PRECISION) {
+        solver = new CG(mat, matSloppy, matPrecon, param, profile);
+      } else {
+        solver = new CG(mat, matSloppy, param, profile);
+      }
       break;
     case QUDA_BICGSTAB_INVERTER:
       report("BiCGstab");
@@ -55,10 +59,30 @@ namespace quda {
       report("CA-GCR");
       solver = new CAGCR(mat, matSloppy, param, profile);
       break;
+    case QUDA_MSRC_CG_INVERTER:
+      report("MultiSrcCG");
+      solver = new MultiSrcCG(mat, matSloppy, param, profile);
+      break;
+    case QUDA_PIPELINED_CG_INVERTER:
+      report("PipelinedCG");
+      solver = new PipelinedCG(mat, matSloppy, param, profile);
+      break;
+    case QUDA_GCRODR_INVERTER:
+      report("GCRODR");
+      solver = new GCRODR(mat, matSloppy, param, profile);
+      break;
     case QUDA_MR_INVERTER:
       report("MR");
       solver = new MR(mat, matSloppy, param, profile);
       break;
+    case QUDA_GMRES_POLYNOMIAL_INVERTER:
+      report("GMRES-polynomial");
+      solver = new PolySmoother(mat, matSloppy, param, profile);
+      break;
+    case QUDA_CHEBYSHEV_INVERTER:
+      report("Chebyshev");
+      solver = new PolySmoother(mat, matSloppy, param, profile);
+      break;
     case QUDA_SD_INVERTER:
       report("SD");
       solver = new SD(mat, param, profile);
@@ -207,7 +231,7 @@ namespace quda {
   }
 
   void Solver::PrintSummary(const char *name, int k, double r2, double b2,
-                            double r2_tol, double hq_tol) {
+                            double r2_tol, double hq_tol, const char *trace) {
     if (getVerbosity() >= QUDA_SUMMARIZE) {
       if (param.compute_true_res) {
 	if (param.residual_type & QUDA_HEAVY_QUARK_RESIDUAL) {
@@ -228,6 +252,7 @@ namespace quda {
                      name, k, sqrt(r2/b2), sqrt(r2_tol/b2));
 	}
       }
+      if (trace) printfQuda("%s: Precision trace: %s\n", name, trace);
     }
   }
 
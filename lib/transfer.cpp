@@ -17,7 +17,7 @@ namespace quda {
   * for the staggered case, there is no spin blocking, 
   * however we do even-odd to preserve chirality (that is straightforward)
   */
-  Transfer::Transfer(const std::vector<ColorSpinorField*> &B, int Nvec, int *geo_bs, int spin_bs, QudaPrecision null_precision, TimeProfile &profile)
+  Transfer::Transfer(const std::vector<ColorSpinorField*> &B, int Nvec, int *geo_bs, int spin_bs, QudaPrecision null_precision, TimeProfile &profile, bool orthogonalize)
     : B(B), Nvec(Nvec), null_precision(null_precision), V_h(nullptr), V_d(nullptr),
       fine_tmp_h(nullptr), fine_tmp_d(nullptr), coarse_tmp_h(nullptr), coarse_tmp_d(nullptr), geo_bs(nullptr),
       fine_to_coarse_h(nullptr), coarse_to_fine_h(nullptr), fine_to_coarse_d(nullptr), coarse_to_fine_d(nullptr),
@@ -75,7 +75,7 @@ namespace quda {
     for (int s = 0; s < B[0]->Nspin(); s++) spin_map[s] = static_cast<int*>(safe_malloc(2*sizeof(int)));
     createSpinMap(spin_bs);
 
-    reset();
+    if (orthogonalize) reset();
     postTrace();
   }
 
@@ -183,6 +183,17 @@ namespace quda {
     postTrace();
   }
 
+  ColorSpinorField& Transfer::HostVectors() const
+  {
+    initializeLazy(QUDA_CPU_FIELD_LOCATION);
+    return *V_h;
+  }
+
+  void Transfer::updateVectors() const
+  {
+    if (enable_gpu) *V_d = *V_h;
+  }
+
   Transfer::~Transfer() {
     if (spin_map)
     {
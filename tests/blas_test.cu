@@ -33,7 +33,7 @@ extern QudaSolveType solve_type;
 
 extern void usage(char** );
 
-const int Nkernels = 43;
+const int Nkernels = 45;
 
 using namespace quda;
 
@@ -491,6 +491,14 @@ double benchmark(int kernel, const int niter) {
       for (int i=0; i < niter; ++i) blas::cDotProduct(A, xmD->Components(), ymD->Components());
       break;
 
+    case 43:
+      for (int i=0; i < niter; ++i) blas::pipeCGUpdate(a, b, *xD, *yD, *zD, *wD);
+      break;
+
+    case 44:
+      for (int i=0; i < niter; ++i) blas::pipeCGUpdateNorm(a, b, *xD, *yD, *zD, *wD, *vD);
+      break;
+
     default:
       errorQuda("Undefined blas kernel %d\n", kernel);
     }
@@ -935,6 +943,27 @@ double test(int kernel) {
     error /= Nsrc*Msrc;
     break;
 
+  case 43:
+    *xD = *xH;
+    *yD = *yH;
+    *zD = *zH;
+    *wD = *wH;
+    { blas::pipeCGUpdate(a, b, *xD, *yD, *zD, *wD);
+      blas::pipeCGUpdate(a, b, *xH, *yH, *zH, *wH);
+      error = ERROR(y) + ERROR(z) + ERROR(w); }
+    break;
+
+  case 44:
+    *xD = *xH;
+    *yD = *yH;
+    *zD = *zH;
+    *wD = *wH;
+    *vD = *vH;
+    { double2 d = blas::pipeCGUpdateNorm(a, b, *xD, *yD, *zD, *wD, *vD);
+      double2 h = blas::pipeCGUpdateNorm(a, b, *xH, *yH, *zH, *wH, *vH);
+      error = ERROR(x) + ERROR(y) + ERROR(w) + fabs(d.x - h.x) / fabs(h.x) + fabs(d.y - h.y) / fabs(h.y); }
+    break;
+
   default:
     errorQuda("Undefined blas kernel %d\n", kernel);
   }
@@ -995,6 +1024,8 @@ const char *names[] = {
   "caxpyBzpx",
   "cDotProductNorm_block",
   "cDotProduct_block",
+  "pipeCGUpdate",
+  "pipeCGUpdateNorm",
   "caxpy_composite"
 };
 
@@ -51,6 +51,7 @@ extern char latfile[];
 extern int Nsrc; // number of spinors to apply to simultaneously
 extern int niter;
 extern int nvec[];
+extern int multishift; // whether to test the deflated multi-shift solver
 
 extern QudaInverterType inv_type;
 extern QudaInverterType precon_type;
@@ -84,6 +85,7 @@ extern QudaExtLibType   deflation_ext_lib;
 
 extern QudaFieldLocation location_ritz;
 extern QudaMemoryType    mem_type_ritz;
+extern bool df_vec_store;
 
 namespace quda {
   extern void setTransferGPU(bool);
@@ -293,6 +295,7 @@ void setDeflationParam(QudaEigParam &df_param) {
   // set file i/o parameters
   strcpy(df_param.vec_infile, vec_infile);
   strcpy(df_param.vec_outfile, vec_outfile);
+  df_param.vec_store = df_vec_store ? QUDA_BOOLEAN_YES : QUDA_BOOLEAN_NO;
 }
   
 
@@ -422,6 +425,59 @@ int main(int argc, char **argv)
     printfQuda("\nDone for %d rhs.\n", inv_param.rhs_idx);
   }
 
+  int multishift_result = 0;
+  if (multishift) {
+    // reuse the deflation space built by the eigCG solves for a
+    // multi-shift solve of the same normal operator, once without and
+    // once with deflation
+    QudaInvertParam ms_param = inv_param;
+    ms_param.inv_type = QUDA_CG_INVERTER;
+    ms_param.solution_type = QUDA_MATPCDAG_MATPC_SOLUTION;
+    ms_param.solve_type = QUDA_NORMOP_PC_SOLVE;
+    ms_param.num_offset = 4;
+    double offset[4] = {0.0, 0.01, 0.1, 1.0};
+    for (int i=0; i<ms_param.num_offset; i++) {
+      ms_param.offset[i] = offset[i];
+      ms_param.tol_offset[i] = ms_param.tol;
+      ms_param.tol_hq_offset[i] = ms_param.tol_hq;
+    }
+
+    void **spinorOutMulti = (void**)malloc(ms_param.num_offset*sizeof(void *));
+    for (int i=0; i<ms_param.num_offset; i++) spinorOutMulti[i] = malloc(V*spinorSiteSize*sSize*inv_param.Ls);
+
+    // deflation requires the true residuals, which confirm the shifts
+    // that converge from the deflated guess alone
+    ms_param.compute_true_res = 1;
+
+    int iter[2];
+    double true_res[2][4];
+    for (int deflate=0; deflate<2; deflate++) {
+      ms_param.iter = 0;
+      ms_param.deflation_op = deflate ? df_preconditioner : nullptr;
+      invertMultiShiftQuda(spinorOutMulti, spinorIn, &ms_param);
+      iter[deflate] = ms_param.iter;
+      for (int i=0; i<ms_param.num_offset; i++) {
+        true_res[deflate][i] = ms_param.true_res_offset[i];
+        printfQuda("Shift %d (%s): true residual %e\n", i, deflate ? "deflated" : "undeflated", true_res[deflate][i]);
+      }
+    }
+    printfQuda("\nMulti-shift CG iterations: %d without deflation, %d with deflation\n", iter[0], iter[1]);
+
+    // deflation must not cost iterations, nor accuracy on any shift
+    // whose true residual was computed
+    bool pass = iter[1] <= iter[0];
+    for (int i=0; i<ms_param.num_offset; i++) {
+      if (std::isinf(true_res[0][i]) || std::isinf(true_res[1][i])) continue;
+      double limit = 10.0 * (true_res[0][i] > ms_param.tol_offset[i] ? true_res[0][i] : ms_param.tol_offset[i]);
+      if (true_res[1][i] > limit) pass = false;
+    }
+    printfQuda("Deflated multi-shift CG %s\n", pass ? "PASSED" : "FAILED");
+    if (!pass) multishift_result = 1;
+
+    for (int i=0; i<ms_param.num_offset; i++) free(spinorOutMulti[i]);
+    free(spinorOutMulti);
+  }
+
   destroyDeflationQuda(df_preconditioner);    
 
   // stop the timer
@@ -500,5 +556,5 @@ int main(int argc, char **argv)
 
   for (int dir = 0; dir<4; dir++) free(gauge[dir]);
 
-  return 0;
+  return multishift_result;
 }
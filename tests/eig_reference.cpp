@@ -0,0 +1,16 @@
+#include <eig_reference.h>
+#include <Eigen/Dense>
+#include <algorithm>
+
+void hermitian_eigenvalues(double *evals, const std::complex<double> *A, int n) {
+  Eigen::Map<const Eigen::MatrixXcd> A_(A, n, n);
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXcd> eig(A_, Eigen::EigenvaluesOnly);
+  for (int i=0; i<n; i++) evals[i] = eig.eigenvalues()(i);
+}
+
+void eigenvalues(std::complex<double> *evals, const std::complex<double> *A, int n) {
+  Eigen::Map<const Eigen::MatrixXcd> A_(A, n, n);
+  Eigen::ComplexEigenSolver<Eigen::MatrixXcd> eig(A_, false);
+  for (int i=0; i<n; i++) evals[i] = eig.eigenvalues()(i);
+  std::sort(evals, evals+n, [](const std::complex<double> &a, const std::complex<double> &b) { return std::abs(a) < std::abs(b); });
+}
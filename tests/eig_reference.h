@@ -0,0 +1,14 @@
+#ifndef _EIG_REFERENCE_H
+#define _EIG_REFERENCE_H
+
+#include <complex>
+
+// ---------- eig_reference.cpp ----------
+
+// eigenvalues of the dense Hermitian n x n matrix A (column major), in ascending order
+void hermitian_eigenvalues(double *evals, const std::complex<double> *A, int n);
+
+// eigenvalues of the dense n x n matrix A (column major), in ascending order of magnitude
+void eigenvalues(std::complex<double> *evals, const std::complex<double> *A, int n);
+
+#endif // _EIG_REFERENCE_H
@@ -0,0 +1,345 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <sys/time.h>
+#include <algorithm>
+
+#include <util_quda.h>
+#include <test_util.h>
+#include "misc.h"
+
+#include <native_io.h>
+#include <qio_field.h>
+
+// In a typical application, quda.h is the only QUDA header required.
+#include <quda.h>
+
+extern int xdim;
+extern int ydim;
+extern int zdim;
+extern int tdim;
+extern int gridsize_from_cmdline[];
+extern QudaPrecision prec;
+extern char latfile[];
+extern int niter;
+extern bool verify_results;
+
+extern void usage(char**);
+
+static const char synthetic_file[] = "gauge_io_benchmark.nersc";
+static const char ildg_file[] = "gauge_io_benchmark.lime";
+static const char spinor_file[] = "gauge_io_benchmark_spinor.lime";
+static const char checkpoint_file[] = "gauge_io_benchmark.ckp";
+static const char store_file[] = "gauge_io_benchmark.vst";
+static const char compact_file[] = "gauge_io_benchmark_spinor.qvec";
+
+static double wall_time() {
+  timeval t;
+  gettimeofday(&t, NULL);
+  return t.tv_sec + 1e-6*t.tv_usec;
+}
+
+// deterministic pseudo-random element of the synthetic gauge field
+static double synthetic_value(uint64_t global_site, int mu, int j) {
+  uint64_t z = (global_site*4 + mu)*gaugeSiteSize + j + 0x9e3779b97f4a7c15ull;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  z = z ^ (z >> 31);
+  return 2.0 * (z >> 11) * (1.0 / 9007199254740992.0) - 1.0;
+}
+
+static bool host_big_endian() {
+  const uint16_t one = 1;
+  return *reinterpret_cast<const uint8_t*>(&one) == 0;
+}
+
+// rank 0 writes a synthetic 4D_SU3_GAUGE_3x3 IEEE64BIG NERSC file
+static void write_synthetic_file(const int *L) {
+  const size_t slice = (size_t)L[0]*L[1]*L[2];
+  const size_t site_reals = 4*gaugeSiteSize;
+
+  // first pass computes the checksum and link trace for the header
+  uint32_t checksum = 0;
+  double trace = 0.0;
+  for (size_t g=0; g<slice*L[3]; g++) {
+    for (int mu=0; mu<4; mu++) {
+      for (int j=0; j<gaugeSiteSize; j++) {
+	double v = synthetic_value(g, mu, j);
+	uint32_t w[2];
+	memcpy(w, &v, sizeof(v));
+	checksum += w[0] + w[1];
+	if (j == 0 || j == 8 || j == 16) trace += v;
+      }
+    }
+  }
+  trace /= 3.0 * 4.0 * slice * L[3];
+
+  FILE *fp = fopen(synthetic_file, "wb");
+  if (!fp) errorQuda("Failed to open %s", synthetic_file);
+  fprintf(fp, "BEGIN_HEADER\nHDR_VERSION = 1.0\nDATATYPE = 4D_SU3_GAUGE_3x3\n");
+  for (int d=0; d<4; d++) fprintf(fp, "DIMENSION_%d = %d\n", d+1, L[d]);
+  fprintf(fp, "LINK_TRACE = %.16e\nCHECKSUM = %x\nFLOATING_POINT = IEEE64BIG\nEND_HEADER\n", trace, checksum);
+
+  double *buf = (double*)malloc(slice*site_reals*sizeof(double));
+  for (int t=0; t<L[3]; t++) {
+    for (size_t s=0; s<slice; s++) {
+      for (int mu=0; mu<4; mu++) {
+	for (int j=0; j<gaugeSiteSize; j++) {
+	  double v = synthetic_value(t*slice + s, mu, j);
+	  if (!host_big_endian()) {
+	    uint64_t w;
+	    memcpy(&w, &v, sizeof(v));
+	    w = __builtin_bswap64(w);
+	    memcpy(&v, &w, sizeof(v));
+	  }
+	  buf[(s*4 + mu)*gaugeSiteSize + j] = v;
+	}
+      }
+    }
+    if (fwrite(buf, sizeof(double), slice*site_reals, fp) != slice*site_reals)
+      errorQuda("Failed to write %s", synthetic_file);
+  }
+  free(buf);
+  fclose(fp);
+}
+
+template <typename Float>
+static double verify_synthetic(void **gauge, const int *X, const int *L) {
+  const int Vh = V/2;
+  double max_dev = 0.0;
+  for (int l=0; l<V; l++) {
+    int x[4];
+    int r = l;
+    for (int d=0; d<4; d++) { x[d] = r % X[d] + commCoords(d)*X[d]; r /= X[d]; }
+    const int parity = (x[0] + x[1] + x[2] + x[3]) & 1;
+    const uint64_t g = (((uint64_t)x[3]*L[2] + x[2])*L[1] + x[1])*L[0] + x[0];
+    for (int mu=0; mu<4; mu++) {
+      const Float *u = static_cast<Float*>(gauge[mu]) + (parity*Vh + l/2)*gaugeSiteSize;
+      for (int j=0; j<gaugeSiteSize; j++) max_dev = std::max(max_dev, fabs(u[j] - synthetic_value(g, mu, j)));
+    }
+  }
+  reduceMaxDouble(max_dev);
+  return max_dev;
+}
+
+// maximum deviation of the components of b from a, relative to the
+// largest component of the site and field, as quantized by the compact format
+template <typename Float>
+static double compare_compact(void **a, void **b, int n, int site_len) {
+  double max_dev = 0.0;
+  for (int i=0; i<n; i++) {
+    const Float *u = static_cast<Float*>(a[i]);
+    const Float *v = static_cast<Float*>(b[i]);
+    for (int l=0; l<V; l++) {
+      double norm = 0.0;
+      for (int j=0; j<site_len; j++) norm = std::max(norm, (double)fabs(u[l*site_len + j]));
+      for (int j=0; j<site_len; j++)
+	if (norm > 0.0) max_dev = std::max(max_dev, fabs(u[l*site_len + j] - v[l*site_len + j]) / norm);
+    }
+  }
+  reduceMaxDouble(max_dev);
+  return max_dev;
+}
+
+// number of entries that differ between two host fields
+static double compare_fields(void **a, void **b, int n, size_t bytes) {
+  double diff = 0;
+  for (int i=0; i<n; i++)
+    for (size_t j=0; j<bytes; j++) diff += static_cast<char*>(a[i])[j] != static_cast<char*>(b[i])[j];
+  reduceDouble(diff);
+  return diff;
+}
+
+int main(int argc, char **argv)
+{
+  for (int i = 1; i < argc; i++){
+    if(process_command_line_option(argc, argv, &i) == 0){
+      continue;
+    }
+    printf("ERROR: Invalid option:%s\n", argv[i]);
+    usage(argv);
+  }
+
+  // initialize QMP/MPI, QUDA comms grid and RNG (test_util.cpp)
+  initComms(argc, argv, gridsize_from_cmdline);
+
+  if (prec != QUDA_DOUBLE_PRECISION && prec != QUDA_SINGLE_PRECISION) prec = QUDA_DOUBLE_PRECISION;
+
+  int X[4] = { xdim, ydim, zdim, tdim };
+  int L[4];
+  for (int d=0; d<4; d++) L[d] = X[d]*commDim(d);
+  setDims(X);
+
+  const char *filename = strcmp(latfile, "") ? latfile : synthetic_file;
+  if (!strcmp(latfile, "")) {
+    printfQuda("Writing synthetic %dx%dx%dx%d NERSC file %s\n", L[0], L[1], L[2], L[3], filename);
+    if (comm_rank() == 0) write_synthetic_file(L);
+    comm_barrier();
+  }
+
+  void *gauge[4];
+  for (int dir = 0; dir < 4; dir++) gauge[dir] = malloc((size_t)V*gaugeSiteSize*prec);
+
+  // warm up and verify the checksum once
+  read_gauge_field_native(filename, gauge, prec, X, QUDA_QDP_GAUGE_ORDER);
+
+  QudaVerbosity verbosity = getVerbosity();
+  setVerbosity(QUDA_SILENT);
+  comm_barrier();
+  double time = -wall_time();
+  for (int i=0; i<niter; i++) read_gauge_field_native(filename, gauge, prec, X, QUDA_QDP_GAUGE_ORDER);
+  comm_barrier();
+  time += wall_time();
+  setVerbosity(verbosity);
+
+  // bytes are counted in the host precision delivered to the application
+  const double gbytes = (double)V*4*gaugeSiteSize*prec*1e-9;
+  double rate_min = gbytes*niter/time, rate_max = rate_min, rate_sum = rate_min;
+  comm_allreduce_min(&rate_min);
+  comm_allreduce_max(&rate_max);
+  comm_allreduce(&rate_sum);
+
+  printfQuda("%d reads of %s in %g secs\n", niter, filename, time);
+  printfQuda("GB/s per rank: min = %g, avg = %g, max = %g; aggregate = %g GB/s\n",
+	     rate_min, rate_sum / comm_size(), rate_max, rate_sum);
+
+  int fail = 0;
+  bool restored = false;
+  if (verify_results && !strcmp(latfile, "")) {
+    double dev = prec == QUDA_DOUBLE_PRECISION ? verify_synthetic<double>(gauge, X, L) : verify_synthetic<float>(gauge, X, L);
+    const double tol = prec == QUDA_DOUBLE_PRECISION ? 1e-15 : 1e-7;
+    printfQuda("Maximum deviation from the synthetic field = %e (%s)\n", dev, dev < tol ? "PASSED" : "FAILED");
+    fail = dev < tol ? 0 : 1;
+  }
+
+  // write the field back out in both formats and read it again
+  void *gauge_check[4];
+  for (int dir = 0; dir < 4; dir++) gauge_check[dir] = malloc((size_t)V*gaugeSiteSize*prec);
+  const size_t gauge_bytes = (size_t)V*gaugeSiteSize*prec;
+
+  write_gauge_field_native(ildg_file, gauge, prec, X, QUDA_QDP_GAUGE_ORDER, NATIVE_ILDG_FORMAT);
+  read_gauge_field_native(ildg_file, gauge_check, prec, X, QUDA_QDP_GAUGE_ORDER);
+  double diff = compare_fields(gauge, gauge_check, 4, gauge_bytes);
+  printfQuda("ILDG native write/read round trip: %g differing bytes (%s)\n", diff, diff == 0 ? "PASSED" : "FAILED");
+  if (diff != 0) fail = 1;
+
+#ifdef HAVE_QIO
+  // the native writer must produce files that QIO can read
+  read_gauge_field(ildg_file, gauge_check, prec, X, argc, argv);
+  diff = compare_fields(gauge, gauge_check, 4, gauge_bytes);
+  printfQuda("ILDG native write/QIO read round trip: %g differing bytes (%s)\n", diff, diff == 0 ? "PASSED" : "FAILED");
+  if (diff != 0) fail = 1;
+
+  const int nSpin = 4, nColor = 3, Nvec = 2;
+  const size_t spinor_bytes = (size_t)V*2*nSpin*nColor*prec;
+  void *spinor[Nvec], *spinor_check[Nvec];
+  for (int i=0; i<Nvec; i++) {
+    spinor[i] = malloc(spinor_bytes);
+    spinor_check[i] = malloc(spinor_bytes);
+    for (size_t j=0; j<spinor_bytes/prec; j++) {
+      if (prec == QUDA_DOUBLE_PRECISION) static_cast<double*>(spinor[i])[j] = rand() / (double)RAND_MAX;
+      else static_cast<float*>(spinor[i])[j] = rand() / (float)RAND_MAX;
+    }
+  }
+  write_spinor_field_native(spinor_file, spinor, prec, X, nColor, nSpin, Nvec);
+  read_spinor_field(spinor_file, spinor_check, prec, X, nColor, nSpin, Nvec, argc, argv);
+  diff = compare_fields(spinor, spinor_check, Nvec, spinor_bytes);
+  printfQuda("Spinor native write/QIO read round trip: %g differing bytes (%s)\n", diff, diff == 0 ? "PASSED" : "FAILED");
+  if (diff != 0) fail = 1;
+  for (int i=0; i<Nvec; i++) {
+    free(spinor[i]);
+    free(spinor_check[i]);
+  }
+  if (comm_rank() == 0) remove(spinor_file);
+#endif
+
+  write_gauge_field_native(synthetic_file, gauge, prec, X, QUDA_QDP_GAUGE_ORDER, NATIVE_NERSC_FORMAT);
+  read_gauge_field_native(synthetic_file, gauge_check, prec, X, QUDA_QDP_GAUGE_ORDER);
+  diff = compare_fields(gauge, gauge_check, 4, gauge_bytes);
+  printfQuda("NERSC native write/read round trip: %g differing bytes (%s)\n", diff, diff == 0 ? "PASSED" : "FAILED");
+  if (diff != 0) fail = 1;
+
+  // compact vector round trip, which is lossy: each component is
+  // quantized to 16 bits relative to the largest component of its site
+  {
+    const int nSpin = 4, nColor = 3, Nvec = 2;
+    const int site_len = 2*nSpin*nColor;
+    const size_t spinor_bytes = (size_t)V*site_len*prec;
+    void *spinor[Nvec], *spinor_check[Nvec];
+    for (int i=0; i<Nvec; i++) {
+      spinor[i] = malloc(spinor_bytes);
+      spinor_check[i] = malloc(spinor_bytes);
+      for (size_t j=0; j<spinor_bytes/prec; j++) {
+	if (prec == QUDA_DOUBLE_PRECISION) static_cast<double*>(spinor[i])[j] = 2.0 * rand() / (double)RAND_MAX - 1.0;
+	else static_cast<float*>(spinor[i])[j] = 2.0f * rand() / (float)RAND_MAX - 1.0f;
+      }
+    }
+    write_spinor_field_compact(compact_file, spinor, prec, X, nColor, nSpin, Nvec);
+    restored = is_compact_spinor_file(compact_file) && !is_compact_spinor_file(synthetic_file);
+    read_spinor_field_compact(compact_file, spinor_check, prec, X, nColor, nSpin, Nvec);
+    double dev = prec == QUDA_DOUBLE_PRECISION ? compare_compact<double>(spinor, spinor_check, Nvec, site_len) :
+      compare_compact<float>(spinor, spinor_check, Nvec, site_len);
+    // half a quantization step, plus the rounding of the float norm
+    const double tol = 0.5 / 32767.0 + 1e-6;
+    printfQuda("Compact spinor write/read round trip: maximum relative deviation %e (%s)\n", dev,
+	       restored && dev <= tol ? "PASSED" : "FAILED");
+    if (!restored || dev > tol) fail = 1;
+    for (int i=0; i<Nvec; i++) {
+      free(spinor[i]);
+      free(spinor_check[i]);
+    }
+    if (comm_rank() == 0) remove(compact_file);
+  }
+
+  // checkpoint round trip, restoring the record in a second stage
+  const uint64_t key = 0x9e3779b97f4a7c15ull;
+  NativeRecord record = { gauge, 4, gaugeSiteSize, prec, X };
+  write_checkpoint_native(checkpoint_file, key, &record, 1);
+  restored = is_checkpoint_native(checkpoint_file, key) && !is_checkpoint_native(checkpoint_file, ~key);
+  record.V = gauge_check;
+  restored = restored && read_checkpoint_native(checkpoint_file, key, &record, 1);
+  diff = compare_fields(gauge, gauge_check, 4, gauge_bytes);
+  printfQuda("Checkpoint write/read round trip: %g differing bytes (%s)\n", diff, restored && diff == 0 ? "PASSED" : "FAILED");
+  if (!restored || diff != 0) fail = 1;
+
+  // vector store round trip, appending the directions in two commits
+  // and reading them back through the mapping
+  const int meta = 4;
+  NativeVectorStore *store = create_vector_store(store_file, key, gauge_bytes, 4, sizeof(meta));
+  for (int dir = 0; dir < 2; dir++) vector_store_write(store, dir, gauge[dir]);
+  vector_store_commit(store, 2, &meta);
+  for (int dir = 2; dir < 4; dir++) vector_store_write(store, dir, gauge[dir]);
+  vector_store_commit(store, 4, &meta);
+  close_vector_store(store);
+
+  store = open_vector_store(store_file, key, gauge_bytes, 4, sizeof(meta), false);
+  restored = store && vector_store_size(store) == 4 && !open_vector_store(store_file, ~key, gauge_bytes, 4, sizeof(meta), false);
+  if (store) {
+    int meta_check = 0;
+    vector_store_read_meta(store, &meta_check);
+    restored = restored && meta_check == meta;
+    for (int dir = 0; dir < 4; dir++) memcpy(gauge_check[dir], vector_store_vector(store, dir), gauge_bytes);
+    close_vector_store(store);
+  }
+  diff = compare_fields(gauge, gauge_check, 4, gauge_bytes);
+  printfQuda("Vector store write/read round trip: %g differing bytes (%s)\n", diff, restored && diff == 0 ? "PASSED" : "FAILED");
+  if (!restored || diff != 0) fail = 1;
+
+  if (comm_rank() == 0) {
+    remove(store_file);
+    remove(checkpoint_file);
+    remove(ildg_file);
+    remove(synthetic_file);
+  }
+
+  for (int dir = 0; dir < 4; dir++) {
+    free(gauge[dir]);
+    free(gauge_check[dir]);
+  }
+
+  finalizeComms();
+
+  return fail;
+}
@@ -42,6 +42,7 @@ extern QudaPrecision prec;
 extern QudaPrecision  prec_sloppy;
 extern QudaPrecision  prec_precondition;
 extern QudaPrecision  prec_refinement_sloppy;
+extern QudaPrecision  prec_adaptive;
 extern QudaReconstructType link_recon;
 extern QudaReconstructType link_recon_sloppy;
 extern QudaReconstructType link_recon_precondition;
@@ -65,6 +66,10 @@ extern bool compute_clover;
 extern int Nsrc; // number of spinors to apply to simultaneously
 extern int niter; // max solver iterations
 extern int gcrNkrylov; // number of inner iterations for GCR, or l for BiCGstab-l
+extern QudaCABasis ca_basis; // basis for CA-CG
+extern double ca_lambda_min; // lower bound on the spectrum for the Chebyshev basis
+extern double ca_lambda_max; // upper bound on the spectrum for the Chebyshev basis
+extern int nev; // dimension of the recycled subspace for GCRO-DR
 extern int pipeline; // length of pipeline for fused operations in GCR or BiCGstab-l
 extern int solution_accumulator_pipeline; // length of pipeline for fused solution update from the direction vectors
 extern char latfile[];
@@ -204,7 +209,8 @@ int main(int argc, char **argv)
 
   inv_param.inv_type = inv_type;
   if (multishift) {
-    inv_param.solution_type = QUDA_MATPCDAG_MATPC_SOLUTION;
+    // multi-shift BiCGstab solves the shifted MATPC systems directly
+    inv_param.solution_type = inv_type == QUDA_BICGSTAB_INVERTER ? QUDA_MATPC_SOLUTION : QUDA_MATPCDAG_MATPC_SOLUTION;
   } else if (dslash_type == QUDA_TWISTED_MASS_DSLASH || dslash_type == QUDA_TWISTED_CLOVER_DSLASH ||
 	     dslash_type == QUDA_DOMAIN_WALL_DSLASH  || dslash_type == QUDA_DOMAIN_WALL_4D_DSLASH ||
 	     dslash_type == QUDA_MOBIUS_DWF_DSLASH) {
@@ -221,13 +227,16 @@ int main(int argc, char **argv)
   inv_param.mass_normalization = normalization;
   inv_param.solver_normalization = QUDA_DEFAULT_NORMALIZATION;
 
-  if (dslash_type == QUDA_DOMAIN_WALL_DSLASH || 
+  if (multishift && inv_type == QUDA_BICGSTAB_INVERTER) {
+    inv_param.solve_type = QUDA_DIRECT_PC_SOLVE;
+  } else if (dslash_type == QUDA_DOMAIN_WALL_DSLASH || 
       dslash_type == QUDA_DOMAIN_WALL_4D_DSLASH ||
       dslash_type == QUDA_MOBIUS_DWF_DSLASH ||
       dslash_type == QUDA_TWISTED_MASS_DSLASH || 
       dslash_type == QUDA_TWISTED_CLOVER_DSLASH || 
       multishift || inv_type == QUDA_CG_INVERTER ||
-      inv_type == QUDA_CG3_INVERTER || inv_type == QUDA_CA_CG_INVERTER) {
+      inv_type == QUDA_CG3_INVERTER || inv_type == QUDA_CA_CG_INVERTER ||
+      inv_type == QUDA_PIPELINED_CG_INVERTER) {
     inv_param.solve_type = QUDA_NORMOP_PC_SOLVE;
   } else {
     inv_param.solve_type = QUDA_DIRECT_PC_SOLVE;
@@ -238,6 +247,10 @@ int main(int argc, char **argv)
 
   inv_param.Nsteps = 2;
   inv_param.gcrNkrylov = gcrNkrylov;
+  inv_param.nev = nev;
+  inv_param.ca_basis = ca_basis;
+  inv_param.ca_lambda_min = ca_lambda_min;
+  inv_param.ca_lambda_max = ca_lambda_max;
   inv_param.tol = tol;
   inv_param.tol_restart = 1e-3; //now theoretical background for this parameter... 
   if(tol_hq == 0 && tol == 0){
@@ -278,6 +291,7 @@ int main(int argc, char **argv)
   inv_param.cuda_prec = cuda_prec;
   inv_param.cuda_prec_sloppy = cuda_prec_sloppy;
   inv_param.cuda_prec_refinement_sloppy = cuda_prec_refinement_sloppy;
+  inv_param.cuda_prec_adaptive = prec_adaptive;
   inv_param.preserve_source = QUDA_PRESERVE_SOURCE_YES;
   inv_param.gamma_basis = QUDA_DEGRAND_ROSSI_GAMMA_BASIS;
   inv_param.dirac_order = QUDA_DIRAC_ORDER;
@@ -473,6 +487,9 @@ int main(int argc, char **argv)
         exit(-1);
       }
 
+      // multi-shift BiCGstab solves M + offset rather than M^dag M + offset
+      if (inv_type == QUDA_BICGSTAB_INVERTER) memcpy(spinorCheck, spinorTmp, Vh*spinorSiteSize*sSize*inv_param.Ls);
+
       axpy(inv_param.offset[i], spinorOutMulti[i], spinorCheck, Vh*spinorSiteSize, inv_param.cpu_prec);
       mxpy(spinorIn, spinorCheck, Vh*spinorSiteSize, inv_param.cpu_prec);
       double nrm2 = norm_2(spinorCheck, Vh*spinorSiteSize, inv_param.cpu_prec);
@@ -229,7 +229,7 @@ int main(int argc, char **argv)
       dslash_type == QUDA_MOBIUS_DWF_DSLASH ||
       dslash_type == QUDA_TWISTED_MASS_DSLASH ||
       dslash_type == QUDA_TWISTED_CLOVER_DSLASH ||
-      multishift || inv_type == QUDA_CG_INVERTER) {
+      multishift || inv_type == QUDA_CG_INVERTER || inv_type == QUDA_MSRC_CG_INVERTER) {
     inv_param.solve_type = QUDA_NORMOP_PC_SOLVE;
   } else {
     inv_param.solve_type = QUDA_DIRECT_PC_SOLVE;
@@ -1124,6 +1124,23 @@ get_schwarz_type(char* s)
   return ret;
 }
 
+QudaCABasis
+get_ca_basis_type(char* s)
+{
+  QudaCABasis ret = QUDA_INVALID_BASIS;
+
+  if (strcmp(s, "power") == 0) {
+    ret = QUDA_POWER_BASIS;
+  } else if (strcmp(s, "chebyshev") == 0 || strcmp(s, "cheby") == 0) {
+    ret = QUDA_CHEBYSHEV_BASIS;
+  } else {
+    fprintf(stderr, "Error: invalid CA basis type %s\n", s);
+    exit(1);
+  }
+
+  return ret;
+}
+
 QudaTwistFlavorType
 get_flavor_type(char* s)
 {
@@ -1222,6 +1239,16 @@ get_solver_type(char* s)
     ret = QUDA_CA_CG_INVERTER;
   } else if (strcmp(s, "ca-gcr") == 0){
     ret = QUDA_CA_GCR_INVERTER;
+  } else if (strcmp(s, "msrc-cg") == 0){
+    ret = QUDA_MSRC_CG_INVERTER;
+  } else if (strcmp(s, "pipe-cg") == 0){
+    ret = QUDA_PIPELINED_CG_INVERTER;
+  } else if (strcmp(s, "gcrodr") == 0){
+    ret = QUDA_GCRODR_INVERTER;
+  } else if (strcmp(s, "gmres-poly") == 0){
+    ret = QUDA_GMRES_POLYNOMIAL_INVERTER;
+  } else if (strcmp(s, "chebyshev") == 0){
+    ret = QUDA_CHEBYSHEV_INVERTER;
   } else {
     fprintf(stderr, "Error: invalid solver type %s\n", s);
     exit(1);
@@ -1305,6 +1332,21 @@ get_solver_str(QudaInverterType type)
   case QUDA_CA_GCR_INVERTER:
     ret = "ca-gcr";
     break;
+  case QUDA_MSRC_CG_INVERTER:
+    ret = "msrc-cg";
+    break;
+  case QUDA_PIPELINED_CG_INVERTER:
+    ret = "pipe-cg";
+    break;
+  case QUDA_GCRODR_INVERTER:
+    ret = "gcrodr";
+    break;
+  case QUDA_GMRES_POLYNOMIAL_INVERTER:
+    ret = "gmres-poly";
+    break;
+  case QUDA_CHEBYSHEV_INVERTER:
+    ret = "chebyshev";
+    break;
   default:
     ret = "unknown";
     errorQuda("Error: invalid solver type %d\n", type);
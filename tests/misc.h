@@ -37,6 +37,8 @@ extern "C" {
 
   QudaSchwarzType get_schwarz_type(char* s);
 
+  QudaCABasis get_ca_basis_type(char* s);
+
   QudaTwistFlavorType get_flavor_type(char* s);
 
   int get_rank_order(char* s);
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/time.h>
 
 #include <quda_internal.h>
 #include <color_spinor_field.h>
@@ -11,6 +12,11 @@
 // include because of nasty globals used in the tests
 #include <dslash_util.h>
 #include <dirac_quda.h>
+#include <invert_quda.h>
+#include <lanczos_quda.h>
+#include <krylov_schur_quda.h>
+
+#include <eig_reference.h>
 
 #define MAX(a,b) ((a)>(b)?(a):(b))
 
@@ -24,6 +30,7 @@ extern int zdim;
 extern int tdim;
 extern int gridsize_from_cmdline[];
 extern int niter;
+extern int gcrNkrylov; // number of powers for the matrix-powers test
 
 extern int Nsrc; // number of spinors to apply to simultaneously
 
@@ -41,6 +48,9 @@ using namespace quda;
 
 ColorSpinorField *xH, *yH;
 ColorSpinorField *xD, *yD;
+std::vector<ColorSpinorField*> powH, refH; // host fields for the matrix-powers test
+std::vector<ColorSpinorField*> batchInH, batchOutH, batchRefH; // host fields for the multi-RHS test
+int nBatch; // number of right-hand sides applied at once in the multi-RHS test
 
 cpuGaugeField *Y_h, *X_h, *Xinv_h, *Yhat_h;
 cudaGaugeField *Y_d, *X_d, *Xinv_d, *Yhat_d;
@@ -91,6 +101,26 @@ void initFields(QudaPrecision prec)
   xH = new cpuColorSpinorField(param);
   yH = new cpuColorSpinorField(param);
 
+  if (test_type == 3) {
+    for (int k=0; k<gcrNkrylov; k++) {
+      powH.push_back(new cpuColorSpinorField(param));
+      refH.push_back(new cpuColorSpinorField(param));
+    }
+  }
+
+  if (test_type == 4 || test_type == 5 || test_type >= 7) {
+    // the batch is made of single right-hand-side fields
+    ColorSpinorParam batchParam(param);
+    batchParam.nDim = 4;
+    batchParam.x[4] = 1;
+    for (int k=0; k<Nsrc; k++) {
+      batchInH.push_back(new cpuColorSpinorField(batchParam));
+      batchOutH.push_back(new cpuColorSpinorField(batchParam));
+      batchRefH.push_back(new cpuColorSpinorField(batchParam));
+      static_cast<cpuColorSpinorField*>(batchInH[k])->Source(QUDA_RANDOM_SOURCE, k, 0, 0);
+    }
+  }
+
   //static_cast<cpuColorSpinorField*>(xH)->Source(QUDA_RANDOM_SOURCE, 0, 0, 0);
   //static_cast<cpuColorSpinorField*>(yH)->Source(QUDA_RANDOM_SOURCE, 0, 0, 0);
 
@@ -175,6 +205,18 @@ void freeFields()
   delete xH;
   delete yH;
 
+  for (auto p : powH) delete p;
+  for (auto p : refH) delete p;
+  powH.clear();
+  refH.clear();
+
+  for (auto p : batchInH) delete p;
+  for (auto p : batchOutH) delete p;
+  for (auto p : batchRefH) delete p;
+  batchInH.clear();
+  batchOutH.clear();
+  batchRefH.clear();
+
   delete Y_h;
   delete X_h;
   delete Xinv_h;
@@ -186,6 +228,52 @@ void freeFields()
   delete Yhat_d;
 }
 
+// fill a host coarse field with random numbers of magnitude up to scale
+void randomize(cpuGaugeField &U, double scale)
+{
+  const int n = U.Ncolor();
+  for (int d=0; d<U.Geometry(); d++) {
+    for (int i=0; i<2*U.Volume()*n*n; i++) {
+      double r = scale * (2.0 * rand() / RAND_MAX - 1.0);
+      if (U.Precision() == QUDA_DOUBLE_PRECISION) static_cast<double**>(U.Gauge_p())[d][i] = r;
+      else static_cast<float**>(U.Gauge_p())[d][i] = r;
+    }
+  }
+}
+
+// add a to the diagonal of the host coarse field U
+void shiftDiagonal(cpuGaugeField &U, double a)
+{
+  const int n = U.Ncolor();
+  for (int x=0; x<U.Volume(); x++) {
+    for (int i=0; i<n; i++) {
+      if (U.Precision() == QUDA_DOUBLE_PRECISION) static_cast<double**>(U.Gauge_p())[0][2*((x*n + i)*n + i)] += a;
+      else static_cast<float**>(U.Gauge_p())[0][2*((x*n + i)*n + i)] += a;
+    }
+  }
+}
+
+// dense matrix of the operator on host fields, built column by column
+// by applying it to every unit vector
+void denseMatrix(std::complex<double> *A, DiracMatrix &mat, ColorSpinorField &e, ColorSpinorField &Ae)
+{
+  const int n = e.Volume() * e.Nspin() * e.Ncolor();
+  std::complex<double> *e_ = static_cast<std::complex<double>*>(e.V());
+  std::complex<double> *Ae_ = static_cast<std::complex<double>*>(Ae.V());
+  for (int j=0; j<n; j++) {
+    for (int i=0; i<n; i++) e_[i] = 0.0;
+    e_[j] = 1.0;
+    mat(Ae, e);
+    for (int i=0; i<n; i++) A[static_cast<size_t>(j)*n + i] = Ae_[i];
+  }
+}
+
+static double wall_time() {
+  timeval t;
+  gettimeofday(&t, NULL);
+  return t.tv_sec + 1e-6*t.tv_usec;
+}
+
 DiracCoarse *dirac;
 
 double benchmark(int test, const int niter) {
@@ -205,6 +293,23 @@ double benchmark(int test, const int niter) {
   case 2:
     for (int i=0; i < niter; ++i) dirac->Clover(xD->Even(), yD->Even(), QUDA_EVEN_PARITY);
     break;
+  case 3:
+    for (int i=0; i < niter; ++i) dirac->MPowers(powH, *yH);
+    break;
+  case 4:
+    {
+      std::vector<ColorSpinorField*> in(batchInH.begin(), batchInH.begin() + nBatch);
+      std::vector<ColorSpinorField*> out(batchOutH.begin(), batchOutH.begin() + nBatch);
+      for (int i=0; i < niter; ++i) dirac->M(out, in);
+    }
+    break;
+  case 6: // reference for test 4: the batch applied one field at a time
+    {
+      std::vector<ColorSpinorField*> in(batchInH.begin(), batchInH.begin() + nBatch);
+      std::vector<ColorSpinorField*> out(batchRefH.begin(), batchRefH.begin() + nBatch);
+      for (int i=0; i < niter; ++i) dirac->Dirac::M(out, in);
+    }
+    break;
   default:
     errorQuda("Undefined test %d", test);
   }
@@ -224,9 +329,300 @@ double benchmark(int test, const int niter) {
 const char *names[] = {
   "Dslash",
   "Mat",
-  "Clover"
+  "Clover",
+  "MatPowers (host)",
+  "MatBatch (host)",
+  "MultiSrcCG (host)",
+  "MatBatch (host, one at a time)",
+  "Chrono forecast",
+  "Lanczos",
+  "Krylov-Schur"
 };
 
+/**
+   Solve M^dagger M x = b for the Nsrc sources of the batch with the
+   multi-source CG, which applies the host coarse operator to all
+   active sources at once, and compare against solving each source
+   with CG in turn.
+   @return Whether the solutions agree and have converged
+*/
+bool solveMultiSrc()
+{
+  if (Nsrc < 2 || Nsrc > QUDA_MAX_MULTI_SHIFT) errorQuda("Test 5 requires 2 <= nsrc <= %d", QUDA_MAX_MULTI_SHIFT);
+
+  QudaInvertParam inv_param = newQudaInvertParam();
+  SolverParam param(inv_param);
+  param.tol = 1e-10;
+  param.tol_hq = 0.0;
+  param.maxiter = 10000;
+  param.delta = 0.1;
+  param.use_alternative_reliable = false;
+  param.use_sloppy_partial_accumulator = false;
+  param.solution_accumulator_pipeline = 0;
+  param.max_res_increase = 1;
+  param.max_res_increase_total = 10;
+  param.heavy_quark_check = 10;
+  param.pipeline = 0;
+  param.residual_type = QUDA_L2_RELATIVE_RESIDUAL;
+  param.use_init_guess = QUDA_USE_INIT_GUESS_NO;
+  param.preserve_source = QUDA_PRESERVE_SOURCE_YES;
+  param.compute_true_res = true;
+  param.precision = QUDA_DOUBLE_PRECISION;
+  param.precision_sloppy = QUDA_DOUBLE_PRECISION;
+  param.precision_refinement_sloppy = QUDA_DOUBLE_PRECISION;
+  param.precision_precondition = QUDA_DOUBLE_PRECISION;
+  param.num_src = Nsrc;
+
+  DiracMdagM mdagm(*dirac);
+  TimeProfile profile("MultiSrcCG test");
+
+  double t = -wall_time();
+  param.iter = 0;
+  MultiSrcCG msrc(mdagm, mdagm, param, profile);
+  std::vector<ColorSpinorField*> x(batchOutH.begin(), batchOutH.end());
+  std::vector<ColorSpinorField*> b(batchInH.begin(), batchInH.end());
+  for (auto v : x) blas::zero(*v);
+  msrc.solve(x, b);
+  t += wall_time();
+  int iter_msrc = param.iter;
+  std::vector<double> true_res(param.true_res_offset, param.true_res_offset + Nsrc);
+
+  double t_ref = -wall_time();
+  param.iter = 0;
+  CG cg(mdagm, mdagm, param, profile);
+  for (int k=0; k<Nsrc; k++) {
+    blas::zero(*batchRefH[k]);
+    cg(*batchRefH[k], *batchInH[k]);
+  }
+  t_ref += wall_time();
+
+  printfQuda("Ncolor = %2d, %-31s: nRHS = %3d, %d sweeps in %g secs (one at a time %d iterations in %g secs)\n",
+	     Ncolor, names[5], Nsrc, iter_msrc, t, param.iter, t_ref);
+
+  // both solutions carry an error of order tol times the condition number
+  bool pass = true;
+  const double tol = 1e2 * param.tol;
+  for (int k=0; k<Nsrc; k++) {
+    double dev = sqrt(blas::xmyNorm(*batchRefH[k], *batchOutH[k]) / blas::norm2(*batchRefH[k]));
+    bool ok = true_res[k] < tol && dev < sqrt(tol);
+    printfQuda("Source %2d: true residual = %e, relative deviation from CG = %e (%s)\n",
+	       k, true_res[k], dev, ok ? "PASSED" : "FAILED");
+    pass = pass && ok;
+  }
+  return pass;
+}
+
+/**
+   Forecast the solution of M x = b, and of M^dagger M x = b, from a
+   history of Nsrc random vectors, with the compressed chronological
+   basis and with MinResExt.  Both minimize over the span of the
+   history (the residual for M, the M^dagger M-norm of the error for
+   M^dagger M), so their residuals must agree.  The basis is grown
+   with a forecast after every push, so that its projected matrix is
+   extended incrementally, and the final forecast is repeated with
+   the projected matrix recomputed from scratch.  With nsrc >= 3, the
+   time-reversible forecast is also checked against its recurrence.
+   @return Whether the forecasts agree with MinResExt
+*/
+bool chronoForecast()
+{
+  if (Nsrc < 2) errorQuda("Test 7 requires nsrc >= 2");
+
+  ColorSpinorParam param(*batchInH[0]);
+  param.create = QUDA_ZERO_FIELD_CREATE;
+  param.setPrecision(prec);
+  param.fieldOrder = QUDA_FLOAT2_FIELD_ORDER;
+
+  std::vector<ColorSpinorField*> hist, p, q;
+  for (int k=0; k<Nsrc; k++) {
+    hist.push_back(new cudaColorSpinorField(param));
+    p.push_back(new cudaColorSpinorField(param));
+    q.push_back(new cudaColorSpinorField(param));
+    *hist[k] = *batchInH[k];
+  }
+
+  static_cast<cpuColorSpinorField*>(batchOutH[0])->Source(QUDA_RANDOM_SOURCE, Nsrc, 0, 0);
+  cudaColorSpinorField b(param), r(param), x(param), tmp(param);
+  b = *batchOutH[0];
+  const double b2 = blas::norm2(b);
+
+  DiracM m(*dirac);
+  DiracMdagM mdagm(*dirac);
+  TimeProfile profile("Chrono test");
+
+  // relative residual |b - A x| / |b|
+  auto residual = [&](DiracMatrix &mat, ColorSpinorField &x) {
+    mat(r, x, tmp);
+    return sqrt(blas::xmyNorm(b, r) / b2);
+  };
+
+  const double tol = prec == QUDA_DOUBLE_PRECISION ? 1e-8 : 1e-3;
+  bool pass = true;
+  for (int hermitian=0; hermitian<2; hermitian++) {
+    DiracMatrix &mat = hermitian ? static_cast<DiracMatrix&>(mdagm) : static_cast<DiracMatrix&>(m);
+    const uint64_t key = 1;
+
+    for (int k=0; k<Nsrc; k++) blas::copy(*p[k], *hist[k]);
+    blas::copy(r, b);
+    MinResExt mre(mat, true, true, hermitian, profile);
+    mre(x, r, p, q);
+    const double res_mre = residual(mat, x);
+
+    ChronoBasis chrono;
+    for (int k=0; k<Nsrc; k++) {
+      chrono.push(*hist[k], Nsrc, false, prec, QUDA_CHRONO_MINRES_EXTRAPOLATION, mat, prec, hermitian, key);
+      chrono.forecast(x, b, mat, prec, QUDA_CHRONO_MINRES_EXTRAPOLATION, hermitian, key);
+    }
+    const double res_inc = residual(mat, x);
+    chrono.forecast(x, b, mat, prec, QUDA_CHRONO_MINRES_EXTRAPOLATION, hermitian, 0);
+    const double res_full = residual(mat, x);
+
+    bool ok = fabs(res_inc - res_mre) < tol * res_mre && fabs(res_full - res_mre) < tol * res_mre;
+    printfQuda("Ncolor = %2d, %-31s: %s, history %d, |res|/|src| = %e (MinResExt %e, recomputed %e) (%s)\n",
+	       Ncolor, names[7], hermitian ? "MdagM" : "M", Nsrc, res_inc, res_mre, res_full, ok ? "PASSED" : "FAILED");
+    pass = pass && ok;
+  }
+
+  // time-reversible extrapolation with chrono_max_dim = 3 keeps two
+  // auxiliary guesses, seeded with the first two solutions, and then
+  // propagates them by p_{n+1} = 2 x_n - p_{n-1}
+  if (Nsrc >= 3) {
+    ChronoBasis chrono;
+    double dev = 0.0;
+    for (int k=0; k<Nsrc; k++) {
+      chrono.push(*hist[k], 3, false, prec, QUDA_CHRONO_TIME_REVERSIBLE_EXTRAPOLATION, mdagm, prec, true, 0);
+      chrono.forecast(*q[k], b, mdagm, prec, QUDA_CHRONO_TIME_REVERSIBLE_EXTRAPOLATION, true, 0);
+      blas::copy(r, *hist[k]);
+      if (k >= 2) blas::axpby(-1.0, *q[k-2], 2.0, r);
+      const double r2 = blas::norm2(r);
+      const double dev_k = sqrt(blas::xmyNorm(*q[k], r) / r2);
+      dev = dev_k > dev ? dev_k : dev;
+    }
+    bool ok = dev < tol;
+    printfQuda("Ncolor = %2d, %-31s: time-reversible, history %d, max relative deviation = %e (%s)\n",
+	       Ncolor, names[7], Nsrc, dev, ok ? "PASSED" : "FAILED");
+    pass = pass && ok;
+  }
+
+  for (int k=0; k<Nsrc; k++) {
+    delete q[k];
+    delete p[k];
+    delete hist[k];
+  }
+  return pass;
+}
+
+/**
+   Compute the lowest eigenpairs of M^dagger M on the device with the
+   thick-restart Lanczos solver (QUDA_IMP_RST_LANCZOS), and compare
+   the eigenvalues against those of the dense matrix built on the
+   host.  Meant for small lattices.
+   @return Whether the eigenvalues agree and the residuals are converged
+*/
+bool lanczosEigenvalues()
+{
+  const int nk = 8;
+  const int m = 3*nk;
+  const double tol = prec == QUDA_DOUBLE_PRECISION ? 1e-10 : 1e-5;
+
+  DiracMdagM mdagm(*dirac);
+
+  ColorSpinorParam param(*batchInH[0]);
+  param.create = QUDA_ZERO_FIELD_CREATE;
+  cpuColorSpinorField e(param), Ae(param);
+  const int n = e.Volume() * e.Nspin() * e.Ncolor();
+  std::vector<std::complex<double> > A(static_cast<size_t>(n)*n);
+  denseMatrix(A.data(), mdagm, e, Ae);
+  std::vector<double> ref(n);
+  hermitian_eigenvalues(ref.data(), A.data(), n);
+
+  param.setPrecision(prec);
+  param.fieldOrder = QUDA_FLOAT2_FIELD_ORDER;
+  std::vector<ColorSpinorField*> V;
+  for (int i=0; i<m; i++) V.push_back(new cudaColorSpinorField(param));
+  cudaColorSpinorField r(param);
+  r = *batchInH[0];
+
+  QudaEigParam eig_param = newQudaEigParam();
+  eig_param.eig_type = QUDA_IMP_RST_LANCZOS;
+  eig_param.nk = nk;
+  eig_param.NPoly = 0;
+  eig_param.Stp_residual = tol;
+  eig_param.max_restarts = 1000;
+
+  TimeProfile profile("Lanczos test");
+  std::vector<double> evals(nk), residua(nk);
+  ImpRstLanczos lanczos(mdagm, eig_param, profile);
+  lanczos(V, r, evals.data(), residua.data());
+
+  bool pass = true;
+  for (int i=0; i<nk; i++) {
+    double dev = fabs(evals[i] - ref[i]) / ref[i];
+    bool ok = dev < 10 * tol && residua[i] < 10 * tol * ref[i];
+    printfQuda("Ncolor = %2d, %-31s: eigenvalue %d = %e (dense %e), relative deviation = %e, residual = %e (%s)\n",
+	       Ncolor, names[8], i, evals[i], ref[i], dev, residua[i], ok ? "PASSED" : "FAILED");
+    pass = pass && ok;
+  }
+
+  for (auto v : V) delete v;
+  return pass;
+}
+
+/**
+   Compute the eigenpairs of smallest magnitude of M on the device
+   with the block Krylov-Schur solver, as used by the verification of
+   the multigrid setup, and compare the eigenvalues against those of
+   the dense matrix built on the host.  Meant for small lattices.
+   @return Whether all eigenpairs converged to the eigenvalues of smallest magnitude
+*/
+bool krylovSchurEigenvalues()
+{
+  const int nev = 8;
+  const int block_size = 4;
+  const int ncv = 24;
+  const double tol = prec == QUDA_DOUBLE_PRECISION ? 1e-10 : 1e-5;
+
+  DiracM m(*dirac);
+
+  ColorSpinorParam param(*batchInH[0]);
+  param.create = QUDA_ZERO_FIELD_CREATE;
+  cpuColorSpinorField e(param), Ae(param);
+  const int n = e.Volume() * e.Nspin() * e.Ncolor();
+  std::vector<std::complex<double> > A(static_cast<size_t>(n)*n);
+  denseMatrix(A.data(), m, e, Ae);
+  std::vector<std::complex<double> > ref(n);
+  eigenvalues(ref.data(), A.data(), n);
+
+  param.setPrecision(prec);
+  param.fieldOrder = QUDA_FLOAT2_FIELD_ORDER;
+  std::vector<ColorSpinorField*> evecs;
+  for (int i=0; i<nev; i++) evecs.push_back(new cudaColorSpinorField(param));
+
+  TimeProfile profile("Krylov-Schur test");
+  std::vector<Complex> evals(nev);
+  std::vector<double> residua(nev);
+  BlockKrylovSchur eig(m, nev, ncv, block_size, tol, 1000, "SM", profile);
+  const int nconv = eig(evecs, evals.data(), residua.data());
+
+  // each eigenvalue must be one of the nev of smallest magnitude (up to ties)
+  bool pass = nconv == nev;
+  if (nconv < nev) printfQuda("Ncolor = %2d, %-31s: only %d of %d eigenpairs converged (FAILED)\n", Ncolor, names[9], nconv, nev);
+  for (int i=0; i<nconv; i++) {
+    int nearest = 0;
+    for (int j=1; j<n; j++) if (std::abs(ref[j] - evals[i]) < std::abs(ref[nearest] - evals[i])) nearest = j;
+    double dev = std::abs(ref[nearest] - evals[i]) / std::abs(ref[nearest]);
+    bool ok = dev < 1e2 * tol && std::abs(ref[nearest]) <= std::abs(ref[nev-1]) * (1 + 1e2 * tol) &&
+      residua[i] < 1e2 * tol * std::abs(evals[i]);
+    printfQuda("Ncolor = %2d, %-31s: eigenvalue %d = (%e, %e) (dense (%e, %e)), relative deviation = %e, residual = %e (%s)\n",
+	       Ncolor, names[9], i, evals[i].real(), evals[i].imag(), ref[nearest].real(), ref[nearest].imag(),
+	       dev, residua[i], ok ? "PASSED" : "FAILED");
+    pass = pass && ok;
+  }
+
+  for (auto v : evecs) delete v;
+  return pass;
+}
+
 int main(int argc, char** argv)
 {
   // Set some defaults that lets the benchmark fit in memory if you run it
@@ -252,15 +648,124 @@ int main(int argc, char** argv)
   Nspin = 2;
 
   printfQuda("\nBenchmarking %s precision with %d iterations...\n\n", get_prec_str(prec), niter);
+  int fail = 0;
   for (int c=24; c<=32; c+=8) {
     Ncolor = c;
 
     initFields(prec);
 
+    if (test_type == 3 || test_type == 4 || test_type == 5 || test_type >= 7) {
+      // the host kernels need nontrivial host fields
+      randomize(*Y_h, 1.0/(8*Nspin*Ncolor));
+      randomize(*X_h, 1.0/(Nspin*Ncolor));
+      // keep the solver test well conditioned
+      if (test_type == 5 || test_type == 9) shiftDiagonal(*X_h, 1.0);
+      Y_h->exchangeGhost(QUDA_LINK_BIDIRECTIONAL);
+      if (test_type >= 7) {
+	Y_d->copy(*Y_h);
+	X_d->copy(*X_h);
+      }
+      static_cast<cpuColorSpinorField*>(yH)->Source(QUDA_RANDOM_SOURCE, 0, 0, 0);
+    }
+
     DiracParam param;
     param.halo_precision = smoother_halo_prec;
     dirac = new DiracCoarse(param, Y_h, X_h, Xinv_h, Yhat_h, Y_d, X_d, Xinv_d, Yhat_d);
 
+    if (test_type == 4) {
+      // sweep the number of right-hand sides, comparing against applying the operator to each in turn
+      for (nBatch = 1; nBatch <= Nsrc; nBatch *= 2) {
+	benchmark(4, 1);
+	dirac->Flops();
+	double secs = benchmark(4, niter);
+	double gflops = (dirac->Flops()*1e-9)/(secs);
+
+	benchmark(6, 1);
+	dirac->Flops();
+	double secs_ref = benchmark(6, niter);
+	double gflops_ref = (dirac->Flops()*1e-9)/(secs_ref);
+
+	printfQuda("Ncolor = %2d, %-31s: nRHS = %3d, Gflop/s = %6.1f (one at a time %6.1f, speedup %.2f)\n",
+		   Ncolor, names[test_type], nBatch, gflops, gflops_ref, secs_ref/secs);
+
+	if (verify_results) {
+	  double dev2 = 0.0, ref2 = 0.0;
+	  for (int k=0; k<nBatch; k++) {
+	    ref2 += blas::norm2(*batchRefH[k]);
+	    dev2 += blas::xmyNorm(*batchOutH[k], *batchRefH[k]);
+	  }
+	  // the two paths differ only in summation order
+	  const double tol = Y_h->Precision() == QUDA_DOUBLE_PRECISION ? 1e-12 : 1e-5;
+	  double dev = sqrt(dev2/ref2);
+	  printfQuda("nRHS = %3d: relative deviation = %e (%s)\n", nBatch, dev, dev < tol ? "PASSED" : "FAILED");
+	  if (!(dev < tol)) fail = 1;
+	}
+      }
+
+      if (verify_results && Nsrc > 1) {
+	// a device batch is applied by the same multi-source kernel
+	Y_d->copy(*Y_h);
+	X_d->copy(*X_h);
+	ColorSpinorParam devParam(*batchInH[0]);
+	devParam.create = QUDA_ZERO_FIELD_CREATE;
+	devParam.setPrecision(prec);
+	devParam.fieldOrder = QUDA_FLOAT2_FIELD_ORDER;
+	std::vector<ColorSpinorField*> in_d, out_d;
+	for (int k=0; k<Nsrc; k++) {
+	  in_d.push_back(new cudaColorSpinorField(devParam));
+	  out_d.push_back(new cudaColorSpinorField(devParam));
+	  *in_d[k] = *batchInH[k];
+	}
+	dirac->M(out_d, in_d);
+	dirac->Dirac::M(batchRefH, batchInH);
+
+	double dev2 = 0.0, ref2 = 0.0;
+	for (int k=0; k<Nsrc; k++) {
+	  *batchOutH[k] = *out_d[k];
+	  ref2 += blas::norm2(*batchRefH[k]);
+	  dev2 += blas::xmyNorm(*batchOutH[k], *batchRefH[k]);
+	  delete out_d[k];
+	  delete in_d[k];
+	}
+	const double tol = Y_h->Precision() == QUDA_DOUBLE_PRECISION ? 1e-12 : 1e-5;
+	double dev = sqrt(dev2/ref2);
+	printfQuda("nRHS = %3d on the device: relative deviation = %e (%s)\n", Nsrc, dev, dev < tol ? "PASSED" : "FAILED");
+	if (!(dev < tol)) fail = 1;
+      }
+
+      delete dirac;
+      freeFields();
+      continue;
+    }
+
+    if (test_type == 5) {
+      if (!solveMultiSrc()) fail = 1;
+      delete dirac;
+      freeFields();
+      continue;
+    }
+
+    if (test_type == 7) {
+      if (!chronoForecast()) fail = 1;
+      delete dirac;
+      freeFields();
+      continue;
+    }
+
+    if (test_type == 8) {
+      if (!lanczosEigenvalues()) fail = 1;
+      delete dirac;
+      freeFields();
+      continue;
+    }
+
+    if (test_type == 9) {
+      if (!krylovSchurEigenvalues()) fail = 1;
+      delete dirac;
+      freeFields();
+      continue;
+    }
+
     // do the initial tune
     benchmark(test_type, 1);
 
@@ -272,7 +777,24 @@ int main(int argc, char** argv)
 
     printfQuda("Ncolor = %2d, %-31s: Gflop/s = %6.1f\n", Ncolor, names[test_type], gflops);
 
+    if (test_type == 3) {
+      if (verify_results) {
+	// compare against applying the operator in turn
+	dirac->Dirac::MPowers(refH, *yH);
+	// the two paths differ only in summation order
+	const double tol = Y_h->Precision() == QUDA_DOUBLE_PRECISION ? 1e-12 : 1e-5;
+	for (int k=0; k<gcrNkrylov; k++) {
+	  double ref2 = blas::norm2(*refH[k]);
+	  double dev = sqrt(blas::xmyNorm(*powH[k], *refH[k]) / ref2);
+	  printfQuda("Power %2d: relative deviation = %e (%s)\n", k+1, dev, dev < tol ? "PASSED" : "FAILED");
+	  if (!(dev < tol)) fail = 1;
+	}
+      }
+      setVerbosity(QUDA_VERBOSE); // report the halo messages saved
+    }
+
     delete dirac;
+    setVerbosity(QUDA_SUMMARIZE);
     freeFields();
   }
 
@@ -282,4 +804,6 @@ int main(int argc, char** argv)
   endQuda();
 
   finalizeComms();
+
+  return fail;
 }
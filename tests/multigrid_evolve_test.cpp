@@ -63,6 +63,7 @@ extern int niter;
 extern int gcrNkrylov; // number of inner iterations for GCR, or l for BiCGstab-l
 extern int pipeline; // length of pipeline for fused operations in GCR or BiCGstab-l
 extern int nvec[];
+extern bool adaptive_nvec[];
 extern int mg_levels;
 
 extern bool generate_nullspace;
@@ -85,6 +86,7 @@ extern int num_setup_iter[QUDA_MAX_MG_LEVEL];
 extern double setup_tol[QUDA_MAX_MG_LEVEL];
 extern int setup_maxiter[QUDA_MAX_MG_LEVEL];
 extern int setup_maxiter_refresh[QUDA_MAX_MG_LEVEL];
+extern double setup_refresh_tol[QUDA_MAX_MG_LEVEL];
 extern QudaSetupType setup_type;
 extern bool pre_orthonormalize;
 extern bool post_orthonormalize;
@@ -94,16 +96,23 @@ extern QudaInverterType smoother_type[QUDA_MAX_MG_LEVEL];
 extern double coarse_solver_tol[QUDA_MAX_MG_LEVEL];
 extern double smoother_tol[QUDA_MAX_MG_LEVEL];
 extern int coarse_solver_maxiter[QUDA_MAX_MG_LEVEL];
+extern int coarse_solver_deflate_nvec[QUDA_MAX_MG_LEVEL];
+extern int coarse_solver_agglomerate_volume[QUDA_MAX_MG_LEVEL];
 
 extern QudaPrecision smoother_halo_prec;
+extern QudaPrecision coarse_link_prec;
 extern QudaSchwarzType schwarz_type[QUDA_MAX_MG_LEVEL];
 extern int schwarz_cycle[QUDA_MAX_MG_LEVEL];
+extern int schwarz_overlap[QUDA_MAX_MG_LEVEL];
+extern int verify_n_evec[QUDA_MAX_MG_LEVEL];
 
 extern QudaMatPCType matpc_type;
 extern QudaSolveType solve_type;
 
 extern char vec_infile[];
 extern char vec_outfile[];
+extern bool vec_compact;
+extern char setup_checkpoint[];
 
 //Twisted mass flavor type
 extern QudaTwistFlavorType twist_flavor;
@@ -266,9 +275,13 @@ void setMultigridParam(QudaMultigridParam &mg_param) {
     mg_param.setup_tol[i] = setup_tol[i];
     mg_param.setup_maxiter[i] = setup_maxiter[i];
     mg_param.setup_maxiter_refresh[i] = setup_maxiter_refresh[i];
+    mg_param.setup_refresh_tol[i] = setup_refresh_tol[i];
     mg_param.n_vec[i] = nvec[i] == 0 ? 24 : nvec[i]; // default to 24 vectors if not set
+    mg_param.setup_adaptive_nvec[i] = adaptive_nvec[i] ? QUDA_BOOLEAN_YES : QUDA_BOOLEAN_NO; // n_vec is then the maximum
+    mg_param.verify_n_evec[i] = verify_n_evec[i]; // eigenvectors whose null-space overlap the verification reports
     mg_param.precision_null[i] = prec_null; // precision to store the null-space basis
     mg_param.smoother_halo_precision[i] = smoother_halo_prec; // precision of the halo exchange in the smoother
+    mg_param.precision_coarse_link[i] = coarse_link_prec; // precision to store the coarse link matrices in
     mg_param.nu_pre[i] = nu_pre[i];
     mg_param.nu_post[i] = nu_post[i];
     mg_param.mu_factor[i] = mu_factor[i];
@@ -279,6 +292,8 @@ void setMultigridParam(QudaMultigridParam &mg_param) {
     mg_param.coarse_solver[i] = coarse_solver[i];
     mg_param.coarse_solver_tol[i] = coarse_solver_tol[i];
     mg_param.coarse_solver_maxiter[i] = coarse_solver_maxiter[i];
+    mg_param.coarse_solver_deflate_nvec[i] = coarse_solver_deflate_nvec[i];
+    mg_param.coarse_solver_agglomerate_volume[i] = coarse_solver_agglomerate_volume[i];
 
     mg_param.smoother[i] = smoother_type[i];
 
@@ -297,6 +312,7 @@ void setMultigridParam(QudaMultigridParam &mg_param) {
 
     // set number of Schwarz cycles to apply
     mg_param.smoother_schwarz_cycle[i] = schwarz_cycle[i];
+    mg_param.smoother_schwarz_overlap[i] = schwarz_overlap[i];
 
     // Set set coarse_grid_solution_type: this defines which linear
     // system we are solving on a given level
@@ -389,6 +405,8 @@ void setMultigridParam(QudaMultigridParam &mg_param) {
   // set file i/o parameters
   strcpy(mg_param.vec_infile, vec_infile);
   strcpy(mg_param.vec_outfile, vec_outfile);
+  mg_param.vec_compact = vec_compact ? QUDA_BOOLEAN_YES : QUDA_BOOLEAN_NO;
+  strcpy(mg_param.setup_checkpoint, setup_checkpoint);
 
   // these need to tbe set for now but are actually ignored by the MG setup
   // needed to make it pass the initialization test
@@ -740,6 +758,9 @@ int main(int argc, char **argv)
     void *mg_preconditioner = newMultigridQuda(&mg_param);
     inv_param.preconditioner = mg_preconditioner;
 
+    // later setups reuse the adaptively chosen number of null-space vectors
+    for (int i=0; i<mg_levels-1; i++) mg_param.setup_adaptive_nvec[i] = QUDA_BOOLEAN_NO;
+
     invertQuda(spinorOut, spinorIn, &inv_param);
 
     freeGaugeQuda();
@@ -3,6 +3,7 @@
 #include <time.h>
 #include <math.h>
 #include <string.h>
+#include <sys/time.h>
 
 #include <util_quda.h>
 #include <test_util.h>
@@ -54,9 +55,13 @@ extern int niter;
 extern int gcrNkrylov; // number of inner iterations for GCR, or l for BiCGstab-l
 extern int pipeline; // length of pipeline for fused operations in GCR or BiCGstab-l
 extern int nvec[];
+extern bool adaptive_nvec[];
 extern int mg_levels;
 
 extern bool generate_nullspace;
+extern bool twisted_pair;
+extern bool compare_smoother;
+extern bool compare_link_prec;
 extern bool generate_all_levels;
 extern int nu_pre[QUDA_MAX_MG_LEVEL];
 extern int nu_post[QUDA_MAX_MG_LEVEL];
@@ -83,16 +88,23 @@ extern QudaInverterType smoother_type[QUDA_MAX_MG_LEVEL];
 extern double coarse_solver_tol[QUDA_MAX_MG_LEVEL];
 extern double smoother_tol[QUDA_MAX_MG_LEVEL];
 extern int coarse_solver_maxiter[QUDA_MAX_MG_LEVEL];
+extern int coarse_solver_deflate_nvec[QUDA_MAX_MG_LEVEL];
+extern int coarse_solver_agglomerate_volume[QUDA_MAX_MG_LEVEL];
 
 extern QudaPrecision smoother_halo_prec;
+extern QudaPrecision coarse_link_prec;
 extern QudaSchwarzType schwarz_type[QUDA_MAX_MG_LEVEL];
 extern int schwarz_cycle[QUDA_MAX_MG_LEVEL];
+extern int schwarz_overlap[QUDA_MAX_MG_LEVEL];
+extern int verify_n_evec[QUDA_MAX_MG_LEVEL];
 
 extern QudaMatPCType matpc_type;
 extern QudaSolveType solve_type;
 
 extern char vec_infile[];
 extern char vec_outfile[];
+extern bool vec_compact;
+extern char setup_checkpoint[];
 
 //Twisted mass flavor type
 extern QudaTwistFlavorType twist_flavor;
@@ -253,8 +265,11 @@ void setMultigridParam(QudaMultigridParam &mg_param) {
     mg_param.setup_maxiter[i] = setup_maxiter[i];
     mg_param.spin_block_size[i] = 1;
     mg_param.n_vec[i] = nvec[i] == 0 ? 24 : nvec[i]; // default to 24 vectors if not set
+    mg_param.setup_adaptive_nvec[i] = adaptive_nvec[i] ? QUDA_BOOLEAN_YES : QUDA_BOOLEAN_NO; // n_vec is then the maximum
+    mg_param.verify_n_evec[i] = verify_n_evec[i]; // eigenvectors whose null-space overlap the verification reports
     mg_param.precision_null[i] = prec_null; // precision to store the null-space basis
     mg_param.smoother_halo_precision[i] = smoother_halo_prec; // precision of the halo exchange in the smoother
+    mg_param.precision_coarse_link[i] = coarse_link_prec; // precision to store the coarse link matrices in
     mg_param.nu_pre[i] = nu_pre[i];
     mg_param.nu_post[i] = nu_post[i];
     mg_param.mu_factor[i] = mu_factor[i];
@@ -265,6 +280,8 @@ void setMultigridParam(QudaMultigridParam &mg_param) {
     mg_param.coarse_solver[i] = coarse_solver[i];
     mg_param.coarse_solver_tol[i] = coarse_solver_tol[i];
     mg_param.coarse_solver_maxiter[i] = coarse_solver_maxiter[i];
+    mg_param.coarse_solver_deflate_nvec[i] = coarse_solver_deflate_nvec[i];
+    mg_param.coarse_solver_agglomerate_volume[i] = coarse_solver_agglomerate_volume[i];
 
     mg_param.smoother[i] = smoother_type[i];
 
@@ -283,6 +300,7 @@ void setMultigridParam(QudaMultigridParam &mg_param) {
 
     // set number of Schwarz cycles to apply
     mg_param.smoother_schwarz_cycle[i] = schwarz_cycle[i];
+    mg_param.smoother_schwarz_overlap[i] = schwarz_overlap[i];
 
     // Set set coarse_grid_solution_type: this defines which linear
     // system we are solving on a given level
@@ -378,6 +396,8 @@ void setMultigridParam(QudaMultigridParam &mg_param) {
   // set file i/o parameters
   strcpy(mg_param.vec_infile, vec_infile);
   strcpy(mg_param.vec_outfile, vec_outfile);
+  mg_param.vec_compact = vec_compact ? QUDA_BOOLEAN_YES : QUDA_BOOLEAN_NO;
+  strcpy(mg_param.setup_checkpoint, setup_checkpoint);
 
   // these need to tbe set for now but are actually ignored by the MG setup
   // needed to make it pass the initialization test
@@ -623,6 +643,18 @@ int main(int argc, char **argv)
   void *mg_preconditioner = newMultigridQuda(&mg_param);
   inv_param.preconditioner = mg_preconditioner;
 
+  int fail = 0;
+
+  // report the adaptively chosen number of null-space vectors for reuse in later runs
+  for (int i=0; i<mg_levels-1; i++) {
+    if (mg_param.setup_adaptive_nvec[i] != QUDA_BOOLEAN_YES) continue;
+    int max_nvec = nvec[i] == 0 ? 24 : nvec[i];
+    bool ok = mg_param.n_vec[i] >= 1 && mg_param.n_vec[i] <= max_nvec;
+    printfQuda("Chosen null-space vectors: --mg-nvec %d %d (maximum %d, %s)\n", i, mg_param.n_vec[i], max_nvec,
+               ok ? "PASSED" : "FAILED");
+    if (!ok) fail = 1;
+  }
+
   for (int i=0; i<Nsrc; i++) {
     // create a point source at 0 (in each subvolume...  FIXME)
     memset(spinorIn, 0, inv_param.Ls*V*spinorSiteSize*sSize);
@@ -640,6 +672,125 @@ int main(int argc, char **argv)
     invertQuda(spinorOut, spinorIn, &inv_param);
   }
 
+  if (twisted_pair) {
+    if (dslash_type != QUDA_TWISTED_MASS_DSLASH && dslash_type != QUDA_TWISTED_CLOVER_DSLASH) {
+      printfQuda("Paired flavor solve requires a twisted dslash type\n");
+      exit(-1);
+    }
+
+    auto wall_time = []() { timeval t; gettimeofday(&t, NULL); return t.tv_sec + 1e-6*t.tv_usec; };
+    void *spinorOutMinus = malloc(V*spinorSiteSize*sSize*inv_param.Ls);
+    void *spinorSepPlus = malloc(V*spinorSiteSize*sSize*inv_param.Ls);
+    void *spinorSepMinus = malloc(V*spinorSiteSize*sSize*inv_param.Ls);
+
+    // both flavors with the hierarchy built once for mu
+    double t_pair = -wall_time();
+    invertTwistedPairQuda(spinorOut, spinorOutMinus, spinorIn, &inv_param);
+    t_pair += wall_time();
+    int iter_pair = inv_param.iter;
+
+    // the same two solves done separately, with the coarse operators rebuilt for -mu
+    double t_separate = -wall_time();
+    invertQuda(spinorSepPlus, spinorIn, &inv_param);
+    int iter_separate = inv_param.iter;
+    inv_param.mu = mg_inv_param.mu = -mu;
+    updateMultigridQuda(mg_preconditioner, &mg_param);
+    invertQuda(spinorSepMinus, spinorIn, &inv_param);
+    iter_separate += inv_param.iter;
+    inv_param.mu = mg_inv_param.mu = mu;
+    updateMultigridQuda(mg_preconditioner, &mg_param);
+    t_separate += wall_time();
+
+    printfQuda("Paired flavor solve: %d iterations in %g secs, against %d iterations in %g secs for two separate solves\n",
+               iter_pair, t_pair, iter_separate, t_separate);
+
+    // each flavor of the paired solve must meet the solver tolerance
+    // on its own operator, and agree with the separate solve
+    const int pair_len = (inv_param.solution_type == QUDA_MAT_SOLUTION ? V : Vh)*spinorSiteSize*inv_param.Ls;
+    const double src2 = norm_2(spinorIn, pair_len, inv_param.cpu_prec);
+    void *pair[] = { spinorOut, spinorOutMinus };
+    void *separate[] = { spinorSepPlus, spinorSepMinus };
+    for (int flavor=0; flavor<2; flavor++) {
+      inv_param.mu = flavor == 0 ? mu : -mu;
+      MatQuda(spinorCheck, pair[flavor], &inv_param);
+      mxpy(spinorIn, spinorCheck, pair_len, inv_param.cpu_prec);
+      double l2r = sqrt(norm_2(spinorCheck, pair_len, inv_param.cpu_prec) / src2);
+
+      memcpy(spinorCheck, separate[flavor], pair_len*sSize);
+      mxpy(pair[flavor], spinorCheck, pair_len, inv_param.cpu_prec);
+      double dev = sqrt(norm_2(spinorCheck, pair_len, inv_param.cpu_prec) /
+                        norm_2(separate[flavor], pair_len, inv_param.cpu_prec));
+
+      bool ok = l2r < 10 * inv_param.tol;
+      printfQuda("Paired flavor solve, mu = %+g: true residual = %e, relative deviation from separate solve = %e (%s)\n",
+                 inv_param.mu, l2r, dev, ok ? "PASSED" : "FAILED");
+      if (!ok) fail = 1;
+    }
+    inv_param.mu = mu;
+
+    free(spinorSepMinus);
+    free(spinorSepPlus);
+    free(spinorOutMinus);
+  }
+
+  if (compare_smoother) {
+    auto wall_time = []() { timeval t; gettimeofday(&t, NULL); return t.tv_sec + 1e-6*t.tv_usec; };
+    void *spinorCompare = malloc(V*spinorSiteSize*sSize*inv_param.Ls);
+
+    // the same source solved with the requested smoothers and with MR smoothers on every level
+    double t_smoother = -wall_time();
+    invertQuda(spinorCompare, spinorIn, &inv_param);
+    t_smoother += wall_time();
+    int iter_smoother = inv_param.iter;
+
+    destroyMultigridQuda(mg_preconditioner);
+    for (int i=0; i<mg_levels; i++) mg_param.smoother[i] = QUDA_MR_INVERTER;
+    mg_preconditioner = newMultigridQuda(&mg_param);
+    inv_param.preconditioner = mg_preconditioner;
+
+    double t_mr = -wall_time();
+    invertQuda(spinorCompare, spinorIn, &inv_param);
+    t_mr += wall_time();
+    int iter_mr = inv_param.iter;
+
+    for (int i=0; i<mg_levels; i++) mg_param.smoother[i] = smoother_type[i];
+
+    // the polynomial smoother may cost a few outer iterations, but no more
+    bool ok = iter_smoother <= iter_mr + (iter_mr / 10 > 2 ? iter_mr / 10 : 2);
+    printfQuda("Smoother comparison: %d iterations in %g secs with the requested smoothers, against %d iterations in %g secs with MR smoothers (%s)\n",
+               iter_smoother, t_smoother, iter_mr, t_mr, ok ? "PASSED" : "FAILED");
+    if (!ok) fail = 1;
+
+    free(spinorCompare);
+  }
+
+  if (compare_link_prec) {
+    void *spinorCompare = malloc(V*spinorSiteSize*sSize*inv_param.Ls);
+
+    // the same source solved with the coarse links in the requested
+    // storage precision and in the null-space precision
+    invertQuda(spinorCompare, spinorIn, &inv_param);
+    int iter_link = inv_param.iter;
+
+    destroyMultigridQuda(mg_preconditioner);
+    for (int i=0; i<mg_levels; i++) mg_param.precision_coarse_link[i] = QUDA_INVALID_PRECISION;
+    mg_preconditioner = newMultigridQuda(&mg_param);
+    inv_param.preconditioner = mg_preconditioner;
+
+    invertQuda(spinorCompare, spinorIn, &inv_param);
+    int iter_null = inv_param.iter;
+
+    for (int i=0; i<mg_levels; i++) mg_param.precision_coarse_link[i] = coarse_link_prec;
+
+    // compressed links may cost a few outer iterations, but no more
+    bool ok = iter_link <= iter_null + (iter_null / 10 > 2 ? iter_null / 10 : 2);
+    printfQuda("Coarse link precision comparison: %d iterations with link precision %d, against %d iterations in the null-space precision (%s)\n",
+               iter_link, coarse_link_prec, iter_null, ok ? "PASSED" : "FAILED");
+    if (!ok) fail = 1;
+
+    free(spinorCompare);
+  }
+
   // free the multigrid solver
   destroyMultigridQuda(mg_preconditioner);
 
@@ -721,5 +872,5 @@ int main(int argc, char **argv)
 
   for (int dir = 0; dir<4; dir++) free(gauge[dir]);
 
-  return 0;
+  return fail;
 }
@@ -1645,6 +1645,7 @@ QudaPrecision prec = QUDA_SINGLE_PRECISION;
 QudaPrecision prec_sloppy = QUDA_INVALID_PRECISION;
 QudaPrecision prec_refinement_sloppy = QUDA_INVALID_PRECISION;
 QudaPrecision prec_precondition = QUDA_INVALID_PRECISION;
+QudaPrecision prec_adaptive = QUDA_INVALID_PRECISION;
 QudaPrecision prec_null = QUDA_INVALID_PRECISION;
 QudaPrecision  prec_ritz = QUDA_INVALID_PRECISION;
 QudaVerbosity verbosity = QUDA_SUMMARIZE;
@@ -1661,12 +1662,18 @@ int Nsrc = 1;
 int Msrc = 1;
 int niter = 100;
 int gcrNkrylov = 10;
+QudaCABasis ca_basis = QUDA_POWER_BASIS;
+double ca_lambda_min = 0.0;
+double ca_lambda_max = -1.0;
 int pipeline = 0;
 int solution_accumulator_pipeline = 0;
 int test_type = 0;
 int nvec[QUDA_MAX_MG_LEVEL] = { };
+bool adaptive_nvec[QUDA_MAX_MG_LEVEL] = { };
 char vec_infile[256] = "";
 char vec_outfile[256] = "";
+bool vec_compact = false;
+char setup_checkpoint[256] = "";
 QudaInverterType inv_type;
 QudaInverterType precon_type = QUDA_INVALID_INVERTER;
 int multishift = 0;
@@ -1707,6 +1714,7 @@ int num_setup_iter[QUDA_MAX_MG_LEVEL] = { };
 double setup_tol[QUDA_MAX_MG_LEVEL] = { };
 int setup_maxiter[QUDA_MAX_MG_LEVEL] = { };
 int setup_maxiter_refresh[QUDA_MAX_MG_LEVEL] = { };
+double setup_refresh_tol[QUDA_MAX_MG_LEVEL] = { };
 QudaSetupType setup_type = QUDA_NULL_VECTOR_SETUP;
 bool pre_orthonormalize = false;
 bool post_orthonormalize = true;
@@ -1715,12 +1723,20 @@ QudaInverterType coarse_solver[QUDA_MAX_MG_LEVEL] = { };
 double coarse_solver_tol[QUDA_MAX_MG_LEVEL] = { };
 QudaInverterType smoother_type[QUDA_MAX_MG_LEVEL] = { };
 QudaPrecision smoother_halo_prec = QUDA_INVALID_PRECISION;
+QudaPrecision coarse_link_prec = QUDA_INVALID_PRECISION;
 double smoother_tol[QUDA_MAX_MG_LEVEL] = { };
 int coarse_solver_maxiter[QUDA_MAX_MG_LEVEL] = { };
+int coarse_solver_deflate_nvec[QUDA_MAX_MG_LEVEL] = { };
+int coarse_solver_agglomerate_volume[QUDA_MAX_MG_LEVEL] = { };
 bool generate_nullspace = true;
+bool twisted_pair = false;
+bool compare_smoother = false;
+bool compare_link_prec = false;
 bool generate_all_levels = true;
 QudaSchwarzType schwarz_type[QUDA_MAX_MG_LEVEL] = { };
 int schwarz_cycle[QUDA_MAX_MG_LEVEL] = { };
+int schwarz_overlap[QUDA_MAX_MG_LEVEL] = { };
+int verify_n_evec[QUDA_MAX_MG_LEVEL] = { };
 
 int geo_block_size[QUDA_MAX_MG_LEVEL][QUDA_MAX_DIM] = { };
 int nev = 8;
@@ -1737,6 +1753,7 @@ QudaExtLibType solver_ext_lib     = QUDA_EIGEN_EXTLIB;
 QudaExtLibType deflation_ext_lib  = QUDA_EIGEN_EXTLIB;
 QudaFieldLocation location_ritz   = QUDA_CUDA_FIELD_LOCATION;
 QudaMemoryType    mem_type_ritz   = QUDA_MEMORY_DEVICE;
+bool df_vec_store = false;
 
 double heatbath_beta_value = 6.2;
 int heatbath_warmup_steps = 10;
@@ -1766,6 +1783,7 @@ void usage(char** argv )
   printf("    --prec <double/single/half>               # Precision in GPU\n");
   printf("    --prec-sloppy <double/single/half>        # Sloppy precision in GPU\n");
   printf("    --prec-refine <double/single/half>        # Sloppy precision for refinement in GPU\n");
+  printf("    --prec-adaptive <single/half>             # Starting sloppy precision of adaptive-precision CG (default disabled)\n");
   printf("    --prec-precondition <double/single/half>  # Preconditioner precision in GPU\n");
   printf("    --prec-ritz <double/single/half>  # Eigenvector precision in GPU\n");
   printf("    --recon <8/9/12/13/18>                    # Link reconstruction type\n");
@@ -1794,7 +1812,10 @@ void usage(char** argv )
   printf("    --load-gauge file                         # Load gauge field \"file\" for the test (requires QIO)\n");
   printf("    --save-gauge file                         # Save gauge field \"file\" for the test (requires QIO, heatbath test only)\n");
   printf("    --niter <n>                               # The number of iterations to perform (default 10)\n");
-  printf("    --ngcrkrylov <n>                          # The number of inner iterations to use for GCR, BiCGstab-l (default 10)\n");
+  printf("    --ngcrkrylov <n>                          # The number of inner iterations to use for GCR, BiCGstab-l, CA-CG (default 10)\n");
+  printf("    --ca-basis-type <power/chebyshev>         # The basis to use for CA-CG (default power)\n");
+  printf("    --cheby-basis-eig-min <val>               # Lower bound on the spectrum for the CA-CG Chebyshev basis (default 0)\n");
+  printf("    --cheby-basis-eig-max <val>               # Upper bound on the spectrum for the CA-CG Chebyshev basis (default is to estimate it)\n");
   printf("    --pipeline <n>                            # The pipeline length for fused operations in GCR, BiCGstab-l (default 0, no pipelining)\n");
   printf("    --solution-pipeline <n>                   # The pipeline length for fused solution accumulation (default 0, no pipelining)\n");
   printf("    --inv-type <cg/bicgstab/gcr>              # The type of solver to use (default cg)\n");
@@ -1818,6 +1839,7 @@ void usage(char** argv )
   printf("    --test                                    # Test method (different for each test)\n");
   printf("    --verify <true/false>                     # Verify the GPU results using CPU results (default true)\n");
   printf("    --mg-nvec <level nvec>                    # Number of null-space vectors to define the multigrid transfer operator on a given level\n");
+  printf("    --mg-adaptive-nvec <level true/false>     # Choose the number of null-space vectors on a given level adaptively, with --mg-nvec as the maximum (default false)\n");
   printf("    --mg-gpu-prolongate <true/false>          # Whether to do the multigrid transfer operators on the GPU (default false)\n");
   printf("    --mg-levels <2+>                          # The number of multigrid levels to do (default 2)\n");
   printf("    --mg-nu-pre <level 1-20>                  # The number of pre-smoother applications to do at a given multigrid level (default 2)\n");
@@ -1829,6 +1851,7 @@ void usage(char** argv )
   printf("    --mg-setup-inv <level inv>                # The inverter to use for the setup of multigrid (default bicgstab)\n");
   printf("    --mg-setup-maxiter <level iter>           # The maximum number of solver iterations to use when relaxing on a null space vector (default 500)\n");
   printf("    --mg-setup-maxiter-refresh <level iter>   # The maximum number of solver iterations to use when refreshing the pre-existing null space vectors (default 100)\n");
+  printf("    --mg-setup-refresh-tol <level tol>        # The null-space deviation above which a refresh rebuilds the prolongator (default 0, always rebuild)\n");
   printf("    --mg-setup-iters <level iter>             # The number of setup iterations to use for the multigrid (default 1)\n");
   printf("    --mg-setup-tol <level tol>                # The tolerance to use for the setup of multigrid (default 5e-6)\n");
   printf("    --mg-setup-type <null/test>               # The type of setup to use for the multigrid (default null)\n");
@@ -1838,17 +1861,27 @@ void usage(char** argv )
   printf("    --mg-coarse-solver <level gcr/etc.>       # The solver to wrap the V cycle on each level (default gcr, only for levels 1+)\n");
   printf("    --mg-coarse-solver-tol <level gcr/etc.>   # The coarse solver tolerance for each level (default 0.25, only for levels 1+)\n");
   printf("    --mg-coarse-solver-maxiter <level n>      # The coarse solver maxiter for each level (default 100)\n");
-  printf("    --mg-smoother <level mr/etc.>             # The smoother to use for multigrid (default mr)\n");
+  printf("    --mg-coarse-solver-deflate <level n>      # The number of low singular vectors that deflate the coarse solver on each level (default 0)\n");
+  printf("    --mg-coarse-solver-agglomerate <level v>  # Gather the coarsest solve onto fewer processes while the local volume of the level is below v sites (default 0, requires MPI)\n");
+  printf("    --mg-smoother <level mr/etc.>             # The smoother to use for multigrid, e.g. mr, gmres-poly or chebyshev (default mr)\n");
   printf("    --mg-smoother-tol <level resid_tol>       # The smoother tolerance to use for each multigrid (default 0.25)\n");
   printf("    --mg-smoother-halo-prec                   # The smoother halo precision (applies to all levels - defaults to null_precision)\n");
+  printf("    --mg-coarse-link-prec <prec>              # Precision to store the coarse link matrices in (applies to all levels - defaults to null_precision)\n");
   printf("    --mg-schwarz-type <level false/add/mul>   # Whether to use Schwarz preconditioning (requires MR smoother and GCR setup solver) (default false)\n");
   printf("    --mg-schwarz-cycle <level cycle>          # The number of Schwarz cycles to apply per smoother application (default=1)\n");
+  printf("    --mg-schwarz-overlap <level n>            # Overlap depth of restricted additive Schwarz on a coarse level (requires mg-schwarz-type add and mg-solver-location cpu) (default=0)\n");
+  printf("    --mg-verify-nevec <level n>               # Number of eigenvectors whose null-space overlap the verification reports on a level (requires verify) (default=0)\n");
   printf("    --mg-block-size <level x y z t>           # Set the geometric block size for the each multigrid level's transfer operator (default 4 4 4 4)\n");
   printf("    --mg-mu-factor <level factor>             # Set the multiplicative factor for the twisted mass mu parameter on each level (default 1)\n");
   printf("    --mg-generate-nullspace <true/false>      # Generate the null-space vector dynamically (default true, if set false and mg-load-vec isn't set, creates free-field null vectors)\n");
   printf("    --mg-generate-all-levels <true/talse>     # true=generate null-space on all levels, false=generate on level 0 and create other levels from that (default true)\n");
   printf("    --mg-load-vec file                        # Load the vectors \"file\" for the multigrid_test (requires QIO)\n");
-  printf("    --mg-save-vec file                        # Save the generated null-space vectors \"file\" from the multigrid_test (requires QIO)\n");
+  printf("    --mg-save-vec file                        # Save the generated null-space vectors \"file\" from the multigrid_test (requires QIO unless compact)\n");
+  printf("    --mg-vec-compact <true/false>             # Save the null-space vectors in the compact 16-bit native format (default false)\n");
+  printf("    --mg-setup-checkpoint file                # Restore the multigrid setup from checkpoint \"file\" if it matches, else save it there\n");
+  printf("    --mg-twisted-pair <true/false>            # Solve for both +mu and -mu with one hierarchy and compare against separate solves (default false)\n");
+  printf("    --mg-compare-smoother <true/false>        # Compare the time to solution against a hierarchy with MR smoothers on every level (default false)\n");
+  printf("    --mg-compare-link-prec <true/false>       # Compare the iteration count against a hierarchy with the coarse links in null_precision (default false)\n");
   printf("    --mg-verbosity <level verb>                # The verbosity to use on each level of the multigrid (default summarize)\n");
   printf("    --df-nev <nev>                            # Set number of eigenvectors computed within a single solve cycle (default 8)\n");
   printf("    --df-max-search-dim <dim>                 # Set the size of eigenvector search space (default 64)\n");
@@ -1864,8 +1897,9 @@ void usage(char** argv )
   printf("    --df-ext-lib-type <eigen/magma>           # Set external library for the deflation methods  (default Eigen library)\n");
   printf("    --df-location-ritz <host/cuda>            # Set memory location for the ritz vectors  (default cuda memory location)\n");
   printf("    --df-mem-type-ritz <device/pinned/mapped> # Set memory type for the ritz vectors  (default device memory type)\n");
+  printf("    --df-vec-store <true/false>               # Keep the deflation space in a memory-mapped native store rather than a SciDAC file (default false)\n");
 
-  printf("    --nsrc <n>                                # How many spinors to apply the dslash to simultaneusly (experimental for staggered only)\n");
+  printf("    --nsrc <n>                                # How many spinors to apply the dslash to simultaneusly (experimental for staggered and the coarse operator)\n");
 
   printf("    --msrc <n>                                # Used for testing non-square block blas routines where nsrc defines the other dimension\n");
   printf("    --heatbath-beta <beta>                    # Beta value used in heatbath test (default 6.2)\n");
@@ -1986,6 +2020,16 @@ int process_command_line_option(int argc, char** argv, int* idx)
     goto out;
   }
 
+  if( strcmp(argv[i], "--prec-adaptive") == 0){
+    if (i+1 >= argc){
+      usage(argv);
+    }
+    prec_adaptive =  get_prec(argv[i+1]);
+    i++;
+    ret = 0;
+    goto out;
+  }
+
   if( strcmp(argv[i], "--prec-null") == 0){
     if (i+1 >= argc){
       usage(argv);
@@ -2633,6 +2677,30 @@ int process_command_line_option(int argc, char** argv, int* idx)
     goto out;
   }
 
+  if( strcmp(argv[i], "--mg-adaptive-nvec") == 0){
+    if (i+2 >= argc){
+      usage(argv);
+    }
+    int level = atoi(argv[i+1]);
+    if (level < 0 || level >= QUDA_MAX_MG_LEVEL) {
+      printf("ERROR: invalid multigrid level %d", level);
+      usage(argv);
+    }
+    i++;
+
+    if (strcmp(argv[i+1], "true") == 0){
+      adaptive_nvec[level] = true;
+    }else if (strcmp(argv[i+1], "false") == 0){
+      adaptive_nvec[level] = false;
+    }else{
+      fprintf(stderr, "ERROR: invalid value for adaptive_nvec type\n");
+      exit(1);
+    }
+    i++;
+    ret = 0;
+    goto out;
+  }
+
   if( strcmp(argv[i], "--mg-levels") == 0){
     if (i+1 >= argc){
       usage(argv);
@@ -2845,6 +2913,23 @@ int process_command_line_option(int argc, char** argv, int* idx)
     goto out;
   }
 
+  if( strcmp(argv[i], "--mg-setup-refresh-tol") == 0){
+    if (i+2 >= argc){
+      usage(argv);
+    }
+    int level = atoi(argv[i+1]);
+    if (level < 0 || level >= QUDA_MAX_MG_LEVEL) {
+      printf("ERROR: invalid multigrid level %d", level);
+      usage(argv);
+    }
+    i++;
+
+    setup_refresh_tol[level] = atof(argv[i+1]);
+    i++;
+    ret = 0;
+    goto out;
+  }
+
   if( strcmp(argv[i], "--mg-setup-type") == 0){
     if (i+1 >= argc){
       usage(argv);
@@ -3017,6 +3102,42 @@ int process_command_line_option(int argc, char** argv, int* idx)
     goto out;
   }
 
+  if( strcmp(argv[i], "--mg-coarse-solver-deflate") == 0){
+    if (i+2 >= argc){
+      usage(argv);
+    }
+
+    int level = atoi(argv[i+1]);
+    if (level < 1 || level >= QUDA_MAX_MG_LEVEL) {
+      printf("ERROR: invalid multigrid level %d for coarse solver", level);
+      usage(argv);
+    }
+    i++;
+
+    coarse_solver_deflate_nvec[level] = atoi(argv[i+1]);
+    i++;
+    ret = 0;
+    goto out;
+  }
+
+  if( strcmp(argv[i], "--mg-coarse-solver-agglomerate") == 0){
+    if (i+2 >= argc){
+      usage(argv);
+    }
+
+    int level = atoi(argv[i+1]);
+    if (level < 1 || level >= QUDA_MAX_MG_LEVEL) {
+      printf("ERROR: invalid multigrid level %d for coarse solver", level);
+      usage(argv);
+    }
+    i++;
+
+    coarse_solver_agglomerate_volume[level] = atoi(argv[i+1]);
+    i++;
+    ret = 0;
+    goto out;
+  }
+
 
   if( strcmp(argv[i], "--mg-smoother-halo-prec") == 0){
     if (i+1 >= argc){
@@ -3028,6 +3149,16 @@ int process_command_line_option(int argc, char** argv, int* idx)
     goto out;
   }
 
+  if( strcmp(argv[i], "--mg-coarse-link-prec") == 0){
+    if (i+1 >= argc){
+      usage(argv);
+    }
+    coarse_link_prec =  get_prec(argv[i+1]);
+    i++;
+    ret = 0;
+    goto out;
+  }
+
 
   if( strcmp(argv[i], "--mg-schwarz-type") == 0){
     if (i+2 >= argc){
@@ -3068,6 +3199,50 @@ int process_command_line_option(int argc, char** argv, int* idx)
     goto out;
   }
 
+  if( strcmp(argv[i], "--mg-verify-nevec") == 0){
+    if (i+2 >= argc){
+      usage(argv);
+    }
+    int level = atoi(argv[i+1]);
+    if (level < 0 || level >= QUDA_MAX_MG_LEVEL) {
+      printf("ERROR: invalid multigrid level %d", level);
+      usage(argv);
+    }
+    i++;
+
+    verify_n_evec[level] = atoi(argv[i+1]);
+    if (verify_n_evec[level] < 0) {
+      printf("ERROR: invalid number of eigenvectors %d requested for level %d",
+	     verify_n_evec[level], level);
+      usage(argv);
+    }
+    i++;
+    ret = 0;
+    goto out;
+  }
+
+  if( strcmp(argv[i], "--mg-schwarz-overlap") == 0){
+    if (i+2 >= argc){
+      usage(argv);
+    }
+    int level = atoi(argv[i+1]);
+    if (level < 1 || level >= QUDA_MAX_MG_LEVEL) {
+      printf("ERROR: invalid multigrid level %d", level);
+      usage(argv);
+    }
+    i++;
+
+    schwarz_overlap[level] = atoi(argv[i+1]);
+    if (schwarz_overlap[level] < 0) {
+      printf("ERROR: invalid Schwarz overlap %d requested for level %d",
+	     schwarz_overlap[level], level);
+      usage(argv);
+    }
+    i++;
+    ret = 0;
+    goto out;
+  }
+
   if( strcmp(argv[i], "--mg-block-size") == 0){
     if (i+5 >= argc){
       usage(argv);
@@ -3133,6 +3308,63 @@ int process_command_line_option(int argc, char** argv, int* idx)
     goto out;
   }
 
+  if( strcmp(argv[i], "--mg-twisted-pair") == 0){
+    if (i+1 >= argc){
+      usage(argv);
+    }
+
+    if (strcmp(argv[i+1], "true") == 0){
+      twisted_pair = true;
+    }else if (strcmp(argv[i+1], "false") == 0){
+      twisted_pair = false;
+    }else{
+      fprintf(stderr, "ERROR: invalid twisted pair type\n");
+      exit(1);
+    }
+
+    i++;
+    ret = 0;
+    goto out;
+  }
+
+  if( strcmp(argv[i], "--mg-compare-smoother") == 0){
+    if (i+1 >= argc){
+      usage(argv);
+    }
+
+    if (strcmp(argv[i+1], "true") == 0){
+      compare_smoother = true;
+    }else if (strcmp(argv[i+1], "false") == 0){
+      compare_smoother = false;
+    }else{
+      fprintf(stderr, "ERROR: invalid compare smoother type\n");
+      exit(1);
+    }
+
+    i++;
+    ret = 0;
+    goto out;
+  }
+
+  if( strcmp(argv[i], "--mg-compare-link-prec") == 0){
+    if (i+1 >= argc){
+      usage(argv);
+    }
+
+    if (strcmp(argv[i+1], "true") == 0){
+      compare_link_prec = true;
+    }else if (strcmp(argv[i+1], "false") == 0){
+      compare_link_prec = false;
+    }else{
+      fprintf(stderr, "ERROR: invalid compare link precision type\n");
+      exit(1);
+    }
+
+    i++;
+    ret = 0;
+    goto out;
+  }
+
   if( strcmp(argv[i], "--mg-generate-nullspace") == 0){
     if (i+1 >= argc){
       usage(argv);
@@ -3191,6 +3423,35 @@ int process_command_line_option(int argc, char** argv, int* idx)
     goto out;
   }
 
+  if( strcmp(argv[i], "--mg-vec-compact") == 0){
+    if (i+1 >= argc){
+      usage(argv);
+    }
+
+    if (strcmp(argv[i+1], "true") == 0){
+      vec_compact = true;
+    }else if (strcmp(argv[i+1], "false") == 0){
+      vec_compact = false;
+    }else{
+      fprintf(stderr, "ERROR: invalid value for vec_compact type\n");
+      exit(1);
+    }
+
+    i++;
+    ret = 0;
+    goto out;
+  }
+
+  if( strcmp(argv[i], "--mg-setup-checkpoint") == 0){
+    if (i+1 >= argc){
+      usage(argv);
+    }
+    strcpy(setup_checkpoint, argv[i+1]);
+    i++;
+    ret = 0;
+    goto out;
+  }
+
   if( strcmp(argv[i], "--df-nev") == 0){
     if (i+1 >= argc){
       usage(argv);
@@ -3322,6 +3583,25 @@ int process_command_line_option(int argc, char** argv, int* idx)
     goto out;
   }
 
+  if( strcmp(argv[i], "--df-vec-store") == 0){
+    if (i+1 >= argc){
+      usage(argv);
+    }
+
+    if (strcmp(argv[i+1], "true") == 0){
+      df_vec_store = true;
+    }else if (strcmp(argv[i+1], "false") == 0){
+      df_vec_store = false;
+    }else{
+      fprintf(stderr, "ERROR: invalid value for df_vec_store type\n");
+      exit(1);
+    }
+
+    i++;
+    ret = 0;
+    goto out;
+  }
+
   if( strcmp(argv[i], "--niter") == 0){
     if (i+1 >= argc){
       usage(argv);
@@ -3349,6 +3629,40 @@ int process_command_line_option(int argc, char** argv, int* idx)
     ret = 0;
     goto out;
   }
+
+  if( strcmp(argv[i], "--ca-basis-type") == 0){
+    if (i+1 >= argc){
+      usage(argv);
+    }
+    ca_basis = get_ca_basis_type(argv[i+1]);
+    i++;
+    ret = 0;
+    goto out;
+  }
+
+  if( strcmp(argv[i], "--cheby-basis-eig-min") == 0){
+    if (i+1 >= argc){
+      usage(argv);
+    }
+    ca_lambda_min = atof(argv[i+1]);
+    if (ca_lambda_min < 0.0){
+      printf("ERROR: invalid Chebyshev basis lower bound (%e)\n", ca_lambda_min);
+      usage(argv);
+    }
+    i++;
+    ret = 0;
+    goto out;
+  }
+
+  if( strcmp(argv[i], "--cheby-basis-eig-max") == 0){
+    if (i+1 >= argc){
+      usage(argv);
+    }
+    ca_lambda_max = atof(argv[i+1]);
+    i++;
+    ret = 0;
+    goto out;
+  }
   
   if( strcmp(argv[i], "--pipeline") == 0){
     if (i+1 >= argc){